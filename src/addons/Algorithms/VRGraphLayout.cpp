@@ -1,13 +1,19 @@
 #include "VRGraphLayout.h"
-#include "core/math/Octree.h"
+#include "core/math/VRSpatialIndexT.h"
+#include "core/scene/VRScene.h"
+#include "core/utils/VRFunction.h"
+
+#include <boost/bind.hpp>
+#include <cmath>
 
 using namespace OSG;
 
 VRGraphLayout::VRGraphLayout() {}
+VRGraphLayout::~VRGraphLayout() { stop(); }
 
 VRGraphLayoutPtr VRGraphLayout::create() { return VRGraphLayoutPtr( new VRGraphLayout() ); }
 
-void VRGraphLayout::setGraph(GraphPtr g) { graph = g; }
+void VRGraphLayout::setGraph(GraphPtr g) { graph = g; px.clear(); }
 GraphPtr VRGraphLayout::getGraph() { return graph; }
 void VRGraphLayout::setAlgorithm(ALGORITHM a, int p) { algorithms[p] = a; }
 void VRGraphLayout::clearAlgorithms() { algorithms.clear(); }
@@ -17,117 +23,219 @@ void VRGraphLayout::setAlgorithm(string a, int p) {
     setAlgorithm(A, p);
 }
 
-void VRGraphLayout::applySprings(float eps, float v) {
-    if (!graph) return;
+/** copies the node boxes and the edges of the graph, the velocities are kept as long as the graph size does not change **/
+void VRGraphLayout::load() {
+    auto& nodes = graph->getNodes();
+    int N = nodes.size();
+    if (N != (int)px.size()) {
+        for (auto v : { &px, &py, &pz, &fx, &fy, &fz, &hx, &hy, &hz, &radii }) v->assign(N, 0);
+        for (auto v : { &vx, &vy, &vz }) v->assign(N, 0);
+        states.assign(N, NONE);
+    }
+
+    for (int i=0; i<N; i++) {
+        auto& b = nodes[i].box;
+        Vec3f c = b.center();
+        Vec3f s = b.size()*0.5;
+        px[i] = c[0]; py[i] = c[1]; pz[i] = c[2];
+        hx[i] = s[0]; hy[i] = s[1]; hz[i] = s[2];
+        radii[i] = b.radius();
+        states[i] = getFlag(i);
+    }
+
+    // edges as links per node, both ends know the edge
+    linkOffsets.assign(N+1, 0);
     for (auto& n : graph->getEdges()) {
         for (auto& e : n) {
-            auto f1 = getFlag(e.from);
-            auto f2 = getFlag(e.to);
-            if (f1 & INACTIVE || f2 & INACTIVE) continue;
-
-            auto& n1 = graph->getNode(e.from);
-            auto& n2 = graph->getNode(e.to);
-            Vec3f p1 = n1.box.center();
-            Vec3f p2 = n2.box.center();
-
-            float r = radius + n1.box.radius() + n2.box.radius();
-            Vec3f d = p2 - p1;
-            float x = d.length() - r; // displacement
-            d.normalize();
-            if (abs(x) < eps) continue;
-
-            p1 += d*x*v;
-            p2 += -d*x*v;
-            auto po1 = graph->getPosition(e.from);
-            auto po2 = graph->getPosition(e.to);
-            po1->setPos(p1);
-            po2->setPos(p2);
-            switch (e.connection) {
-                case Graph::SIMPLE:
-                    if (!(f1 & FIXED)) graph->setPosition(e.from, po1);
-                    if (!(f2 & FIXED)) graph->setPosition(e.to, po2);
-                    break;
-                case Graph::HIERARCHY:
-                    if (!(f2 & FIXED)) graph->setPosition(e.to, po2);
-                    else if (!(f1 & FIXED)) graph->setPosition(e.from, po1);
-                    break;
-                case Graph::DEPENDENCY:
-                    if (!(f1 & FIXED)) graph->setPosition(e.from, po1);
-                    else if (!(f2 & FIXED)) graph->setPosition(e.to, po2);
-                    break;
-                case Graph::SIBLING:
-                    if (x < 0) { // push away siblings
-                        if (!(f1 & FIXED)) graph->setPosition(e.from, po1);
-                        if (!(f2 & FIXED)) graph->setPosition(e.to, po2);
-                    }
-                    break;
-            }
+            if (e.from < 0 || e.to < 0 || e.from >= N || e.to >= N) continue;
+            linkOffsets[e.from+1]++;
+            linkOffsets[e.to+1]++;
+        }
+    }
+    for (int i=0; i<N; i++) linkOffsets[i+1] += linkOffsets[i];
+    links.resize(linkOffsets[N]);
+    vector<int> fill(linkOffsets.begin(), linkOffsets.end()-1);
+    for (auto& n : graph->getEdges()) {
+        for (auto& e : n) {
+            if (e.from < 0 || e.to < 0 || e.from >= N || e.to >= N) continue;
+            links[fill[e.from]++] = { e.to, e.connection, true };
+            links[fill[e.to]++] = { e.from, e.connection, false };
         }
     }
 }
 
-void VRGraphLayout::applyOccupancy(float eps, float v) {
-    if (!graph) return;
+/** writes the box centers of the moved nodes back to the graph **/
+void VRGraphLayout::store() {
     auto& nodes = graph->getNodes();
-    Octree o(10*eps);
-
-    for (unsigned long i=0; i<nodes.size(); i++) {
-        if ( isFlag(i, INACTIVE) ) continue;
-        auto& n = nodes[i];
-        o.addBox( n.box, (void*)i );
+    int N = min(nodes.size(), px.size());
+    for (int i=0; i<N; i++) {
+        bool moved = !(states[i] & (FIXED | INACTIVE));
+        if (moved) {
+            Vec3f p(px[i], py[i], pz[i]);
+            nodes[i].box.setCenter(p);
+            nodes[i].p.setPos(p);
+        }
+        graph->update(i, moved);
     }
+}
 
-    for (uint i=0; i<nodes.size(); i++) {
-        if ( isFlag(i, FIXED) || isFlag(i, INACTIVE) ) continue;
-        auto& n = nodes[i];
-        Vec3f pn = n.box.center();
-
-        Vec3f D;
-        for (auto& on2 : o.boxSearch(n.box) ) {
-            uint j = (long)on2;
-            if (i == j) continue; // no self interaction
-
-            auto& n2 = nodes[j];
-            Vec3f d = n2.box.center() - pn;
-            Vec3f w = n.box.size() + n2.box.size();
-
-            Vec3f vx = Vec3f(abs(d[0]), abs(d[1]), abs(d[2])) - w*0.5;
-            float x = vx[0]; // get smallest intrusion
-            if (abs(vx[1]) < abs(x) && w[1] > 0) x = vx[1];
-            if (abs(vx[2]) < abs(x) && w[2] > 0) x = vx[2];
-
-            //cout << " dir " << dir << "   x " << x << "   d " << d << "   w2 " << w*0.5 << "   vx " << vx << endl;
-            //cout << "displ " << i << " " << j << " w " << n.box.size() << " + " << n2.box.size() << "    d " << d << "    x " << x << endl;
-            if (abs(x) < eps) continue;
-            d.normalize();
-            D -= d*abs(x);
-        }
+/** spring displacements along the edges, which end moves depends on the kind of connection **/
+void VRGraphLayout::applySprings(float eps, float v) {
+    int N = px.size();
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<N; i++) {
+        int si = states[i];
+        if (si & (INACTIVE | FIXED)) continue;
 
-        auto po = graph->getPosition(i);
-        po->setPos(pn+v*D);
-        graph->setPosition(i, po); // move node away from neighbors
+        float Dx = 0, Dy = 0, Dz = 0;
+        for (int k = linkOffsets[i]; k < linkOffsets[i+1]; k++) {
+            const Link& l = links[k];
+            int j = l.other;
+            int sj = states[j];
+            if (sj & INACTIVE) continue;
+
+            bool jFixed = sj & FIXED;
+            bool moves = false;
+            switch (l.connection) {
+                case Graph::SIMPLE: moves = true; break;
+                case Graph::HIERARCHY: moves = !l.from || jFixed; break; // the child moves
+                case Graph::DEPENDENCY: moves = l.from || jFixed; break; // the dependent node moves
+                case Graph::SIBLING: moves = true; break;
+            }
+            if (!moves) continue;
+
+            float dx = px[j] - px[i], dy = py[j] - py[i], dz = pz[j] - pz[i];
+            float L = sqrt(dx*dx + dy*dy + dz*dz);
+            float x = L - (radius + radii[i] + radii[j]); // displacement
+            if (abs(x) < eps || L == 0) continue;
+            if (l.connection == Graph::SIBLING && x >= 0) continue; // only push away siblings
+
+            float f = x*v/L; // towards the other node when too far away
+            Dx += dx*f; Dy += dy*f; Dz += dz*f;
+        }
+        fx[i] += Dx; fy[i] += Dy; fz[i] += Dz;
     }
 }
 
-void VRGraphLayout::compute(int N, float eps) {
-    if (!graph) return;
-    for (int i=0; i<N; i++) { // steps
-        for (auto a : algorithms) {
-            switch(a.second) {
-                case SPRINGS:
-                    applySprings(eps, 0.03);
-                    break;
-                case OCCUPANCYMAP:
-                    applyOccupancy(eps, 0.5);
-                    break;
+/** pushes overlapping boxes apart along their smallest intrusion **/
+void VRGraphLayout::applyOccupancy(float eps, float v) {
+    int N = px.size();
+    vector<Vec3f> centers;
+    vector<int> IDs;
+    Vec3f hmax;
+    for (int i=0; i<N; i++) {
+        if (states[i] & INACTIVE) continue;
+        centers.push_back( Vec3f(px[i], py[i], pz[i]) );
+        IDs.push_back(i);
+        hmax[0] = max(hmax[0], hx[i]); hmax[1] = max(hmax[1], hy[i]); hmax[2] = max(hmax[2], hz[i]);
+    }
+
+    VRSpatialIndex<int> index;
+    index.build(centers, IDs);
+
+    #pragma omp parallel
+    {
+        vector<int> res;
+        #pragma omp for schedule(dynamic, 256)
+        for (int i=0; i<N; i++) {
+            if (states[i] & (FIXED | INACTIVE)) continue;
+            Vec3f pi(px[i], py[i], pz[i]);
+            Vec3f hi(hx[i], hy[i], hz[i]);
+            res.clear();
+            index.boxSearch(pi - hi - hmax, pi + hi + hmax, res); // all centers close enough to overlap
+
+            float Dx = 0, Dy = 0, Dz = 0;
+            for (int j : res) {
+                if (i == j) continue; // no self interaction
+                Vec3f d = Vec3f(px[j], py[j], pz[j]) - pi;
+                Vec3f w = Vec3f(hx[i] + hx[j], hy[i] + hy[j], hz[i] + hz[j]); // half of the summed sizes
+                if (abs(d[0]) > w[0] || abs(d[1]) > w[1] || abs(d[2]) > w[2]) continue; // boxes do not overlap
+
+                Vec3f vi = Vec3f(abs(d[0]), abs(d[1]), abs(d[2])) - w;
+                float x = vi[0]; // get smallest intrusion
+                if (abs(vi[1]) < abs(x) && w[1] > 0) x = vi[1];
+                if (abs(vi[2]) < abs(x) && w[2] > 0) x = vi[2];
+                if (abs(x) < eps) continue;
+
+                float L = d.length();
+                if (L == 0) continue;
+                float f = abs(x)*v/L;
+                Dx -= d[0]*f; Dy -= d[1]*f; Dz -= d[2]*f; // move node away from neighbors
             }
+            fx[i] += Dx; fy[i] += Dy; fz[i] += Dz;
+        }
+    }
+}
+
+/** one iteration of all algorithms, returns the largest movement of a node **/
+float VRGraphLayout::step(float eps) {
+    int N = px.size();
+    for (auto v : { &fx, &fy, &fz }) v->assign(N, 0);
+
+    for (auto a : algorithms) {
+        switch(a.second) {
+            case SPRINGS:
+                applySprings(eps, 0.03);
+                break;
+            case OCCUPANCYMAP:
+                applyOccupancy(eps, 0.5);
+                break;
         }
     }
 
-    // update graph nodes a second time
-    for (uint i=0; i<graph->getNodes().size(); i++) graph->update(i, false);
+    float maxMove = 0;
+    #pragma omp parallel for reduction(max:maxMove)
+    for (int i=0; i<N; i++) {
+        if (states[i] & (FIXED | INACTIVE)) { vx[i] = vy[i] = vz[i] = 0; continue; }
+        vx[i] = damping*vx[i] + speed*(fx[i] + gravity[0]);
+        vy[i] = damping*vy[i] + speed*(fy[i] + gravity[1]);
+        vz[i] = damping*vz[i] + speed*(fz[i] + gravity[2]);
+        px[i] += vx[i];
+        py[i] += vy[i];
+        pz[i] += vz[i];
+        float m = vx[i]*vx[i] + vy[i]*vy[i] + vz[i]*vz[i];
+        maxMove = max(maxMove, m);
+    }
+
+    iterations++;
+    return sqrt(maxMove);
+}
+
+/** computes up to N iterations, returns true if the layout converged **/
+bool VRGraphLayout::compute(int N, float eps) {
+    if (!graph) return false;
+    load();
+    converged = false;
+    for (int i=0; i<N && !converged; i++) converged = (step(eps) < eps*0.01);
+    store();
+    return converged;
+}
+
+void VRGraphLayout::update() {
+    if (!graph || compute(incrementalSteps, incrementalEps)) stop();
 }
 
+/** computes stepsPerFrame iterations each frame until the layout converged **/
+void VRGraphLayout::computeIncremental(int stepsPerFrame, float eps) {
+    stop();
+    incrementalSteps = max(stepsPerFrame, 1);
+    incrementalEps = eps;
+    converged = false;
+    auto scene = VRScene::getCurrent();
+    if (!scene) return;
+    updateCb = VRFunction<int>::create("graph_layout_update", boost::bind(&VRGraphLayout::update, this));
+    scene->addUpdateFkt(updateCb);
+}
+
+void VRGraphLayout::stop() {
+    if (!updateCb) return;
+    if (auto scene = VRScene::getCurrent()) scene->dropUpdateFkt(updateCb);
+    updateCb = 0;
+}
+
+bool VRGraphLayout::isConverged() { return converged; }
+int VRGraphLayout::getIterations() { return iterations; }
+
 void VRGraphLayout::setFlag(int i, FLAG f) {
     if (!flags.count(i)) flags[i] = NONE;
     flags[i] = flags[i] | f;
@@ -152,9 +260,13 @@ void VRGraphLayout::setNodeState(int i, bool s) { if(!s) setFlag(i, INACTIVE); e
 void VRGraphLayout::setRadius(float r) { radius = r; }
 void VRGraphLayout::setSpeed(float s) { speed = s; }
 void VRGraphLayout::setGravity(Vec3f v) { gravity = v; }
+void VRGraphLayout::setDamping(float d) { damping = d; }
 
 void VRGraphLayout::clear() {
     flags.clear();
+    px.clear();
+    iterations = 0;
+    converged = false;
 }
 
 
@@ -3,6 +3,7 @@
 
 #include "VRAlgorithmsFwd.h"
 #include "core/math/graph.h"
+#include "core/utils/VRFunctionFwd.h"
 
 #include <OpenSG/OSGVector.h>
 #include <map>
@@ -10,6 +11,14 @@
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
+/**
+    Force directed layout of the node boxes of a graph.
+    The box centers are copied into flat position and velocity arrays, the forces of all nodes are accumulated in parallel,
+    springs along the edges and box overlaps found with a spatial index over the node centers.
+    The iterations stop when no node moves more than a fraction of eps, the results are written back to the graph once per compute.
+    computeIncremental runs a few iterations each frame until the layout converged.
+*/
+
 class VRGraphLayout {
     public:
         enum ALGORITHM {
@@ -24,15 +33,42 @@ class VRGraphLayout {
         };
 
     private:
+        struct Link {
+            int other;
+            Graph::CONNECTION connection;
+            bool from; // the node is the source of the edge
+        };
+
         GraphPtr graph;
         map<int, ALGORITHM> algorithms;
         map<int, int> flags;
         Vec3f gravity;
         float radius = 1;
         float speed = 1;
+        float damping = 0;
+
+        // layout state, one entry per graph node
+        vector<float> px, py, pz; // box centers
+        vector<float> vx, vy, vz; // velocities
+        vector<float> fx, fy, fz; // displacements of the current iteration
+        vector<float> hx, hy, hz; // half box sizes
+        vector<float> radii;
+        vector<int> states; // flags
+        vector<int> linkOffsets; // links of node i are linkOffsets[i] to linkOffsets[i+1]
+        vector<Link> links;
+
+        int iterations = 0;
+        bool converged = false;
+        int incrementalSteps = 0;
+        float incrementalEps = 0.1;
+        VRUpdateCbPtr updateCb;
 
+        void load();
+        void store();
+        float step(float eps);
         void applySprings(float eps, float v);
         void applyOccupancy(float eps, float v);
+        void update();
 
         int getFlag(int i);
         void setFlag(int i, FLAG f);
@@ -41,6 +77,7 @@ class VRGraphLayout {
 
     public:
         VRGraphLayout();
+        ~VRGraphLayout();
         static VRGraphLayoutPtr create();
 
         void clear();
@@ -50,11 +87,16 @@ class VRGraphLayout {
         void setAlgorithm(ALGORITHM a, int position = 0);
         void setAlgorithm(string a, int position = 0);
         void clearAlgorithms();
-        void compute(int N = 10, float eps = 0.1);
+        bool compute(int N = 10, float eps = 0.1);
+        void computeIncremental(int stepsPerFrame = 5, float eps = 0.1);
+        void stop();
+        bool isConverged();
+        int getIterations();
 
         void setGravity(Vec3f v);
         void setRadius(float r);
         void setSpeed(float s);
+        void setDamping(float d);
         void fixNode(int i);
         void setNodeState(int i, bool state);
 };
@@ -9,9 +9,12 @@ simpleVRPyType(GraphLayout, New_ptr);
 PyMethodDef VRPyGraphLayout::methods[] = {
     {"setGraph", (PyCFunction)VRPyGraphLayout::setGraph, METH_VARARGS, "Set graph - setGraph(graph)" },
     {"setAlgorithm", (PyCFunction)VRPyGraphLayout::setAlgorithm, METH_VARARGS, "Set pipeline algorithms - setAlgorithm( str algorithm, int position )\n\talgorithm: 'SPRINGS', 'OCCUPANCYMAP'" },
-    {"setParameters", (PyCFunction)VRPyGraphLayout::setParameters, METH_VARARGS, "Set parameters - setParameters( flt radius )" },
+    {"setParameters", (PyCFunction)VRPyGraphLayout::setParameters, METH_VARARGS, "Set parameters - setParameters( flt radius | flt speed, flt damping )" },
     {"fixNode", (PyCFunction)VRPyGraphLayout::fixNode, METH_VARARGS, "Fix a node, making it static - fixNode( int n )" },
-    {"compute", (PyCFunction)VRPyGraphLayout::compute, METH_VARARGS, "Compute N steps - compute( int steps, float threshold )" },
+    {"compute", (PyCFunction)VRPyGraphLayout::compute, METH_VARARGS, "Compute up to N steps, returns True if the layout converged - bool compute( int steps, float threshold )" },
+    {"computeIncremental", (PyCFunction)VRPyGraphLayout::computeIncremental, METH_VARARGS, "Compute N steps each frame until the layout converged - computeIncremental( int steps, float threshold )" },
+    {"stop", (PyCFunction)VRPyGraphLayout::stop, METH_NOARGS, "Stop the incremental computation - stop()" },
+    {"isConverged", (PyCFunction)VRPyGraphLayout::isConverged, METH_NOARGS, "Check if the last computation converged - bool isConverged()" },
     {NULL}  /* Sentinel */
 };
 
@@ -35,8 +38,12 @@ PyObject* VRPyGraphLayout::setAlgorithm(VRPyGraphLayout* self, PyObject* args) {
 PyObject* VRPyGraphLayout::setParameters(VRPyGraphLayout* self, PyObject* args) {
     if (!self->valid()) return NULL;
     float r = 1;
-    if (!PyArg_ParseTuple(args, "f", &r)) return NULL;
+    float s = 1;
+    float d = 0;
+    if (!PyArg_ParseTuple(args, "f|ff", &r, &s, &d)) return NULL;
     self->objPtr->setRadius( r );
+    self->objPtr->setSpeed( s );
+    self->objPtr->setDamping( d );
     Py_RETURN_TRUE;
 }
 
@@ -45,10 +52,29 @@ PyObject* VRPyGraphLayout::compute(VRPyGraphLayout* self, PyObject* args) {
     int N;
     float t = 0.1;
     if (!PyArg_ParseTuple(args, "i|f", &N, &t)) return NULL;
-    self->objPtr->compute( N, t );
+    return PyBool_FromLong( self->objPtr->compute( N, t ) );
+}
+
+PyObject* VRPyGraphLayout::computeIncremental(VRPyGraphLayout* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    int N = 5;
+    float t = 0.1;
+    if (!PyArg_ParseTuple(args, "|if", &N, &t)) return NULL;
+    self->objPtr->computeIncremental( N, t );
     Py_RETURN_TRUE;
 }
 
+PyObject* VRPyGraphLayout::stop(VRPyGraphLayout* self) {
+    if (!self->valid()) return NULL;
+    self->objPtr->stop();
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyGraphLayout::isConverged(VRPyGraphLayout* self) {
+    if (!self->valid()) return NULL;
+    return PyBool_FromLong( self->objPtr->isConverged() );
+}
+
 PyObject* VRPyGraphLayout::fixNode(VRPyGraphLayout* self, PyObject* args) {
     if (!self->valid()) return NULL;
     self->objPtr->fixNode( parseInt(args) );
@@ -11,6 +11,9 @@ struct VRPyGraphLayout : VRPyBaseT<OSG::VRGraphLayout> {
     static PyObject* setParameters(VRPyGraphLayout* self, PyObject* args);
     static PyObject* fixNode(VRPyGraphLayout* self, PyObject* args);
     static PyObject* compute(VRPyGraphLayout* self, PyObject* args);
+    static PyObject* computeIncremental(VRPyGraphLayout* self, PyObject* args);
+    static PyObject* stop(VRPyGraphLayout* self);
+    static PyObject* isConverged(VRPyGraphLayout* self);
 };
 
 #endif // VRPYGRAPHLAYOUT_H_INCLUDED
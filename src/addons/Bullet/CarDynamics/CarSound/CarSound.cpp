@@ -155,6 +155,7 @@ void CarSound::resetValues() {
     nSamples = 0;
     resolution = 0;
     lastRPM = 0.;
+    streamedRPM = -1;
     init = false;
 }
 
@@ -172,20 +173,23 @@ void CarSound::loadSoundFile(string filename) {
     cout<<"Spectrum tool loaded"<<endl;
 }
 
+/** passes the spectrum of the rpm to the sound thread, which crossfades to it within the fade time **/
 void CarSound::play(float rpm) {
     if (active and sound) {
         if (!isLoaded()) { cout << "No spectrum data loaded" << endl; return; }
-        auto clamp = [](float& v, float a, float b) { return min(b,max(a,v)); };
-        clamp(rpm, minRPM, maxRPM);
+        rpm = min(maxRPM, max(minRPM, rpm));
+        if (rpm == streamedRPM) return;
 
-        sound->recycleBuffer();
-        if ( sound->getQueuedBuffer() < 2 ) {
-            sound->synthesizeSpectrum(getSpectrum(rpm), getRes(), duration, fade);
-        }
+        sound->streamSpectrum(getSpectrum(rpm), getRes(), fade);
+        streamedRPM = rpm;
     }
 }
 
-void CarSound::toggleSound(bool onOff) { active = onOff; }
+void CarSound::toggleSound(bool onOff) {
+    active = onOff;
+    if (!active && sound && streamedRPM >= 0) sound->stop();
+    if (!active) streamedRPM = -1;
+}
 void CarSound::setSound(VRSoundPtr s) { sound = s; }
 VRSoundPtr CarSound::getSound() { return sound; }
 const uint CarSound::getRes() {return resolution; }
@@ -16,9 +16,10 @@ class CarSound {
         float minRPM = 0;
         float maxRPM = 0;
         float lastRPM = 0; // previous rpm
+        float streamedRPM = -1; // rpm of the last spectrum passed to the sound
         bool lin = true;
         float fade = 0.01; // in s
-        float duration =  0.1; // in s
+        float duration =  0.1; // in s, packet duration of synthesizeSpectrum, not used when streaming
 
         unsigned int nSamples; // number of spectra provided
         unsigned int resolution; // number of frequencies per spectrum, data type needs to fit ~50k
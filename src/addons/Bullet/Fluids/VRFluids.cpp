@@ -90,142 +90,144 @@ void VRFluids::updateParticles(int from, int to) {
     }
 }
 
-inline void VRFluids::updateSPH(int from, int to) {
-    {
-        SphParticle* p;
-        BLock lock(mtx());
+/**
+ * Copies position, velocity, mass and radius of the active particles into the grid and sorts them into cells.
+ */
+void VRFluids::sph_gather(int from, int to) {
+    activeParticles.clear();
+    for (int i=from; i < to; i++) if (particles[i]->isActive == true) activeParticles.push_back(i);
+
+    int N = activeParticles.size();
+    auto& in = grid.in;
+    in.resize(N);
+    float h = 0;
+
+    #pragma omp parallel for reduction(max:h)
+    for (int i=0; i < N; i++) {
+        SphParticle* p = (SphParticle*) particles[activeParticles[i]];
+        btVector3 o = p->body->getWorldTransform().getOrigin();
+        btVector3 v = p->body->getLinearVelocity();
+        in.x[i] = o[0]; in.y[i] = o[1]; in.z[i] = o[2];
+        in.vx[i] = v[0]; in.vy[i] = v[1]; in.vz[i] = v[2];
+        in.mass[i] = p->mass;
+        in.area[i] = p->sphArea;
+        h = max(h, p->sphArea);
+    }
 
-        // clear and fill octree
-        ocparticles.clear();
-        for (int i=from; i < to; i++) {
-            if (particles[i]->isActive == true) {
-                p = (SphParticle*) particles[i];
-                btVector3 p_origin = p->body->getWorldTransform().getOrigin();
-                ocparticles.add(Vec3f(p_origin[0],p_origin[1],p_origin[2]),p);
-            }
-        }
+    grid.build(h);
+}
 
-        #pragma omp parallel for private(p) shared(from, to)
-        for (int i=from; i < to; i++) {
-            if (particles[i]->isActive == true) {
-                p = (SphParticle*) particles[i];
-                sph_calc_properties(p);
-            }
-        }
+/** The particle of the sorted grid slot i */
+inline SphParticle* VRFluids::sph_particle(int i) {
+    return (SphParticle*) particles[ activeParticles[ grid.index[i] ] ];
+}
 
-        #pragma omp parallel for private(p) shared(from, to)
-        for (int i=from; i < to; i++) {
-            if (particles[i]->isActive == true) {
-                p = (SphParticle*) particles[i];
-                sph_calc_forces(p);
-                btVector3 force = (p->sphPressureForce + p->sphViscosityForce);
-                p->body->applyCentralForce(force);
-
-                // btVector3 pf = p->sphPressureForce; // NOTE very ressource heavy debug foo here
-                // btVector3 vis = p->sphViscosityForce;
-                // printf("--> (%f,%f,%f) + (%f,%f,%f) << (%f <dens-press> %f), mass(%f)\n",
-                //         pf[0], pf[1], pf[2], vis[0],vis[1],vis[2], p->sphDensity/REST_DENSITY, p->sphPressure, p->mass);
-            }
+inline void VRFluids::updateSPH(int from, int to) {
+    {
+        BLock lock(mtx());
+        sph_gather(from, to);
+        int N = grid.size();
+
+        #pragma omp parallel for
+        for (int i=0; i < N; i++) sph_calc_properties(i);
+
+        #pragma omp parallel for
+        for (int i=0; i < N; i++) {
+            sph_calc_forces(i);
+            SphParticle* p = sph_particle(i);
+            btVector3 force = (p->sphPressureForce + p->sphViscosityForce);
+            p->body->applyCentralForce(force);
         }
-
-        // NOTE ressource heavy debug foo here
-        // int num = (rand() % this->to); // NOTE nimm immer neue stichprobe
-        // int num = 42; // NOTE nimm ein bestimmtes partikel
-        // p = (SphParticle*) particles[num];
-        // btVector3 pf = p->sphPressureForce;
-        // btVector3 vis = p->sphViscosityForce;
-        // printf("--> (%f,%f,%f) + (%f,%f,%f) << (%f <dens-press> %f), mass(%f)\n",
-        //         pf[0], pf[1], pf[2], vis[0],vis[1],vis[2], p->sphDensity/REST_DENSITY, p->sphPressure, p->mass);
     }
 }
 
 const float XSPH_CHAINING = 0.3; // binding strength between particles (XSPH)
 inline void VRFluids::updateXSPH(int from, int to) {
-    SphParticle* p;
-    btVector3 force(0,0,0);
-
     {
         BLock lock(mtx());
-        //#pragma omp parallel for private(p) shared(from, to)
-        for (int i=from; i < to; i++) {
-            p = (SphParticle*) particles[i];
-            sph_calc_properties(p);
-        }
+        sph_gather(from, to);
+        int N = grid.size();
 
-        //#pragma omp parallel for private(p, n) shared(from, to)
-        for (int i=from; i < to; i++) {
-            xsph_calc_movement(p, from, to);
+        #pragma omp parallel for
+        for (int i=0; i < N; i++) sph_calc_properties(i);
+
+        #pragma omp parallel for
+        for (int i=0; i < N; i++) {
+            xsph_calc_movement(i);
+            SphParticle* p = sph_particle(i);
             p->body->setLinearVelocity(p->sphPressureForce);
-            // simulation done.
-            // use normal and color to hand over force and particle size to shaders
-            Vec4f color(0,0,0, (*p).sphArea);
-            Vec3f normal(force.x(), force.y(), force.z());
-            normals->setValue(normal, i);
-            colors->setValue(color, i);
+        }
+
+        // simulation done.
+        // use normal and color to hand over force and particle size to shaders
+        for (int i=0; i < N; i++) {
+            int k = activeParticles[ grid.index[i] ];
+            Vec4f color(0,0,0, grid.p.area[i]);
+            normals->setValue(Vec3f(0,0,0), k);
+            colors->setValue(color, k);
         }
     }
 }
 
-const float NOTHING2 = 0.01;
 /**
- * Calculates density, pressure and neighbors and stores them in SphParticle p.
+ * Calculates density and pressure of the sorted grid slot i and stores them in the grid and the SphParticle.
  */
-inline void VRFluids::sph_calc_properties(SphParticle* p) {
-    p->sphDensity = 0.0;
-    btVector3 p_origin = p->body->getWorldTransform().getOrigin();
-    //float p_speed = p->body->getLinearVelocity().length2();
-
-    p->neighbors = ocparticles.radiusSearch(Vec3f(p_origin[0],p_origin[1],p_origin[2]),p->sphArea);
-    auto it = p->neighbors.begin();
-
-    while (it != p->neighbors.end()) {
-        btVector3 n_origin = ((SphParticle*) *it)->body->getWorldTransform().getOrigin();
-        float kernel = kernel_poly6(p_origin - n_origin, p->sphArea);
-        if (kernel == 0.0) {
-            it = p->neighbors.erase(it);
-        } else {
-            p->sphDensity += ((SphParticle*) *it)->mass * kernel;
-            it++;
-        }
-    }
-    p->sphPressure = PRESSURE_KAPPA * (p->sphDensity - REST_DENSITY);
+inline void VRFluids::sph_calc_properties(int i) {
+    auto& g = grid.p;
+    float h = g.area[i];
+    float density = 0.0;
+
+    grid.forNeighbors(i, [&](int j, float rx, float ry, float rz, float r2) {
+        density += g.mass[j] * kernel_poly6(btVector3(rx,ry,rz), h);
+    });
+
+    grid.density[i] = density;
+    grid.pressure[i] = PRESSURE_KAPPA * (density - REST_DENSITY);
+
+    SphParticle* p = sph_particle(i);
+    p->sphDensity = density;
+    p->sphPressure = grid.pressure[i];
 }
 
-inline void VRFluids::sph_calc_forces(SphParticle* p) {
-    p->sphPressureForce.setZero();
-    p->sphViscosityForce.setZero();
-    btVector3 p_origin = p->body->getWorldTransform().getOrigin();
-    btVector3 p_speed = p->body->getLinearVelocity();
+inline void VRFluids::sph_calc_forces(int i) {
+    auto& g = grid.p;
+    float h = g.area[i];
+    btVector3 p_speed(g.vx[i], g.vy[i], g.vz[i]);
+    btVector3 pressureForce(0,0,0);
+    btVector3 viscosityForce(0,0,0);
 
-    for (auto np : p->neighbors) {
-        SphParticle* n = (SphParticle*) np;
-        btVector3 n_origin = n->body->getWorldTransform().getOrigin();
-        btVector3 n_speed = n->body->getLinearVelocity();
+    grid.forNeighbors(i, [&](int j, float rx, float ry, float rz, float r2) {
+        btVector3 d(-rx, -ry, -rz); // p_origin - n_origin
+        float n_density = grid.density[j];
         // calc pressure force
-        float ptrick = (p->sphPressure + n->sphPressure) / (2 * n->sphDensity); // makes forces symmetric
-        btVector3 pKernel = kernel_spiky_gradient(p_origin - n_origin, p->sphArea);
-        p->sphPressureForce -= n->mass * ptrick * pKernel;
+        float ptrick = (grid.pressure[i] + grid.pressure[j]) / (2 * n_density); // makes forces symmetric
+        pressureForce -= g.mass[j] * ptrick * kernel_spiky_gradient(d, h);
         // calc viscosity force
-        btVector3 vtrick = (n_speed - p_speed) / n->sphDensity;
-        p->sphViscosityForce += n->mass * vtrick * kernel_visc_laplacian(p_origin - n_origin, p->sphArea);
-    }
-    p->sphViscosityForce *= VISCOSITY_MU;
+        btVector3 vtrick = (btVector3(g.vx[j], g.vy[j], g.vz[j]) - p_speed) / n_density;
+        viscosityForce += g.mass[j] * vtrick * kernel_visc_laplacian(d, h);
+    });
+
+    SphParticle* p = sph_particle(i);
+    p->sphPressureForce = pressureForce;
+    p->sphViscosityForce = viscosityForce * VISCOSITY_MU;
 }
 
 /** XSPH */
-inline void VRFluids::xsph_calc_movement(SphParticle* p, int from, int to) {
-    p->sphPressureForce.setZero();
-    for (int i = from; i < to; i++) {
-        SphParticle* n = (SphParticle*) particles[i];
-        btVector3 p_origin = p->body->getWorldTransform().getOrigin();
-        btVector3 n_origin = n->body->getWorldTransform().getOrigin();
-
-        float pressureAvg = 0.5 * (p->sphDensity + n->sphDensity);
-        btVector3 vDiff = n->body->getLinearVelocity() - p->body->getLinearVelocity();
-        p->sphPressureForce += kernel_poly6(n_origin - p_origin, p->sphArea) * n->mass * (vDiff/pressureAvg);
-    }
-    p->sphPressureForce *= XSPH_CHAINING;
-    p->sphPressureForce += p->body->getLinearVelocity();
+inline void VRFluids::xsph_calc_movement(int i) {
+    auto& g = grid.p;
+    float h = g.area[i];
+    btVector3 p_speed(g.vx[i], g.vy[i], g.vz[i]);
+    btVector3 force(0,0,0);
+
+    // the poly6 kernel vanishes outside the sph radius, only the neighbours contribute
+    grid.forNeighbors(i, [&](int j, float rx, float ry, float rz, float r2) {
+        float pressureAvg = 0.5 * (grid.density[i] + grid.density[j]);
+        btVector3 vDiff = btVector3(g.vx[j], g.vy[j], g.vz[j]) - p_speed;
+        force += kernel_poly6(btVector3(rx,ry,rz), h) * g.mass[j] * (vDiff/pressureAvg);
+    });
+
+    SphParticle* p = sph_particle(i);
+    p->sphPressureForce = force * XSPH_CHAINING + p_speed;
 }
 
 /** Kernel for density (poly6)
@@ -2,6 +2,7 @@
 #define VRFLUIDS_H_INCLUDED
 
 #include "../Particles/VRParticles.h"
+#include "VRSPHGrid.h"
 
 OSG_BEGIN_NAMESPACE;
 
@@ -58,7 +59,13 @@ class VRFluids : public VRParticles {
         /* The average volume of a particle */
         float particleVolume = 1;
 
-        inline void xsph_calc_movement(SphParticle* p, int from, int to);
+        /* Cell sorted particle data for the neighbour search, rebuilt every step */
+        VRSPHGrid grid;
+        vector<int> activeParticles;
+
+        void sph_gather(int from, int to);
+        inline SphParticle* sph_particle(int i);
+        inline void xsph_calc_movement(int i);
 
         inline float kernel_poly6(btVector3 distance_vector, float area) /*__attribute__((always_inline))*/;
         inline float kernel_spiky(btVector3 distance_vector, float area) /*__attribute__((always_inline))*/;
@@ -66,8 +73,8 @@ class VRFluids : public VRParticles {
         inline float kernel_visc(btVector3 distance_vector, float area) /*__attribute__((always_inline))*/;
         inline float kernel_visc_laplacian(btVector3 distance_vector, float area) /*__attribute__((always_inline))*/;
 
-        inline void sph_calc_properties(SphParticle* p) __attribute__((always_inline));
-        inline void sph_calc_forces(SphParticle* p) __attribute__((always_inline));
+        inline void sph_calc_properties(int i) __attribute__((always_inline));
+        inline void sph_calc_forces(int i) __attribute__((always_inline));
 
         void setFunctions(int from, int to) override;
         void disableFunctions() override;
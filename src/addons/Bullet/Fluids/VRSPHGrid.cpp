@@ -0,0 +1,63 @@
+#include "VRSPHGrid.h"
+
+#include <algorithm>
+#include <omp.h>
+
+using namespace OSG;
+
+void VRSPHGrid::Particles::resize(int N) {
+    x.resize(N); y.resize(N); z.resize(N);
+    vx.resize(N); vy.resize(N); vz.resize(N);
+    mass.resize(N); area.resize(N);
+}
+
+VRSPHGrid::VRSPHGrid() {}
+VRSPHGrid::~VRSPHGrid() {}
+
+int VRSPHGrid::size() { return index.size(); }
+
+void VRSPHGrid::build(float s) {
+    cellSize = max(s, 1e-6f);
+    int N = in.x.size();
+
+    unsigned int tableSize = 1024; // at least two buckets per particle
+    while (tableSize < 2*(unsigned int)N) tableSize *= 2;
+    mask = tableSize-1;
+
+    keys.resize(N);
+    index.resize(N);
+    p.resize(N);
+    density.resize(N);
+    pressure.resize(N);
+    cellStart.assign(tableSize+1, 0);
+
+    // count particles per bucket
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        unsigned int k = hash(cell(in.x[i]), cell(in.y[i]), cell(in.z[i]));
+        keys[i] = k;
+        #pragma omp atomic
+        cellStart[k+1]++;
+    }
+
+    for (unsigned int i=0; i<tableSize; i++) cellStart[i+1] += cellStart[i];
+    cursor.assign(cellStart.begin(), cellStart.end()-1);
+
+    // scatter
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        int s;
+        #pragma omp atomic capture
+        s = cursor[keys[i]]++;
+        index[s] = i;
+    }
+
+    // reorder the particle data, neighbours are now close in memory
+    #pragma omp parallel for
+    for (int s=0; s<N; s++) {
+        int i = index[s];
+        p.x[s] = in.x[i]; p.y[s] = in.y[i]; p.z[s] = in.z[i];
+        p.vx[s] = in.vx[i]; p.vy[s] = in.vy[i]; p.vz[s] = in.vz[i];
+        p.mass[s] = in.mass[i]; p.area[s] = in.area[i];
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef VRSPHGRID_H_INCLUDED
+#define VRSPHGRID_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Uniform grid for the SPH neighbour search.
+    The caller fills the unsorted particle arrays 'in', build() hashes the particles into cells
+    and sorts them with a parallel counting sort into the arrays 'p', index maps back to the input.
+    The cell size has to be at least the largest sph radius, neighbours are then found in the 27 surrounding cells.
+*/
+
+class VRSPHGrid {
+    public:
+        struct Particles {
+            vector<float> x, y, z;
+            vector<float> vx, vy, vz;
+            vector<float> mass, area;
+
+            void resize(int N);
+        };
+
+        Particles in;
+        Particles p;
+        vector<int> index;
+        vector<float> density;
+        vector<float> pressure;
+
+    private:
+        float cellSize = 1;
+        unsigned int mask = 0;
+        vector<unsigned int> keys;
+        vector<int> cellStart;
+        vector<int> cursor;
+
+        inline unsigned int hash(int cx, int cy, int cz) const {
+            return ((unsigned int)cx*73856093u ^ (unsigned int)cy*19349663u ^ (unsigned int)cz*83492791u) & mask;
+        }
+
+        inline int cell(float v) const { return (int)floor(v/cellSize); }
+
+    public:
+        VRSPHGrid();
+        ~VRSPHGrid();
+
+        void build(float cellSize);
+        int size();
+
+        /** calls f(j, dx, dy, dz, r2) for every sorted particle j within the sph radius of the sorted particle i, i included **/
+        template<class F>
+        void forNeighbors(int i, F f) const {
+            const float xi = p.x[i], yi = p.y[i], zi = p.z[i];
+            const float h2 = p.area[i]*p.area[i];
+            const int cx = cell(xi), cy = cell(yi), cz = cell(zi);
+
+            unsigned int visited[27];
+            int Nv = 0;
+            for (int dz=-1; dz<=1; dz++) {
+                for (int dy=-1; dy<=1; dy++) {
+                    for (int dx=-1; dx<=1; dx++) {
+                        unsigned int h = hash(cx+dx, cy+dy, cz+dz);
+                        bool seen = false; // different cells may share a bucket
+                        for (int k=0; k<Nv; k++) if (visited[k] == h) { seen = true; break; }
+                        if (seen) continue;
+                        visited[Nv++] = h;
+
+                        for (int j=cellStart[h]; j<cellStart[h+1]; j++) {
+                            float rx = p.x[j]-xi, ry = p.y[j]-yi, rz = p.z[j]-zi;
+                            float r2 = rx*rx + ry*ry + rz*rz;
+                            if (r2 <= h2) f(j, rx, ry, rz, r2);
+                        }
+                    }
+                }
+            }
+        }
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSPHGRID_H_INCLUDED
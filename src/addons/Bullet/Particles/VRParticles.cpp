@@ -26,7 +26,7 @@ boost::recursive_mutex& VRParticles::mtx() {
     };
 }
 
-VRParticles::VRParticles(bool spawnParticles) : VRGeometry("particles"), ocparticles(0.1) {
+VRParticles::VRParticles(bool spawnParticles) : VRGeometry("particles") {
     if (spawnParticles) resetParticles<Particle>();
     allowCulling(false);
     getMesh()->geo->setDlistCache(false);
@@ -5,7 +5,6 @@
 #include <OpenSG/OSGGeoProperties.h>
 #include "core/objects/geometry/VRGeometry.h"
 #include "core/utils/VRFunctionFwd.h"
-#include "core/math/Octree.h"
 #include "VRParticle.h"
 #include "VREmitter.h"
 
@@ -43,7 +42,6 @@ class VRParticles : public VRGeometry {
         int from, to;
         bool collideWithSelf = true;
         vector<Particle*> particles;
-        Octree ocparticles;
         map<int, shared_ptr<Emitter> > emitters;
 
         VRUpdateCbPtr fkt;
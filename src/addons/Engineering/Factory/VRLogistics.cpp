@@ -2,6 +2,7 @@
 #include "core/objects/geometry/VRSprite.h"
 #include "core/objects/VRTransform.h"
 #include "core/math/path.h"
+#include "core/math/VRGraphCSR.h"
 #include "core/objects/geometry/VRStroke.h"
 #include "core/objects/material/VRMaterial.h"
 #include "core/utils/toString.h"
@@ -150,13 +151,39 @@ Vec3f FNode::getTangent() {
 FPath::FPath() {}
 std::vector<shared_ptr<FNode>>& FPath::get() {return nodes; }
 
-void FPath::set(shared_ptr<FNode> n1, shared_ptr<FNode> n2) { // TODO: A*
+void FPath::set(shared_ptr<FNode> n1, shared_ptr<FNode> n2) {
     nodes.clear();
-    shared_ptr<FNode> n = n1;
-    nodes.push_back(n);
-    while(n != n2 && n->next() > 0) {
-        n = n->next(); // assumes linear networks
+    if (!n1) return;
+
+    // index the nodes reachable from n1
+    vector<shared_ptr<FNode>> reached;
+    map<FNode*, int> IDs;
+    vector<Vec2i> edges;
+    reached.push_back(n1);
+    IDs[n1.get()] = 0;
+    for (unsigned int i=0; i<reached.size(); i++) {
+        for (auto o : reached[i]->getOutgoing()) {
+            auto n = o.second;
+            if (!IDs.count(n.get())) { IDs[n.get()] = reached.size(); reached.push_back(n); }
+            edges.push_back( Vec2i(i, IDs[n.get()]) );
+        }
+    }
+
+    vector<Vec3f> positions;
+    for (auto n : reached) positions.push_back( n->getTransform() ? n->getTransform()->getWorldPosition() : Vec3f() );
+
+    VRGraphCSR csr;
+    csr.build(reached.size(), edges, positions);
+    int target = (n2 && IDs.count(n2.get())) ? IDs[n2.get()] : -1;
+    for (int i : csr.shortestPathAStar(0, target)) nodes.push_back( reached[i] );
+
+    if (nodes.size() == 0) { // not reachable, follow the network to its end
+        shared_ptr<FNode> n = n1;
         nodes.push_back(n);
+        while(n != n2 && n->next() > 0 && nodes.size() <= reached.size()) {
+            n = n->next();
+            nodes.push_back(n);
+        }
     }
     update();
 }
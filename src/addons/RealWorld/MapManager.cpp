@@ -1,18 +1,24 @@
 #include "MapManager.h"
 #include "MapGrid.h"
 #include "MapCoordinator.h"
+#include "RealWorld.h"
+#include "OSM/OSMMapDB.h"
 #include "Modules/BaseModule.h"
 
 #include "core/objects/object/VRObject.h"
 #include "core/scene/VRSceneManager.h"
 #include "core/scene/VRScene.h"
-#include "core/scene/VRThreadManager.h"
+#include "core/scene/VRWorkPool.h"
 #include "core/utils/VRFunction.h"
+#include "core/utils/VRProfiler.h"
 
 #include <boost/bind.hpp>
+#include <iostream>
 
 using namespace OSG;
 
+typedef boost::mutex::scoped_lock PLock;
+
 MapManager::MapManager(Vec2f position, MapCoordinator* mapCoordinator, World* world, VRObjectPtr root) {
     this->position = position;
     this->mapCoordinator = mapCoordinator;
@@ -20,19 +26,44 @@ MapManager::MapManager(Vec2f position, MapCoordinator* mapCoordinator, World* wo
     this->root = root;
 
     grid = new MapGrid(3, mapCoordinator->getGridSize() );
+    prefetchGrid = new MapGrid(3, mapCoordinator->getGridSize() );
+    stream = shared_ptr<Stream>( new Stream() );
 
-    worker = VRFunction< VRThreadWeakPtr >::create( "mapmanager work", boost::bind(&MapManager::work, this, _1) );
-    VRScene::getCurrent()->initThread(worker, "mapmanager worker", true, 1);
+    updateCb = VRFunction<int>::create( "mapmanager update", boost::bind(&MapManager::update, this) );
+    VRScene::getCurrent()->addUpdateFkt(updateCb);
 }
 
-void MapManager::work(VRThreadWeakPtr tw) {
-    if (jobs.size() == 0) { sleep(1); return; }
+MapManager::~MapManager() {
+    {
+        PLock lock(stream->mtx);
+        stream->stopped = true;
+        stream->queue.clear();
+    }
+    VRWorkPool::get()->wait(&stream->group); // loads in progress use the map DB, the remaining tasks return right away
+    delete grid;
+    delete prefetchGrid;
+}
+
+/** loads the OSM data of the tile with the lowest priority value, the pool runs one task per requested tile **/
+void MapManager::work(shared_ptr<Stream> s) {
+    string key;
+    {
+        PLock lock(s->mtx);
+        if (s->stopped || s->queue.empty()) return;
+        key = s->queue.begin()->second;
+        s->queue.erase(s->queue.begin());
+        s->tiles[key].loading = true;
+    }
 
-    MapManager::job j = jobs.front(); jobs.pop_front();
-    VRThreadPtr t = tw.lock();
-    t->syncFromMain();
-    j.mod->loadBbox(j.b);
-    t->syncToMain();
+    try { if (auto rw = RealWorld::get()) if (auto db = rw->getDB()) db->getMap(key); }
+    catch (exception& e) { cout << "MapManager Error: loading " << key << " failed, " << e.what() << endl; }
+
+    PLock lock(s->mtx);
+    auto t = s->tiles.find(key);
+    if (t == s->tiles.end()) return;
+    if (t->second.prefetch) s->prefetched.insert(key);
+    else for (auto m : t->second.modules) s->ready.push_back(job(t->second.box, m));
+    s->tiles.erase(t);
 }
 
 void MapManager::addModule(BaseModule* mod) {
@@ -40,32 +71,124 @@ void MapManager::addModule(BaseModule* mod) {
     root->addChild(mod->getRoot());
 }
 
-void MapManager::updatePosition(Vec2f pos) {
-    position = pos;
-    Vec2f bboxPosition = mapCoordinator->getRealBboxPosition(pos);
-    grid->set(bboxPosition);
+void MapManager::setFrameBudget(float ms) { frameBudget = ms; }
+void MapManager::setPrefetchTime(float s) { prefetchTime = s; }
+
+/** distance to the chunk center, halved ahead in the direction of motion, or the view direction when standing **/
+float MapManager::getPriority(MapGrid::Box& b) {
+    Vec2f d = mapCoordinator->realToWorld( (b.min + b.max)*0.5 ) - position;
+    Vec2f h = velocity.length() > 0.5 ? velocity : direction;
+    float L = d.length();
+    float H = h.length();
+    if (L < 1e-3 || H < 1e-3) return L;
+    float a = d.dot(h)/(L*H);
+    return L*(1.0 - 0.5*a);
+}
 
-    // unload/load boxes as needed
-    vector<MapGrid::Box> toUnload;
-    for (auto b : loadedBoxes) {
-        if (!grid->has(b.second)) toUnload.push_back(b.second);
+void MapManager::request(MapGrid::Box& b, vector<BaseModule*> mods, bool prefetch) {
+    {
+        PLock lock(stream->mtx);
+        if (prefetch && stream->prefetched.count(b.str)) return;
+        auto i = stream->tiles.find(b.str);
+        if (i != stream->tiles.end()) { // already queued or loading
+            auto& t = i->second;
+            if (!prefetch) {
+                t.prefetch = false;
+                t.modules.insert(t.modules.end(), mods.begin(), mods.end());
+            }
+            return;
+        }
+
+        Tile& t = stream->tiles[b.str];
+        t.box = b;
+        t.modules = mods;
+        t.prefetch = prefetch;
     }
+    VRWorkPool::get()->push( boost::bind(&MapManager::work, stream), &stream->group );
+}
 
-    vector<MapGrid::Box> toLoad;
-    for (auto b : grid->getBoxes()) {
-        if (!loadedBoxes.count( b.str )) toLoad.push_back(b);
+/** drops the queued tiles that left the grids and sorts the remaining tiles by their new priority **/
+void MapManager::cancel() {
+    PLock lock(stream->mtx);
+    stream->queue.clear();
+    for (auto i = stream->tiles.begin(); i != stream->tiles.end();) {
+        auto& t = i->second;
+        bool inGrid = grid->has(t.box);
+        if (!inGrid && !t.prefetch) { // load the modules again when the chunk comes back
+            auto& s = suspended[i->first];
+            s.insert(s.end(), t.modules.begin(), t.modules.end());
+            t.modules.clear();
+            t.prefetch = true;
+        }
+
+        if (t.loading) { i++; continue; }
+        if (!inGrid && !prefetchGrid->has(t.box)) { i = stream->tiles.erase(i); continue; }
+
+        float p = getPriority(t.box);
+        if (t.prefetch) p += 1e6; // after all chunks of the grid
+        stream->queue.insert( make_pair(p, i->first) );
+        i++;
     }
+}
 
-    //cout << "MapManager::updatePosition " << pos << " load " << toLoad.size() << " unload " << toUnload.size() << endl;
+/** builds the geometry of loaded chunks within the frame budget, at least one module per frame **/
+void MapManager::update() {
+    {
+        PLock lock(stream->mtx);
+        jobs.splice(jobs.end(), stream->ready);
+    }
+    if (jobs.empty()) return;
+
+    for (auto i = jobs.begin(); i != jobs.end();) {
+        if (grid->has(i->b)) { i++; continue; }
+        suspended[i->b.str].push_back(i->mod);
+        i = jobs.erase(i);
+    }
+
+    jobs.sort([&](job& a, job& b) { return getPriority(a.b) < getPriority(b.b); });
+
+    long long t0 = VRProfiler::getTime();
+    while (jobs.size()) {
+        job j = jobs.front(); jobs.pop_front();
+        j.mod->loadBbox(j.b);
+        if ((VRProfiler::getTime() - t0)*1e-6 > frameBudget) break;
+    }
+}
+
+void MapManager::updatePosition(Vec2f pos, Vec2f dir) {
+    long long t = VRProfiler::getTime();
+    if (lastTime > 0) {
+        float dt = (t - lastTime)*1e-9;
+        if (dt > 1) velocity = Vec2f(); // no recent updates
+        else if (dt > 1e-3) velocity = velocity*0.8 + (pos - position)*(0.2/dt);
+    }
+    lastTime = t;
+
+    position = pos;
+    direction = dir;
+    grid->set( mapCoordinator->getRealBboxPosition(pos) );
+    prefetchGrid->set( mapCoordinator->getRealBboxPosition(pos + velocity*prefetchTime) );
+
+    vector<BaseModule*> threaded;
+    for (auto mod : modules) if (mod->useThreads) threaded.push_back(mod);
 
-    for(auto b : toLoad) {
-        loadedBoxes[b.str] = b;
-        for(auto mod : modules) {
-            if (!mod->useThreads) mod->loadBbox(b);
-            else jobs.push_back(job(b, mod));
+    for (auto b : grid->getBoxes()) {
+        if (!loadedBoxes.count(b.str)) {
+            loadedBoxes[b.str] = b;
+            for (auto mod : modules) if (!mod->useThreads) mod->loadBbox(b);
+            if (threaded.size()) request(b, threaded, false);
+        } else if (suspended.count(b.str)) {
+            request(b, suspended[b.str], false);
+            suspended.erase(b.str);
         }
     }
 
+    for (auto b : prefetchGrid->getBoxes()) {
+        if (!loadedBoxes.count(b.str)) request(b, vector<BaseModule*>(), true);
+    }
+
+    cancel();
+
     /*for (auto b : toUnload) { // segfaulting when threaded
         loadedBoxes.erase(b.str);
         for(auto mod : modules) mod->unloadBbox(b);
@@ -4,10 +4,15 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <list>
+#include <memory>
 #include <OpenSG/OSGVector.h>
+#include <boost/thread/mutex.hpp>
 #include "MapGrid.h"
 #include "core/objects/VRObjectFwd.h"
 #include "core/utils/VRFunctionFwd.h"
+#include "core/scene/VRWorkPool.h"
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
@@ -18,36 +23,76 @@ class BaseModule;
 class AreaBoundingBox;
 class MapData;
 
+/**
+    Streams the map chunks around the position.
+    The OSM data of a chunk is loaded by the work pool, chunks close to the position and ahead in the direction of motion first,
+    chunks the position will reach within the prefetch time are loaded too, chunks that leave the grid before they are loaded are cancelled.
+    The modules build the geometry of loaded chunks on the main thread, each frame until the frame budget is used up.
+*/
+
 class MapManager {
     private:
+        struct job {
+            MapGrid::Box b;
+            BaseModule* mod = 0;
+            job(MapGrid::Box& b, BaseModule* m) : b(b), mod(m) {}
+        };
+
+        struct Tile {
+            MapGrid::Box box;
+            vector<BaseModule*> modules; // waiting for the OSM data
+            bool prefetch = false; // only load the OSM data
+            bool loading = false;
+        };
+
+        struct Stream { // shared with the work pool tasks
+            boost::mutex mtx;
+            VRWorkPool::Group group; // own group, waits on the frame groups never help with or wait for chunk loads
+            map<string, Tile> tiles;
+            set< pair<float, string> > queue; // lowest priority first
+            list<job> ready;
+            set<string> prefetched;
+            bool stopped = false;
+        };
+
         Vec2f position;
+        Vec2f direction;
+        Vec2f velocity;
+        long long lastTime = 0;
         MapGrid* grid = 0;
+        MapGrid* prefetchGrid = 0;
         MapCoordinator* mapCoordinator = 0;
         World* world = 0;
         vector<BaseModule*> modules;
         VRObjectPtr root;
-        VRThreadCbPtr worker;
+        VRUpdateCbPtr updateCb;
 
-        map<string, MapGrid::Box> loadedBoxes;
-
-        struct job {
-            MapGrid::Box b;
-            BaseModule* mod = 0;
-            job(MapGrid::Box& b, BaseModule* m) : b(b), mod(m) {}
-        };
+        float frameBudget = 5; // ms
+        float prefetchTime = 3; // s
 
+        map<string, MapGrid::Box> loadedBoxes;
+        map<string, vector<BaseModule*> > suspended; // cancelled module loads of boxes in loadedBoxes
+        shared_ptr<Stream> stream;
         list<job> jobs;
 
-        void work(VRThreadWeakPtr tw);
+        static void work(shared_ptr<Stream> s);
+
+        float getPriority(MapGrid::Box& b);
+        void request(MapGrid::Box& b, vector<BaseModule*> mods, bool prefetch);
+        void cancel();
+        void update();
 
     public:
         MapManager(Vec2f position, MapCoordinator* mapCoordinator, World* world, VRObjectPtr root);
+        ~MapManager();
 
         void addModule(BaseModule* mod);
-        void updatePosition(Vec2f worldPosition);
+        void updatePosition(Vec2f worldPosition, Vec2f viewDirection = Vec2f());
+
+        void setFrameBudget(float ms);
+        void setPrefetchTime(float s);
 };
 
 OSG_END_NAMESPACE;
 
 #endif	/* MAPMANAGER_H */
-
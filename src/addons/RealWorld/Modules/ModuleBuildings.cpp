@@ -42,7 +42,7 @@ void ModuleBuildings::loadBbox(MapGrid::Box bbox) {
 
     cout << "LOADING BUILDINGS FOR " << bbox.str << "\n" << flush;
 
-    for(OSMWay* way : osmMap->osmWays) {
+    for(OSMWay* way : osmMap->getWays(bbox.min[0], bbox.min[1], bbox.max[0], bbox.max[1])) {
         if (way->tags["building"] != "yes") continue;
         //if (meshes.count(way->id)) continue;
 
@@ -101,7 +101,7 @@ void ModuleStreets::loadBbox(MapGrid::Box bbox) {
         listLoadJoints[node->id] = joint;
     }
 
-    for (OSMWay* way : osmMap->osmWays) {
+    for (OSMWay* way : osmMap->getWays(bbox.min[0], bbox.min[1], bbox.max[0], bbox.max[1])) {
         if (!types.count(way->tags["highway"])) continue;
         auto type = types[way->tags["highway"]];
 
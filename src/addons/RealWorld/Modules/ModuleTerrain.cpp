@@ -25,7 +25,7 @@ void ModuleTerrain::loadBbox(MapGrid::Box bbox) {
     OSMMap* osmMap = mapDB->getMap(bbox.str);
     if (!osmMap) return;
 
-    for (OSMWay* way : osmMap->osmWays) {
+    for (OSMWay* way : osmMap->getWays(bbox.min[0], bbox.min[1], bbox.max[0], bbox.max[1])) {
         for (auto mat : terrainList) {
             if (way->tags[mat->k] == mat->v) {
                 if (meshes.count(way->id)) continue;
@@ -54,7 +54,7 @@ void ModuleTerrain::unloadBbox(MapGrid::Box bbox) {
     if (!mapDB) return;
     OSMMap* osmMap = mapDB->getMap(bbox.str);
     if (!osmMap) return;
-    for (OSMWay* way : osmMap->osmWays) {
+    for (OSMWay* way : osmMap->getWays(bbox.min[0], bbox.min[1], bbox.max[0], bbox.max[1])) {
         for (TerrainMaterial* mat : terrainList) {
             if (way->tags[mat->k] == mat->v) {
                 if (meshes.count(way->id)) meshes.erase(way->id);
@@ -21,7 +21,7 @@ void ModuleWalls::loadBbox(MapGrid::Box bbox) {
     cout << "LOADING WALLS FOR " << bbox.str << "\n" << flush;
     VRGeoData geo;
 
-    for (OSMWay* way : osmMap->osmWays) {
+    for (OSMWay* way : osmMap->getWays(bbox.min[0], bbox.min[1], bbox.max[0], bbox.max[1])) {
         for (WallMaterial* mat : wallList) {
             if (way->tags[mat->k] == mat->v) {
                 Wall* wall = new Wall(way->id);
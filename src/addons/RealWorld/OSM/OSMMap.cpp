@@ -1,44 +1,143 @@
 #include "OSMMap.h"
+#include "OSMTile.h"
 #include "core/utils/toString.h"
 
 #include <libxml++/libxml++.h>
+#include <iostream>
 
 using namespace OSG;
 using namespace std;
 
+namespace {
+    /** reads the elements one by one, without building the document tree **/
+    class OSMParser : public xmlpp::SaxParser {
+        private:
+            OSMMap* map = 0;
+            OSMBase* current = 0;
+            OSMWay* way = 0;
+
+            string get(const AttributeList& attributes, const char* name) {
+                for (auto& a : attributes) if (a.name == name) return a.value;
+                return "";
+            }
+
+        public:
+            OSMParser(OSMMap* m) : map(m) {}
+
+            void on_start_element(const Glib::ustring& name, const AttributeList& attributes) {
+                if (name == "node") {
+                    auto node = new OSMNode(get(attributes, "id"), toDouble(get(attributes, "lat")), toDouble(get(attributes, "lon")));
+                    map->addNode(node);
+                    current = node;
+                    way = 0;
+                } else if (name == "way") {
+                    way = new OSMWay(get(attributes, "id"));
+                    map->addWay(way);
+                    current = way;
+                } else if (name == "tag") {
+                    if (current) current->tags[get(attributes, "k")] = get(attributes, "v");
+                } else if (name == "nd") {
+                    if (way) way->nodeRefs.push_back(get(attributes, "ref"));
+                } else if (name == "bounds") {
+                    map->setBounds( toFloat(get(attributes, "minlat")), toFloat(get(attributes, "minlon")), toFloat(get(attributes, "maxlat")), toFloat(get(attributes, "maxlon")) );
+                } else if (name != "osm") { // relations and unknown elements
+                    current = 0;
+                    way = 0;
+                }
+            }
+
+            void on_end_element(const Glib::ustring& name) {
+                if (name == "node" || name == "way") { current = 0; way = 0; }
+            }
+    };
+}
+
+OSMMap::OSMMap() {}
+
 OSMMap::OSMMap(string filepath) {
-    xmlpp::DomParser parser;
+    OSMParser parser(this);
     try { parser.parse_file(filepath); }
-    catch(const exception& ex) { cout << "OSMMap Error: " << ex.what() << endl; return; }
-
-    auto nodes = parser.get_document()->get_root_node()->get_children();
-    for (auto node : nodes) {
-        if (auto element = dynamic_cast<xmlpp::Element*>(node)) {
-            if (element->get_name() == "node") readNode(element);
-            if (element->get_name() == "way") readWay(element);
-            if (element->get_name() == "bounds") readBounds(element);
-        }
-    }
+    catch(const exception& ex) { cout << "OSMMap Error: " << ex.what() << endl; parsed = false; }
+}
+
+OSMMap::~OSMMap() {
+    for (auto n : osmNodes) delete n;
+    for (auto w : osmWays) delete w;
 }
 
 OSMMap* OSMMap::loadMap(string filepath) { return new OSMMap(filepath); }
 
-void OSMMap::readNode(xmlpp::Element* element) {
+/** expands the nodes, the modules look up the nodes by ID, the ways are expanded by getWays **/
+OSMMap* OSMMap::loadTile(string filepath) {
+    auto tile = shared_ptr<OSMTile>( new OSMTile() );
+    if (!tile->open(filepath)) return 0;
+
+    auto m = new OSMMap();
+    m->tile = tile;
+    double b[4];
+    tile->getBounds(b[0], b[1], b[2], b[3]);
+    m->setBounds(b[0], b[1], b[2], b[3]);
+
+    int N = tile->getNodeCount();
+    m->osmNodes.reserve(N);
+    for (int i=0; i<N; i++) {
+        auto node = new OSMNode(to_string(tile->getNode(i).id), tile->getLat(i), tile->getLon(i));
+        for (auto t : tile->getNodeTags(i)) node->tags[tile->getString(t.key)] = tile->getString(t.value);
+        m->addNode(node);
+    }
+
+    m->tileWays.resize(tile->getWayCount(), 0);
+    m->osmWays.reserve(tile->getWayCount());
+    return m;
+}
+
+void OSMMap::addNode(OSMNode* node) {
     nodeCount++;
-    OSMNode* osmn = new OSMNode(element);
-    osmNodes.push_back(osmn);
-    osmNodeMap[osmn->id] = osmn;
+    osmNodes.push_back(node);
+    osmNodeMap[node->id] = node;
 }
 
-void OSMMap::readWay(xmlpp::Element* element) {
+void OSMMap::addWay(OSMWay* way) {
     wayCount++;
-    OSMWay* osmWay = new OSMWay(element);
-    osmWays.push_back(osmWay);
+    osmWays.push_back(way);
+}
+
+void OSMMap::setBounds(float minLat, float minLon, float maxLat, float maxLon) {
+    hasBounds = true;
+    boundsMinLat = minLat;
+    boundsMinLon = minLon;
+    boundsMaxLat = maxLat;
+    boundsMaxLon = maxLon;
 }
 
-void OSMMap::readBounds(xmlpp::Element* element) {
-    this->boundsMinLat = toFloat( element->get_attribute_value("minlat") );
-    this->boundsMinLon = toFloat( element->get_attribute_value("minlon") );
-    this->boundsMaxLat = toFloat( element->get_attribute_value("maxlat") );
-    this->boundsMaxLon = toFloat( element->get_attribute_value("maxlon") );
+/** ways with a node in the box, the grid of a tile may return ways that only pass close by,
+    a tile expands its ways on first use and adds them to osmWays **/
+vector<OSMWay*> OSMMap::getWays(float minLat, float minLon, float maxLat, float maxLon) {
+    vector<OSMWay*> res;
+    if (tile) {
+        boost::mutex::scoped_lock lock(mtx);
+        for (int i : tile->getWays(minLat, minLon, maxLat, maxLon)) {
+            if (!tileWays[i]) {
+                auto way = new OSMWay(to_string(tile->getWayID(i)));
+                for (auto r : tile->getWayRefs(i)) way->nodeRefs.push_back(to_string(r));
+                for (auto t : tile->getWayTags(i)) way->tags[tile->getString(t.key)] = tile->getString(t.value);
+                tileWays[i] = way;
+                addWay(way);
+            }
+            res.push_back(tileWays[i]);
+        }
+        return res;
+    }
+
+    for (auto way : osmWays) {
+        for (auto& ref : way->nodeRefs) {
+            auto n = osmNodeMap.find(ref);
+            if (n == osmNodeMap.end()) continue;
+            double lat = n->second->lat, lon = n->second->lon;
+            if (lat < minLat || lat > maxLat || lon < minLon || lon > maxLon) continue;
+            res.push_back(way);
+            break;
+        }
+    }
+    return res;
 }
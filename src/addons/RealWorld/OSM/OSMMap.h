@@ -7,10 +7,13 @@
 */
 
 #include "OSMNode.h"
+#include <memory>
+#include <boost/thread/mutex.hpp>
 
-namespace xmlpp { class Element; }
 using namespace std;
 
+class OSMTile;
+
 class OSMMap {
     public:
         int nodeCount = 0;
@@ -20,19 +23,30 @@ class OSMMap {
         vector<OSMNode*> osmNodes;
         map<string, OSMNode*> osmNodeMap;
         vector<OSMWay*> osmWays;
-        float boundsMinLat;
-        float boundsMinLon;
-        float boundsMaxLat;
-        float boundsMaxLon;
-
+        bool hasBounds = false;
+        float boundsMinLat = 0;
+        float boundsMinLon = 0;
+        float boundsMaxLat = 0;
+        float boundsMaxLon = 0;
+        bool parsed = true; // false if the XML file could not be parsed
+
+        OSMMap();
         OSMMap(string filepath);
+        ~OSMMap();
 
         static OSMMap* loadMap(string filepath);
+        static OSMMap* loadTile(string filepath);
+
+        void addNode(OSMNode* node);
+        void addWay(OSMWay* way);
+        void setBounds(float minLat, float minLon, float maxLat, float maxLon);
+
+        vector<OSMWay*> getWays(float minLat, float minLon, float maxLat, float maxLon);
 
     private:
-        void readNode(xmlpp::Element* element);
-        void readWay(xmlpp::Element* element);
-        void readBounds(xmlpp::Element* element);
+        shared_ptr<OSMTile> tile; // way index of maps loaded from a tile
+        vector<OSMWay*> tileWays; // by tile index, 0 until expanded
+        boost::mutex mtx;
 };
 
 #endif // SIMPLEMAP_H
@@ -1,16 +1,45 @@
 #include "OSMMapDB.h"
+#include "OSMTile.h"
 #include "../RealWorld.h"
 #include <iostream>
 #include <boost/filesystem.hpp>
 
+namespace bf = boost::filesystem;
+
+OSMMapDB::~OSMMapDB() {
+    for (auto m : maps) delete m.second;
+}
+
 OSMMap* OSMMapDB::getMap(string posStr) {
-    if (maps.count(posStr)) return maps[posStr];
+    {
+        boost::mutex::scoped_lock lock(mtx);
+        while (loading.count(posStr)) loaded.wait(lock); // another thread loads the chunk
+        if (maps.count(posStr)) return maps[posStr];
+        loading.insert(posStr);
+    }
+
+    OSMMap* m = loadMap(posStr);
+
+    boost::mutex::scoped_lock lock(mtx);
+    if (m) maps[posStr] = m; // a chunk that failed to load is tried again
+    loading.erase(posStr);
+    loaded.notify_all();
+    return m;
+}
 
+OSMMap* OSMMapDB::loadMap(string posStr) {
     string chunkspath = RealWorld::getOption("CHUNKS_PATH");
     if (*chunkspath.rbegin() != '/') chunkspath += "/";
     string filename = chunkspath+"map-"+posStr+".osm";
-    if ( !boost::filesystem::exists(filename) ) { cout << "OSMMapDB Error: no file " << filename << endl; return 0; }
+    string tilename = filename+"b";
+    bool hasXML = bf::exists(filename);
+    bool hasTile = bf::exists(tilename);
+    if (hasTile && hasXML && bf::last_write_time(tilename) < bf::last_write_time(filename)) hasTile = false; // outdated tile
 
-    maps[posStr] = OSMMap::loadMap(filename);
-    return maps[posStr];
+    if (hasTile) if (auto m = OSMMap::loadTile(tilename)) return m;
+    if (!hasXML) { cout << "OSMMapDB Error: no file " << filename << endl; return 0; }
+    auto m = OSMMap::loadMap(filename);
+    if (!m->parsed) { delete m; return 0; } // an empty tile would shadow the XML
+    if (!OSMTile::write(m, tilename)) cout << "OSMMapDB Warning: could not write tile " << tilename << endl;
+    return m;
 }
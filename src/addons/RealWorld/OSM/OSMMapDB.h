@@ -2,14 +2,24 @@
 #define OSMMAPDB_H
 
 #include "OSMMap.h"
+#include <set>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 using namespace std;
 
+/** maps by chunk position, map-<pos>.osm is parsed once and stored as binary tile map-<pos>.osmb next to it,
+    different chunks may be loaded by several threads at once **/
 struct OSMMapDB {
     map<string, OSMMap*> maps;
+    set<string> loading;
+    boost::mutex mtx;
+    boost::condition_variable loaded;
+
+    ~OSMMapDB();
 
     OSMMap* getMap(string posStr);
+    OSMMap* loadMap(string posStr);
 };
 
 #endif // OSMMAPDB_H
-
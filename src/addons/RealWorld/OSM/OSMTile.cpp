@@ -0,0 +1,344 @@
+#include "OSMTile.h"
+#include "OSMMap.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace {
+    const char magic[4] = { 'O', 'S', 'M', 'T' };
+    const uint32_t version = 3; // 2 had no way grid
+    const size_t alignment = 16;
+    const double scale = 1e7; // fixed point coordinates, about 1cm
+
+    enum Section {
+        STRING_OFFSETS = 0, STRINGS, NODES, NODE_TAG_OFFSETS, NODE_TAGS,
+        WAY_IDS, WAY_REF_OFFSETS, WAY_REFS, EXTERNAL_IDS, WAY_TAG_OFFSETS, WAY_TAGS,
+        CELL_OFFSETS, CELL_WAYS, SECTION_COUNT
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        double origin[2];
+        double bounds[4];
+        uint32_t gridN;
+        uint32_t nStrings;
+        uint32_t nNodes;
+        uint32_t nWays;
+        uint64_t offsets[SECTION_COUNT];
+        uint64_t sizes[SECTION_COUNT]; // in bytes
+    };
+
+    struct Writer {
+        ofstream out;
+        size_t pos = 0;
+
+        Writer(string path) : out(path, ios::binary | ios::trunc) {}
+
+        void raw(const void* d, size_t N) { out.write((const char*)d, N); pos += N; }
+
+        template<class T> void section(Header& h, Section s, const vector<T>& v) {
+            static const char zeros[alignment] = {0};
+            raw(zeros, (alignment - pos%alignment)%alignment);
+            h.offsets[s] = pos;
+            h.sizes[s] = v.size()*sizeof(T);
+            if (v.size()) raw(&v[0], v.size()*sizeof(T));
+        }
+    };
+
+    struct StringTable {
+        unordered_map<string, uint32_t> ids;
+        vector<uint32_t> offsets = vector<uint32_t>(1,0);
+        vector<char> chars;
+
+        uint32_t get(const string& s) {
+            auto i = ids.find(s);
+            if (i != ids.end()) return i->second;
+            uint32_t id = offsets.size()-1;
+            ids[s] = id;
+            chars.insert(chars.end(), s.begin(), s.end());
+            offsets.push_back(chars.size());
+            return id;
+        }
+    };
+
+    int64_t parseID(const string& s) { return strtoll(s.c_str(), 0, 10); }
+    int32_t toFixed(double v, double origin) { return (int32_t)lround((v-origin)*scale); }
+
+    int cellIndex(double v, double vmin, double vmax, int N) {
+        if (vmax <= vmin) return 0;
+        int i = floor( (v-vmin)/(vmax-vmin)*N );
+        return max(0, min(N-1, i));
+    }
+
+    bool monotonic(const uint32_t* offsets, size_t N) { // N+1 entries starting at 0
+        if (offsets[0] != 0) return false;
+        for (size_t i=0; i<N; i++) if (offsets[i] > offsets[i+1]) return false;
+        return true;
+    }
+
+    template<class T> bool inRange(const T* v, size_t N, size_t M) {
+        for (size_t i=0; i<N; i++) if (v[i] >= M) return false;
+        return true;
+    }
+}
+
+OSMTile::OSMTile() {}
+OSMTile::~OSMTile() { close(); }
+
+bool OSMTile::write(OSMMap* map, string path) {
+    if (!map) return false;
+
+    double b[4] = { 1e9, 1e9, -1e9, -1e9 };
+    if (map->hasBounds) {
+        b[0] = map->boundsMinLat; b[1] = map->boundsMinLon;
+        b[2] = map->boundsMaxLat; b[3] = map->boundsMaxLon;
+    }
+    for (auto n : map->osmNodes) {
+        b[0] = min(b[0], n->lat); b[1] = min(b[1], n->lon);
+        b[2] = max(b[2], n->lat); b[3] = max(b[3], n->lon);
+    }
+    if (b[0] > b[2]) b[0] = b[1] = b[2] = b[3] = 0; // empty map
+
+    Header h;
+    memset(&h, 0, sizeof(Header));
+    memcpy(h.magic, magic, 4);
+    h.version = version;
+    h.origin[0] = b[0];
+    h.origin[1] = b[1];
+    for (int i=0; i<4; i++) h.bounds[i] = b[i];
+
+    StringTable strings;
+    auto addTags = [&](OSMBase* e, vector<uint32_t>& offsets, vector<Tag>& tags) {
+        for (auto& t : e->tags) tags.push_back( { strings.get(t.first), strings.get(t.second) } );
+        offsets.push_back(tags.size());
+    };
+
+    vector<Node> nodes;
+    vector<uint32_t> nodeTagOffsets(1,0);
+    vector<Tag> nodeTags;
+    unordered_map<string, int32_t> nodeIndex;
+    nodes.reserve(map->osmNodes.size());
+    for (auto n : map->osmNodes) {
+        nodeIndex[n->id] = nodes.size();
+        nodes.push_back( { parseID(n->id), toFixed(n->lat, h.origin[0]), toFixed(n->lon, h.origin[1]) } );
+        addTags(n, nodeTagOffsets, nodeTags);
+    }
+
+    vector<int64_t> wayIDs;
+    vector<uint32_t> wayRefOffsets(1,0);
+    vector<int32_t> wayRefs;
+    vector<int64_t> externalIDs;
+    vector<uint32_t> wayTagOffsets(1,0);
+    vector<Tag> wayTags;
+    vector<double> wayBounds; // min lat, min lon, max lat, max lon per way, for the grid
+    for (auto w : map->osmWays) {
+        wayIDs.push_back( parseID(w->id) );
+        double wb[4] = { 1e9, 1e9, -1e9, -1e9 };
+        for (auto& ref : w->nodeRefs) {
+            auto n = nodeIndex.find(ref);
+            if (n == nodeIndex.end()) { // node of another tile
+                wayRefs.push_back( -1-int32_t(externalIDs.size()) );
+                externalIDs.push_back( parseID(ref) );
+                continue;
+            }
+            wayRefs.push_back(n->second);
+            auto node = map->osmNodes[n->second];
+            wb[0] = min(wb[0], node->lat); wb[1] = min(wb[1], node->lon);
+            wb[2] = max(wb[2], node->lat); wb[3] = max(wb[3], node->lon);
+        }
+        wayRefOffsets.push_back(wayRefs.size());
+        addTags(w, wayTagOffsets, wayTags);
+        wayBounds.insert(wayBounds.end(), wb, wb+4);
+    }
+
+    int N = max(1, min(64, int(sqrt(wayIDs.size()/4.0))));
+    vector<vector<uint32_t> > cells(N*N);
+    for (uint32_t k=0; k<wayIDs.size(); k++) {
+        double* wb = &wayBounds[4*k];
+        if (wb[0] > wb[2]) continue; // no local nodes
+        int i0 = cellIndex(wb[0], b[0], b[2], N), i1 = cellIndex(wb[2], b[0], b[2], N);
+        int j0 = cellIndex(wb[1], b[1], b[3], N), j1 = cellIndex(wb[3], b[1], b[3], N);
+        for (int i=i0; i<=i1; i++) for (int j=j0; j<=j1; j++) cells[i*N+j].push_back(k);
+    }
+
+    vector<uint32_t> cellOffsets(1,0);
+    vector<uint32_t> cellWays;
+    for (auto& c : cells) {
+        cellWays.insert(cellWays.end(), c.begin(), c.end());
+        cellOffsets.push_back(cellWays.size());
+    }
+
+    h.gridN = N;
+    h.nStrings = strings.offsets.size()-1;
+    h.nNodes = nodes.size();
+    h.nWays = wayIDs.size();
+
+    Writer w(path + ".tmp");
+    if (!w.out) return false;
+    w.raw(&h, sizeof(Header)); // placeholder, rewritten with the section offsets
+    w.section(h, STRING_OFFSETS, strings.offsets);
+    w.section(h, STRINGS, strings.chars);
+    w.section(h, NODES, nodes);
+    w.section(h, NODE_TAG_OFFSETS, nodeTagOffsets);
+    w.section(h, NODE_TAGS, nodeTags);
+    w.section(h, WAY_IDS, wayIDs);
+    w.section(h, WAY_REF_OFFSETS, wayRefOffsets);
+    w.section(h, WAY_REFS, wayRefs);
+    w.section(h, EXTERNAL_IDS, externalIDs);
+    w.section(h, WAY_TAG_OFFSETS, wayTagOffsets);
+    w.section(h, WAY_TAGS, wayTags);
+    w.section(h, CELL_OFFSETS, cellOffsets);
+    w.section(h, CELL_WAYS, cellWays);
+    w.out.seekp(0);
+    w.out.write((const char*)&h, sizeof(Header));
+    w.out.close();
+    if (!w.out) { remove((path + ".tmp").c_str()); return false; }
+    return rename((path + ".tmp").c_str(), path.c_str()) == 0; // readers never see a partial tile
+}
+
+bool OSMTile::open(string path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) { ::close(fd); return false; }
+    void* m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+    data = (const char*)m;
+    size = st.st_size;
+
+    Header h;
+    memcpy(&h, data, sizeof(Header));
+    if (memcmp(h.magic, magic, 4) != 0 || h.version != version || h.gridN == 0 || h.gridN > 64) { close(); return false; }
+    for (int s=0; s<SECTION_COUNT; s++) {
+        if (h.offsets[s] % alignment != 0 || h.offsets[s] > size || h.sizes[s] > size - h.offsets[s]) { close(); return false; }
+    }
+
+    auto check = [&](Section s, size_t N, size_t elemSize) { return h.sizes[s] == N*elemSize; };
+    bool ok = check(STRING_OFFSETS, size_t(h.nStrings)+1, 4) && check(NODES, h.nNodes, sizeof(Node));
+    ok = ok && check(NODE_TAG_OFFSETS, size_t(h.nNodes)+1, 4) && check(WAY_IDS, h.nWays, 8);
+    ok = ok && check(WAY_REF_OFFSETS, size_t(h.nWays)+1, 4) && check(WAY_TAG_OFFSETS, size_t(h.nWays)+1, 4);
+    ok = ok && check(CELL_OFFSETS, h.gridN*h.gridN+1, 4);
+    ok = ok && h.sizes[EXTERNAL_IDS] % 8 == 0;
+    if (!ok) { close(); return false; }
+
+    originLat = h.origin[0];
+    originLon = h.origin[1];
+    for (int i=0; i<4; i++) bounds[i] = h.bounds[i];
+    gridN = h.gridN;
+    nStrings = h.nStrings;
+    nNodes = h.nNodes;
+    nWays = h.nWays;
+
+    stringOffsets = (const uint32_t*)(data + h.offsets[STRING_OFFSETS]);
+    strings = data + h.offsets[STRINGS];
+    nodes = (const Node*)(data + h.offsets[NODES]);
+    nodeTagOffsets = (const uint32_t*)(data + h.offsets[NODE_TAG_OFFSETS]);
+    nodeTags = (const Tag*)(data + h.offsets[NODE_TAGS]);
+    wayIDs = (const int64_t*)(data + h.offsets[WAY_IDS]);
+    wayRefOffsets = (const uint32_t*)(data + h.offsets[WAY_REF_OFFSETS]);
+    wayRefs = (const int32_t*)(data + h.offsets[WAY_REFS]);
+    externalIDs = (const int64_t*)(data + h.offsets[EXTERNAL_IDS]);
+    wayTagOffsets = (const uint32_t*)(data + h.offsets[WAY_TAG_OFFSETS]);
+    wayTags = (const Tag*)(data + h.offsets[WAY_TAGS]);
+    cellOffsets = (const uint32_t*)(data + h.offsets[CELL_OFFSETS]);
+    cellWays = (const uint32_t*)(data + h.offsets[CELL_WAYS]);
+
+    // the offset tables end in the section sizes
+    ok = stringOffsets[nStrings]*sizeof(char) == h.sizes[STRINGS];
+    ok = ok && nodeTagOffsets[nNodes]*sizeof(Tag) == h.sizes[NODE_TAGS];
+    ok = ok && wayRefOffsets[nWays]*sizeof(int32_t) == h.sizes[WAY_REFS];
+    ok = ok && wayTagOffsets[nWays]*sizeof(Tag) == h.sizes[WAY_TAGS];
+    ok = ok && cellOffsets[gridN*gridN]*sizeof(uint32_t) == h.sizes[CELL_WAYS];
+    if (!ok) { close(); return false; }
+
+    // everything the getters index with, a corrupt tile is parsed from the XML again
+    ok = monotonic(stringOffsets, nStrings) && monotonic(nodeTagOffsets, nNodes);
+    ok = ok && monotonic(wayRefOffsets, nWays) && monotonic(wayTagOffsets, nWays);
+    ok = ok && monotonic(cellOffsets, gridN*gridN);
+    size_t nRefs = wayRefOffsets[nWays];
+    size_t nExternal = h.sizes[EXTERNAL_IDS]/8;
+    for (size_t k=0; ok && k<nRefs; k++) {
+        int64_t r = wayRefs[k];
+        ok = r >= 0 ? r < nNodes : -1-r < (int64_t)nExternal;
+    }
+    ok = ok && inRange((const uint32_t*)nodeTags, 2*size_t(nodeTagOffsets[nNodes]), nStrings);
+    ok = ok && inRange((const uint32_t*)wayTags, 2*size_t(wayTagOffsets[nWays]), nStrings);
+    ok = ok && inRange(cellWays, cellOffsets[gridN*gridN], nWays);
+    if (!ok) { close(); return false; }
+    return true;
+}
+
+void OSMTile::close() {
+    if (data) munmap((void*)data, size);
+    data = 0;
+    size = 0;
+    nStrings = nNodes = nWays = gridN = 0;
+}
+
+int OSMTile::getNodeCount() { return nNodes; }
+int OSMTile::getWayCount() { return nWays; }
+const OSMTile::Node& OSMTile::getNode(int i) { return nodes[i]; }
+double OSMTile::getLat(int i) { return originLat + nodes[i].lat/scale; }
+double OSMTile::getLon(int i) { return originLon + nodes[i].lon/scale; }
+vector<OSMTile::Tag> OSMTile::getNodeTags(int i) { return vector<Tag>(nodeTags + nodeTagOffsets[i], nodeTags + nodeTagOffsets[i+1]); }
+int64_t OSMTile::getWayID(int i) { return wayIDs[i]; }
+vector<OSMTile::Tag> OSMTile::getWayTags(int i) { return vector<Tag>(wayTags + wayTagOffsets[i], wayTags + wayTagOffsets[i+1]); }
+
+vector<int64_t> OSMTile::getWayRefs(int i) {
+    vector<int64_t> res;
+    res.reserve(wayRefOffsets[i+1] - wayRefOffsets[i]);
+    for (uint32_t k = wayRefOffsets[i]; k < wayRefOffsets[i+1]; k++) {
+        int32_t r = wayRefs[k];
+        res.push_back( r >= 0 ? nodes[r].id : externalIDs[-1-r] );
+    }
+    return res;
+}
+
+string OSMTile::getString(uint32_t i) {
+    if (i >= nStrings) return "";
+    return string(strings + stringOffsets[i], stringOffsets[i+1] - stringOffsets[i]);
+}
+
+void OSMTile::getBounds(double& minLat, double& minLon, double& maxLat, double& maxLon) {
+    minLat = bounds[0]; minLon = bounds[1];
+    maxLat = bounds[2]; maxLon = bounds[3];
+}
+
+void OSMTile::cellRange(double lat, double lon, int& i, int& j) {
+    i = cellIndex(lat, bounds[0], bounds[2], gridN);
+    j = cellIndex(lon, bounds[1], bounds[3], gridN);
+}
+
+/** ways whose bounding box overlaps a grid cell of the box, sorted by index **/
+vector<int> OSMTile::getWays(double minLat, double minLon, double maxLat, double maxLon) {
+    vector<int> res;
+    if (!data || maxLat < bounds[0] || minLat > bounds[2] || maxLon < bounds[1] || minLon > bounds[3]) return res;
+
+    int i0, j0, i1, j1;
+    cellRange(minLat, minLon, i0, j0);
+    cellRange(maxLat, maxLon, i1, j1);
+    for (int i=i0; i<=i1; i++) {
+        for (int j=j0; j<=j1; j++) {
+            int c = i*gridN+j;
+            res.insert(res.end(), cellWays + cellOffsets[c], cellWays + cellOffsets[c+1]);
+        }
+    }
+
+    sort(res.begin(), res.end());
+    res.erase(unique(res.begin(), res.end()), res.end());
+    return res;
+}
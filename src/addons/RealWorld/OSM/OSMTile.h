@@ -0,0 +1,84 @@
+#ifndef OSMTILE_H
+#define OSMTILE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+class OSMMap;
+
+/**
+    Binary tile of an OSM map, written once after parsing the XML and mapped into memory when loaded.
+    Coordinates are 1e-7 degree offsets to the origin of the tile, tag keys and values are indices into a table of unique strings.
+    The node and way arrays have fixed size entries, the tags of node i are nodeTags[nodeTagOffsets[i]] to nodeTags[nodeTagOffsets[i+1]],
+    the tags and node references of the ways are stored the same way, a reference -1-k is the node with the external ID k from another tile.
+    The ways are indexed by a grid over the tile, cell c contains the ways cellWays[cellOffsets[c]] to cellWays[cellOffsets[c+1]].
+*/
+
+class OSMTile {
+    public:
+        struct Node {
+            int64_t id;
+            int32_t lat;
+            int32_t lon;
+        };
+
+        struct Tag {
+            uint32_t key;
+            uint32_t value;
+        };
+
+    private:
+        const char* data = 0;
+        size_t size = 0;
+
+        double originLat = 0;
+        double originLon = 0;
+        double bounds[4] = {0,0,0,0}; // min lat, min lon, max lat, max lon
+        uint32_t gridN = 0;
+
+        uint32_t nStrings = 0;
+        uint32_t nNodes = 0;
+        uint32_t nWays = 0;
+        const uint32_t* stringOffsets = 0;
+        const char* strings = 0;
+        const Node* nodes = 0;
+        const uint32_t* nodeTagOffsets = 0;
+        const Tag* nodeTags = 0;
+        const int64_t* wayIDs = 0;
+        const uint32_t* wayRefOffsets = 0;
+        const int32_t* wayRefs = 0;
+        const int64_t* externalIDs = 0;
+        const uint32_t* wayTagOffsets = 0;
+        const Tag* wayTags = 0;
+        const uint32_t* cellOffsets = 0;
+        const uint32_t* cellWays = 0;
+
+        void cellRange(double lat, double lon, int& i, int& j);
+
+    public:
+        OSMTile();
+        ~OSMTile();
+
+        static bool write(OSMMap* map, string path);
+        bool open(string path);
+        void close();
+
+        int getNodeCount();
+        int getWayCount();
+        const Node& getNode(int i);
+        double getLat(int i);
+        double getLon(int i);
+        vector<Tag> getNodeTags(int i);
+        int64_t getWayID(int i);
+        vector<int64_t> getWayRefs(int i);
+        vector<Tag> getWayTags(int i);
+        string getString(uint32_t i);
+        void getBounds(double& minLat, double& minLon, double& maxLat, double& maxLon);
+
+        vector<int> getWays(double minLat, double minLon, double maxLat, double maxLon);
+};
+
+#endif // OSMTILE_H
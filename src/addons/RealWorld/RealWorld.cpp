@@ -37,10 +37,10 @@ RealWorld::RealWorld(string name) {
 }
 
 RealWorld::~RealWorld() {
+    if (mapManager) delete mapManager; // waits for the map loading threads
     if (world) delete world;
     if (mapDB) delete mapDB;
     if (mapCoordinator) delete mapCoordinator;
-    if (mapManager) delete mapManager;
 }
 
 std::shared_ptr<RealWorld> RealWorld::create(string name) { return std::shared_ptr<RealWorld>(new RealWorld(name)); }
@@ -60,9 +60,12 @@ World* RealWorld::getWorld() { return world; }
 OSMMapDB* RealWorld::getDB() { return mapDB; }
 TrafficSimulation* RealWorld::getTrafficSimulation() { return trafficSimulation; }
 
-void RealWorld::update(Vec3f pos) { if (mapManager) mapManager->updatePosition( Vec2f(pos[0], pos[2]) ); }
+void RealWorld::update(Vec3f pos, Vec3f dir) { if (mapManager) mapManager->updatePosition( Vec2f(pos[0], pos[2]), Vec2f(dir[0], dir[2]) ); }
 void RealWorld::configure(string var, string val) { options[var] = val; }
-string RealWorld::getOption(string var) { return options[var]; }
+string RealWorld::getOption(string var) { // read by the map loading threads
+    auto o = options.find(var);
+    return o != options.end() ? o->second : "";
+}
 
 void RealWorld::enableModule(string mod, bool b, bool t, bool p) {
     if (!mapManager) return;
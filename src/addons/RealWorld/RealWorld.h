@@ -44,7 +44,7 @@ class RealWorld : public VRObject {
         void enableModule(string mod, bool b, bool t, bool p);
         void configure(string var, string val);
         static string getOption(string var);
-        void update(OSG::Vec3f pos);
+        void update(OSG::Vec3f pos, OSG::Vec3f dir = OSG::Vec3f());
 
         TrafficSimulation* getTrafficSimulation();
         MapCoordinator* getCoordinator();
@@ -8,7 +8,7 @@ simplePyType(RealWorld, New_named_ptr);
 
 PyMethodDef VRPyRealWorld::methods[] = {
     {"init", (PyCFunction)VRPyRealWorld::initWorld, METH_VARARGS, "Init world - init( size [X,Y])" },
-    {"update", (PyCFunction)VRPyRealWorld::update, METH_VARARGS, "Update world chunks around position - update([x,y,z])" },
+    {"update", (PyCFunction)VRPyRealWorld::update, METH_VARARGS, "Update world chunks around position, chunks in view direction are loaded first - update([x,y,z] | [dx,dy,dz])" },
     {"enableModule", (PyCFunction)VRPyRealWorld::enableModule, METH_VARARGS, "Enable a module - enableModule(str, bool threaded, bool physicalized)" },
     {"disableModule", (PyCFunction)VRPyRealWorld::disableModule, METH_VARARGS, "Disable a module - disableModule(str)" },
     {"configure", (PyCFunction)VRPyRealWorld::configure, METH_VARARGS, "Configure a variable - configure( str var, str value )"
@@ -35,7 +35,11 @@ PyObject* VRPyRealWorld::configure(VRPyRealWorld* self, PyObject* args) {
 
 PyObject* VRPyRealWorld::update(VRPyRealWorld* self, PyObject* args) {
 	if (!self->valid()) return NULL;
-    self->objPtr->update( parseVec3f(args) );
+    if (pySize(args) == 2) { // position and view direction
+        PyObject *p, *d;
+        if (! PyArg_ParseTuple(args, "OO", &p, &d)) return NULL;
+        self->objPtr->update( parseVec3fList(p), parseVec3fList(d) );
+    } else self->objPtr->update( parseVec3f(args) );
     Py_RETURN_TRUE;
 }
 
@@ -25,6 +25,7 @@ void ModuleTraffic::loadBbox(MapGrid::Box bbox) {
     auto mapDB = RealWorld::get()->getDB();
     OSMMap* osmMap = mapDB->getMap(bbox.str);
     if (!osmMap) return;
+    osmMap->getWays(bbox.min[0], bbox.min[1], bbox.max[0], bbox.max[1]); // expands the ways of a tile into osmWays before the thread reads them
 
     threadFkt = VRFunction<VRThreadWeakPtr>::create("trafficAddMap", boost::bind(&TrafficSimulation::addMap, simulation, osmMap));
     VRSceneManager::get()->initThread(threadFkt, "trafficAddMap", false);
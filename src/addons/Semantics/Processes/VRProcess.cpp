@@ -78,9 +78,9 @@ void VRProcess::update() {
     string q_subjects = "q(x):ActiveProcessComponent(x);Layer("+layer->getName()+");has("+layer->getName()+",x)";
     for ( auto subject : query(q_subjects) ) {
         string label;
-        if (auto l = subject->get("hasModelComponentLable") ) label = l->value;
+        if (auto l = subject->get("hasModelComponentLable") ) label = l->getValue();
         int nID = addSubject(label)->ID;
-        if (auto ID = subject->get("hasModelComponentID") ) nodes[ID->value] = nID;
+        if (auto ID = subject->get("hasModelComponentID") ) nodes[ID->getValue()] = nID;
     }
 
     map<string, map<string, vector<VREntityPtr>>> messages;
@@ -88,8 +88,8 @@ void VRProcess::update() {
     for ( auto message : query(q_messages) ) {
         string sender;
         string receiver;
-        if (auto s = message->get("sender") ) sender = s->value;
-        if (auto r = message->get("receiver") ) receiver = r->value;
+        if (auto s = message->get("sender") ) sender = s->getValue();
+        if (auto r = message->get("receiver") ) receiver = r->getValue();
         messages[sender][receiver].push_back(message);
     }
 
@@ -100,7 +100,7 @@ void VRProcess::update() {
                 string q_message = "q(x):MessageSpec(x);MessageExchange("+message->getName()+");is(x,"+message->getName()+".hasMessageType)";
                 auto msgs = query(q_message);
                 if (msgs.size())
-                    if (auto l = msgs[0]->get("hasModelComponentLable") ) label += "\n - " + l->value;
+                    if (auto l = msgs[0]->get("hasModelComponentLable") ) label += "\n - " + l->getValue();
             }
 
             addMessage(label, nodes[sender.first], nodes[receiver.first]);
@@ -117,15 +117,15 @@ void VRProcess::update() {
         if (subjects.size() == 0) continue;
         auto subject = subjects[0];
         auto ID = subject->get("hasModelComponentID");
-        int sID = nodes[ID->value];
+        int sID = nodes[ID->getValue()];
         behaviorDiagrams[sID] = behaviorDiagram;
 
         string q_States = "q(x):State(x);Behavior("+behavior->getName()+");has("+behavior->getName()+",x)";
         for (auto state : query(q_States)) {
             string label;
-            if (auto l = state->get("hasModelComponentLable") ) label = l->value;
+            if (auto l = state->get("hasModelComponentLable") ) label = l->getValue();
             int nID = addAction(label, behaviorDiagram)->ID;
-            if (auto ID = state->get("hasModelComponentID") ) nodes[ID->value] = nID;
+            if (auto ID = state->get("hasModelComponentID") ) nodes[ID->getValue()] = nID;
         }
 
         map<string, map<string, vector<VREntityPtr>>> edges;
@@ -133,8 +133,8 @@ void VRProcess::update() {
         for (auto edge : query(q_Edges)) {
             string source;
             string target;
-            if (auto s = edge->get("hasSourceState") ) source = s->value;
-            if (auto r = edge->get("hasTargetState") ) target = r->value;
+            if (auto s = edge->get("hasSourceState") ) source = s->getValue();
+            if (auto r = edge->get("hasTargetState") ) target = r->getValue();
             edges[source][target].push_back(edge);
         }
 
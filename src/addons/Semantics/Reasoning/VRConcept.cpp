@@ -9,8 +9,11 @@ using namespace OSG;
 
 map<int, VRConceptPtr> VRConcept::ConceptsByID = map<int, VRConceptPtr>();
 map<string, VRConceptPtr> VRConcept::ConceptsByName = map<string, VRConceptPtr>();
+int VRConcept::taxonomyRevision = 0;
 
 VRConcept::VRConcept(string name, VROntologyPtr o) {
+    static int conceptCount = 0;
+    index = conceptCount++;
     //cout << "VRConcept::VRConcept " << name << endl;
     setStorageType("Concept");
     setNameSpace("concept");
@@ -50,21 +53,24 @@ void VRConcept::setup() {
     auto tmp = parents;
     parents.clear();
     for (auto p : tmp) p.second->append(ptr());
+    taxonomyChanged();
 }
 
 void VRConcept::removeChild(VRConceptPtr c) {
     //if (children.count(c->ID)) children.erase(c->ID);
     if (c->parents.count(ID)) c->parents.erase(ID);
+    taxonomyChanged();
 }
 
 void VRConcept::removeParent(VRConceptPtr c) {
     //if (c->children.count(ID)) c->children.erase(ID);
     if (parents.count(c->ID)) parents.erase(c->ID);
+    taxonomyChanged();
 }
 
-void VRConcept::remProperty(VRPropertyPtr p) { if (properties.count(p->ID)) properties.erase(p->ID); }
+void VRConcept::remProperty(VRPropertyPtr p) { if (properties.count(p->ID)) properties.erase(p->ID); ontologyChanged(); }
 void VRConcept::addAnnotation(VRPropertyPtr p) { annotations[p->ID] = p; }
-void VRConcept::addProperty(VRPropertyPtr p) { properties[p->ID] = p; }
+void VRConcept::addProperty(VRPropertyPtr p) { properties[p->ID] = p; ontologyChanged(); }
 
 VRConceptPtr VRConcept::append(string name, bool link) {
     auto c = VRConcept::create(name, 0);
@@ -76,6 +82,7 @@ void VRConcept::append(VRConceptPtr c, bool link) {
     //cout << "VRConcept::append " << c->getName() << " to " << getName() << " ID " << c->ID << " " << ID << endl;
     //children[c->ID] = c;
     c->parents[ID] = ptr();
+    taxonomyChanged();
     if (!link) return;
     //link[c->ID] = ; // TODO
 }
@@ -161,16 +168,46 @@ int VRConcept::getPropertyID(string name) {
     return -1;
 }
 
+void VRConcept::taxonomyChanged() { taxonomyRevision++; ontologyChanged(); }
+void VRConcept::onNameChanged() { taxonomyChanged(); }
+
+/**
+    walks all ancestors once, recomputed only after the taxonomy changed,
+    the closures of the parents are not reused, in a cycle they may still be incomplete
+**/
+void VRConcept::updateClosure() {
+    if (closureRevision == taxonomyRevision) return;
+
+    auto setBit = [](vector<bool>& bits, int i) {
+        if (i >= (int)bits.size()) bits.resize(i+1, false);
+        bits[i] = true;
+    };
+
+    ancestors.clear();
+    ancestorNames.clear();
+    vector<VRConcept*> stack = { this };
+    while (stack.size()) {
+        VRConcept* c = stack.back();
+        stack.pop_back();
+        if (c->index < (int)ancestors.size() && ancestors[c->index]) continue; // visited
+        setBit(ancestors, c->index);
+        setBit(ancestorNames, internName(c->getName()));
+        for (auto p : c->parents) stack.push_back(p.second.get());
+    }
+
+    closureRevision = taxonomyRevision;
+}
+
 bool VRConcept::is_a(VRConceptPtr c) {
-    if (ID == c->ID) return true;
-    for (auto p : getParents()) if (p->is_a(c)) return true;
-    return false;
+    if (!c) return false;
+    updateClosure();
+    return c->index < (int)ancestors.size() && ancestors[c->index];
 }
 
 bool VRConcept::is_a(string concept) {
-    if (getName() == concept) return true;
-    for (auto p : getParents()) if (p->is_a(concept)) return true;
-    return false;
+    updateClosure(); // interns the names of the ancestors
+    int n = findName(concept);
+    return n >= 0 && n < (int)ancestorNames.size() && ancestorNames[n];
 }
 
 string VRConcept::toString(string indent) {
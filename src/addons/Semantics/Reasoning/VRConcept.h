@@ -28,6 +28,12 @@ struct VROntologyLink : VRStorage {
 struct VRConcept : public std::enable_shared_from_this<VRConcept>, public VROntoID, public VRName {
     static map<int, VRConceptPtr> ConceptsByID;
     static map<string, VRConceptPtr> ConceptsByName;
+    static int taxonomyRevision; // changes with every parent link or rename, invalidates the is_a closures
+
+    int index; // dense concept index
+    vector<bool> ancestors; // transitive is_a closure, by concept index, including this concept
+    vector<bool> ancestorNames; // the same by interned concept name
+    int closureRevision = -1;
 
     //VROntologyWeakPtr ontology;
     map<int, VRConceptPtr> parents;
@@ -67,6 +73,9 @@ struct VRConcept : public std::enable_shared_from_this<VRConcept>, public VROnto
     //void getDescendance(map<int, VRConceptPtr>& concepts);
     void detach();
 
+    void onNameChanged();
+    static void taxonomyChanged();
+    void updateClosure();
     bool is_a(VRConceptPtr c);
     bool is_a(string concept);
     string toString(string indent = "");
@@ -68,7 +68,14 @@ VREntityPtr VREntity::create(string name, VROntologyPtr o, VRConceptPtr c) { ret
 void VREntity::setSGObject(VRObjectPtr o) { sgObject = o; }
 VRObjectPtr VREntity::getSGObject() { return sgObject.lock(); }
 
-void VREntity::addConcept(VRConceptPtr c) { concepts.push_back(c); }
+void VREntity::addConcept(VRConceptPtr c) {
+    concepts.push_back(c);
+    if (auto o = ontology.lock()) o->indexConcept(ID, c);
+}
+
+void VREntity::onNameChanged() {
+    if (auto o = ontology.lock()) o->indexName(ID);
+}
 
 vector<VRConceptPtr> VREntity::getConcepts() {
     vector<VRConceptPtr> res;
@@ -106,7 +113,7 @@ void VREntity::set(string name, string value, int pos) {
     if (!properties.count(name)) { add(name, value); return; }
     auto prop = get(name);
     if (!prop) { WARN("Warning (set): Entity " + this->name + " has no property " + name); return; }
-    properties[name][pos]->value = value;
+    properties[name][pos]->setValue(value);
     // TODO: warn if vector size bigger 1
 }
 
@@ -114,14 +121,16 @@ void VREntity::add(string name, string value) {
     auto prop = getProperty(name);
     if (!prop) { WARN("Warning (add): Entity " + this->name + " has no property " + name); return; }
     prop = prop->copy();
-    prop->value = value;
+    prop->setValue(value);
     properties[name].push_back( prop );
+    ontologyChanged();
 }
 
 void VREntity::clear(string name) {
     auto prop = getProperty(name);
     if (!prop) { WARN("Warning (clear): Entity " + this->name + " has no property " + name); return; }
     properties[name].clear();
+    ontologyChanged();
 }
 
 void VREntity::rem(VRPropertyPtr p) {
@@ -130,13 +139,14 @@ void VREntity::rem(VRPropertyPtr p) {
         auto& v = properties[name];
         v.erase( remove(v.begin(), v.end(), p), v.end() );
     }
+    ontologyChanged();
 }
 
 void VREntity::setVector(string name, vector<string> v, string type, int pos) {
     if (auto o = ontology.lock()) {
         if (!properties.count(name)) { addVector(name, v, type); return; }
         if (!get(name)) { WARN("Warning (setVector): Entity " + this->name + " has no property " + name); return; }
-        auto v_name = properties[name][pos]->value;
+        auto v_name = properties[name][pos]->getValue();
         auto vec = o->getEntity(v_name);
         if (!vec) { WARN("Warning (setVector): Entity " + this->name + " has no vector entity " + v_name); return; }
         int N = v.size();
@@ -156,9 +166,14 @@ void VREntity::addVector(string name, vector<string> v, string type) {
 }
 
 VRPropertyPtr VREntity::get(string prop, int i) {
-    auto props = getAll(prop);
-    if (i >= int(props.size())) return 0;
-    return props[i];
+    if (prop == "") {
+        auto props = getAll(prop);
+        if (i >= int(props.size())) return 0;
+        return props[i];
+    }
+    auto it = properties.find(prop);
+    if (it == properties.end() || i < 0 || i >= int(it->second.size())) return 0;
+    return it->second[i];
 }
 
 vector<VRPropertyPtr> VREntity::getAll(string name) {
@@ -170,15 +185,12 @@ vector<VRPropertyPtr> VREntity::getAll(string name) {
 
 vector<VRPropertyPtr> VREntity::getVector(string prop, int i) { // TODO
     vector<VRPropertyPtr> res;
-    auto vp = get(prop, i);
-    if (!vp) return res;
-    if (auto o = ontology.lock()) {
-        auto ve = o->getEntity( vp->value ); // vector entity
-        if (auto p = ve->get("x")) res.push_back( p );
-        if (auto p = ve->get("y")) res.push_back( p );
-        if (auto p = ve->get("z")) res.push_back( p );
-        if (auto p = ve->get("w")) res.push_back( p );
-    }
+    auto ve = getEntity(prop, i); // vector entity
+    if (!ve) return res;
+    if (auto p = ve->get("x")) res.push_back( p );
+    if (auto p = ve->get("y")) res.push_back( p );
+    if (auto p = ve->get("z")) res.push_back( p );
+    if (auto p = ve->get("w")) res.push_back( p );
     return res;
 }
 
@@ -187,17 +199,27 @@ vector< vector<VRPropertyPtr> > VREntity::getAllVector(string prop) { // TODO
     return res;
 }
 
+/** the referenced entity is cached in the property until its value changes or the entity is renamed **/
+VREntityPtr resolveEntity(VRPropertyPtr p, VROntologyPtr onto) {
+    auto e = p->entity.lock();
+    if (e && e->getName() == p->getValue()) return e;
+    if (!onto) return 0;
+    e = onto->getEntity( p->getValue() );
+    p->entity = e;
+    return e;
+}
+
 VREntityPtr VREntity::getEntity(string prop, int i) {
     auto p = get(prop, i);
     if (!p) return 0;
-    if (auto onto = ontology.lock()) return onto->getEntity( p->value );
-    return 0;
+    return resolveEntity(p, ontology.lock());
 }
 
 vector<VREntityPtr> VREntity::getAllEntities(string prop) {
     vector<VREntityPtr> res;
+    auto onto = ontology.lock();
     for (auto p : getAll(prop)) {
-        auto e = ontology.lock()->getEntity( p->value );
+        auto e = resolveEntity(p, onto);
         if (e) res.push_back( e );
     }
     return res;
@@ -205,13 +227,19 @@ vector<VREntityPtr> VREntity::getAllEntities(string prop) {
 
 Vec3f VREntity::getVec3f(string prop, int i) {
     Vec3f res;
-    auto vec = getVector(prop, i);
-    for (int i=0; i<3; i++) res[i] = toFloat( vec[i]->value );
+    auto ve = getEntity(prop, i); // vector entity
+    if (!ve) return res;
+    if (auto p = ve->get("x")) res[0] = p->getFloat();
+    if (auto p = ve->get("y")) res[1] = p->getFloat();
+    if (auto p = ve->get("z")) res[2] = p->getFloat();
     return res;
 }
 
-vector< Vec3f > VREntity::getAllVec3f(string prop) { // TODO
+vector< Vec3f > VREntity::getAllVec3f(string prop) {
     vector< Vec3f > res;
+    auto it = properties.find(prop);
+    if (it == properties.end()) return res;
+    for (uint i=0; i<it->second.size(); i++) res.push_back( getVec3f(prop, i) );
     return res;
 }
 
@@ -222,7 +250,7 @@ string VREntity::toString() {
     data += " with properties:";
     for (auto p : properties) {
         for (auto sp : p.second) {
-            data += " "+sp->getName()+"("+sp->type+")="+sp->value;
+            data += " "+sp->getName()+"("+sp->type+")="+sp->getValue();
         }
     }
     return data;
@@ -244,7 +272,7 @@ void VREntity::save(xmlpp::Element* e, int p) {
         auto e2 = e->add_child(p.first);
         for (auto sp : p.second) {
             auto e3 = e2->add_child(sp->getName());
-            e3->set_attribute("value", sp->value);
+            e3->set_attribute("value", sp->getValue());
             e3->set_attribute("type", sp->type);
         }
     }
@@ -257,7 +285,7 @@ void VREntity::load(xmlpp::Element* e) {
         for (auto el2 : getChildren(el)) {
             string n = el2->get_name();
             auto p = VRProperty::create(n,"");
-            if (el2->get_attribute("value")) p->value = el2->get_attribute("value")->get_value();
+            if (el2->get_attribute("value")) p->setValue( el2->get_attribute("value")->get_value() );
             if (el2->get_attribute("type")) p->type = el2->get_attribute("type")->get_value();
             properties[n].push_back(p);
         }
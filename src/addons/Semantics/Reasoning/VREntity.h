@@ -15,8 +15,10 @@ struct VREntity : public VROntoID, public VRName {
     map<string, vector<VRPropertyPtr> > properties;
     VROntologyWeakPtr ontology;
     VRObjectWeakPtr sgObject;
+    string indexedName; // name in the index of the ontology, removed from it on rename
 
     VREntity(string name, VROntologyPtr o, VRConceptPtr c = 0);
+    void onNameChanged();
 
     static VREntityPtr create(string name = "none", VROntologyPtr o = 0, VRConceptPtr c = 0);
     void addConcept(VRConceptPtr c);
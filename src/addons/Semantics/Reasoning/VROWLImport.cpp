@@ -223,7 +223,7 @@ bool VROWLImport::ProcessSubject(RDFStatement& statement, vector<RDFStatement>&
 
         if (annproperties.count(predicate) && annproperties[predicate]->type == "aprop") { // concept(subject) has an annotation(predicate) with value(object)
             auto p = annproperties[predicate]->copy(); // copy annotations
-            p->value = object;
+            p->setValue(object);
             getConcept(subject)->addAnnotation(p);
             return 0;
         }
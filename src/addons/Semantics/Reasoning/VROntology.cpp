@@ -1,5 +1,7 @@
 #include "VROntology.h"
 #include "VRReasoner.h"
+#include "VRQueryPlan.h"
+#include "VRStatement.h"
 #include "VRProperty.h"
 #include "VROWLImport.h"
 #include "core/utils/toString.h"
@@ -9,6 +11,7 @@
 #include "core/gui/VRGuiManager.h"
 #include "core/gui/VRGuiConsole.h"
 #include <iostream>
+#include <algorithm>
 
 #define WARN(x) \
 VRGuiManager::get()->getConsole( "Errors" )->write( x+"\n" );
@@ -48,15 +51,19 @@ void VROntology::setup() {
 
     auto insts = entities;
     entities.clear();
+    entityNames.clear();
+    extents.clear();
     for (auto& i : insts) {
         for (auto c : i.second->conceptNames) i.second->addConcept( concepts[c].lock() ); // update concept
-        entities[i.second->ID] = i.second; // update ID mapping
+        addEntity(i.second); // update ID mapping and indices
     }
 
     auto rls = rules;
     rules.clear();
+    hasRules.clear();
     for (auto& r : rls) {
         rules[r.second->ID] = r.second; // update ID mapping
+        indexRule(r.second);
     }
 }
 
@@ -117,6 +124,7 @@ void VROntology::addConcept(VRConceptPtr c) {
     if (c == thing) return;
     concepts[c->getName()] = c;
     if (!c->hasParent()) thing->append(c);
+    ontologyChanged();
 }
 
 void VROntology::remConcept(VRConceptPtr c) {
@@ -124,6 +132,7 @@ void VROntology::remConcept(VRConceptPtr c) {
     if (!concepts.count(c->getName())) return;
     c->detach();
     concepts.erase(c->getName());
+    ontologyChanged();
 }
 
 void VROntology::renameConcept(VRConceptPtr c, string newName) {
@@ -138,6 +147,13 @@ void VROntology::remEntity(VREntityPtr e) {
     if (!e) return;
     if (!entities.count(e->ID)) return;
     entities.erase(e->ID);
+    auto n = entityNames.find(e->getName());
+    if (n != entityNames.end() && n->second.lock() == e) entityNames.erase(n);
+    for (auto cw : e->concepts) {
+        auto c = cw.lock();
+        if (c && extents.count(c->ID)) extents[c->ID].entities.erase(e->ID);
+    }
+    ontologyChanged();
 }
 
 void VROntology::remEntities(string concept) {
@@ -147,18 +163,50 @@ void VROntology::remEntities(string concept) {
 void VROntology::remRule(VROntologyRulePtr r) {
     if (!rules.count(r->ID)) return;
     rules.erase(r->ID);
+    hasRules.erase(r->ID);
+    ontologyChanged();
 }
 
 void VROntology::renameEntity(VREntityPtr e, string s) {
     if (!entities.count(e->ID)) return;
-    e->setName(s);
+    e->setName(s); // reindexed in VREntity::onNameChanged
+}
+
+void VROntology::indexName(int ID) {
+    auto e = entities.find(ID);
+    if (e != entities.end()) {
+        auto& E = e->second;
+        auto old = entityNames.find(E->indexedName);
+        if (old != entityNames.end() && old->second.lock() == E) entityNames.erase(old); // renamed
+        E->indexedName = E->getName();
+        entityNames[E->indexedName] = E;
+    }
+    ontologyChanged();
+}
+
+void VROntology::indexConcept(int ID, VRConceptPtr c) {
+    auto e = entities.find(ID);
+    if (!c || e == entities.end()) return;
+    auto& extent = extents[c->ID];
+    extent.concept = c;
+    extent.entities[ID] = e->second;
+    ontologyChanged();
+}
+
+void VROntology::indexRule(VROntologyRulePtr r) {
+    if (r->query && r->query->verb == "has") hasRules.insert(r->ID);
+    else hasRules.erase(r->ID);
 }
 
+bool VROntology::hasHasRules() { return hasRules.size() > 0; }
+
 //void VROntology::import(VROntologyPtr o) { dependencies[o->getName()] = o; }
 void VROntology::import(VROntologyPtr o) { merge(o); }
 
 void VROntology::merge(VROntologyPtr o) { // Todo: check it well!
+    ontologyChanged();
     for (auto c : o->rules) rules[c.first] = c.second;
+    hasRules.insert(o->hasRules.begin(), o->hasRules.end());
     for (auto b : o->builtins) builtins[b.first] = b.second;
     for (auto c : o->concepts) {
         auto cn = c.second.lock();
@@ -190,6 +238,8 @@ vector<VROntologyRulePtr> VROntology::getRules() {
 VROntologyRulePtr VROntology::addRule(string rule, string ac) {
     VROntologyRulePtr r = VROntologyRule::create(rule, ac);
     rules[r->ID] = r;
+    indexRule(r);
+    ontologyChanged();
     return r;
 }
 
@@ -209,7 +259,12 @@ VREntityPtr VROntology::addVectorEntity(string name, string concept, vector<stri
     return i;
 }
 
-void VROntology::addEntity(VREntityPtr e) { entities[e->ID] = e; }
+void VROntology::addEntity(VREntityPtr e) {
+    if (!e->ontology.lock()) e->ontology = ptr(); // imported entities, needed to keep the indices up to date
+    entities[e->ID] = e;
+    indexName(e->ID);
+    for (auto c : e->concepts) indexConcept(e->ID, c.lock());
+}
 
 VREntityPtr VROntology::addEntity(string name, string concept) {
     auto c = getConcept(concept);
@@ -218,20 +273,39 @@ VREntityPtr VROntology::addEntity(string name, string concept) {
     return e;
 }
 
-VREntityPtr VROntology::getEntity(string e) {
-    for (auto i : entities) if (i.second->getName() == e) return i.second;
-    return 0;
+VREntityPtr VROntology::getEntity(string name) {
+    auto i = entityNames.find(name);
+    if (i == entityNames.end()) return 0;
+    auto e = i->second.lock();
+    if (e && e->getName() == name && entities.count(e->ID)) return e;
+    return 0; // entry of an entity renamed in another ontology
 }
 
+/** unites the extents of all concepts that are a concept, ordered by entity ID **/
 vector<VREntityPtr> VROntology::getEntities(string concept) {
     vector<VREntityPtr> res;
-    if (concept != "") {
-        for (auto i : entities) {
-            for (auto c : i.second->getConcepts()) {
-                if(c && c->is_a(concept)) { res.push_back(i.second); break; }
-            }
-        }
-    } else for (auto i : entities) res.push_back(i.second);
+    if (concept == "") {
+        for (auto i : entities) res.push_back(i.second);
+        return res;
+    }
+
+    vector<pair<int, VREntityPtr> > found;
+    int nExtents = 0;
+    for (auto& x : extents) {
+        auto c = x.second.concept.lock();
+        if (!c || !c->is_a(concept)) continue;
+        nExtents++;
+        for (auto& e : x.second.entities) if (auto E = e.second.lock()) found.push_back( make_pair(e.first, E) );
+    }
+
+    if (nExtents > 1) { // entities with several concepts
+        auto lessID = [](const pair<int, VREntityPtr>& a, const pair<int, VREntityPtr>& b) { return a.first < b.first; };
+        auto sameID = [](const pair<int, VREntityPtr>& a, const pair<int, VREntityPtr>& b) { return a.first == b.first; };
+        sort(found.begin(), found.end(), lessID);
+        found.erase( unique(found.begin(), found.end(), sameID), found.end() );
+    }
+
+    for (auto& f : found) res.push_back(f.second);
     return res;
 }
 
@@ -261,9 +335,14 @@ void VROntology::addModule(string mod) {
 void VROntology::setFlag(string f) { flag = f; }
 string VROntology::getFlag() { return flag; }
 
-vector<VREntityPtr> VROntology::process(string query) {
-    auto r = VRReasoner::create();
-    return r->process(query, ptr());
+/** the placeholders $0, $1, .. in the query are replaced by the parameters, the query is compiled only once **/
+vector<VREntityPtr> VROntology::process(string query, vector<string> params) {
+    auto p = queryPlans.find(query);
+    if (p == queryPlans.end()) {
+        if (queryPlans.size() > 1000) queryPlans.clear(); // queries built from names instead of parameters
+        p = queryPlans.insert( make_pair(query, VRQueryPlan::create(query, ptr())) ).first;
+    }
+    return p->second->execute(params);
 }
 
 
@@ -9,6 +9,8 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <set>
 #include <vector>
 #include <memory>
 
@@ -16,6 +18,11 @@ using namespace std;
 OSG_BEGIN_NAMESPACE;
 
 struct VROntology : public std::enable_shared_from_this<VROntology>, public VRName {
+    struct Extent {
+        VRConceptWeakPtr concept;
+        map<int, VREntityWeakPtr> entities;
+    };
+
     static map<string, VROntologyPtr> library;
     static void setupLibrary();
 
@@ -23,10 +30,14 @@ struct VROntology : public std::enable_shared_from_this<VROntology>, public VRNa
 
     VRConceptPtr thing = 0;
     map<int, VREntityPtr> entities;
+    unordered_map<string, VREntityWeakPtr> entityNames; // name index, lookups check the entries and never modify the index
+    map<int, Extent> extents; // entities by the ID of their direct concepts
     map<string, VRConceptWeakPtr> concepts;
     map<int, VROntologyRulePtr> rules;
+    set<int> hasRules; // IDs of the rules with a has query, queries need the reasoner while there are any
     map<string, VROntologyWeakPtr> dependencies;
     map<string, VRSemanticBuiltinPtr> builtins;
+    map<string, VRQueryPlanPtr> queryPlans; // compiled queries, with cached results
 
     VROntology(string name);
     static VROntologyPtr create(string name = "");
@@ -47,6 +58,10 @@ struct VROntology : public std::enable_shared_from_this<VROntology>, public VRNa
     void remRule(VROntologyRulePtr rule);
     void renameConcept(VRConceptPtr c, string newName);
     void renameEntity(VREntityPtr e, string s);
+    void indexName(int entityID);
+    void indexConcept(int entityID, VRConceptPtr c);
+    void indexRule(VROntologyRulePtr r);
+    bool hasHasRules();
 
     VRConceptPtr addConcept(string concept, string parent = "", string comment = "");
     VROntologyRulePtr addRule(string rule, string ac);
@@ -71,7 +86,7 @@ struct VROntology : public std::enable_shared_from_this<VROntology>, public VRNa
     void setFlag(string f);
     string getFlag();
 
-    vector<VREntityPtr> process(string query);
+    vector<VREntityPtr> process(string query, vector<string> params = vector<string>());
 };
 
 OSG_END_NAMESPACE;
@@ -1,11 +1,37 @@
 #include "VROntologyUtils.h"
 
+#include <unordered_map>
+#include <atomic>
+#include <boost/thread/mutex.hpp>
+
 int guid() {
-    static int id = 0;
-    id++;
-    return id;
+    static atomic<int> id(0);
+    return ++id;
+}
+
+unordered_map<string, int> internedNames;
+boost::mutex internMtx; // names are interned by loader threads too
+
+int internName(const string& name) {
+    boost::mutex::scoped_lock lock(internMtx);
+    auto it = internedNames.find(name);
+    if (it != internedNames.end()) return it->second;
+    int i = internedNames.size();
+    internedNames[name] = i;
+    return i;
 }
 
+int findName(const string& name) {
+    boost::mutex::scoped_lock lock(internMtx);
+    auto it = internedNames.find(name);
+    return it != internedNames.end() ? it->second : -1;
+}
+
+atomic<int> revision(0);
+
+int ontologyRevision() { return revision; }
+void ontologyChanged() { revision++; }
+
 VROntoID::VROntoID() {
     ID = guid();
 }
@@ -7,6 +7,12 @@ using namespace std;
 
 int guid();
 
+int internName(const string& name); // dense ID shared by all equal names
+int findName(const string& name); // -1 if the name was never interned
+
+int ontologyRevision(); // changes with every modification of an ontology, its entities or their properties
+void ontologyChanged();
+
 struct VROntoID {
     int ID;
     VROntoID();
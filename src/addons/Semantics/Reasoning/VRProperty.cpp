@@ -1,4 +1,6 @@
 #include "VRProperty.h"
+#include "core/utils/toString.h"
+#include "core/utils/VRStorage_template.h"
 
 #include <iostream>
 
@@ -14,11 +16,22 @@ VRProperty::VRProperty(string name, string t) {
 
     store("type", &type);
     store("value", &value);
+    regStorageSetupFkt( VRFunction<int>::create("property setup", boost::bind(&VRProperty::setup, this)) );
 }
 
 VRPropertyPtr VRProperty::create(string name, string type) { return VRPropertyPtr(new VRProperty(name, type)); }
 
 void VRProperty::setType(string type) { this->type = type; }
+void VRProperty::setup() { setValue(value); }
+string VRProperty::getValue() { return value; }
+float VRProperty::getFloat() { return number; }
+
+void VRProperty::setValue(string v) {
+    value = v;
+    number = toFloat(v);
+    entity.reset();
+    ontologyChanged();
+}
 
 string VRProperty::toString() {
     string res;
@@ -28,6 +41,6 @@ string VRProperty::toString() {
 
 VRPropertyPtr VRProperty::copy() {
     auto p = create(base_name, type);
-    p->value = value;
+    p->setValue(value);
     return p;
 }
@@ -10,16 +10,25 @@ using namespace std;
 OSG_BEGIN_NAMESPACE;
 
 struct VRProperty : public VROntoID, public VRName {
-    string type;
-    string value;
+    private:
+        string value;
+        float number = 0; // value parsed once when set
 
-    VRProperty(string name, string type = "");
-    static VRPropertyPtr create(string name = "none", string type = "");
-    VRPropertyPtr copy();
+    public:
+        string type;
+        VREntityWeakPtr entity; // the entity named by the value, resolved on first access
 
-    void setType(string type);
+        VRProperty(string name, string type = "");
+        static VRPropertyPtr create(string name = "none", string type = "");
+        VRPropertyPtr copy();
 
-    string toString();
+        void setType(string type);
+        void setValue(string value);
+        string getValue();
+        float getFloat();
+        void setup();
+
+        string toString();
 };
 
 OSG_END_NAMESPACE;
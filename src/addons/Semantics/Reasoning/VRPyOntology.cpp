@@ -40,7 +40,7 @@ PyObject* VRPyProperty::getType(VRPyProperty* self) {
 }
 
 PyObject* VRPyProperty::getValue(VRPyProperty* self) {
-    return PyString_FromString( self->objPtr->value.c_str() );
+    return PyString_FromString( self->objPtr->getValue().c_str() );
 }
 
 // --------------------- Concept --------------------
@@ -128,14 +128,14 @@ PyMethodDef VRPyEntity::methods[] = {
 struct VRPyPropertyCaster {
     static PyObject* cast(VRPropertyPtr p, VROntologyPtr o) {
         if (!p) Py_RETURN_NONE;
-        if (p->value == "") Py_RETURN_NONE;
-        if (p->type == "int") return PyInt_FromLong( toInt(p->value) );
-        if (p->type == "float") return PyFloat_FromDouble( toFloat(p->value) );
-        if (p->type == "string") return PyString_FromString( p->value.c_str() );
+        if (p->getValue() == "") Py_RETURN_NONE;
+        if (p->type == "int") return PyInt_FromLong( toInt(p->getValue()) );
+        if (p->type == "float") return PyFloat_FromDouble( toFloat(p->getValue()) );
+        if (p->type == "string") return PyString_FromString( p->getValue().c_str() );
         if (o) {
-            if (auto e = o->getEntity(p->value)) return VRPyEntity::fromSharedPtr(e);
+            if (auto e = o->getEntity(p->getValue())) return VRPyEntity::fromSharedPtr(e);
         }
-        return PyString_FromString( p->value.c_str() );
+        return PyString_FromString( p->getValue().c_str() );
     }
 };
 
@@ -298,7 +298,7 @@ PyMethodDef VRPyOntology::methods[] = {
     {"copy", (PyCFunction)VRPyOntology::copy, METH_NOARGS, "Copy the ontology - ontology copy()" },
     //{"addModule", (PyCFunction)proxy<string, VRPyOntology, void (VROntology::*)(string), &VROntology::addModule>::set, METH_VARARGS, "Add module from library - addModule( str name )" },
     {"addModule", PySetter(Ontology, addModule, string), "Add module from library - addModule( str name )" },
-    {"process", (PyCFunction)VRPyOntology::process, METH_VARARGS, "Process a query - process( str query )" },
+    {"process", (PyCFunction)VRPyOntology::process, METH_VARARGS, "Process a query, the placeholders $0, $1, .. are replaced by the parameters - [entities] process( str query | [str] params )" },
     {NULL}  /* Sentinel */
 };
 
@@ -308,11 +308,16 @@ PyObject* VRPyOntology::copy(VRPyOntology* self) {
 
 PyObject* VRPyOntology::process(VRPyOntology* self, PyObject* args) {
     const char* query = 0;
-    if (! PyArg_ParseTuple(args, "s:process", &query)) return NULL;
+    PyObject* pyParams = 0;
+    if (! PyArg_ParseTuple(args, "s|O:process", &query, &pyParams)) return NULL;
 
     auto pyres = PyList_New(0);
     if (!query) return pyres;
-    auto res = self->objPtr->process(string(query));
+    vector<string> params;
+    if (pyParams && isList(pyParams)) {
+        for (auto p : pyListToVector(pyParams)) if (PyString_Check(p)) params.push_back( PyString_AsString(p) );
+    }
+    auto res = self->objPtr->process(string(query), params);
     for (auto e : res) PyList_Append(pyres, VRPyEntity::fromSharedPtr(e));
     return pyres;
 }
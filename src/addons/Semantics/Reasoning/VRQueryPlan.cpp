@@ -0,0 +1,176 @@
+#include "VRQueryPlan.h"
+#include "VRReasoner.h"
+#include "VROntology.h"
+#include "VRProperty.h"
+#include "VRStatement.h"
+#include "core/utils/toString.h"
+
+#include <unordered_set>
+#include <algorithm>
+
+using namespace OSG;
+
+VRQueryPlan::VRQueryPlan(string query, VROntologyPtr onto) : query(query), ontology(onto) { compile(); }
+VRQueryPlan::~VRQueryPlan() {}
+
+VRQueryPlanPtr VRQueryPlan::create(string query, VROntologyPtr onto) { return VRQueryPlanPtr( new VRQueryPlan(query, onto) ); }
+
+int VRQueryPlan::getVariable(const string& name) {
+    for (uint i=0; i<vars.size(); i++) if (vars[i] == name) return i;
+    vars.push_back(name);
+    concepts.push_back("");
+    return vars.size()-1;
+}
+
+/** checks if the query can be evaluated without the reasoner **/
+void VRQueryPlan::compile() {
+    Query q(query);
+    if (!q.request || q.request->verb != "q" || q.request->terms.size() != 1) return;
+    if (q.request->terms[0].path.size() != 1) return;
+
+    for (auto s : q.statements) {
+        if (s->verb == "has") {
+            if (s->terms.size() != 2) return;
+            auto& a = s->terms[0];
+            auto& b = s->terms[1];
+            if (a.path.size() < 1 || a.path.size() > 3 || b.path.size() != 1) return;
+            int l = getVariable(a.path.root);
+            int r = getVariable(b.path.root);
+            joins.push_back( { l, r, a.path } );
+            continue;
+        }
+
+        if (s->isSimpleVerb() || s->terms.size() != 1 || s->terms[0].path.size() != 1) return; // is, q and builtins
+        int v = getVariable(s->terms[0].path.root);
+        if (concepts[v] != "" && concepts[v] != s->verb) return; // variable with several concepts
+        concepts[v] = s->verb;
+    }
+
+    request = getVariable(q.request->terms[0].path.root);
+    direct = true;
+}
+
+/** rules for has statements and unknown concepts need the reasoner **/
+bool VRQueryPlan::isDirect(VROntologyPtr onto) {
+    if (!direct) return false;
+    for (auto& c : concepts) if (c != "" && !onto->getConcept(c)) return false;
+    if (onto->hasHasRules()) return false;
+    return true;
+}
+
+string VRQueryPlan::resolve(const string& name, const vector<string>& params) {
+    if (name.size() < 2 || name[0] != '$') return name;
+    uint i = toInt(name.substr(1));
+    return i < params.size() ? params[i] : name;
+}
+
+string VRQueryPlan::substitute(const vector<string>& params) {
+    string res = query;
+    for (int i = params.size()-1; i >= 0; i--) { // $10 before $1
+        string p = "$" + toString(i);
+        for (size_t k = res.find(p); k != string::npos; k = res.find(p, k + params[i].size())) res.replace(k, p.size(), params[i]);
+    }
+    return res;
+}
+
+/** keeps the left entities with a path value naming an entity that has the name of a right entity as property value, and those right entities **/
+bool VRQueryPlan::semiJoin(Join& j, vector<vector<VREntityPtr> >& domains, VROntologyPtr onto) {
+    auto& L = domains[j.left];
+    auto& R = domains[j.right];
+    unordered_set<string> names;
+    for (auto& e : R) names.insert(e->getName());
+
+    unordered_set<string> matched;
+    vector<VREntityPtr> left;
+    for (auto& e : L) {
+        bool found = false;
+        for (auto& v : j.path.getValue(e)) {
+            auto owner = onto->getEntity(v);
+            if (!owner) continue;
+            for (auto& p : owner->properties) {
+                for (auto& pv : p.second) {
+                    if (!names.count(pv->getValue())) continue;
+                    matched.insert(pv->getValue());
+                    found = true;
+                }
+            }
+        }
+        if (found) left.push_back(e);
+    }
+
+    vector<VREntityPtr> right;
+    for (auto& e : R) if (matched.count(e->getName())) right.push_back(e);
+
+    if (j.left == j.right) { // both sides are the same variable
+        vector<VREntityPtr> both;
+        for (auto& e : left) if (matched.count(e->getName())) both.push_back(e);
+        bool changed = both.size() != L.size();
+        L.swap(both);
+        return changed;
+    }
+
+    bool changed = left.size() != L.size() || right.size() != R.size();
+    L.swap(left);
+    R.swap(right);
+    return changed;
+}
+
+vector<VREntityPtr> VRQueryPlan::evaluate(const vector<string>& params, VROntologyPtr onto) {
+    vector<vector<VREntityPtr> > domains(vars.size());
+    for (uint i=0; i<vars.size(); i++) {
+        if (auto e = onto->getEntity( resolve(vars[i], params) )) domains[i].push_back(e);
+        else if (concepts[i] != "") domains[i] = onto->getEntities(concepts[i]);
+    }
+
+    vector<int> order(joins.size());
+    for (uint i=0; i<order.size(); i++) order[i] = i;
+    auto cost = [&](int i) { return domains[joins[i].left].size() + domains[joins[i].right].size(); };
+
+    for (bool changed = true; changed; ) {
+        changed = false;
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return cost(a) < cost(b); });
+        for (int i : order) {
+            if (semiJoin(joins[i], domains, onto)) changed = true;
+            if (domains[request].empty()) return domains[request];
+        }
+        if (joins.size() == 1) break;
+    }
+
+    auto& res = domains[request];
+    sort(res.begin(), res.end(), [](const VREntityPtr& a, const VREntityPtr& b) { return a->ID < b->ID; });
+    return res;
+}
+
+void VRQueryPlan::clearCache() {
+    cache.clear();
+    cacheRevision = -1;
+}
+
+vector<VREntityPtr> VRQueryPlan::execute(const vector<string>& params) {
+    auto onto = ontology.lock();
+    if (!onto) return vector<VREntityPtr>();
+
+    int revision = ontologyRevision();
+    if (revision != cacheRevision) {
+        cache.clear();
+        cacheRevision = revision;
+        useDirect = isDirect(onto);
+    }
+
+    string key;
+    for (auto& p : params) key += p + '\n';
+    auto c = cache.find(key);
+    if (c != cache.end()) return c->second;
+
+    vector<VREntityPtr> res;
+    if (useDirect) {
+        res = evaluate(params, onto);
+        if (VRReasoner::verbose()) VRReasoner::print("direct query " + substitute(params) + ", " + toString(res.size()) + " results", VRReasoner::GREEN);
+    } else {
+        res = VRReasoner::create()->process(substitute(params), onto);
+        if (ontologyRevision() != revision) return res; // the reasoner modified the ontology
+    }
+
+    cache[key] = res;
+    return res;
+}
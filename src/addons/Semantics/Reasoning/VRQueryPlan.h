@@ -0,0 +1,62 @@
+#ifndef VRQUERYPLAN_H_INCLUDED
+#define VRQUERYPLAN_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "../VRSemanticsFwd.h"
+#include "VRSemanticUtils.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Compiled query, parsed once and evaluated for different parameters, the placeholders $0, $1, .. in the query are replaced by the parameters.
+    Queries of one variable with concept and has statements are evaluated directly on the concept extents,
+    each has statement is a hash semi join between the two variable domains, applied smallest domains first until no domain changes anymore.
+    All other queries, and ontologies with rules for has, are passed to the reasoner.
+    The results are cached per parameter set until an ontology is modified.
+*/
+
+class VRQueryPlan {
+    private:
+        struct Join {
+            int left;
+            int right;
+            VPath path; // of the left variable
+        };
+
+        string query;
+        VROntologyWeakPtr ontology;
+        bool direct = false;
+        int request = -1;
+        vector<string> vars; // variable names, or placeholders
+        vector<string> concepts; // concept of each variable, empty if not declared
+        vector<Join> joins;
+
+        map<string, vector<VREntityPtr> > cache; // results by parameters
+        int cacheRevision = -1;
+        bool useDirect = false;
+
+        void compile();
+        bool isDirect(VROntologyPtr onto);
+        int getVariable(const string& name);
+        string resolve(const string& name, const vector<string>& params);
+        string substitute(const vector<string>& params);
+        bool semiJoin(Join& j, vector<vector<VREntityPtr> >& domains, VROntologyPtr onto);
+        vector<VREntityPtr> evaluate(const vector<string>& params, VROntologyPtr onto);
+
+    public:
+        VRQueryPlan(string query, VROntologyPtr onto);
+        ~VRQueryPlan();
+        static VRQueryPlanPtr create(string query, VROntologyPtr onto);
+
+        vector<VREntityPtr> execute(const vector<string>& params = vector<string>());
+        void clearCache();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRQUERYPLAN_H_INCLUDED
@@ -52,6 +52,8 @@ bool VRReasoner::startswith(string s, string subs) {
     return s.compare(0, subs.size(), subs);
 }
 
+bool VRReasoner::verbose() { return verbGui || verbConsole; }
+
 void VRReasoner::print(const string& s) {
     if (verbConsole) cout << pre << s << endl;
     if (verbGui) VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n" );
@@ -70,33 +72,33 @@ void VRReasoner::print(const string& s, COLOR c) {
 
     if (verbGui) {
         switch(c) {
-            case BLUE: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "blue" );
-            case RED: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "red" );
-            case GREEN: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "green" );
-            case YELLOW: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "yellow" );
+            case BLUE: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "blue" ); break;
+            case RED: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "red" ); break;
+            case GREEN: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "green" ); break;
+            case YELLOW: VRGuiManager::get()->getConsole( "Reasoning" )->write( s+"\n", "yellow" ); break;
         }
     }
 }
 
 bool VRReasoner::findRule(VRStatementPtr statement, VRSemanticContextPtr context) {
-    print("     search rule for statement: " + statement->toString());
+    if (verbose()) print("     search rule for statement: " + statement->toString());
     for ( auto r : context->onto->getRules()) { // no match found -> check rules and initiate new queries
         //print("      check rule in context: "+r->rule, BLUE);
         if (!context->rules.count(r->rule)) continue;
         Query query = context->rules[r->rule];
         //print("      check rule verb: "+query.request->verb+" and "+statement->verb, BLUE);
         if (query.request->verb != statement->verb) continue; // rule verb does not match
-        print("      found rule with matching name: " + query.request->toString(), GREEN);
+        if (verbose()) print("      found rule with matching name: " + query.request->toString(), GREEN);
         if (!statement->match(query.request)) continue; // statements are not similar enough
-        print("      found rule: " + query.request->toString(), GREEN);
+        if (verbose()) print("      found rule: " + query.request->toString(), GREEN);
 
         query.substituteRequest(statement);
         //query.request->updateLocalVariables(context.vars, context.onto);
         context->queries.push_back(query);
-        print("      add query " + query.toString(), YELLOW);
+        if (verbose()) print("      add query " + query.toString(), YELLOW);
         return true;
     }
-    print("      no rule found!", RED);
+    if (verbose()) print("      no rule found!", RED);
     return false;
 }
 
@@ -130,7 +132,7 @@ bool VRReasoner::builtin(VRStatementPtr s, VRSemanticContextPtr c) {
                     auto e_var = c->vars[v];
                     for (auto ep : e_var->entities) {
                         auto e = ep.second;
-                        if (e->is_a("Vector")) params[i][er.get()] = e->get("x")->value +" "+ e->get("y")->value +" "+ e->get("z")->value;
+                        if (e->is_a("Vector")) params[i][er.get()] = e->get("x")->getValue() +" "+ e->get("y")->getValue() +" "+ e->get("z")->getValue();
                         else params[i][er.get()] = e->getName();
                     }
                 }
@@ -142,7 +144,7 @@ bool VRReasoner::builtin(VRStatementPtr s, VRSemanticContextPtr c) {
             for (auto ep : t.var->entities) {
                 auto e = ep.second;
                 if (!e) continue;
-                if (e->is_a("Vector")) params[i][e.get()] = e->get("x")->value +" "+ e->get("y")->value +" "+ e->get("z")->value;
+                if (e->is_a("Vector")) params[i][e.get()] = e->get("x")->getValue() +" "+ e->get("y")->getValue() +" "+ e->get("z")->getValue();
                 else params[i][e.get()] = e->getName();
             }
             continue;
@@ -178,7 +180,7 @@ bool VRReasoner::is(VRStatementPtr statement, VRSemanticContextPtr context) {
 
     bool b = left.is(right, context);
     bool NOT = statement->verb_suffix == "not";
-    print("   " + left.str + " is " + (b?"":" not ") + (NOT?" not ":"") + right.var->value);
+    if (verbose()) print("   " + left.str + " is " + (b?"":" not ") + (NOT?" not ":"") + right.var->value);
 
     return ( (b && !NOT) || (!b && NOT) );
 }
@@ -188,8 +190,8 @@ bool VRReasoner::has(VRStatementPtr statement, VRSemanticContextPtr context) { /
     auto& right = statement->terms[1];
 
     bool b = left.has(right, context);
-    print("  " + left.str + " has " + (b?"":"not") + " " + right.str);
-    print("RES " + toString(&right.var) + "   " + right.var->toString());
+    if (verbose()) print("  " + left.str + " has " + (b?"":"not") + " " + right.str);
+    if (verbose()) print("RES " + toString(&right.var) + "   " + right.var->toString());
     if (b) { statement->state = 1; return true; }
 
     // DEBUG -> TODO
@@ -232,12 +234,12 @@ bool VRReasoner::apply(VRStatementPtr statement, VRSemanticContextPtr context) {
                     }
 
                     left.path.setValue(vR, eL.second);
-                    print("  set " + left.str + " to " + right.str + " -> " + vR, GREEN);
+                    if (verbose()) print("  set " + left.str + " to " + right.str + " -> " + vR, GREEN);
                 }
             }
         } else {
             left.var->value = right.var->value;
-            print("  set " + left.str + " to " + right.str + " -> " + toString(left.var->value), GREEN);
+            if (verbose()) print("  set " + left.str + " to " + right.str + " -> " + toString(left.var->value), GREEN);
         }
         statement->state = 1;
     }
@@ -247,16 +249,16 @@ bool VRReasoner::apply(VRStatementPtr statement, VRSemanticContextPtr context) {
         auto& right = statement->terms[1];
         auto Cconcept = context->onto->getConcept( right.var->concept ); // child concept
         auto Pconcept = context->onto->getConcept( left.var->concept ); // parent concept
-        if (!Pconcept || !Cconcept) { print("Warning: failed to apply " + statement->toString()); return false; }
+        if (!Pconcept || !Cconcept) { if (verbose()) print("Warning: failed to apply " + statement->toString()); return false; }
         auto prop = Pconcept->getProperties( Cconcept->getName() );
-        if (prop.size() == 0) { print("Warning: failed to apply " + statement->toString()); return false; }
+        if (prop.size() == 0) { if (verbose()) print("Warning: failed to apply " + statement->toString()); return false; }
         for (auto i : left.var->entities) i.second->add(prop[0]->getName(), right.var->value); // TODO: the first parameter is wrong
         statement->state = 1;
-        print("  give " + right.str + " to " + left.str, GREEN);
+        if (verbose()) print("  give " + right.str + " to " + left.str, GREEN);
     }
 
     if (statement->verb == "q") {
-        if (statement->terms.size() == 0) { print("Warning: failed to apply " + statement->toString() + ", empty query!"); return false; }
+        if (statement->terms.size() == 0) { if (verbose()) print("Warning: failed to apply " + statement->toString() + ", empty query!"); return false; }
         string x = statement->terms[0].var->value;
         VariablePtr v = context->vars[x];
         for (auto e : v->entities) {
@@ -264,7 +266,7 @@ bool VRReasoner::apply(VRStatementPtr statement, VRSemanticContextPtr context) {
             if (eval.state == Evaluation::VALID) context->results.push_back(e.second);
         }
         statement->state = 1;
-        print("  process results of queried variable " + x, GREEN);
+        if (verbose()) print("  process results of queried variable " + x, GREEN);
         clearAssumptions();
     }
 
@@ -272,7 +274,7 @@ bool VRReasoner::apply(VRStatementPtr statement, VRSemanticContextPtr context) {
 }
 
 bool VRReasoner::evaluate(VRStatementPtr statement, VRSemanticContextPtr context) {
-    print(" " + toString(statement->place) + " eval " + statement->toString());
+    if (verbose()) print(" " + toString(statement->place) + " eval " + statement->toString());
     statement->updateLocalVariables(context->vars, context->onto);
 
     if (statement->verb == "builtin") {
@@ -295,14 +297,14 @@ bool VRReasoner::evaluate(VRStatementPtr statement, VRSemanticContextPtr context
                     //TODO: what happens then?
                     //  are the entities that don't have the concept removed from the variable? I think not...
                 }
-                print("  reuse variable " + context->vars[name]->toString(), BLUE);
+                if (verbose()) print("  reuse variable " + context->vars[name]->toString(), BLUE);
                 statement->state = 1;
                 return true;
             }
 
             auto var = Variable::create( context->onto, concept, name );
             context->vars[name] = var;
-            print("  added variable " + var->toString(), BLUE);
+            if (verbose()) print("  added variable " + var->toString(), BLUE);
             statement->state = 1;
             return true;
         }
@@ -312,7 +314,7 @@ bool VRReasoner::evaluate(VRStatementPtr statement, VRSemanticContextPtr context
 }
 
 vector<VREntityPtr> VRReasoner::process(string initial_query, VROntologyPtr onto) {
-    print(initial_query);
+    if (verbose()) print(initial_query);
 
     auto context = VRSemanticContext::create(onto); // create context
     context->queries.push_back(Query(initial_query));
@@ -323,11 +325,11 @@ vector<VREntityPtr> VRReasoner::process(string initial_query, VROntologyPtr onto
         auto request = query.request;
         if (request->state == 1) {
             apply(request, context);
-            print(" solved: " + query.toString(), RED);
+            if (verbose()) print(" solved: " + query.toString(), RED);
             context->queries.pop_back(); continue;
         }; // query answered, pop and continue
 
-        print("QUERY " + query.toString(), RED);
+        if (verbose()) print("QUERY " + query.toString(), RED);
 
         request->updateLocalVariables(context->vars, context->onto);
 
@@ -342,8 +344,8 @@ vector<VREntityPtr> VRReasoner::process(string initial_query, VROntologyPtr onto
         if (context->itr >= context->itr_max) break;
     }
 
-    print(" break after " + toString(context->itr) + " iterations\n");
-    for (auto e : context->results) print(" instance " + e->toString());
+    if (verbose()) print(" break after " + toString(context->itr) + " iterations\n");
+    if (verbose()) for (auto e : context->results) print(" instance " + e->toString());
     return context->results;
 }
 
@@ -35,6 +35,7 @@ class VRReasoner {
 
         static bool verbGui;
         static bool verbConsole;
+        static bool verbose();
         static void print(const string& s);
         static void print(const string& s, COLOR c);
 
@@ -83,7 +83,7 @@ bool Variable::has(VariablePtr other, VPath& path1, VPath& path2, VROntologyPtr
         for (auto p : e->properties) { // property vectors of local entity
             for (auto v : p.second) { // local properties
                 //if (v->value == other->value) matches[e].push_back(0); // TODO: direct match with other variable value
-                if (v->value == oName) return true;
+                if (v->getValue() == oName) return true;
                 //auto childEntity = onto->getEntity(v->value); // TODO: this might by stupid..
                 //if (childEntity && computeMatches(childEntity, oName)) return true;
             }
@@ -215,15 +215,15 @@ vector<string> VPath::getValue(VREntityPtr e) {
     };
 
     if (size() == 2) {
-        for (auto p : getEntityProperties(e,nodes[1])) res.push_back(p->value);
+        for (auto p : getEntityProperties(e,nodes[1])) res.push_back(p->getValue());
         return res;
     }
 
     if (size() == 3) {
         for (auto p : getEntityProperties(e,nodes[1])) {
-            auto e2 = onto->getEntity(p->value);
+            auto e2 = onto->getEntity(p->getValue());
             if (!e2) continue;
-            for (auto p : getEntityProperties(e2,nodes[2])) res.push_back(p->value);
+            for (auto p : getEntityProperties(e2,nodes[2])) res.push_back(p->getValue());
         }
         return res;
     }
@@ -238,7 +238,7 @@ void VPath::setValue(string v, VREntityPtr e) {
         if (!prop) return;
         if (!e->properties.count(prop->getName())) return;
         for (auto p : e->properties[prop->getName()]) {
-            p->value = v;
+            p->setValue(v);
         }
     }
 }
@@ -315,13 +315,13 @@ string Term::computeExpression(VRSemanticContextPtr context) {
                 auto vals = p.getValue(e.second);
                 for (auto val : vals) {
                     l->setValue(val);
-                    cout << " computeExpression, replace " << p.root << " by " << val << endl;
+                    if (VRReasoner::verbConsole) cout << " computeExpression, replace " << p.root << " by " << val << endl;
                 }
             }
         }
     }
     string res = me.compute();
-    cout << " computeExpression '"+str+"' results to " << res << endl;
+    if (VRReasoner::verbConsole) cout << " computeExpression '"+str+"' results to " << res << endl;
     return res;
 }
 
@@ -362,20 +362,21 @@ void Query::substituteRequest(VRStatementPtr replace) { // replaces the roots of
 
     auto substitute = [&](string& var) {
         if (!substitutes.count(var)) return;
-        cout << "  substitute: " << var;
+        if (VRReasoner::verbConsole) cout << "  substitute: " << var << " with " << substitutes[var] << endl;
         var = substitutes[var];
-        cout << " with " << var << endl;
     };
 
-    cout << " substitutes:\n";
-    for (auto s : substitutes) cout << "  substitute "+s.first+" "+s.second << endl;
+    if (VRReasoner::verbConsole) {
+        cout << " substitutes:\n";
+        for (auto s : substitutes) cout << "  substitute "+s.first+" "+s.second << endl;
+    }
 
     for (auto statement : statements) { // substitute values in all statements of the query
         for (auto& ts : statement->terms) {
             if (ts.isMathExpression()) {
                 Expression e(ts.str);
                 e.computeTree();
-                cout << " substitute expression: " << e.toString() << endl;
+                if (VRReasoner::verbConsole) cout << " substitute expression: " << e.toString() << endl;
                 for (auto& l : e.getLeafs()) {
                     for (int i=0; i<request->terms.size(); i++) {
                         auto& t1 = request->terms[i];
@@ -393,7 +394,7 @@ void Query::substituteRequest(VRStatementPtr replace) { // replaces the roots of
                 }
                 ts.str = e.toString();
                 ts.path = VPath(ts.str);
-                cout << " substituted expression: " << ts.str << endl;
+                if (VRReasoner::verbConsole) cout << " substituted expression: " << ts.str << endl;
             } else {
                 for (int i=0; i<request->terms.size(); i++) {
                     auto& t1 = request->terms[i];
@@ -62,7 +62,7 @@ bool VRStatement::isSimpleVerb() {
 
 bool VRStatement::match(VRStatementPtr s) {
     if (terms.size() != s->terms.size()) {
-        VRReasoner::print("       statement has wrong number of arguments!", VRReasoner::RED);
+        if (VRReasoner::verbose()) VRReasoner::print("       statement has wrong number of arguments!", VRReasoner::RED);
         return false;
     }
 
@@ -76,7 +76,7 @@ bool VRStatement::match(VRStatementPtr s) {
         if (!cS || !cR) continue; // may be anything..
 
         if (!cS->is_a(cR) && !cR->is_a(cS)) { // check if the concepts are related
-            VRReasoner::print("       var "+tR.var->value+" ("+tR.var->concept+") and var "+tS.var->value+" ("+tS.var->concept+") are not related!", VRReasoner::RED);
+            if (VRReasoner::verbose()) VRReasoner::print("       var "+tR.var->value+" ("+tR.var->concept+") and var "+tS.var->value+" ("+tS.var->concept+") are not related!", VRReasoner::RED);
             return false;
         }
 
@@ -6,22 +6,15 @@
 #include <vector>
 #include <map>
 #include "core/objects/VRObjectFwd.h"
+#include "core/math/VRMeshTopology.h"
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 class VRAdjacencyGraph {
-    public:
-        struct edge { int v1, v2; };
-        struct triangle { int v1, v2, v3; };
-
-        map<int, map<int, vector<triangle> > > edge_triangle_loockup;
-        vector<int> vertex_neighbor_params;
-        vector<int> vertex_neighbors;
-        vector<float> vertex_curvatures;
-
     private:
         VRGeometryWeakPtr geo;
+        VRMeshTopology topology;
 
     public:
         VRAdjacencyGraph();
@@ -35,6 +28,7 @@ class VRAdjacencyGraph {
         void compTriLoockup();
         void compCurvatures(int range = 1);
 
+        VRMeshTopology& getTopology();
         vector<int> getNeighbors(int i, int range = 1);
         vector<int> getBorderVertices();
         float getCurvature(int i);
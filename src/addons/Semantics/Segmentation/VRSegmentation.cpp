@@ -4,6 +4,7 @@
 #include "core/objects/geometry/OSGGeometry.h"
 #include "core/objects/material/VRMaterial.h"
 #include "core/math/Octree.h"
+#include "core/math/VRMeshTopology.h"
 #include <OpenSG/OSGGeometry.h>
 #include <OpenSG/OSGGeoProperties.h>
 #include <OpenSG/OSGGeoFunctions.h>
@@ -19,42 +20,32 @@ void VRSegmentation::removeDuplicates(VRGeometryPtr geo) {
     if (geo == 0) return;
     if (geo->getMesh() == 0) return;
 
+    vector<Vec3f> corners;
+	for (TriangleIterator it(geo->getMesh()->geo); !it.isAtEnd(); ++it) {
+        for (int i=0; i<3; i++) corners.push_back( Vec3f(it.getPosition(i)) );
+	}
+
+	vector<int> remap, unique;
+	VRMeshTopology::weld(corners, 1e-4, remap, unique);
+
+	vector<Vec3f> points(unique.size());
+	for (uint i=0; i<unique.size(); i++) points[i] = corners[unique[i]];
+	VRMeshTopology topology;
+	topology.build(points, remap); // skips the triangles collapsed by the welding
+	topology.computeNormals();
+
     GeoPnt3fPropertyRecPtr pos = GeoPnt3fProperty::create();
     GeoVec3fPropertyRecPtr norms = GeoVec3fProperty::create();
     GeoUInt32PropertyRecPtr inds = GeoUInt32Property::create();
     GeoUInt32PropertyRecPtr lengths = GeoUInt32Property::create();
-	size_t curIndex = 0;
-	float threshold = 1e-4;
-	size_t NLM = numeric_limits<size_t>::max();
-	Octree oct(threshold);
-
-	TriangleIterator it(geo->getMesh()->geo);
-	for (; !it.isAtEnd() ;++it) {
-        vector<size_t> IDs(3);
-        for (int i=0; i<3; i++) {
-            Pnt3f p = it.getPosition(i);
-            vector<void*> resultData = oct.radiusSearch(p.subZero(), threshold);
-            if (resultData.size() > 0) IDs[i] = *(size_t*)resultData.at(0);
-            else IDs[i] = NLM;
-        }
-
-		for (int i=0; i<3; i++) {
-			if (IDs[i] == NLM) {
-                Pnt3f p = it.getPosition(i);
-                Vec3f n = it.getNormal(i);
-				pos->addValue(p);
-				norms->addValue(n);
-				IDs[i] = curIndex;
-				size_t *curIndexPtr = new size_t;
-				*curIndexPtr = curIndex;
-				oct.add(p.subZero(), curIndexPtr);
-				curIndex++;
-			}
-		}
-
-		if (IDs[0] == IDs[1] || IDs[0] == IDs[2] || IDs[1] == IDs[2]) continue;
-
-		for (int i=0; i<3; i++) inds->addValue(IDs[i]);
+    auto& normals = topology.getNormals();
+	for (uint i=0; i<points.size(); i++) {
+        pos->addValue(Pnt3f(points[i]));
+        norms->addValue(normals[i]);
+	}
+	for (int t=0; t<topology.getNTriangles(); t++) {
+        Vec3i T = topology.getTriangle(t);
+        for (int i=0; i<3; i++) inds->addValue(T[i]);
 	}
 
     lengths->addValue(inds->size());
@@ -63,10 +54,6 @@ void VRSegmentation::removeDuplicates(VRGeometryPtr geo) {
 	geo->setIndices(inds);
 	geo->setType(GL_TRIANGLES);
 	geo->setLengths(lengths);
-
-	calcVertexNormals(geo->getMesh()->geo);
-
-	for (void* o : oct.getData()) delete (size_t*)o; // Cleanup
 }
 
 
@@ -517,14 +504,12 @@ Edge* Triangle::getOtherEdge(Edge* E, Vertex* v) {
     return 0;
 }
 
-void Triangle::addEdges(map<int, Edge*>& Edges) {
+void Triangle::addEdges(map<unsigned long long, Edge*>& Edges) {
     Vec3i IDs(vertices[0]->ID, vertices[1]->ID, vertices[2]->ID);
     for (int i=0; i<3; i++) {
-        int ID1 = IDs[i];
-        int ID2 = IDs[(i+1)%3];
-        int eID_h1 = (ID1+ID2)*(ID1+ID2+1)*0.5+ID2; // hash IDs edge map
-        int eID_h2 = (ID1+ID2)*(ID1+ID2+1)*0.5+ID1; // hash IDs edge map
-        int ID = min(eID_h1, eID_h2);
+        unsigned long long ID1 = IDs[i];
+        unsigned long long ID2 = IDs[(i+1)%3];
+        unsigned long long ID = min(ID1,ID2) << 32 | max(ID1,ID2); // vertex pair as edge key
         Edge* e = 0;
         if (Edges.count(ID)) e = Edges[ID];
         if (e == 0) {
@@ -560,22 +545,13 @@ void VRSegmentation::fillHoles(VRGeometryPtr geo, int steps) {
     if (geo == 0) return;
     if (geo->getMesh() == 0) return;
 
-    /*auto agraph = VRAdjacencyGraph::create();
-    agraph->setGeometry(geo);
-    agraph->compute();
-
-    vector<int> borderEdges = agraph->getBorderVertices();
-    map<int, int> borders;
-
-    for (int i=0; i<borderEdges.size()/2; i++) {
-        int ev0 = borderEdges[2*i+0];
-        int ev1 = borderEdges[2*i+1];
-        ;
-    }*/
+    VRMeshTopology topology;
+    topology.build(geo->getMesh()->geo);
+    if (topology.getBorderEdges().size() == 0) return; // closed mesh, nothing to fill
 
     vector<Triangle*> triangles;
     map<int, Vertex*> vertices;
-    map<int, Edge*> edges;
+    map<unsigned long long, Edge*> edges;
 
     // ---- build linked structure ---- //
 	TriangleIterator it(geo->getMesh()->geo);
@@ -56,7 +56,7 @@ struct Triangle {
     Border* border = 0;
 
     Triangle();
-    void addEdges(map<int, Edge*>& Edges);
+    void addEdges(map<unsigned long long, Edge*>& Edges);
     void addVertices(Vertex* v1, Vertex* v2, Vertex* v3);
     Edge* getOtherEdge(Edge* e, Vertex* v);
 };
@@ -18,6 +18,7 @@ ptrFwd(VROntologyRule);
 ptrFwd(VROntologyLink);
 ptrFwd(VRSemanticContext);
 ptrFwd(VRReasoner);
+ptrFwd(VRQueryPlan);
 ptrFwd(VRStatement);
 ptrFwd(VRSemanticBuiltin);
 ptrFwd(Variable);
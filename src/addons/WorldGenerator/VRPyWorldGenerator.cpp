@@ -69,7 +69,7 @@ PyMethodDef VRPyRoadNetwork::methods[] = {
     {"computeLanes", (PyCFunction)VRPyRoadNetwork::computeLanes, METH_NOARGS, "Compute the lanes - computeLanes( )" },
     {"computeSurfaces", (PyCFunction)VRPyRoadNetwork::computeSurfaces, METH_NOARGS, "Compute the surfaces - computeSurfaces( )" },
     {"computeMarkings", (PyCFunction)VRPyRoadNetwork::computeMarkings, METH_NOARGS, "Compute the markings - computeMarkings( )" },
-    {"compute", (PyCFunction)VRPyRoadNetwork::compute, METH_NOARGS, "Compute everything - compute( )" },
+    {"compute", (PyCFunction)VRPyRoadNetwork::compute, METH_NOARGS, "Compute everything, later calls only update the surfaces of new and dirty roads - compute( )" },
     {"computeMarkingsRoad2", (PyCFunction)VRPyRoadNetwork::computeMarkingsRoad2, METH_VARARGS, "Compute markings of a type 2 road - computeMarkingsRoad2( road )" },
     {"computeMarkingsIntersection", (PyCFunction)VRPyRoadNetwork::computeMarkingsIntersection, METH_VARARGS, "Compute markings of an intersection - computeMarkingsIntersection( intersection )" },
     {"createRoadGeometry", (PyCFunction)VRPyRoadNetwork::createRoadGeometry, METH_VARARGS, "Create a geometry for a road - geo createRoadGeometry( road )" },
@@ -77,6 +77,9 @@ PyMethodDef VRPyRoadNetwork::methods[] = {
     {"getRoadID", (PyCFunction)VRPyRoadNetwork::getRoadID, METH_NOARGS, "Get a road ID - int getRoadID()" },
     {"getMaterial", (PyCFunction)VRPyRoadNetwork::getMaterial, METH_NOARGS, "Get road material - material getMaterial()" },
     {"clear", (PyCFunction)VRPyRoadNetwork::clear, METH_NOARGS, "Clear all data - clear()" },
+    {"setNodeDirty", (PyCFunction)VRPyRoadNetwork::setNodeDirty, METH_VARARGS, "Mark the roads and intersections of a node for the next compute or computeSurfaces - setNodeDirty( node )" },
+    {"setTileSize", (PyCFunction)VRPyRoadNetwork::setTileSize, METH_VARARGS, "Set the size of the surface tiles - setTileSize( float size )" },
+    {"getStats", (PyCFunction)VRPyRoadNetwork::getStats, METH_NOARGS, "Get the build statistics, times in ms - dict getStats()" },
     {NULL}  /* Sentinel */
 };
 
@@ -96,6 +99,31 @@ PyObject* VRPyRoadNetwork::clear(VRPyRoadNetwork* self) {
     Py_RETURN_TRUE;
 }
 
+PyObject* VRPyRoadNetwork::setNodeDirty(VRPyRoadNetwork* self, PyObject *args) {
+    if (!self->valid()) return NULL;
+    VRPyEntity* node = 0;
+    if (!PyArg_ParseTuple(args, "O", &node)) return NULL;
+    self->objPtr->setNodeDirty( node->objPtr );
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyRoadNetwork::setTileSize(VRPyRoadNetwork* self, PyObject *args) {
+    if (!self->valid()) return NULL;
+    self->objPtr->setTileSize( parseFloat(args) );
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyRoadNetwork::getStats(VRPyRoadNetwork* self) {
+    if (!self->valid()) return NULL;
+    PyObject* res = PyDict_New();
+    for (auto s : self->objPtr->getStats()) {
+        PyObject* v = PyFloat_FromDouble(s.second);
+        PyDict_SetItemString(res, s.first.c_str(), v);
+        Py_DECREF(v);
+    }
+    return res;
+}
+
 PyObject* VRPyRoadNetwork::computeMarkingsRoad2(VRPyRoadNetwork* self, PyObject *args) {
     if (!self->valid()) return NULL;
     VRPyEntity* road = 0;
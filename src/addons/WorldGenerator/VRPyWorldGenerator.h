@@ -41,6 +41,9 @@ struct VRPyRoadNetwork : VRPyBaseT<OSG::VRRoadNetwork> {
     static PyObject* getRoadID(VRPyRoadNetwork* self);
     static PyObject* getMaterial(VRPyRoadNetwork* self);
     static PyObject* clear(VRPyRoadNetwork* self);
+    static PyObject* setNodeDirty(VRPyRoadNetwork* self, PyObject *args);
+    static PyObject* setTileSize(VRPyRoadNetwork* self, PyObject *args);
+    static PyObject* getStats(VRPyRoadNetwork* self);
 };
 
 #endif // VRPYWORLDGENERATOR_H_INCLUDED
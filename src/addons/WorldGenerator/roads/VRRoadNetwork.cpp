@@ -8,9 +8,11 @@
 #include "core/math/polygon.h"
 #include "core/math/triangulator.h"
 #include "core/objects/geometry/VRGeometry.h"
+#include "core/objects/geometry/VRGeoData.h"
 #include "core/objects/geometry/VRStroke.h"
 #include "core/objects/material/VRTextureGenerator.h"
 #include "core/utils/toString.h"
+#include "core/utils/VRTimer.h"
 
 #include <OpenSG/OSGGeoProperties.h>
 
@@ -41,14 +43,12 @@ class Road {
 
         float getWidth() {
             float width = 0;
-            for (auto lane : entity->getAllEntities("lanes")) width += toFloat( lane->get("width")->value );
+            for (auto lane : entity->getAllEntities("lanes")) width += toFloat( lane->get("width")->getValue() );
             return width;
         }
 
         VREntityPtr getEntry( VREntityPtr node ) {
-            string rN = entity->getName();
-            string nN = node->getName();
-            auto nodeEntry = entity->ontology.lock()->process("q(e):NodeEntry(e);Node("+nN+");Road("+rN+");has("+rN+".path,e);has("+nN+",e)");
+            auto nodeEntry = entity->ontology.lock()->process("q(e):NodeEntry(e);Node($0);Road($1);has($1.path,e);has($0,e)", { node->getName(), entity->getName() });
             return nodeEntry[0];
         }
 
@@ -56,7 +56,7 @@ class Road {
             if (edgePoints.count(node) == 0) {
                 float width = getWidth();
                 VREntityPtr rEntry = getEntry( node );
-                Vec3f norm = rEntry->getVec3f("direction") * toInt(rEntry->get("sign")->value);
+                Vec3f norm = rEntry->getVec3f("direction") * toInt(rEntry->get("sign")->getValue());
                 Vec3f x = Vec3f(0,1,0).cross(norm);
                 x.normalize();
                 Vec3f pNode = node->getVec3f("position");
@@ -88,6 +88,15 @@ GraphPtr VRRoadNetwork::getGraph() { return graph; }
 void VRRoadNetwork::clear() {
 	nextRoadID = 0;
 	if (ontology) ontology->remEntities("RoadMarking");
+	for (auto t : tiles) t.second->destroy();
+	for (auto a : arrows) a.second->destroy();
+	tiles.clear();
+	arrows.clear();
+	paths.clear();
+	surfaces.clear();
+	dependents.clear();
+	dirty.clear();
+	built = false;
     //if (asphalt) asphalt = VRAsphalt::create();
 }
 
@@ -160,8 +169,8 @@ VREntityPtr VRRoadNetwork::addPath( string type, string name, vector<VREntityPtr
 		path->add("nodes", nodeEntry->getName());
 
 		if (lastNode) {
-			int nID1 = toInt(lastNode->get("graphID")->value);
-			int nID2 = toInt(node->get("graphID")->value);
+			int nID1 = toInt(lastNode->get("graphID")->getValue());
+			int nID2 = toInt(node->get("graphID")->getValue());
 			tool->connect(nID1, nID2, 1, nL, norm);
 		}
 		lastNode = node;
@@ -188,8 +197,7 @@ void VRRoadNetwork::computeIntersectionLanes( VREntityPtr intersection ) {
 	string nN = node->getName();
 
 	auto getRoadEntry = [&](VREntityPtr road, VREntityPtr node) {
-		string rN = road->getName();
-		auto nodeEntry = ontology->process("q(e):NodeEntry(e);Node("+nN+");Road("+rN+");has("+rN+".path,e);has("+nN+",e)");
+		auto nodeEntry = ontology->process("q(e):NodeEntry(e);Node($0);Road($1);has($1.path,e);has($0,e)", { nN, road->getName() });
 		return nodeEntry[0];
 	};
 
@@ -198,9 +206,9 @@ void VRRoadNetwork::computeIntersectionLanes( VREntityPtr intersection ) {
 	vector< pair<VREntityPtr, VREntityPtr> > outLanes;
 	for (VREntityPtr road : roads) {
 		VREntityPtr roadEntry = getRoadEntry(road, node);
-		int reSign = toInt( roadEntry->get("sign")->value );
+		int reSign = toInt( roadEntry->get("sign")->getValue() );
 		for (VREntityPtr lane : road->getAllEntities("lanes")) {
-			int direction = toInt( lane->get("direction")->value );
+			int direction = toInt( lane->get("direction")->getValue() );
 			if (direction*reSign == 1) inLanes.push_back(pair<VREntityPtr, VREntityPtr>(lane, road));
 			if (direction*reSign == -1) outLanes.push_back(pair<VREntityPtr, VREntityPtr>(lane, road));
 		}
@@ -210,7 +218,7 @@ void VRRoadNetwork::computeIntersectionLanes( VREntityPtr intersection ) {
 	for (auto inRL : inLanes) {
         VREntityPtr laneIn = inRL.first;
         VREntityPtr roadIn = inRL.second;
-		float width = toFloat( laneIn->get("width")->value );
+		float width = toFloat( laneIn->get("width")->getValue() );
 		auto nodes1 = laneIn->getEntity("path")->getAllEntities("nodes");
 		VREntityPtr node1 = *nodes1.rbegin();
 		for (auto outRL : outLanes) {
@@ -245,9 +253,16 @@ pathPtr VRRoadNetwork::toPath( VREntityPtr pathEntity, int resolution ) {
 		norms.push_back(  nodeEntry->getVec3f("direction") );
 	}
 
+	auto& cache = paths[ make_pair(pathEntity->ID, resolution) ];
+	if (cache.p && cache.positions == pos && cache.directions == norms) { stats["pathCacheHits"]++; return cache.p; }
+	stats["pathCacheMisses"]++;
+
 	pathPtr Path = path::create();
 	for (int i=0; i<pos.size(); i++) Path->addPoint(pose(pos[i], norms[i]));
 	Path->compute(resolution);
+	cache.positions = pos;
+	cache.directions = norms;
+	cache.p = Path;
 	return Path;
 }
 
@@ -256,13 +271,13 @@ void VRRoadNetwork::computeLanePaths( VREntityPtr road ) {
 	int Nlanes = lanes.size();
 
 	float roadWidth = 0;
-	for (auto lane : lanes) roadWidth += toFloat( lane->get("width")->value );
+	for (auto lane : lanes) roadWidth += toFloat( lane->get("width")->getValue() );
 
 	for (int li=0; li<Nlanes; li++) {
         auto lane = lanes[li];
 		lane->clear("path");
-		float width = toFloat( lane->get("width")->value );
-		int direction = toInt( lane->get("direction")->value );
+		float width = toFloat( lane->get("width")->getValue() );
+		int direction = toInt( lane->get("direction")->getValue() );
 		for (auto pathEnt : road->getAllEntities("path")) {
 			pathPtr rPath = toPath(pathEnt, 8);
 			vector<VREntityPtr> nodes;
@@ -290,7 +305,7 @@ void VRRoadNetwork::computeLanePaths( VREntityPtr road ) {
 }
 
 void VRRoadNetwork::setupTexCoords( VRGeometryPtr geo, VREntityPtr way ) {
-	int rID = toInt( way->get("ID")->value );
+	int rID = toInt( way->get("ID")->getValue() );
 	GeoVec2fPropertyRecPtr tcs = GeoVec2fProperty::create();
 	for (int i=0; i<geo->size(); i++) tcs->addValue(Vec2f(rID, 0));
 	geo->setPositionalTexCoords2D(1.0, 0, Vec2i(0,2)); // positional tex coords
@@ -331,9 +346,7 @@ VRGeometryPtr VRRoadNetwork::createIntersectionGeometry( VREntityPtr intersectio
     string nN = node->getName();
     for (auto roadEnt : roads) {
         Road road(roadEnt);
-        string rN = roadEnt->getName();
-        string qNode = "q(n):Node(n);Road("+rN+");RoadIntersection("+iN+");has("+rN+".path.nodes,n);has("+iN+".path.nodes,n)";
-        auto rNodes = ontology->process(qNode);
+        auto rNodes = ontology->process("q(n):Node(n);Road($0);RoadIntersection($1);has($0.path.nodes,n);has($1.path.nodes,n)", { roadEnt->getName(), iN });
         if (rNodes.size() == 0) { cout << "Warning in createIntersectionGeometry, road " << roadEnt->getName() << " has no nodes!" << endl; continue; }
         auto& endP = road.getEdgePoints( rNodes[0] );
         poly.addPoint(Vec2f(endP.p1[0], endP.p1[2]));
@@ -353,7 +366,7 @@ void VRRoadNetwork::computeIntersections() {
     int k = 0;
     for (auto node : ontology->process("q(n):Node(n);Road(r);has(r.path.nodes,n)") ) {
         Vec3f pNode = node->getVec3f("position");
-        vector<VREntityPtr> roads = ontology->process("q(r):Node("+node->getName()+");Road(r);has(r.path.nodes,"+node->getName()+")");
+        vector<VREntityPtr> roads = ontology->process("q(r):Node($0);Road(r);has(r.path.nodes,$0)", { node->getName() });
         if (roads.size() <= 2) continue; // for now ignore ends and curves
         map<VREntityPtr, Road> roadData;
         for (VREntityPtr roadEnt : roads) roadData[roadEnt] = Road(roadEnt);
@@ -410,7 +423,7 @@ void VRRoadNetwork::computeIntersections() {
         for (int i=0; i<roads.size(); i++) { // compute intersection paths
             auto road1 = roads[i];
             auto rEntry1 = roadData[road1].getEntry(node);
-            int s1 = toInt(rEntry1->get("sign")->value);
+            int s1 = toInt(rEntry1->get("sign")->getValue());
             Vec3f norm1 = rEntry1->getVec3f("direction");
             auto& data1 = roadData[road1].getEdgePoints( node );
             VREntityPtr node1 = data1.entry->getEntity("node");
@@ -419,7 +432,7 @@ void VRRoadNetwork::computeIntersections() {
                     auto road2 = roads[j];
                     if (j == i) continue;
                     auto rEntry2 = roadData[road2].getEntry(node);
-                    int s2 = toInt(rEntry2->get("sign")->value);
+                    int s2 = toInt(rEntry2->get("sign")->getValue());
                     if (s2 != -1) continue;
                     Vec3f norm2 = rEntry2->getVec3f("direction");
                     auto& data2 = roadData[road2].getEdgePoints( node );
@@ -469,7 +482,7 @@ void VRRoadNetwork::computeMarkingsRoad2(VREntityPtr roadEnt) {
 
         for (int li=0; li<Nlanes; li++) {
             auto lane = lanes[li];
-            float width = toFloat( lane->get("width")->value );
+            float width = toFloat( lane->get("width")->getValue() );
             float k = width*li - roadWidth*0.5 + mw*0.5;
             Vec3f pi = x*k + p;
             nodes.push_back(addNode(pi));
@@ -498,7 +511,7 @@ void VRRoadNetwork::computeMarkingsRoad2(VREntityPtr roadEnt) {
 
         if (li != Nlanes) {
             auto lane = lanes[li];
-            int direction = toInt( lane->get("direction")->value );
+            int direction = toInt( lane->get("direction")->getValue() );
             if (li != 0 && lastDir*direction > 0) {
                 mL->set("style", "dashed");
                 mL->set("dashNumber", Ndots);
@@ -547,7 +560,7 @@ void VRRoadNetwork::computeMarkingsIntersection( VREntityPtr intersection) {
     for (auto lane : intersection->getAllEntities("lanes")) {
         for (auto pathEnt : lane->getAllEntities("path")) {
             auto entry = pathEnt->getEntity("nodes");
-            laneEntries[entry] = toFloat( lane->get("width")->value );
+            laneEntries[entry] = toFloat( lane->get("width")->getValue() );
         }
     }
 
@@ -581,28 +594,210 @@ void VRRoadNetwork::computeLanes() {
     for (auto intersection : ontology->getEntities("RoadIntersection")) computeIntersectionLanes(intersection);
 }
 
-void VRRoadNetwork::computeSurfaces() {
-    for (auto road : ontology->getEntities("Road")) {
-        auto roadGeo = createRoadGeometry( road );
-        if (!roadGeo) continue;
-        roadGeo->hide();
-        addChild( roadGeo );
+void VRRoadNetwork::setNodeDirty( VREntityPtr node ) {
+    if (!node || !dependents.count(node->ID)) return;
+    for (int ID : dependents[node->ID]) dirty.insert(ID);
+}
+
+void VRRoadNetwork::setTileSize( float s ) {
+    tileSize = s;
+    for (auto t : tiles) t.second->destroy();
+    tiles.clear();
+    surfaces.clear(); // rebuild all tiles
+}
+
+map<string, float> VRRoadNetwork::getStats() { return stats; }
+
+void VRRoadNetwork::addDependency( VREntityPtr pathEntity, int ID ) {
+    for (auto nodeEntry : pathEntity->getAllEntities("nodes")) {
+        if (auto node = nodeEntry->getEntity("node")) dependents[node->ID].insert(ID);
     }
+}
 
-    for (auto intersection : ontology->getEntities("RoadIntersection")) {
-        auto iGeo = createIntersectionGeometry( intersection );
-        if (!iGeo) continue;
-        iGeo->hide();
-        addChild( iGeo );
+VRRoadNetwork::SurfaceInput VRRoadNetwork::gatherRoad( VREntityPtr roadEnt ) {
+    SurfaceInput in;
+    in.ID = roadEnt->ID;
+    in.rID = toInt( roadEnt->get("ID")->getValue() );
+    in.width = Road(roadEnt).getWidth()*0.5*1.1;
+    for (auto p : roadEnt->getAllEntities("path")) {
+        auto Path = toPath(p,16);
+        in.positions.push_back( Path->getPositions() );
+        in.directions.push_back( Path->getDirections() );
+        in.upVectors.push_back( Path->getUpvectors() );
+        addDependency(p, in.ID);
     }
+    return in;
+}
 
+VRRoadNetwork::SurfaceInput VRRoadNetwork::gatherIntersection( VREntityPtr intersectionEnt ) {
+    SurfaceInput in;
+    in.ID = intersectionEnt->ID;
+    in.rID = toInt( intersectionEnt->get("ID")->getValue() );
+    VREntityPtr node = intersectionEnt->getEntity("node");
+    if (!node) return in;
+    in.height = node->getVec3f("position")[1];
+    dependents[node->ID].insert(in.ID);
+
+    string iN = intersectionEnt->getName();
+    for (auto roadEnt : intersectionEnt->getAllEntities("roads")) {
+        Road road(roadEnt);
+        auto rNodes = ontology->process("q(n):Node(n);Road($0);RoadIntersection($1);has($0.path.nodes,n);has($1.path.nodes,n)", { roadEnt->getName(), iN });
+        if (rNodes.size() == 0) { cout << "Warning in computeSurfaces, road " << roadEnt->getName() << " has no nodes!" << endl; continue; }
+        auto& endP = road.getEdgePoints( rNodes[0] );
+        in.corners.push_back(Vec2f(endP.p1[0], endP.p1[2]));
+        in.corners.push_back(Vec2f(endP.p2[0], endP.p2[2]));
+        for (auto p : roadEnt->getAllEntities("path")) addDependency(p, in.ID);
+    }
+    return in;
+}
+
+/** a strip along each path, like the stroke of the two point profile in createRoadGeometry **/
+void VRRoadNetwork::meshRoad( const SurfaceInput& in, Surface& s ) {
+    for (uint k=0; k<in.positions.size(); k++) {
+        auto& pos = in.positions[k];
+        for (uint j=0; j<pos.size(); j++) {
+            Vec3f u = in.upVectors[k][j];
+            Vec3f x = in.directions[k][j].cross(u);
+            x.normalize();
+            s.positions.push_back( pos[j] - x*in.width );
+            s.positions.push_back( pos[j] + x*in.width );
+            s.normals.push_back(u);
+            s.normals.push_back(u);
+            if (j == 0) continue;
+            int N1 = s.positions.size()-4;
+            int N2 = s.positions.size()-2;
+            for (int i : { N1, N2, N2+1, N1, N2+1, N1+1 }) s.triangles.push_back(i);
+        }
+    }
+}
+
+/** a fan over the convex hull of the road fronts **/
+void VRRoadNetwork::meshIntersection( const SurfaceInput& in, Surface& s ) {
+    polygon poly;
+    for (auto c : in.corners) poly.addPoint(c);
+    if (poly.size() < 3) return;
+    auto hull = poly.getConvexHull().get();
+    if (hull.size() < 3) return;
+    for (auto c : hull) {
+        s.positions.push_back( Vec3f(c[0], in.height, c[1]) );
+        s.normals.push_back( Vec3f(0,1,0) );
+    }
+    Vec3f n = (s.positions[1]-s.positions[0]).cross(s.positions[2]-s.positions[0]);
+    bool flip = n[1] < 0;
+    for (uint i=1; i+1<hull.size(); i++) {
+        s.triangles.push_back(0);
+        s.triangles.push_back(flip ? i+1 : i);
+        s.triangles.push_back(flip ? i : i+1);
+    }
+}
+
+void VRRoadNetwork::updateTile( pair<int, int> tile ) {
+    VRGeoData data;
+    for (auto& sp : surfaces) {
+        auto& s = sp.second;
+        if (s.tile != tile) continue;
+        int i0 = data.size();
+        for (uint i=0; i<s.positions.size(); i++) {
+            Vec3f p = s.positions[i];
+            data.pushVert(Pnt3f(p), s.normals[i], Vec2f(p[0], p[2]), Vec2f(s.rID, 0)); // positional tex coords and road ID
+        }
+        for (uint i=0; i+2<s.triangles.size(); i+=3) data.pushTri(i0+s.triangles[i], i0+s.triangles[i+1], i0+s.triangles[i+2]);
+    }
+
+    if (data.size() == 0) {
+        if (tiles.count(tile)) tiles[tile]->destroy();
+        tiles.erase(tile);
+        return;
+    }
+
+    if (!tiles.count(tile)) {
+        auto geo = VRGeometry::create("roadTile");
+        geo->hide();
+        addChild(geo);
+        tiles[tile] = geo;
+    }
+    data.apply( tiles[tile] );
+    tiles[tile]->setMaterial( asphalt );
+}
+
+void VRRoadNetwork::computeSurfaces() {
+    VRTimer timer;
+    timer.start();
+
+    // gather the input of new and dirty surfaces, the ontology is not thread safe
+    vector<SurfaceInput> inputs;
+    vector<bool> isIntersection;
+    set<int> current;
+    set< pair<int, int> > dirtyTiles;
+    auto gather = [&](string concept, bool intersection) {
+        for (auto e : ontology->getEntities(concept)) {
+            current.insert(e->ID);
+            if (surfaces.count(e->ID) && !dirty.count(e->ID)) continue;
+            if (surfaces.count(e->ID)) dirtyTiles.insert(surfaces[e->ID].tile);
+            inputs.push_back( intersection ? gatherIntersection(e) : gatherRoad(e) );
+            isIntersection.push_back(intersection);
+        }
+    };
+    gather("Road", false);
+    gather("RoadIntersection", true);
+    dirty.clear();
+
+    for (auto i = surfaces.begin(); i != surfaces.end();) { // removed roads and intersections
+        if (current.count(i->first)) { i++; continue; }
+        dirtyTiles.insert(i->second.tile);
+        i = surfaces.erase(i);
+    }
+    stats["tGather"] = timer.stop();
+
+    // mesh in parallel, each surface is written by one thread only
+    timer.start();
+    int N = inputs.size();
+    vector<Surface> results(N);
+    #pragma omp parallel for schedule(dynamic)
+    for (int i=0; i<N; i++) {
+        auto& in = inputs[i];
+        auto& s = results[i];
+        s.rID = in.rID;
+        if (isIntersection[i]) meshIntersection(in, s);
+        else meshRoad(in, s);
+
+        Vec3f c;
+        for (auto& p : s.positions) c += p;
+        if (s.positions.size()) c *= 1.0/s.positions.size();
+        s.tile = make_pair( int(floor(c[0]/tileSize)), int(floor(c[2]/tileSize)) );
+    }
+    stats["tMesh"] = timer.stop();
+
+    // merge the changed tiles
+    timer.start();
+    int nIntersections = 0;
+    for (int i=0; i<N; i++) {
+        dirtyTiles.insert(results[i].tile);
+        if (isIntersection[i]) nIntersections++;
+        surfaces[inputs[i].ID] = results[i];
+    }
+    for (auto t : dirtyTiles) updateTile(t);
+    stats["tMerge"] = timer.stop();
+
+    stats["surfaces"] = surfaces.size();
+    stats["rebuiltRoads"] = N - nIntersections;
+    stats["rebuiltIntersections"] = nIntersections;
+    stats["tiles"] = tiles.size();
+    stats["rebuiltTiles"] = dirtyTiles.size();
+
+    computeArrows();
+}
+
+void VRRoadNetwork::computeArrows() {
     for (auto arrow : ontology->getEntities("Arrow")) {
-        float t = toFloat( arrow->get("position")->value );
+        if (arrows.count(arrow->ID)) continue;
+        float t = toFloat( arrow->get("position")->getValue() );
         auto lane = arrow->getEntity("lane");
         auto lpath = toPath( lane->getEntity("path"), 32 );
         auto geo = VRGeometry::create("arrow");
         geo->setEntity(arrow);
         addChild( geo );
+        arrows[arrow->ID] = geo;
         geo->setPose( pose::create(lpath->getPose(t)) );
 
         auto dirs = arrow->getAll("direction");
@@ -615,7 +810,7 @@ void VRRoadNetwork::computeSurfaces() {
         tg.drawFill(Vec4f(0,0,1,1));
 
         for (auto d : dirs) {
-            float dir = toFloat(d->value);
+            float dir = toFloat(d->getValue());
 
             auto apath = path::create();
             apath->addPoint( pose(Vec3f(0.5,1.0,0), Vec3f(0,-1,0), Vec3f(0,0,1)) );
@@ -645,11 +840,30 @@ void VRRoadNetwork::computeMarkings() {
     for (auto intersection : ontology->getEntities("RoadIntersection")) computeMarkingsIntersection( intersection );
 }
 
+/** the first call builds the network, later calls only update the surfaces of new and dirty roads and intersections **/
 void VRRoadNetwork::compute() {
+    VRTimer timer;
+    if (built) {
+        stats["tIntersections"] = stats["tLanes"] = stats["tMarkings"] = 0;
+        timer.start("surfaces");
+        computeSurfaces();
+        stats["tSurfaces"] = timer.stop("surfaces");
+        return;
+    }
+
+    built = true;
+    timer.start("intersections");
     computeIntersections();
+    stats["tIntersections"] = timer.stop("intersections");
+    timer.start("lanes");
     computeLanes();
+    stats["tLanes"] = timer.stop("lanes");
+    timer.start("surfaces");
     computeSurfaces();
+    stats["tSurfaces"] = timer.stop("surfaces");
+    timer.start("markings");
     computeMarkings();
+    stats["tMarkings"] = timer.stop("markings");
 }
 
 
@@ -7,11 +7,47 @@
 #include "core/math/graph.h"
 #include "core/objects/object/VRObject.h"
 
+#include <map>
+#include <set>
+
 using namespace std;
 OSG_BEGIN_NAMESPACE;
 
+/**
+    The sampled paths are cached per path entity and resolution, and reused as long as their nodes and directions are unchanged.
+    computeSurfaces only meshes the roads and intersections that are new or depend on a node passed to setNodeDirty,
+    the meshes are generated in parallel from data gathered beforehand and merged into one geometry per tile, only the changed tiles are rebuilt.
+    The intersection, lane and marking stages create entities and run once, in the first compute after clear,
+    later calls of compute only run computeSurfaces, after an edit pass the moved nodes to setNodeDirty and call compute again.
+*/
+
 class VRRoadNetwork : public VRObject {
     private:
+        struct Surface { // surface mesh of a road or intersection
+            vector<Vec3f> positions;
+            vector<Vec3f> normals;
+            vector<int> triangles;
+            int rID = 0;
+            pair<int, int> tile;
+        };
+
+        struct SurfaceInput {
+            int ID = 0;
+            int rID = 0;
+            float width = 0; // half width of roads
+            float height = 0; // of intersections
+            vector< vector<Vec3f> > positions; // one vector per road path
+            vector< vector<Vec3f> > directions;
+            vector< vector<Vec3f> > upVectors;
+            vector<Vec2f> corners; // intersection outline
+        };
+
+        struct PathCache {
+            vector<Vec3f> positions;
+            vector<Vec3f> directions;
+            pathPtr p;
+        };
+
         GraphPtr graph;
         VRAsphaltPtr asphalt;
         VROntologyPtr ontology;
@@ -20,8 +56,25 @@ class VRRoadNetwork : public VRObject {
 
 		float trackWidth = 1.6; // TODO
 
+        map<pair<int, int>, PathCache> paths; // by path entity ID and resolution
+        map<int, Surface> surfaces; // by road and intersection entity ID
+        map<int, set<int> > dependents; // roads and intersections using a node, by node ID
+        set<int> dirty;
+        bool built = false; // intersections, lanes and markings computed
+        map<pair<int, int>, VRGeometryPtr> tiles;
+        map<int, VRGeometryPtr> arrows;
+        float tileSize = 100;
+        map<string, float> stats;
+
         void setupTexCoords( VRGeometryPtr geo, VREntityPtr way );
         pathPtr toPath( VREntityPtr pathEntity, int resolution );
+        void addDependency( VREntityPtr pathEntity, int ID );
+        SurfaceInput gatherRoad( VREntityPtr road );
+        SurfaceInput gatherIntersection( VREntityPtr intersection );
+        static void meshRoad( const SurfaceInput& in, Surface& s );
+        static void meshIntersection( const SurfaceInput& in, Surface& s );
+        void updateTile( pair<int, int> tile );
+        void computeArrows();
 
     public:
         VRRoadNetwork();
@@ -56,6 +109,10 @@ class VRRoadNetwork : public VRObject {
         void computeMarkingsRoad2(VREntityPtr roadEnt);
         void computeMarkingsIntersection(VREntityPtr intersection);
 
+        void setNodeDirty( VREntityPtr node );
+        void setTileSize( float s );
+        map<string, float> getStats();
+
         void clear();
         void compute();
 };
@@ -172,8 +172,7 @@ bool VRGuiMonitor::draw(GdkEventExpose* e) {
     draw_timeline(0, N/L, 1, width,   line_height, line_height, selFrame);
 
     float fl = 1./(frame.t1 - frame.t0);
-    for (auto itr : frame.calls) {
-        auto call = itr.second;
+    for (auto& call : frame.calls) {
         float t0 = (call.t0 - frame.t0)*fl;
         float t1 = (call.t1 - frame.t0)*fl;
         float l = t1-t0;
@@ -190,9 +189,9 @@ void VRGuiMonitor::selectFrame() {
     frame = VRProfiler::get()->getFrame(f);
 
     map<string, float> fkts;
-    for (auto c : frame.calls) {
-        if (fkts.count(c.second.name) == 0) fkts[c.second.name] = 0;
-        fkts[c.second.name] += c.second.t1 - c.second.t0;
+    for (auto& c : frame.calls) {
+        if (fkts.count(c.name) == 0) fkts[c.name] = 0;
+        fkts[c.name] += (c.t1 - c.t0)*1e-6; // ms
     }
 
     // update list
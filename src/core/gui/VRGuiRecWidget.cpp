@@ -65,7 +65,8 @@ void VRGuiRecWidget::setVisible(bool b) {
 void VRGuiRecWidget::update() {
     if (!rec->isRunning()) return;
     string T = toString(rec->getRecordingLength(), 2);
-    lbl->set_text("Recording: " + T );
+    string D = toString(rec->getDroppedFrames());
+    lbl->set_text("Recording: " + T + "s, dropped frames: " + D );
 }
 
 void VRGuiRecWidget::buttonHandler(int i) {
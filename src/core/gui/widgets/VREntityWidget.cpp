@@ -30,11 +30,11 @@ void VREntityWidget::on_edit_prop_clicked() {
     Gtk::Dialog* dialog;
     VRGuiBuilder()->get_widget("PropertyEdit", dialog);
     setTextEntry("entry23", selected_entity_property->getName());
-    setTextEntry("entry24", selected_entity_property->value);
+    setTextEntry("entry24", selected_entity_property->getValue());
     dialog->show();
     if (dialog->run() == Gtk::RESPONSE_OK) {
         //selected_entity_property->setName( getTextEntry("entry23") );
-        selected_entity_property->value = getTextEntry("entry24");
+        selected_entity_property->setValue( getTextEntry("entry24") );
     }
     dialog->hide();
     update();
@@ -113,7 +113,7 @@ void VREntityWidget::update() {
             selected = selected_entity_property == ep;
             color = selected ? "green" : "black";
             Gtk::TreeModel::iterator j = treestore->append(i->children());
-            setPropRow(j, ep->getName(), ep->value, color, selected, ep->ID, 1);
+            setPropRow(j, ep->getName(), ep->getValue(), color, selected, ep->ID, 1);
         }
     }
 
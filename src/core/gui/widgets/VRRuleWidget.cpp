@@ -66,6 +66,7 @@ void VRRuleWidget::on_edit_clicked() {
     string s = askUserInput("Change rule " + label->get_text() + ":");
     if (s == "") return;
     rule->setQuery(s);
+    if (auto o = manager->getSelectedOntology()) o->indexRule(rule);
     if (rule->query) label->set_text(rule->query->toString());
     saveScene();
 }
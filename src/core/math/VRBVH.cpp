@@ -0,0 +1,141 @@
+#include "VRBVH.h"
+#include <algorithm>
+
+using namespace OSG;
+
+VRBVH::VRBVH(int leafSize) : leafSize(max(leafSize,1)) {}
+VRBVH::~VRBVH() {}
+
+int VRBVH::size() { return order.size(); }
+int VRBVH::getNodeCount() { return nodes.size(); }
+const vector<int>& VRBVH::getOrder() { return order; }
+
+void VRBVH::clear() {
+    nodes.clear();
+    order.clear();
+}
+
+bool VRBVH::getBounds(Vec3f& min, Vec3f& max) {
+    if (nodes.size() == 0) return false;
+    min = nodes[0].min;
+    max = nodes[0].max;
+    return true;
+}
+
+void VRBVH::build(const vector<Vec3f>& min, const vector<Vec3f>& max) {
+    clear();
+    int N = min.size();
+    if (N == 0) return;
+
+    vector<Vec3f> centers(N);
+    order.resize(N);
+    for (int i=0; i<N; i++) {
+        centers[i] = (min[i] + max[i])*0.5;
+        order[i] = i;
+    }
+
+    nodes.reserve(2*N/leafSize + 1);
+    buildNode(0, N, 0, min, max, centers);
+}
+
+int VRBVH::buildNode(int begin, int end, int depth, const vector<Vec3f>& min, const vector<Vec3f>& max, const vector<Vec3f>& centers) {
+    int ni = nodes.size();
+    nodes.push_back(Node());
+
+    Vec3f bmin = min[order[begin]], bmax = max[order[begin]];
+    Vec3f cmin = centers[order[begin]], cmax = cmin;
+    for (int i=begin+1; i<end; i++) {
+        int k = order[i];
+        for (int j=0; j<3; j++) {
+            bmin[j] = std::min(bmin[j], min[k][j]);
+            bmax[j] = std::max(bmax[j], max[k][j]);
+            cmin[j] = std::min(cmin[j], centers[k][j]);
+            cmax[j] = std::max(cmax[j], centers[k][j]);
+        }
+    }
+    nodes[ni].min = bmin;
+    nodes[ni].max = bmax;
+
+    int N = end - begin;
+    Vec3f ce = cmax - cmin;
+    int axis = (ce[0] > ce[1] && ce[0] > ce[2]) ? 0 : (ce[1] > ce[2] ? 1 : 2);
+    if (N <= leafSize || ce[axis] <= 0) {
+        nodes[ni].begin = begin;
+        nodes[ni].count = N;
+        return ni;
+    }
+
+    auto area = [](const Vec3f& a, const Vec3f& b) {
+        Vec3f e = b - a;
+        return e[0]*e[1] + e[1]*e[2] + e[2]*e[0];
+    };
+
+    // binned SAH along the largest extent of the centers
+    const int B = 12;
+    struct Bin { Vec3f min, max; int n = 0; };
+    Bin bins[B];
+    float scale = B/ce[axis];
+    auto binOf = [&](int k) { return std::min(B-1, int((centers[k][axis] - cmin[axis])*scale)); };
+    for (int i=begin; i<end; i++) {
+        int k = order[i];
+        Bin& b = bins[binOf(k)];
+        if (b.n == 0) { b.min = min[k]; b.max = max[k]; }
+        else for (int j=0; j<3; j++) { b.min[j] = std::min(b.min[j], min[k][j]); b.max[j] = std::max(b.max[j], max[k][j]); }
+        b.n++;
+    }
+
+    float costs[B-1];
+    Bin acc;
+    for (int i=0; i<B-1; i++) { // left sides
+        const Bin& b = bins[i];
+        if (b.n) {
+            if (acc.n == 0) { acc.min = b.min; acc.max = b.max; }
+            else for (int j=0; j<3; j++) { acc.min[j] = std::min(acc.min[j], b.min[j]); acc.max[j] = std::max(acc.max[j], b.max[j]); }
+            acc.n += b.n;
+        }
+        costs[i] = acc.n ? acc.n*area(acc.min, acc.max) : 0;
+    }
+    acc = Bin();
+    for (int i=B-1; i>0; i--) { // right sides
+        const Bin& b = bins[i];
+        if (b.n) {
+            if (acc.n == 0) { acc.min = b.min; acc.max = b.max; }
+            else for (int j=0; j<3; j++) { acc.min[j] = std::min(acc.min[j], b.min[j]); acc.max[j] = std::max(acc.max[j], b.max[j]); }
+            acc.n += b.n;
+        }
+        costs[i-1] += acc.n ? acc.n*area(acc.min, acc.max) : 0;
+    }
+
+    int split = 0;
+    for (int i=1; i<B-1; i++) if (costs[i] < costs[split]) split = i;
+
+    int mid = begin;
+    if (depth < 32) mid = std::partition(order.begin()+begin, order.begin()+end, [&](int k) { return binOf(k) <= split; }) - order.begin();
+    if (mid == begin || mid == end) { // degenerated split or too deep, use the median
+        mid = (begin + end)/2;
+        std::nth_element(order.begin()+begin, order.begin()+mid, order.begin()+end, [&](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+    }
+
+    buildNode(begin, mid, depth+1, min, max, centers);
+    int r = buildNode(mid, end, depth+1, min, max, centers);
+    nodes[ni].right = r;
+    return ni;
+}
+
+void VRBVH::refit(const vector<Vec3f>& min, const vector<Vec3f>& max) {
+    for (int i = nodes.size()-1; i >= 0; i--) { // children are stored after their parent
+        Node& n = nodes[i];
+        if (n.count) {
+            n.min = min[order[n.begin]];
+            n.max = max[order[n.begin]];
+            for (int l=n.begin+1; l<n.begin+n.count; l++) {
+                int k = order[l];
+                for (int j=0; j<3; j++) { n.min[j] = std::min(n.min[j], min[k][j]); n.max[j] = std::max(n.max[j], max[k][j]); }
+            }
+        } else {
+            const Node& a = nodes[i+1];
+            const Node& b = nodes[n.right];
+            for (int j=0; j<3; j++) { n.min[j] = std::min(a.min[j], b.min[j]); n.max[j] = std::max(a.max[j], b.max[j]); }
+        }
+    }
+}
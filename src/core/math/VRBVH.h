@@ -0,0 +1,89 @@
+#ifndef VRBVH_H_INCLUDED
+#define VRBVH_H_INCLUDED
+
+#include <vector>
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGVector.h>
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Bounding volume hierarchy over boxes, built with the binned surface area heuristic.
+    The nodes are stored depth first in a flat array, the first child of an inner node is the next node.
+    refit() updates the boxes after the primitives moved and keeps the hierarchy.
+*/
+
+class VRBVH {
+    public:
+        struct Node {
+            Vec3f min;
+            Vec3f max;
+            int begin = 0; // first primitive of a leaf in the order
+            int count = 0; // primitives of a leaf, 0 for inner nodes
+            int right = 0; // second child of an inner node
+        };
+
+    private:
+        vector<Node> nodes;
+        vector<int> order; // primitive indices, the primitives of a leaf are contiguous
+        int leafSize = 4;
+
+        int buildNode(int begin, int end, int depth, const vector<Vec3f>& min, const vector<Vec3f>& max, const vector<Vec3f>& centers);
+
+    public:
+        VRBVH(int leafSize = 4);
+        ~VRBVH();
+
+        void build(const vector<Vec3f>& min, const vector<Vec3f>& max);
+        void refit(const vector<Vec3f>& min, const vector<Vec3f>& max);
+        void clear();
+
+        int size();
+        int getNodeCount();
+        const vector<int>& getOrder();
+        bool getBounds(Vec3f& min, Vec3f& max);
+
+        /** calls leaf(begin, count, tmax) for the leaves hit by the ray, nearest first, leaf may shorten tmax **/
+        template<class F> void traverse(const Pnt3f& o, const Vec3f& d, float tmax, F leaf) const;
+};
+
+template<class F>
+void VRBVH::traverse(const Pnt3f& o, const Vec3f& d, float tmax, F leaf) const {
+    if (nodes.size() == 0) return;
+    Vec3f inv;
+    for (int i=0; i<3; i++) inv[i] = (d[i] == 0) ? 1e30 : 1.0/d[i];
+
+    auto enter = [&](const Node& n) {
+        float t0 = 0, t1 = tmax;
+        for (int i=0; i<3; i++) {
+            float a = (n.min[i] - o[i])*inv[i];
+            float b = (n.max[i] - o[i])*inv[i];
+            if (a > b) swap(a,b);
+            t0 = a > t0 ? a : t0;
+            t1 = b < t1 ? b : t1;
+        }
+        return t0 <= t1 ? t0 : -1.f;
+    };
+
+    int stack[64];
+    int N = 0;
+    if (enter(nodes[0]) >= 0) stack[N++] = 0;
+    while (N > 0) {
+        const Node& n = nodes[stack[--N]];
+        if (enter(n) < 0) continue; // tmax got shorter since the node was pushed
+        if (n.count) { leaf(n.begin, n.count, tmax); continue; }
+
+        int c1 = &n - &nodes[0] + 1;
+        int c2 = n.right;
+        float t1 = enter(nodes[c1]);
+        float t2 = enter(nodes[c2]);
+        if (t1 >= 0 && t2 >= 0 && t2 < t1) { swap(c1,c2); swap(t1,t2); }
+        if (t2 >= 0) stack[N++] = c2; // far child first on the stack
+        if (t1 >= 0) stack[N++] = c1;
+    }
+}
+
+OSG_END_NAMESPACE;
+
+#endif // VRBVH_H_INCLUDED
@@ -0,0 +1,241 @@
+#include "VRGraphCSR.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using namespace OSG;
+
+const float inf = numeric_limits<float>::infinity();
+
+VRGraphCSR::VRGraphCSR() {}
+VRGraphCSR::~VRGraphCSR() {}
+
+shared_ptr<VRGraphCSR> VRGraphCSR::create(GraphPtr g, bool undirected) {
+    auto csr = shared_ptr<VRGraphCSR>(new VRGraphCSR());
+    csr->build(g, undirected);
+    return csr;
+}
+
+void VRGraphCSR::build(GraphPtr g, bool undirected) {
+    vector<Vec2i> edges;
+    vector<Vec3f> pos;
+    if (g) {
+        for (auto& n : g->getNodes()) pos.push_back( n.p.pos() );
+        for (auto& n : g->getEdges()) for (auto& e : n) edges.push_back( Vec2i(e.from, e.to) );
+    }
+    build(pos.size(), edges, pos, undirected);
+
+    if (!g) return;
+    vector<int> IDs; // slots refer to the edge index, use the graph edge IDs instead
+    for (auto& n : g->getEdges()) for (auto& e : n) IDs.push_back( e.ID );
+    for (auto& id : edgeIDs) id = IDs[id];
+}
+
+/** builds the rows with a counting sort over the edge sources, the edge ID of a slot is the index in edges **/
+void VRGraphCSR::build(int n, const vector<Vec2i>& edges, const vector<Vec3f>& pos, bool undir) {
+    N = n;
+    undirected = undir;
+    positions = pos;
+    positions.resize(N);
+
+    offsets.assign(N+1, 0);
+    auto valid = [&](const Vec2i& e) { return e[0] >= 0 && e[1] >= 0 && e[0] < N && e[1] < N; };
+    for (auto& e : edges) {
+        if (!valid(e)) continue;
+        offsets[e[0]+1]++;
+        if (undirected) offsets[e[1]+1]++;
+    }
+    for (int i=0; i<N; i++) offsets[i+1] += offsets[i];
+
+    int M = offsets[N];
+    targets.resize(M);
+    edgeIDs.resize(M);
+    weights.resize(M);
+    vector<int> fill(offsets.begin(), offsets.end()-1);
+    for (int k=0; k<(int)edges.size(); k++) {
+        const Vec2i& e = edges[k];
+        if (!valid(e)) continue;
+        float w = (positions[e[0]] - positions[e[1]]).length();
+        int s = fill[e[0]]++;
+        targets[s] = e[1]; edgeIDs[s] = k; weights[s] = w;
+        if (!undirected) continue;
+        s = fill[e[1]]++;
+        targets[s] = e[0]; edgeIDs[s] = k; weights[s] = w;
+    }
+
+    dist.assign(N, inf);
+    prev.assign(N, -1);
+    stamps.assign(N, 0);
+    stamp = 0;
+}
+
+void VRGraphCSR::setWeights(Weight w) {
+    if (!w) return;
+    for (int i=0; i<N; i++) {
+        for (int s = offsets[i]; s < offsets[i+1]; s++) weights[s] = w(i, targets[s], edgeIDs[s]);
+    }
+}
+
+int VRGraphCSR::size() { return N; }
+int VRGraphCSR::getNEdges() { return targets.size(); }
+int VRGraphCSR::getDegree(int i) { return offsets[i+1] - offsets[i]; }
+const int* VRGraphCSR::getNeighbors(int i) { return &targets[0] + offsets[i]; }
+
+void VRGraphCSR::nextStamp() {
+    stamp++;
+    if (stamp == 0) { // wrapped around, reset all
+        stamps.assign(N, 0);
+        stamp = 1;
+    }
+}
+
+/** nodes reachable from start in breadth first order, the result vector is used as queue **/
+vector<int> VRGraphCSR::bfs(int start, int maxDepth) {
+    vector<int> res;
+    if (start < 0 || start >= N) return res;
+    nextStamp();
+    res.push_back(start);
+    stamps[start] = stamp;
+
+    int depth = 0;
+    size_t levelEnd = 1;
+    for (size_t q = 0; q < res.size(); q++) {
+        if (q == levelEnd) { depth++; levelEnd = res.size(); }
+        if (maxDepth >= 0 && depth >= maxDepth) break;
+        int i = res[q];
+        for (int s = offsets[i]; s < offsets[i+1]; s++) {
+            int j = targets[s];
+            if (stamps[j] == stamp) continue;
+            stamps[j] = stamp;
+            res.push_back(j);
+        }
+    }
+    return res;
+}
+
+/** Dijkstra, or A* if a heuristic is given, with a binary heap and lazy deletion, stops when the target is settled **/
+vector<int> VRGraphCSR::search(int from, int to, Heuristic h, float* length) {
+    vector<int> path;
+    if (length) *length = inf;
+    if (from < 0 || from >= N || to >= N) return path;
+
+    nextStamp();
+    auto cmp = greater<pair<float, int> >();
+    heap.clear();
+    dist[from] = 0;
+    prev[from] = -1;
+    stamps[from] = stamp;
+    heap.push_back( make_pair(h ? h(from) : 0, from) );
+
+    while (heap.size()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto top = heap.back();
+        heap.pop_back();
+        int i = top.second;
+        float di = dist[i];
+        if (top.first > di + (h ? h(i) : 0)) continue; // outdated entry
+        if (i == to) break;
+
+        for (int s = offsets[i]; s < offsets[i+1]; s++) {
+            int j = targets[s];
+            float d = di + weights[s];
+            if (stamps[j] == stamp && d >= dist[j]) continue;
+            stamps[j] = stamp;
+            dist[j] = d;
+            prev[j] = i;
+            heap.push_back( make_pair(d + (h ? h(j) : 0), j) );
+            push_heap(heap.begin(), heap.end(), cmp);
+        }
+    }
+
+    if (to < 0 || stamps[to] != stamp) return path;
+    for (int i = to; i >= 0; i = prev[i]) path.push_back(i);
+    reverse(path.begin(), path.end());
+    if (length) *length = dist[to];
+    return path;
+}
+
+/** shortest distances from a node to all nodes, infinity for unreachable nodes **/
+void VRGraphCSR::distances(int from, vector<float>& res) {
+    search(from, -1, 0, 0);
+    res.assign(N, inf);
+    for (int i=0; i<N; i++) if (stamps[i] == stamp) res[i] = dist[i];
+}
+
+vector<int> VRGraphCSR::shortestPath(int from, int to, float* length) { return search(from, to, 0, length); }
+
+vector<int> VRGraphCSR::shortestPathAStar(int from, int to, Heuristic h, float* length) {
+    if (!h && to >= 0 && to < N) {
+        Vec3f target = positions[to];
+        h = [this, target](int i) { return (positions[i] - target).length(); };
+    }
+    return search(from, to, h, length);
+}
+
+/** weakly connected components with union find, returns the number of components, labels are 0 to n-1 **/
+int VRGraphCSR::connectedComponents(vector<int>& labels) {
+    vector<int> parent(N);
+    for (int i=0; i<N; i++) parent[i] = i;
+    auto root = [&](int i) {
+        while (parent[i] != i) { parent[i] = parent[parent[i]]; i = parent[i]; } // path halving
+        return i;
+    };
+
+    for (int i=0; i<N; i++) {
+        for (int s = offsets[i]; s < offsets[i+1]; s++) {
+            int a = root(i), b = root(targets[s]);
+            if (a != b) parent[max(a,b)] = min(a,b);
+        }
+    }
+
+    labels.assign(N, -1);
+    int C = 0;
+    for (int i=0; i<N; i++) {
+        int r = root(i);
+        if (labels[r] < 0) labels[r] = C++;
+        labels[i] = labels[r];
+    }
+    return C;
+}
+
+/** Kahn's algorithm, returns false if the graph has a cycle or is undirected **/
+bool VRGraphCSR::topologicalSort(vector<int>& order) {
+    order.clear();
+    if (undirected) return false;
+    vector<int> indegree(N, 0);
+    for (int s : targets) indegree[s]++;
+
+    for (int i=0; i<N; i++) if (indegree[i] == 0) order.push_back(i);
+    for (size_t q = 0; q < order.size(); q++) { // order is the queue
+        int i = order[q];
+        for (int s = offsets[i]; s < offsets[i+1]; s++) {
+            if (--indegree[targets[s]] == 0) order.push_back(targets[s]);
+        }
+    }
+    return (int)order.size() == N;
+}
+
+/** Floyd Warshall, res[i*N+j] is the distance from i to j, only for small graphs **/
+void VRGraphCSR::allPairs(vector<float>& res) {
+    res.assign(N*N, inf);
+    for (int i=0; i<N; i++) {
+        res[i*N+i] = 0;
+        for (int s = offsets[i]; s < offsets[i+1]; s++) {
+            float& d = res[i*N+targets[s]];
+            d = min(d, weights[s]);
+        }
+    }
+
+    for (int k=0; k<N; k++) {
+        const float* rk = &res[k*N];
+        #pragma omp parallel for
+        for (int i=0; i<N; i++) {
+            float* ri = &res[i*N];
+            float dik = ri[k];
+            if (dik == inf) continue;
+            for (int j=0; j<N; j++) ri[j] = min(ri[j], dik + rk[j]);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef VRGRAPHCSR_H_INCLUDED
+#define VRGRAPHCSR_H_INCLUDED
+
+#include <vector>
+#include <boost/function.hpp>
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGVector.h>
+#include "core/math/VRMathFwd.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Compressed sparse row snapshot of a graph with search kernels.
+    The outgoing edges of node i are the slots offsets[i] to offsets[i+1], with their target node, weight and graph edge ID.
+    The default weights are the distances between the node positions, A* uses the distance to the target as default heuristic.
+    The searches reuse the buffers of the snapshot and are not thread safe, use one snapshot per thread.
+    The snapshot does not follow changes of the graph, build it again after modifying the graph.
+*/
+
+class VRGraphCSR {
+    public:
+        typedef boost::function<float (int)> Heuristic; // estimated cost from node to the target
+        typedef boost::function<float (int, int, int)> Weight; // from, to, edge ID
+
+    private:
+        int N = 0;
+        bool undirected = false;
+        vector<int> offsets;
+        vector<int> targets;
+        vector<int> edgeIDs;
+        vector<float> weights;
+        vector<Vec3f> positions;
+
+        // search buffers, valid for nodes with the current stamp
+        vector<float> dist;
+        vector<int> prev;
+        vector<unsigned int> stamps;
+        vector<pair<float, int> > heap;
+        unsigned int stamp = 0;
+
+        void nextStamp();
+        vector<int> search(int from, int to, Heuristic h, float* length);
+
+    public:
+        VRGraphCSR();
+        ~VRGraphCSR();
+
+        static shared_ptr<VRGraphCSR> create(GraphPtr g, bool undirected = false);
+
+        void build(GraphPtr g, bool undirected = false);
+        void build(int N, const vector<Vec2i>& edges, const vector<Vec3f>& positions, bool undirected = false);
+        void setWeights(Weight w);
+
+        int size();
+        int getNEdges();
+        int getDegree(int i);
+        const int* getNeighbors(int i);
+
+        vector<int> bfs(int start, int maxDepth = -1);
+        void distances(int from, vector<float>& res);
+        vector<int> shortestPath(int from, int to, float* length = 0);
+        vector<int> shortestPathAStar(int from, int to, Heuristic h = 0, float* length = 0);
+        int connectedComponents(vector<int>& labels);
+        bool topologicalSort(vector<int>& order);
+        void allPairs(vector<float>& res);
+};
+
+typedef shared_ptr<VRGraphCSR> VRGraphCSRPtr;
+
+OSG_END_NAMESPACE;
+
+#endif // VRGRAPHCSR_H_INCLUDED
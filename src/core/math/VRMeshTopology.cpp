@@ -0,0 +1,262 @@
+#include "VRMeshTopology.h"
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGTriangleIterator.h>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#ifdef _OPENMP
+#include <parallel/algorithm>
+#endif
+
+using namespace OSG;
+
+template<class T> void parallelSort(vector<T>& v) {
+#ifdef _OPENMP
+    __gnu_parallel::sort(v.begin(), v.end());
+#else
+    sort(v.begin(), v.end());
+#endif
+}
+
+VRMeshTopology::VRMeshTopology() {}
+VRMeshTopology::~VRMeshTopology() {}
+
+struct WeldCell {
+    long long x, y, z;
+    bool operator==(const WeldCell& c) const { return x == c.x && y == c.y && z == c.z; }
+};
+
+struct WeldCellHash {
+    size_t operator()(const WeldCell& c) const { return size_t(c.x*73856093LL ^ c.y*19349663LL ^ c.z*83492791LL); }
+};
+
+/** merges each vertex with the first unique vertex in range, remap[i] is the unique index of vertex i, unique[k] the first vertex of unique index k **/
+int VRMeshTopology::weld(const vector<Vec3f>& pos, float tolerance, vector<int>& remap, vector<int>& unique, Compatible same) {
+    int M = pos.size();
+    remap.assign(M, -1);
+    unique.clear();
+    float s = tolerance > 0 ? 1.0/tolerance : 1e6;
+    float tol2 = tolerance*tolerance;
+
+    unordered_map<WeldCell, int, WeldCellHash> cells; // last unique vertex added to the cell
+    cells.reserve(M);
+    vector<int> next; // the unique vertex added to the same cell before
+    next.reserve(M);
+
+    for (int i=0; i<M; i++) {
+        const Vec3f& p = pos[i];
+        WeldCell c = { (long long)floor(p[0]*s), (long long)floor(p[1]*s), (long long)floor(p[2]*s) };
+        int match = -1;
+        for (int k=0; k<27 && match < 0; k++) {
+            int o = (k+13)%27; // own cell first
+            WeldCell n = { c.x + o/9-1, c.y + (o/3)%3-1, c.z + o%3-1 };
+            auto it = cells.find(n);
+            if (it == cells.end()) continue;
+            for (int j = it->second; j >= 0; j = next[j]) {
+                if ((pos[unique[j]] - p).squareLength() > tol2) continue;
+                if (same && !same(i, unique[j])) continue;
+                match = j;
+                break;
+            }
+        }
+
+        if (match < 0) {
+            match = unique.size();
+            unique.push_back(i);
+            auto it = cells.find(c);
+            next.push_back(it != cells.end() ? it->second : -1);
+            cells[c] = match;
+        }
+        remap[i] = match;
+    }
+    return unique.size();
+}
+
+void VRMeshTopology::clear() {
+    N = 0;
+    positions.clear();
+    normals.clear();
+    curvatures.clear();
+    triangles.clear();
+    edges.clear();
+    triEdges.clear();
+    eOffsets.clear();
+    eTriangles.clear();
+    vOffsets.clear();
+    vNeighbors.clear();
+    tOffsets.clear();
+    vTriangles.clear();
+}
+
+void VRMeshTopology::build(Geometry* geo) {
+    clear();
+    if (!geo || !geo->getPositions()) return;
+    auto pos = geo->getPositions();
+    vector<Vec3f> P(pos->size());
+    for (uint i=0; i<P.size(); i++) P[i] = Vec3f(pos->getValue<Pnt3f>(i));
+
+    vector<int> tris;
+    for (TriangleIterator it(geo); !it.isAtEnd(); ++it) {
+        for (int i=0; i<3; i++) tris.push_back( it.getPositionIndex(i) );
+    }
+    build(P, tris);
+}
+
+/** the triangle sides are sorted by their vertex pair, equal pairs are one edge, degenerated triangles are skipped **/
+void VRMeshTopology::build(const vector<Vec3f>& pos, const vector<int>& tris) {
+    clear();
+    N = pos.size();
+    positions = pos;
+
+    for (uint t=0; t+2<tris.size(); t+=3) {
+        int a = tris[t], b = tris[t+1], c = tris[t+2];
+        if (a < 0 || b < 0 || c < 0 || a >= N || b >= N || c >= N) continue;
+        if (a == b || a == c || b == c) continue;
+        triangles.push_back(a);
+        triangles.push_back(b);
+        triangles.push_back(c);
+    }
+    int S = triangles.size();
+
+    // unique edges
+    vector<pair<unsigned long long, int> > sides(S);
+    #pragma omp parallel for
+    for (int k=0; k<S; k++) {
+        unsigned long long a = triangles[k];
+        unsigned long long b = triangles[k - k%3 + (k+1)%3];
+        sides[k] = make_pair( min(a,b) << 32 | max(a,b), k );
+    }
+    parallelSort(sides);
+
+    triEdges.resize(S);
+    eTriangles.resize(S);
+    for (int k=0; k<S; k++) {
+        unsigned long long key = sides[k].first;
+        if (k == 0 || key != sides[k-1].first) {
+            edges.push_back( Vec2i(key >> 32, key & 0xffffffff) );
+            eOffsets.push_back(k);
+        }
+        eTriangles[k] = sides[k].second/3;
+        triEdges[sides[k].second] = edges.size()-1;
+    }
+    eOffsets.push_back(S);
+
+    // vertex neighbors, the edges are sorted so the rows are sorted too
+    vOffsets.assign(N+1, 0);
+    for (auto& e : edges) { vOffsets[e[0]+1]++; vOffsets[e[1]+1]++; }
+    for (int i=0; i<N; i++) vOffsets[i+1] += vOffsets[i];
+    vNeighbors.resize(vOffsets[N]);
+    vector<int> fill(vOffsets.begin(), vOffsets.end()-1);
+    for (auto& e : edges) {
+        vNeighbors[fill[e[0]]++] = e[1];
+        vNeighbors[fill[e[1]]++] = e[0];
+    }
+
+    // vertex triangles
+    tOffsets.assign(N+1, 0);
+    for (int v : triangles) tOffsets[v+1]++;
+    for (int i=0; i<N; i++) tOffsets[i+1] += tOffsets[i];
+    vTriangles.resize(S);
+    fill.assign(tOffsets.begin(), tOffsets.end()-1);
+    for (int k=0; k<S; k++) vTriangles[fill[triangles[k]]++] = k/3;
+}
+
+int VRMeshTopology::size() { return N; }
+int VRMeshTopology::getNTriangles() { return triangles.size()/3; }
+int VRMeshTopology::getNEdges() { return edges.size(); }
+Vec3i VRMeshTopology::getTriangle(int t) { return Vec3i(triangles[3*t], triangles[3*t+1], triangles[3*t+2]); }
+Vec2i VRMeshTopology::getEdge(int e) { return edges[e]; }
+int VRMeshTopology::getTriangleEdge(int t, int side) { return triEdges[3*t+side]; }
+int VRMeshTopology::getDegree(int i) { return vOffsets[i+1] - vOffsets[i]; }
+const int* VRMeshTopology::getNeighbors(int i) { return &vNeighbors[0] + vOffsets[i]; }
+bool VRMeshTopology::isBorder(int e) { return eOffsets[e+1] - eOffsets[e] == 1; }
+
+vector<int> VRMeshTopology::getVertexTriangles(int i) { return vector<int>(vTriangles.begin() + tOffsets[i], vTriangles.begin() + tOffsets[i+1]); }
+vector<int> VRMeshTopology::getEdgeTriangles(int e) { return vector<int>(eTriangles.begin() + eOffsets[e], eTriangles.begin() + eOffsets[e+1]); }
+
+vector<int> VRMeshTopology::getBorderEdges() {
+    vector<int> res;
+    for (int e=0; e<(int)edges.size(); e++) if (isBorder(e)) res.push_back(e);
+    return res;
+}
+
+/** the vertices up to range edges away, without i, stamps has to be of size N if range > 1 and must not contain the stamp i+1 yet **/
+void VRMeshTopology::neighbors(int i, int range, vector<int>& res, vector<int>& stamps) {
+    res.assign(vNeighbors.begin() + vOffsets[i], vNeighbors.begin() + vOffsets[i+1]);
+    if (range <= 1) return;
+
+    int stamp = i+1;
+    stamps[i] = stamp;
+    for (int j : res) stamps[j] = stamp;
+    size_t levelBegin = 0;
+    for (int r=1; r<range; r++) {
+        size_t levelEnd = res.size();
+        for (size_t q = levelBegin; q < levelEnd; q++) {
+            int j = res[q];
+            for (int s = vOffsets[j]; s < vOffsets[j+1]; s++) {
+                int k = vNeighbors[s];
+                if (stamps[k] == stamp) continue;
+                stamps[k] = stamp;
+                res.push_back(k);
+            }
+        }
+        levelBegin = levelEnd;
+    }
+}
+
+vector<int> VRMeshTopology::getNeighbors(int i, int range) {
+    vector<int> res;
+    if (i < 0 || i >= N || vOffsets.empty()) return res;
+    vector<int> stamps(range > 1 ? N : 0, 0);
+    neighbors(i, range, res, stamps);
+    return res;
+}
+
+void VRMeshTopology::setNormals(const vector<Vec3f>& n) { normals = n; }
+const vector<Vec3f>& VRMeshTopology::getNormals() { return normals; }
+const vector<float>& VRMeshTopology::getCurvatures() { return curvatures; }
+
+/** area weighted average of the triangle normals, each vertex gathers from its own triangles **/
+void VRMeshTopology::computeNormals() {
+    int T = getNTriangles();
+    vector<Vec3f> faces(T);
+    #pragma omp parallel for
+    for (int t=0; t<T; t++) {
+        const Vec3f& p0 = positions[triangles[3*t]];
+        faces[t] = (positions[triangles[3*t+1]] - p0).cross(positions[triangles[3*t+2]] - p0);
+    }
+
+    normals.resize(N);
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        Vec3f n;
+        for (int k = tOffsets[i]; k < tOffsets[i+1]; k++) n += faces[vTriangles[k]];
+        if (n.squareLength() > 0) n.normalize();
+        normals[i] = n;
+    }
+}
+
+/** mean normal curvature estimate over the neighbors up to range edges away **/
+void VRMeshTopology::computeCurvatures(int range) {
+    if ((int)normals.size() != N) computeNormals();
+    curvatures.assign(N, 0);
+
+    #pragma omp parallel
+    {
+        vector<int> res;
+        vector<int> stamps(range > 1 ? N : 0, 0);
+        #pragma omp for
+        for (int i=0; i<N; i++) {
+            neighbors(i, range, res, stamps);
+            if (res.empty()) continue;
+            float K = 0;
+            for (int j : res) {
+                Vec3f d = positions[j] - positions[i];
+                float l = d.length();
+                if (l > 0) K += 2*normals[i].dot(d)/l;
+            }
+            curvatures[i] = K/res.size();
+        }
+    }
+}
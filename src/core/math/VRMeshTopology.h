@@ -0,0 +1,77 @@
+#ifndef VRMESHTOPOLOGY_H_INCLUDED
+#define VRMESHTOPOLOGY_H_INCLUDED
+
+#include <vector>
+#include <boost/function.hpp>
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGVector.h>
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+class Geometry;
+
+/**
+    Flat topology of a triangle mesh.
+    The unique edges are found by sorting the triangle sides by their vertex pair, the edge of a triangle side is triEdges[3*t+side].
+    The neighbors of vertex i are the sorted slots vOffsets[i] to vOffsets[i+1], the triangles of vertex i and edge e are stored the same way.
+    Edges with only one triangle are border edges, edges with more than two are non manifold.
+    weld merges the vertices closer than the tolerance with a hash grid of cells as large as the tolerance.
+*/
+
+class VRMeshTopology {
+    public:
+        typedef boost::function<bool (int, int)> Compatible; // can vertex i be merged with the unique vertex j
+
+    private:
+        int N = 0;
+        vector<Vec3f> positions;
+        vector<Vec3f> normals;
+        vector<float> curvatures;
+        vector<int> triangles; // 3 vertices per triangle
+
+        vector<Vec2i> edges; // unique edges, lower vertex first
+        vector<int> triEdges; // edge of each triangle side
+        vector<int> eOffsets;
+        vector<int> eTriangles;
+        vector<int> vOffsets;
+        vector<int> vNeighbors;
+        vector<int> tOffsets;
+        vector<int> vTriangles;
+
+        void neighbors(int i, int range, vector<int>& res, vector<int>& stamps);
+
+    public:
+        VRMeshTopology();
+        ~VRMeshTopology();
+
+        static int weld(const vector<Vec3f>& positions, float tolerance, vector<int>& remap, vector<int>& unique, Compatible same = 0);
+
+        void clear();
+        void build(Geometry* geo);
+        void build(const vector<Vec3f>& positions, const vector<int>& triangles);
+
+        int size();
+        int getNTriangles();
+        int getNEdges();
+        Vec3i getTriangle(int t);
+        Vec2i getEdge(int e);
+        int getTriangleEdge(int t, int side);
+        int getDegree(int i);
+        const int* getNeighbors(int i);
+        vector<int> getNeighbors(int i, int range);
+        vector<int> getVertexTriangles(int i);
+        vector<int> getEdgeTriangles(int e);
+        vector<int> getBorderEdges();
+        bool isBorder(int e);
+
+        void setNormals(const vector<Vec3f>& normals);
+        void computeNormals();
+        void computeCurvatures(int range = 1);
+        const vector<Vec3f>& getNormals();
+        const vector<float>& getCurvatures();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRMESHTOPOLOGY_H_INCLUDED
@@ -0,0 +1,77 @@
+#ifndef VRSPATIALINDEX_H_INCLUDED
+#define VRSPATIALINDEX_H_INCLUDED
+
+#include <vector>
+#include <stdint.h>
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGVector.h>
+#include "boundingbox.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Linear octree over points with typed payloads.
+    The entries are sorted by their morton code and stored contiguously,
+    the node hierarchy splits the sorted range at the morton code bits and is stored in a flat array.
+    Entries added with add() are indexed on the next build() or query.
+    The queries do not allocate, they append to a caller supplied vector or fill a caller supplied buffer.
+    Queries are not thread safe while entries are pending, a query then builds the index first.
+    Call build() after the last add() before querying from several threads at once.
+*/
+
+template<class T>
+class VRSpatialIndex {
+    public:
+        struct Entry {
+            Vec3f p;
+            T data;
+        };
+
+        struct Node {
+            Vec3f min;
+            Vec3f max;
+            int begin = 0;
+            int end = 0;
+            int left = -1;
+            int right = -1;
+        };
+
+    private:
+        vector<Entry> entries;
+        vector<uint64_t> codes;
+        vector<Node> nodes;
+        int leafSize = 8;
+        bool dirty = false;
+
+        int buildNode(int begin, int end, int bit);
+        static uint64_t spread(uint64_t v);
+        static float boxDist2(const Node& n, const Vec3f& p);
+
+        template<class F> void visitSphere(Vec3f p, float r, F f);
+        template<class F> void visitBox(Vec3f min, Vec3f max, F f);
+
+    public:
+        VRSpatialIndex(int leafSize = 8);
+        ~VRSpatialIndex();
+
+        void build(const vector<Vec3f>& points, const vector<T>& data);
+        void build();
+        void add(Vec3f p, T data);
+        void clear();
+
+        int size();
+        int getNodeCount();
+
+        void radiusSearch(Vec3f p, float r, vector<T>& res);
+        int radiusSearch(Vec3f p, float r, T* res, int N);
+        void boxSearch(Vec3f min, Vec3f max, vector<T>& res);
+        void boxSearch(const boundingbox& b, vector<T>& res);
+        int boxSearch(Vec3f min, Vec3f max, T* res, int N);
+        int kNearest(Vec3f p, int k, T* res, float* dist2);
+        bool nearest(Vec3f p, T& res);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSPATIALINDEX_H_INCLUDED
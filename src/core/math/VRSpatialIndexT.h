@@ -0,0 +1,276 @@
+#ifndef VRSPATIALINDEXT_H_INCLUDED
+#define VRSPATIALINDEXT_H_INCLUDED
+
+#include "VRSpatialIndex.h"
+#include <algorithm>
+
+OSG_BEGIN_NAMESPACE;
+
+template<class T>
+VRSpatialIndex<T>::VRSpatialIndex(int leafSize) : leafSize(max(leafSize,1)) {}
+
+template<class T>
+VRSpatialIndex<T>::~VRSpatialIndex() {}
+
+template<class T>
+int VRSpatialIndex<T>::size() { return entries.size(); }
+
+template<class T>
+int VRSpatialIndex<T>::getNodeCount() { return nodes.size(); }
+
+template<class T>
+void VRSpatialIndex<T>::add(Vec3f p, T data) {
+    Entry e;
+    e.p = p;
+    e.data = data;
+    entries.push_back(e);
+    dirty = true;
+}
+
+template<class T>
+void VRSpatialIndex<T>::clear() {
+    entries.clear();
+    codes.clear();
+    nodes.clear();
+    dirty = false;
+}
+
+template<class T>
+uint64_t VRSpatialIndex<T>::spread(uint64_t v) { // insert two zero bits between the lower 21 bits
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffull;
+    v = (v | v << 16) & 0x1f0000ff0000ffull;
+    v = (v | v << 8)  & 0x100f00f00f00f00full;
+    v = (v | v << 4)  & 0x10c30c30c30c30c3ull;
+    v = (v | v << 2)  & 0x1249249249249249ull;
+    return v;
+}
+
+template<class T>
+float VRSpatialIndex<T>::boxDist2(const Node& n, const Vec3f& p) {
+    float d = 0;
+    for (int i=0; i<3; i++) {
+        if (p[i] < n.min[i]) d += (n.min[i]-p[i])*(n.min[i]-p[i]);
+        else if (p[i] > n.max[i]) d += (p[i]-n.max[i])*(p[i]-n.max[i]);
+    }
+    return d;
+}
+
+template<class T>
+void VRSpatialIndex<T>::build(const vector<Vec3f>& points, const vector<T>& data) {
+    int N = min(points.size(), data.size());
+    entries.resize(N);
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        entries[i].p = points[i];
+        entries[i].data = data[i];
+    }
+    build();
+}
+
+template<class T>
+void VRSpatialIndex<T>::build() {
+    dirty = false;
+    nodes.clear();
+    int N = entries.size();
+    if (N == 0) { codes.clear(); return; }
+
+    Vec3f bbMin = entries[0].p;
+    Vec3f bbMax = entries[0].p;
+    for (auto& e : entries) {
+        for (int i=0; i<3; i++) {
+            bbMin[i] = min(bbMin[i], e.p[i]);
+            bbMax[i] = max(bbMax[i], e.p[i]);
+        }
+    }
+
+    Vec3f s = bbMax - bbMin;
+    float scale = 0x1fffff / max(max(s[0], s[1]), max(s[2], 1e-12f));
+
+    vector< pair<uint64_t, int> > keys(N);
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        Vec3f q = (entries[i].p - bbMin)*scale;
+        uint64_t c = spread(q[0]) | spread(q[1]) << 1 | spread(q[2]) << 2;
+        keys[i] = make_pair(c, i);
+    }
+    sort(keys.begin(), keys.end());
+
+    vector<Entry> sorted(N);
+    codes.resize(N);
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        sorted[i] = entries[keys[i].second];
+        codes[i] = keys[i].first;
+    }
+    entries.swap(sorted);
+
+    nodes.reserve(2*N/leafSize + 1);
+    buildNode(0, N, 62);
+}
+
+template<class T>
+int VRSpatialIndex<T>::buildNode(int begin, int end, int bit) {
+    int ID = nodes.size();
+    nodes.push_back(Node());
+    nodes[ID].begin = begin;
+    nodes[ID].end = end;
+
+    // find the highest bit at which the range splits
+    int split = begin;
+    while (end - begin > leafSize && bit >= 0) {
+        uint64_t mask = uint64_t(1) << bit;
+        split = partition_point(codes.begin()+begin, codes.begin()+end, [mask](uint64_t c) { return (c & mask) == 0; }) - codes.begin();
+        if (split > begin && split < end) break;
+        bit--;
+    }
+
+    if (end - begin <= leafSize || bit < 0) { // leaf
+        Vec3f mi = entries[begin].p;
+        Vec3f ma = entries[begin].p;
+        for (int i=begin+1; i<end; i++) {
+            for (int j=0; j<3; j++) {
+                mi[j] = min(mi[j], entries[i].p[j]);
+                ma[j] = max(ma[j], entries[i].p[j]);
+            }
+        }
+        nodes[ID].min = mi;
+        nodes[ID].max = ma;
+        return ID;
+    }
+
+    int l = buildNode(begin, split, bit-1);
+    int r = buildNode(split, end, bit-1);
+    Node& n = nodes[ID];
+    n.left = l;
+    n.right = r;
+    for (int j=0; j<3; j++) {
+        n.min[j] = min(nodes[l].min[j], nodes[r].min[j]);
+        n.max[j] = max(nodes[l].max[j], nodes[r].max[j]);
+    }
+    return ID;
+}
+
+template<class T>
+template<class F>
+void VRSpatialIndex<T>::visitSphere(Vec3f p, float r, F f) {
+    if (dirty) build();
+    if (nodes.size() == 0) return;
+
+    float r2 = r*r;
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+        if (boxDist2(n, p) > r2) continue;
+        if (n.left < 0) {
+            for (int i=n.begin; i<n.end; i++)
+                if ((entries[i].p - p).squareLength() <= r2)
+                    if (!f(entries[i])) return;
+            continue;
+        }
+        stack[top++] = n.left;
+        stack[top++] = n.right;
+    }
+}
+
+template<class T>
+template<class F>
+void VRSpatialIndex<T>::visitBox(Vec3f mi, Vec3f ma, F f) {
+    if (dirty) build();
+    if (nodes.size() == 0) return;
+
+    auto overlaps = [&](const Vec3f& a, const Vec3f& b) {
+        return a[0] <= ma[0] && b[0] >= mi[0] && a[1] <= ma[1] && b[1] >= mi[1] && a[2] <= ma[2] && b[2] >= mi[2];
+    };
+
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+        if (!overlaps(n.min, n.max)) continue;
+        if (n.left < 0) {
+            for (int i=n.begin; i<n.end; i++)
+                if (overlaps(entries[i].p, entries[i].p))
+                    if (!f(entries[i])) return;
+            continue;
+        }
+        stack[top++] = n.left;
+        stack[top++] = n.right;
+    }
+}
+
+template<class T>
+void VRSpatialIndex<T>::radiusSearch(Vec3f p, float r, vector<T>& res) {
+    visitSphere(p, r, [&](const Entry& e) { res.push_back(e.data); return true; });
+}
+
+template<class T>
+int VRSpatialIndex<T>::radiusSearch(Vec3f p, float r, T* res, int N) {
+    if (N <= 0) return 0;
+    int k = 0;
+    visitSphere(p, r, [&](const Entry& e) { res[k++] = e.data; return k < N; });
+    return k;
+}
+
+template<class T>
+void VRSpatialIndex<T>::boxSearch(Vec3f mi, Vec3f ma, vector<T>& res) {
+    visitBox(mi, ma, [&](const Entry& e) { res.push_back(e.data); return true; });
+}
+
+template<class T>
+void VRSpatialIndex<T>::boxSearch(const boundingbox& b, vector<T>& res) { boxSearch(b.min(), b.max(), res); }
+
+template<class T>
+int VRSpatialIndex<T>::boxSearch(Vec3f mi, Vec3f ma, T* res, int N) {
+    if (N <= 0) return 0;
+    int k = 0;
+    visitBox(mi, ma, [&](const Entry& e) { res[k++] = e.data; return k < N; });
+    return k;
+}
+
+template<class T>
+int VRSpatialIndex<T>::kNearest(Vec3f p, int k, T* res, float* dist2) { // results sorted by distance
+    if (dirty) build();
+    if (nodes.size() == 0 || k <= 0) return 0;
+
+    int found = 0;
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+        if (found == k && boxDist2(n, p) > dist2[k-1]) continue;
+
+        if (n.left < 0) {
+            for (int i=n.begin; i<n.end; i++) {
+                float d = (entries[i].p - p).squareLength();
+                if (found == k && d >= dist2[k-1]) continue;
+                int j = found < k ? found++ : k-1; // insertion into the sorted result
+                while (j > 0 && dist2[j-1] > d) { dist2[j] = dist2[j-1]; res[j] = res[j-1]; j--; }
+                dist2[j] = d;
+                res[j] = entries[i].data;
+            }
+            continue;
+        }
+
+        // visit the nearer child first
+        float dl = boxDist2(nodes[n.left], p);
+        float dr = boxDist2(nodes[n.right], p);
+        if (dl < dr) { stack[top++] = n.right; stack[top++] = n.left; }
+        else { stack[top++] = n.left; stack[top++] = n.right; }
+    }
+    return found;
+}
+
+template<class T>
+bool VRSpatialIndex<T>::nearest(Vec3f p, T& res) {
+    float d;
+    return kNearest(p, 1, &res, &d) == 1;
+}
+
+OSG_END_NAMESPACE;
+
+#endif // VRSPATIALINDEXT_H_INCLUDED
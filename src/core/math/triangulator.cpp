@@ -4,6 +4,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <deque>
 #include <boost/bind.hpp>
 
 #include <OpenSG/OSGGeoProperties.h>
@@ -11,33 +12,25 @@
 using namespace std;
 using namespace OSG;
 
-Triangulator* current_triangulator;
-vector<Vec3d> tmpVertices;
+thread_local Triangulator* current_triangulator = 0; // the glu callbacks have no user data, one tessellation per thread
+thread_local deque<Vec3d> tmpVertices; // combined vertices, must not move while tessellating
 
-struct Triangulator::GeoData {
+struct Triangulator::GeoData { // plain vectors, the OpenSG properties are only created by compute
     // geo data
-    GeoUInt8PropertyRecPtr types;
-    GeoUInt32PropertyRecPtr lengths;
-    GeoUInt32PropertyRecPtr indices;
-    GeoPnt3fPropertyRecPtr pos;
-    GeoVec3fPropertyRecPtr norms;
+    vector<int> types;
+    vector<int> lengths;
+    vector<int> indices;
+    vector<Pnt3f> pos;
+    vector<Vec3f> norms;
 
     // tmp vars
     int current_primitive = -1;
     int current_vertex_count = 0;
 
-    GeoData() {
-        types = GeoUInt8Property::create();
-        lengths = GeoUInt32Property::create();
-        indices = GeoUInt32Property::create();
-        pos = GeoPnt3fProperty::create();
-        norms = GeoVec3fProperty::create();
-    }
-
     bool valid() {
-        if (!types->size()) { cout << "Triangulator Error: no types!\n"; return false; }
-        if (!lengths->size()) { cout << "Triangulator Error: no lengths!\n"; return false; }
-        if (!pos->size()) { cout << "Triangulator Error: no pos!\n"; return false; }
+        if (!types.size()) { cout << "Triangulator Error: no types!\n"; return false; }
+        if (!lengths.size()) { cout << "Triangulator Error: no lengths!\n"; return false; }
+        if (!pos.size()) { cout << "Triangulator Error: no pos!\n"; return false; }
         return true;
     }
 };
@@ -60,7 +53,7 @@ void Triangulator::testQuad() {
 }
 
 Triangulator::Triangulator() {}
-Triangulator::~Triangulator() {}
+Triangulator::~Triangulator() { if (geo) delete geo; }
 shared_ptr<Triangulator> Triangulator::create() { return shared_ptr<Triangulator>(new Triangulator()); }
 
 void Triangulator::add(polygon p, bool outer) {
@@ -80,23 +73,63 @@ VRGeometryPtr Triangulator::compute() {
             for (int i=0; i<geo->lengths->size(); i++) cout << geo->lengths->getValue(i) << " "; cout << endl;
             for (int i=0; i<geo->indices->size(); i++) cout << geo->indices->getValue(i) << " "; cout << endl;
             cout << "geo data end" << endl;*/
-            g->setTypes(geo->types);
-            g->setPositions(geo->pos);
-            g->setNormals(geo->norms);
-            g->setLengths(geo->lengths);
-            g->setIndices(geo->indices);
+            GeoUInt8PropertyRecPtr types = GeoUInt8Property::create();
+            GeoUInt32PropertyRecPtr lengths = GeoUInt32Property::create();
+            GeoUInt32PropertyRecPtr indices = GeoUInt32Property::create();
+            GeoPnt3fPropertyRecPtr pos = GeoPnt3fProperty::create();
+            GeoVec3fPropertyRecPtr norms = GeoVec3fProperty::create();
+            for (auto t : geo->types) types->addValue(t);
+            for (auto l : geo->lengths) lengths->addValue(l);
+            for (auto i : geo->indices) indices->addValue(i);
+            for (auto& p : geo->pos) pos->addValue(p);
+            for (auto& n : geo->norms) norms->addValue(n);
+            g->setTypes(types);
+            g->setPositions(pos);
+            g->setNormals(norms);
+            g->setLengths(lengths);
+            g->setIndices(indices);
         }
     }
 
     return g;
 }
 
+void Triangulator::append(vector<Pnt3f>& positions, vector<Vec3f>& normals, vector<int>& triangles, const Matrix& m) { // fans and strips are split into triangles
+    tessellate();
+    if (!geo || !geo->valid()) return;
+
+    int k = 0;
+    for (uint i=0; i<geo->types.size(); i++) {
+        int type = geo->types[i];
+        int N = geo->lengths[i];
+        int i0 = positions.size();
+        for (int j=0; j<N; j++, k++) {
+            int v = geo->indices[k];
+            Pnt3f pos = geo->pos[v];
+            Vec3f n = geo->norms[v];
+            m.mult(pos, pos);
+            m.mult(n, n);
+            positions.push_back(pos);
+            normals.push_back(n);
+        }
+
+        for (int j=0; j+2<N; j++) {
+            Vec3i t;
+            if (type == GL_TRIANGLES) { if (j%3) continue; t = Vec3i(j, j+1, j+2); }
+            else if (type == GL_TRIANGLE_FAN) t = Vec3i(0, j+1, j+2);
+            else if (type == GL_TRIANGLE_STRIP) t = j%2 ? Vec3i(j+1, j, j+2) : Vec3i(j, j+1, j+2);
+            else break;
+            for (int l=0; l<3; l++) triangles.push_back(i0+t[l]);
+        }
+    }
+}
+
 // GLU_TESS CALLBACKS
 void tessBeginCB(GLenum which) {
     auto Self = current_triangulator;
     if (!Self->geo) Self->geo = new Triangulator::GeoData();
     Self->geo->current_primitive = which;
-    Self->geo->types->addValue(which);
+    Self->geo->types.push_back(which);
     //cout << "beg " << which << endl;
 }
 
@@ -104,7 +137,7 @@ void tessEndCB() {
     auto Self = current_triangulator;
     int Nprim = Self->geo->current_vertex_count;
 
-    int Ni0 = Self->geo->indices->size();
+    int Ni0 = Self->geo->indices.size();
     int Nidx = Nprim;
     /*switch(Self->geo->current_primitive) {
         case 0x0000: Nidx = Nprim; break; // GL_POINTS
@@ -123,9 +156,9 @@ void tessEndCB() {
     //if (Self->geo->current_primitive == 5) return;
 
     //cout << Nprim << " " << Self->geo->current_primitive << " " << Ni0 << endl;
-    for (int i=0; i<Nidx; i++) Self->geo->indices->addValue( Ni0 + i );
+    for (int i=0; i<Nidx; i++) Self->geo->indices.push_back( Ni0 + i );
 
-    Self->geo->lengths->addValue( Nprim );
+    Self->geo->lengths.push_back( Nprim );
     Self->geo->current_vertex_count = 0;
     //cout << "end" << endl;
 }
@@ -136,8 +169,8 @@ void tessVertexCB(const GLvoid *data) { // draw a vertex
     //Vec3f n(*(ptr+3), *(ptr+4), *(ptr+5));
 
     auto Self = current_triangulator;
-    Self->geo->pos->addValue( p );
-    Self->geo->norms->addValue( Vec3f(0,0,1) );
+    Self->geo->pos.push_back( p );
+    Self->geo->norms.push_back( Vec3f(0,0,1) );
     //Self->geo->norms->addValue( n );
     Self->geo->current_vertex_count++;
     //cout << "vert " << p << endl;
@@ -159,9 +192,7 @@ void tessErrorCB(GLenum errorCode) {
 }
 
 void Triangulator::tessellate() {
-    GLuint id = glGenLists(1);  // create a display list
-    GLUtesselator *tess = gluNewTess(); // create a tessellator
-    if(!id) return;          // failed to create a list, return 0
+    GLUtesselator *tess = gluNewTess(); // create a tessellator, needs no GL context
     if(!tess) return;         // failed to create tessellation object, return 0
 
     // register callback functions
@@ -197,6 +228,7 @@ void Triangulator::tessellate() {
         gluTessEndContour(tess);
     }
     gluTessEndPolygon(tess);
-    //tmpVertices.clear();
+    tmpVertices.clear();
     gluDeleteTess(tess);
+    current_triangulator = 0;
 }
@@ -3,6 +3,7 @@
 
 #include "polygon.h"
 #include "core/objects/VRObjectFwd.h"
+#include <OpenSG/OSGMatrix.h>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,7 @@ class Triangulator {
         void add(polygon p, bool outer = true);
 
         VRGeometryPtr compute();
+        void append(vector<Pnt3f>& positions, vector<Vec3f>& normals, vector<int>& triangles, const Matrix& m = Matrix()); // plain vectors only, safe in worker threads
 };
 
 OSG_END_NAMESPACE;
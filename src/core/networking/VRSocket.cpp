@@ -7,6 +7,7 @@
 #include "core/setup/devices/VRDevice.h"
 #include "core/utils/toString.h"
 #include "core/utils/VRLogger.h"
+#include "core/utils/VRProfiler.h"
 
 #include <algorithm>
 #ifndef WIN32
@@ -141,6 +142,7 @@ class HTTPServer {
 };
 
 static int server_answer_to_connection_m(struct mg_connection *conn, enum mg_event ev) {
+    VRPROFILE_SCOPE("mongoose event");
     bool v = VRLog::tag("net");
     if (v) {
         if (ev == MG_CONNECT) { VRLog::log("net", "EV CONNECT\n"); return MG_FALSE; }
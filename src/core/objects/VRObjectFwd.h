@@ -29,6 +29,7 @@ ptrFwd(VRGroup);
 ptrFwd(VRBillboard);
 ptrFwd(VRStage);
 ptrFwd(VRSky);
+ptrFwd(VRPointCloud);
 
 // other
 ptrFwd(VRTexture);
@@ -124,6 +124,9 @@ void VRTransform::updateTransformation() {
 }
 
 void VRTransform::reg_change() {
+    if (!worldDirty) dirtyWorldObjects.push_back( ptr() );
+    invalidateWorldMatrix();
+
     if (change == false) {
         if (fixed) changedObjects.push_back( ptr() );
         change = true;
@@ -131,6 +134,61 @@ void VRTransform::reg_change() {
     }
 }
 
+void VRTransform::invalidateWorldMatrix() {
+    if (worldDirty) return; // the subtree is already dirty
+    worldDirty = true;
+    VRObject::invalidateWorldMatrix();
+}
+
+VRTransform* getTransform(VRObjectPtr o) { // o or its first transform ancestor
+    while (o && !o->hasAttachment("transform")) o = o->getParent();
+    return static_cast<VRTransform*>(o.get());
+}
+
+/** returns the cached world matrix, a dirty matrix is computed from the parent world matrix **/
+const Matrix& VRTransform::computeWorldMatrix() {
+    if (!worldDirty) return WorldTransformation;
+
+    Matrix m;
+    getMatrix(m);
+    VRTransform* p = getTransform(getParent());
+    if (p) {
+        WorldTransformation = p->computeWorldMatrix();
+        WorldTransformation.mult(m);
+    } else WorldTransformation = m;
+
+    worldDirty = false;
+    return WorldTransformation;
+}
+
+void VRTransform::updateWorldMatrices(VRObjectPtr o, const Matrix& parentMatrix) {
+    const Matrix* pm = &parentMatrix;
+    if (o->hasAttachment("transform")) {
+        auto t = static_pointer_cast<VRTransform>(o);
+        if (t->worldDirty) {
+            Matrix m;
+            t->getMatrix(m);
+            t->WorldTransformation = parentMatrix;
+            t->WorldTransformation.mult(m);
+            t->worldDirty = false;
+        }
+        pm = &t->WorldTransformation;
+    }
+
+    for (uint i=0; i<o->getChildrenCount(); i++) updateWorldMatrices(o->getChild(i), *pm);
+}
+
+/** top down update of the changed subtrees, avoids the walk up the parents of the lazy computation **/
+void VRTransform::updateWorldMatrices() {
+    for (auto w : dirtyWorldObjects) {
+        auto t = w.lock();
+        if (!t) continue;
+        t->computeWorldMatrix();
+        for (uint i=0; i<t->getChildrenCount(); i++) updateWorldMatrices(t->getChild(i), t->WorldTransformation);
+    }
+    dirtyWorldObjects.clear();
+}
+
 void VRTransform::printInformation() { Matrix m; getMatrix(m); cout << " pos " << m[3]; }
 
 uint VRTransform::getLastChange() { return change_time_stamp; }
@@ -276,21 +334,10 @@ posePtr VRTransform::getRelativePose(VRObjectPtr o, bool parentOnly) { return po
 
 /** Returns the world matrix **/
 void VRTransform::getWorldMatrix(Matrix& M, bool parentOnly) {
-    VRTransformPtr t = 0;
-    M.setIdentity();
-
-    Matrix m;
-    VRObjectPtr o = ptr();
-    if (parentOnly && o->getParent() != 0) o = o->getParent();
-
-    while(o) {
-        if (o->hasAttachment("transform")) {
-            t = static_pointer_cast<VRTransform>(o);
-            t->getMatrix(m);
-            M.multLeft(m);
-        }
-        o = o->getParent();
-    }
+    VRTransform* t = this;
+    if (parentOnly && getParent() != 0) t = getTransform(getParent());
+    if (t) M = t->computeWorldMatrix();
+    else M.setIdentity();
 }
 
 Matrix VRTransform::getWorldMatrix(bool parentOnly) {
@@ -781,6 +828,7 @@ void VRTransform::update() {
 }
 
 void VRTransform::setup() {
+    invalidateWorldMatrix();
     change = true;
     update();
 }
@@ -819,5 +867,6 @@ void VRTransform::stopAnimation() {
 
 list<VRTransformWeakPtr > VRTransform::dynamicObjects = list<VRTransformWeakPtr >();
 list<VRTransformWeakPtr > VRTransform::changedObjects = list<VRTransformWeakPtr >();
+list<VRTransformWeakPtr > VRTransform::dirtyWorldObjects = list<VRTransformWeakPtr >();
 
 OSG_END_NAMESPACE;
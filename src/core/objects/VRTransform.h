@@ -50,7 +50,8 @@ class VRTransform : public VRObject {
         OSGObjectPtr translator;
 
         int frame = 0;
-        Matrix WorldTransformation;
+        Matrix WorldTransformation; // cached world matrix
+        bool worldDirty = true; // a dirty transform has only dirty transforms below it
         VRConstraintPtr constraint;
 
         Matrix old_transformation; //drag n drop
@@ -65,6 +66,9 @@ class VRTransform : public VRObject {
 
         void reg_change();
 
+        const Matrix& computeWorldMatrix();
+        static void updateWorldMatrices(VRObjectPtr o, const Matrix& parentMatrix);
+
         bool checkWorldChange();
 
         void printInformation();
@@ -83,6 +87,11 @@ class VRTransform : public VRObject {
 
         static list< VRTransformWeakPtr > changedObjects;
         static list< VRTransformWeakPtr > dynamicObjects;
+        static list< VRTransformWeakPtr > dirtyWorldObjects;
+
+        /** Compute the world matrices of all transforms changed since the last call, once per frame **/
+        static void updateWorldMatrices();
+        void invalidateWorldMatrix();
 
         uint getLastChange();
         bool changedNow();
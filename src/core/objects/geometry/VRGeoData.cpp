@@ -49,6 +49,7 @@ VRGeoData::VRGeoData(VRGeometryPtr geo) : pend(this, 0) {
     if (!geo) { reset(); return; }
 
     this->geo = geo;
+    if (geo->hasExportedProperties()) geo->makeUnique(); // python holds buffer views on the properties
     data->types = (GeoUInt8Property*)geo->getMesh()->geo->getTypes();
     data->lengths = (GeoUInt32Property*)geo->getMesh()->geo->getLengths();
     data->indices = (GeoUInt32Property*)geo->getMesh()->geo->getIndices();
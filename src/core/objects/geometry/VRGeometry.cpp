@@ -15,6 +15,7 @@
 #include <OpenSG/OSGTriangleIterator.h>
 #include "core/scene/import/VRImport.h"
 #include "core/math/interpolator.h"
+#include "core/math/VRMeshTopology.h"
 #include "core/utils/toString.h"
 #include "core/utils/VRFunction.h"
 #include "core/utils/VRGlobals.h"
@@ -26,6 +27,7 @@
 #include "core/networking/VRSharedMemory.h"
 #include "VRPrimitive.h"
 #include "OSGGeometry.h"
+#include <boost/thread/mutex.hpp>
 
 #include <OpenSG/OSGIntersectAction.h>
 #include <OpenSG/OSGLineIterator.h>
@@ -179,6 +181,7 @@ void VRGeometry::setMesh(OSGGeometryPtr g, Reference ref, bool keep_material) {
     getNode()->node->addChild(mesh_node->node);
     meshSet = true;
     source = ref;
+    VRObject::markGraphChanged();
 
     if (mat == 0) mat = VRMaterial::getDefault();
     if (keep_material) mat = VRMaterial::get(g->geo->getMaterial());
@@ -278,6 +281,28 @@ void VRGeometry::makeUnique() {
     setMesh( OSGGeometry::create( dynamic_cast<Geometry*>( clone->getCore() ) ), source );
 }
 
+namespace {
+    boost::mutex exportMtx;
+    map<GeoProperty*, int> exportedProperties; // number of python buffer views by property
+}
+
+void VRGeometry::exportProperty(GeoProperty* p, bool b) {
+    boost::mutex::scoped_lock lock(exportMtx);
+    int& n = exportedProperties[p];
+    n += b ? 1 : -1;
+    if (n <= 0) exportedProperties.erase(p);
+}
+
+bool VRGeometry::hasExportedProperties() {
+    if (!meshSet || !mesh || !mesh->geo) return false;
+    boost::mutex::scoped_lock lock(exportMtx);
+    if (exportedProperties.empty()) return false;
+    Geometry* g = mesh->geo;
+    for (uint i=0; i<g->getMFProperties()->size(); i++) if (exportedProperties.count(g->getProperty(i))) return true;
+    for (uint i=0; i<g->getMFPropIndices()->size(); i++) if (exportedProperties.count(g->getIndex(i))) return true;
+    return exportedProperties.count(g->getTypes()) || exportedProperties.count(g->getLengths());
+}
+
 void VRGeometry::fixColorMapping() {
     mesh->geo->setIndex(mesh->geo->getIndex(Geometry::PositionsIndex), Geometry::ColorsIndex);
 }
@@ -394,10 +419,10 @@ void VRGeometry::updateNormals(bool face) {
 
 int VRGeometry::getLastMeshChange() { return lastMeshChange; }
 
-void VRGeometry::setTypes(GeoIntegralProperty* types) { if (!meshSet) setMesh(); mesh->geo->setTypes(types); }
+void VRGeometry::setTypes(GeoIntegralProperty* types) { if (!meshSet) setMesh(); mesh->geo->setTypes(types); meshChanged(); }
 void VRGeometry::setNormals(GeoVectorProperty* Norms) { if (!meshSet) setMesh(); mesh->geo->setNormals(Norms); }
 void VRGeometry::setColors(GeoVectorProperty* Colors, bool fixMapping) { if (!meshSet) setMesh(); mesh->geo->setColors(Colors); if (fixMapping) fixColorMapping(); }
-void VRGeometry::setLengths(GeoIntegralProperty* lengths) { if (!meshSet) setMesh(); mesh->geo->setLengths(lengths); }
+void VRGeometry::setLengths(GeoIntegralProperty* lengths) { if (!meshSet) setMesh(); mesh->geo->setLengths(lengths); meshChanged(); }
 void VRGeometry::setTexCoords(GeoVectorProperty* Tex, int i, bool fixMapping) {
     if (!meshSet) setMesh();
     if (i == 0) mesh->geo->setTexCoords(Tex);
@@ -442,6 +467,7 @@ void VRGeometry::setIndices(GeoIntegralProperty* Indices, bool doLengths) {
         mesh->geo->setLengths(Length);
     }
     mesh->geo->setIndices(Indices);
+    meshChanged();
 }
 
 int VRGeometry::size() {
@@ -699,8 +725,52 @@ void VRGeometry::decimate(float f) {
     createSharedIndex(mesh);*/
 }
 
-void VRGeometry::removeDoubles(float minAngle) {// TODO: use angle
-    createSharedIndex(mesh->geo);
+/** welds the vertices closer than tolerance if their normals differ less than minAngle and the other attributes match,
+    only the indices are changed, the unused vertex data stays in the properties **/
+void VRGeometry::removeDoubles(float minAngle, float tolerance) {
+    if (!meshSet || !mesh->geo) return;
+    auto geo = mesh->geo;
+    auto pos = geo->getPositions();
+    auto inds = geo->getIndices();
+    if (!pos || !inds) return;
+    if (!geo->isSingleIndex()) { createSharedIndex(geo); return; }
+
+    int N = pos->size();
+    vector<Vec3f> points(N);
+    for (int i=0; i<N; i++) points[i] = Vec3f(pos->getValue<Pnt3f>(i));
+
+    auto getAttribute = [&](GeoVectorProperty* p, vector<Vec4f>& data) {
+        if (!p || (int)p->size() != N) return;
+        data.resize(N);
+        for (int i=0; i<N; i++) data[i] = p->getValue<Vec4f>(i);
+    };
+
+    vector<Vec4f> norms, cols, texs;
+    getAttribute(geo->getNormals(), norms);
+    getAttribute(geo->getColors(), cols);
+    getAttribute(geo->getTexCoords(), texs);
+
+    for (auto& n : norms) {
+        Vec3f v(n[0], n[1], n[2]);
+        v.normalize();
+        n = Vec4f(v[0], v[1], v[2], 0);
+    }
+
+    float cosMin = cos(minAngle) - 1e-6f; // equal normals still weld with minAngle 0 despite rounding
+    auto same = [&](int i, int j) { // colors and texture coordinates have to match exactly, seams stay split
+        if (norms.size() && norms[i].dot(norms[j]) < cosMin) return false;
+        if (cols.size() && cols[i] != cols[j]) return false;
+        if (texs.size() && texs[i] != texs[j]) return false;
+        return true;
+    };
+
+    vector<int> remap, unique;
+    VRMeshTopology::weld(points, tolerance, remap, unique, same);
+    for (uint k=0; k<inds->size(); k++) {
+        UInt32 i = inds->getValue<UInt32>(k);
+        if ((int)i < N) inds->setValue<UInt32>(unique[remap[i]], k);
+    }
+    meshChanged();
 }
 
 void VRGeometry::setRandomColors() {
@@ -804,8 +874,11 @@ void VRGeometry::setMeshVisibility(bool b) {
     if (!mesh_node) return;
     if (b) mesh_node->node->setTravMask(0xffffffff);
     else mesh_node->node->setTravMask(0);
+    VRObject::markGraphChanged();
 }
 
+OSGObjectPtr VRGeometry::getMeshNode() { return mesh_node; }
+
 /** Set the material of the mesh **/
 void VRGeometry::setMaterial(VRMaterialPtr mat) {
     if (mat == 0) mat = this->mat;
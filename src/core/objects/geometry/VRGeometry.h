@@ -15,6 +15,7 @@ OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 class VRMaterial;
+class GeoProperty;
 class GeoVectorProperty;
 class GeoIntegralProperty;
 class Action;
@@ -66,6 +67,10 @@ class VRGeometry : public VRTransform {
         void makeUnique();
         void setMeshVisibility(bool b);
 
+        /** Python holds buffer views on exported properties, VRGeoData edits a copy of the mesh instead of resizing them **/
+        static void exportProperty(GeoProperty* p, bool b);
+        bool hasExportedProperties();
+
         virtual bool applyIntersectionAction(Action* ia);
         virtual void setPrimitive(string primitive, string args = "");
 
@@ -87,7 +92,7 @@ class VRGeometry : public VRTransform {
         void setPositionalTexCoords2D(float scale = 1.0, int i = 0, Vec2i format = Vec2i(0,1));
 
         void setRandomColors();
-        void removeDoubles(float minAngle);
+        void removeDoubles(float minAngle = 0, float tolerance = 1e-5);
         void decimate(float f);
         void merge(VRGeometryPtr geo);
         void removeSelection(VRSelectionPtr sel);
@@ -113,6 +118,7 @@ class VRGeometry : public VRTransform {
 
         /** Returns the mesh as a OSG geometry core **/
         OSGGeometryPtr getMesh();
+        OSGObjectPtr getMeshNode();
         VRPrimitive* getPrimitive();
 
         /** Set the material of the mesh **/
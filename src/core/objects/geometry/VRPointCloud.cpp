@@ -0,0 +1,227 @@
+#include "VRPointCloud.h"
+#include "VRGeometry.h"
+#include "core/objects/VRCamera.h"
+#include "core/objects/material/VRMaterial.h"
+#include "core/scene/VRScene.h"
+#include "core/scene/VRWorkPool.h"
+#include "core/utils/VRFunction.h"
+
+#include <OpenSG/OSGGeoProperties.h>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+
+using namespace OSG;
+
+VRPointCloud::VRPointCloud(string name) : VRTransform(name) {
+    type = "PointCloud";
+    mat = VRMaterial::create("pointcloud");
+    mat->setLit(false);
+    loader = shared_ptr<Loader>( new Loader() );
+    updateCb = VRFunction<int>::create("pointcloud_update", boost::bind(&VRPointCloud::update, this));
+    if (auto scene = VRScene::getCurrent()) scene->addUpdateFkt(updateCb);
+}
+
+VRPointCloud::~VRPointCloud() {
+    if (cacheDir == "") return;
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(cacheDir, ec);
+}
+
+VRPointCloudPtr VRPointCloud::create(string name) { return shared_ptr<VRPointCloud>(new VRPointCloud(name) ); }
+VRPointCloudPtr VRPointCloud::ptr() { return static_pointer_cast<VRPointCloud>( shared_from_this() ); }
+
+void VRPointCloud::setLoadDistance(float d) { loadDistance = d; }
+void VRPointCloud::setLoadsPerFrame(int n) { loadsPerFrame = max(n, 1); }
+int VRPointCloud::getChunkCount() { return chunks.size(); }
+int VRPointCloud::getLoadedChunkCount() { return loaded; }
+
+VRGeometryPtr VRPointCloud::makeGeometry(string name, const Point* points, size_t N, VRMaterialPtr mat, bool normals) {
+    GeoPnt3fPropertyRecPtr Pos = GeoPnt3fProperty::create();
+    GeoVec3fPropertyRecPtr Norms = GeoVec3fProperty::create();
+    GeoColor3ubPropertyRecPtr Cols = GeoColor3ubProperty::create();
+    GeoUInt32PropertyRecPtr Inds = GeoUInt32Property::create();
+    GeoUInt32PropertyRecPtr Lengths = GeoUInt32Property::create();
+    Pos->resize(N);
+    Cols->resize(N);
+    Inds->resize(N);
+    Lengths->addValue(N);
+    if (normals) Norms->resize(N);
+
+    if (N > 0) {
+        Pnt3f* pos = &Pos->editField()[0];
+        Color3ub* cols = &Cols->editField()[0];
+        UInt32* inds = &Inds->editField()[0];
+        #pragma omp parallel for
+        for (long i=0; i<(long)N; i++) {
+            pos[i] = Pnt3f(points[i].x, points[i].y, points[i].z);
+            cols[i] = Color3ub(points[i].r, points[i].g, points[i].b);
+            inds[i] = i;
+        }
+        if (normals) fill(Norms->editField().begin(), Norms->editField().end(), Vec3f(0,1,0));
+    }
+
+    auto geo = VRGeometry::create(name);
+    geo->setType(GL_POINTS);
+    geo->setPositions(Pos);
+    geo->setColors(Cols);
+    if (normals) geo->setNormals(Norms);
+    geo->setLengths(Lengths);
+    geo->setIndices(Inds);
+    if (mat) geo->setMaterial(mat);
+    return geo;
+}
+
+void VRPointCloud::setup(Vec3f mi, Vec3f ma, size_t expectedPoints, int pointsPerChunk) {
+    Vec3f s = ma - mi;
+    size = max(max(s[0], s[1]), max(s[2], 1e-6f));
+    bbMin = mi;
+
+    depth = 0; // octree level with about pointsPerChunk points per cell
+    for (double n = expectedPoints; n > max(pointsPerChunk, 1) && depth < 6; n /= 8) depth++;
+
+    auto dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("polyvr_pointcloud_%%%%%%%%");
+    boost::filesystem::create_directories(dir);
+    cacheDir = dir.string();
+}
+
+void VRPointCloud::addPoints(const Point* points, size_t N) { // thread safe
+    int n = 1 << depth;
+    float cs = size/n;
+    float ccs = cs/coarseResolution;
+
+    boost::mutex::scoped_lock lock(mtx);
+    for (size_t i=0; i<N; i++) {
+        const Point& p = points[i];
+        Vec3f l = Vec3f(p.x, p.y, p.z) - bbMin;
+        int c[3], k[3];
+        for (int j=0; j<3; j++) {
+            c[j] = max(0, min(n-1, int(l[j]/cs)));
+            k[j] = max(0, min(coarseResolution-1, int((l[j] - c[j]*cs)/ccs)));
+        }
+        uint64_t key = uint64_t(c[0]) | uint64_t(c[1]) << 21 | uint64_t(c[2]) << 42;
+
+        auto itr = chunks.find(key);
+        if (itr == chunks.end()) {
+            Chunk& ch = chunks[key];
+            ch.key = key;
+            ch.min = bbMin + Vec3f(c[0], c[1], c[2])*cs;
+            ch.max = ch.min + Vec3f(cs, cs, cs);
+            ch.file = cacheDir + "/" + to_string(key) + ".pts";
+            itr = chunks.find(key);
+        }
+
+        Chunk& ch = itr->second;
+        ch.buffer.push_back(p);
+        ch.N++;
+        if (ch.coarseCells.insert(k[0] + coarseResolution*(k[1] + coarseResolution*k[2])).second) ch.coarse.push_back(p);
+        buffered++;
+        if (ch.buffer.size() >= 1<<16) flush(ch);
+    }
+
+    if (buffered > 1<<22) for (auto& c : chunks) flush(c.second); // bound the memory of the write buffers
+}
+
+void VRPointCloud::flush(Chunk& c) {
+    if (c.buffer.size() == 0) return;
+    ofstream f(c.file, ios::binary | ios::app);
+    f.write((const char*)&c.buffer[0], c.buffer.size()*sizeof(Point));
+    buffered -= c.buffer.size();
+    c.buffer.clear();
+    c.buffer.shrink_to_fit();
+}
+
+void VRPointCloud::finish() {
+    boost::mutex::scoped_lock lock(mtx);
+    for (auto& c : chunks) {
+        Chunk& ch = c.second;
+        flush(ch);
+        ch.coarseCells = unordered_set<uint32_t>();
+        ch.coarseGeo = makeGeometry(getName() + "_coarse", ch.coarse.data(), ch.coarse.size(), mat);
+        ch.coarse = vector<Point>();
+        addChild(ch.coarseGeo);
+    }
+    buffered = 0;
+}
+
+void VRPointCloud::read(shared_ptr<Loader> loader, uint64_t key, string file, size_t N) { // work pool task, no scenegraph changes
+    vector<Point> points(N);
+    ifstream f(file, ios::binary);
+    f.read((char*)points.data(), N*sizeof(Point));
+    points.resize(f.gcount()/sizeof(Point));
+
+    boost::mutex::scoped_lock lock(loader->mtx);
+    loader->done.push_back( make_pair(key, vector<Point>()) );
+    loader->done.back().second.swap(points);
+}
+
+void VRPointCloud::request(Chunk& c) {
+    c.requested = true;
+    requested++;
+    VRWorkPool::get()->push( boost::bind(&VRPointCloud::read, loader, c.key, c.file, c.N) );
+}
+
+void VRPointCloud::load(Chunk& c, vector<Point>& points) {
+    c.fullGeo = makeGeometry(getName() + "_chunk", points.data(), points.size(), mat);
+    c.coarseGeo->setVisible(false);
+    addChild(c.fullGeo);
+    loaded++;
+}
+
+void VRPointCloud::unload(Chunk& c) {
+    subChild(c.fullGeo);
+    c.fullGeo = 0;
+    c.coarseGeo->setVisible(true);
+    loaded--;
+}
+
+void VRPointCloud::update() { // requests the chunks near the camera and swaps in at most loadsPerFrame read chunks per frame
+    auto scene = VRScene::getCurrent();
+    if (!scene) return;
+    auto cam = scene->getActiveCamera();
+    if (!cam) return;
+
+    boost::mutex::scoped_try_lock lock(mtx);
+    if (!lock.owns_lock()) return; // still importing
+    if (chunks.size() == 0 || chunks.begin()->second.coarseGeo == 0) return;
+
+    Matrix m = getWorldMatrix();
+    m.invert();
+    Pnt3f cp;
+    m.mult(Pnt3f(cam->getWorldPosition()), cp);
+
+    vector< pair<float, Chunk*> > toLoad;
+    for (auto& c : chunks) {
+        Chunk& ch = c.second;
+        float d2 = 0;
+        for (int i=0; i<3; i++) {
+            float d = max(max(ch.min[i] - cp[i], cp[i] - ch.max[i]), 0.f);
+            d2 += d*d;
+        }
+        ch.near = d2 < loadDistance*loadDistance;
+        if (!ch.near && ch.fullGeo) unload(ch);
+        if (ch.near && !ch.fullGeo && !ch.requested) toLoad.push_back( make_pair(d2, &ch) );
+    }
+
+    list< pair<uint64_t, vector<Point> > > done;
+    {
+        boost::mutex::scoped_lock lock(loader->mtx);
+        auto end = loader->done.begin();
+        for (int i=0; i<loadsPerFrame && end != loader->done.end(); i++) end++;
+        done.splice(done.end(), loader->done, loader->done.begin(), end);
+    }
+
+    for (auto& d : done) {
+        auto itr = chunks.find(d.first);
+        if (itr == chunks.end()) continue;
+        Chunk& ch = itr->second;
+        ch.requested = false;
+        requested--;
+        if (ch.near && !ch.fullGeo) load(ch, d.second); // else the camera moved away while reading
+    }
+
+    sort(toLoad.begin(), toLoad.end(), [](const pair<float, Chunk*>& a, const pair<float, Chunk*>& b) { return a.first < b.first; });
+    for (int i=0; i<(int)toLoad.size() && requested < loadsPerFrame; i++) request(*toLoad[i].second);
+}
@@ -0,0 +1,94 @@
+#ifndef VRPOINTCLOUD_H_INCLUDED
+#define VRPOINTCLOUD_H_INCLUDED
+
+#include "core/objects/VRTransform.h"
+#include "core/utils/VRFunctionFwd.h"
+#include <boost/thread/mutex.hpp>
+#include <unordered_set>
+#include <list>
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Out of core point cloud.
+    The bounding box is partitioned into the cells of one octree level, each cell is a chunk.
+    The points of a chunk are streamed to a chunk file, a coarse subsample of each chunk stays in memory and is always shown.
+    The chunks near the camera are read from disk by the work pool, update() swaps the decoded chunks in with full resolution and unloads far chunks.
+*/
+
+class VRPointCloud : public VRTransform {
+    public:
+        struct Point {
+            float x, y, z;
+            unsigned char r, g, b, a;
+        };
+
+    private:
+        struct Chunk {
+            uint64_t key = 0;
+            Vec3f min, max;
+            string file;
+            size_t N = 0;
+            bool near = false;
+            bool requested = false; // read by the work pool
+            vector<Point> buffer;
+            vector<Point> coarse;
+            unordered_set<uint32_t> coarseCells;
+            VRGeometryPtr coarseGeo;
+            VRGeometryPtr fullGeo;
+        };
+
+        struct Loader { // shared with the read tasks, they may outlive the point cloud
+            boost::mutex mtx;
+            list< pair<uint64_t, vector<Point> > > done;
+        };
+
+        map<uint64_t, Chunk> chunks;
+        shared_ptr<Loader> loader;
+        boost::mutex mtx;
+        VRUpdateCbPtr updateCb;
+        VRMaterialPtr mat;
+
+        Vec3f bbMin;
+        float size = 1;
+        int depth = 0;
+        int coarseResolution = 64;
+        size_t buffered = 0;
+        string cacheDir;
+
+        float loadDistance = 10;
+        int loadsPerFrame = 1; // chunks read at once and swapped in per frame
+        int loaded = 0;
+        int requested = 0;
+
+        static void read(shared_ptr<Loader> loader, uint64_t key, string file, size_t N);
+
+        void flush(Chunk& c);
+        void request(Chunk& c);
+        void load(Chunk& c, vector<Point>& points);
+        void unload(Chunk& c);
+        void update();
+
+    public:
+        VRPointCloud(string name);
+        ~VRPointCloud();
+
+        static VRPointCloudPtr create(string name = "pointcloud");
+        VRPointCloudPtr ptr();
+
+        static VRGeometryPtr makeGeometry(string name, const Point* points, size_t N, VRMaterialPtr mat = 0, bool normals = false);
+
+        void setup(Vec3f min, Vec3f max, size_t expectedPoints, int pointsPerChunk = 1<<20);
+        void addPoints(const Point* points, size_t N);
+        void finish();
+
+        void setLoadDistance(float d);
+        void setLoadsPerFrame(int n);
+        int getChunkCount();
+        int getLoadedChunkCount();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRPOINTCLOUD_H_INCLUDED
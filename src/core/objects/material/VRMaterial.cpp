@@ -845,6 +845,7 @@ void VRMaterial::remShaderChunk() {
 }
 
 ShaderProgramMTRecPtr VRMaterial::getShaderProgram() { return mats[activePass]->vProgram; }
+bool VRMaterial::hasShader() { return mats[activePass]->shaderChunk && !mats[activePass]->tmpDeferredShdr; }
 
 void VRMaterial::setDefaultVertexShader() {
     auto md = mats[activePass];
@@ -153,6 +153,7 @@ class VRMaterial : public VRObject {
         string getTessControlScript();
         string getTessEvaluationScript();
         ShaderProgramMTRecPtr getShaderProgram();
+        bool hasShader(); // set by the user, not the temporary deferred shader
 
         template<class T> void setShaderParameter(string name, const T &value);
         void enableShaderParameter(string name);
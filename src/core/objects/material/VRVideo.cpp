@@ -3,6 +3,10 @@
 
 #include <OpenSG/OSGImage.h>
 #include "core/objects/material/VRTexture.h"
+#include "core/scene/VRScene.h"
+#include "core/scene/VRAnimationManagerT.h"
+#include "core/objects/VRAnimation.h"
+#include "core/utils/VRFunction.h"
 
 extern "C" {
     #include <libavcodec/avcodec.h>
@@ -11,24 +15,18 @@ extern "C" {
 }
 
 #include <string>
+#include <cmath>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+typedef boost::mutex::scoped_lock PLock;
 
 VRVideo::VRVideo(OSG::VRMaterialPtr mat) {
     material = mat;
-
-    vFile = 0;
-    vCodec = 0;
-    vFrame = 0;
-    NStreams = 0;
-
     av_register_all(); // Register all formats && codecs
-
-    // test
-    const char* file = "~/Videos/drop.avi";
-    open(file);
-    close();
 }
 
-VRVideo::~VRVideo() {;}
+VRVideo::~VRVideo() { close(); }
 
 int VRVideo::getNStreams() {
     if (vFile == 0) return 0;
@@ -43,72 +41,259 @@ int VRVideo::getStream(int j) {
 
     int k = 0;
     for(int i=0; i<(int)vFile->nb_streams; i++) if(vFile->streams[i]->codec->codec_type == AVMEDIA_TYPE_VIDEO) {
-        if (k != j) continue;
+        if (k != j) { k++; continue; }
         return i;
     }
 
     return -1;
 }
 
-void VRVideo::open(string f) {
-    // open file
-    if(avformat_open_input(&vFile, f.c_str(), NULL, NULL)!=0) return; // Couldn't open file
-    if(avformat_find_stream_info(vFile, NULL)<0) return; // Couldn't find stream information
-    av_dump_format(vFile, 0, f.c_str(), 0); // Dump information about file onto standard error
+float VRVideo::getFPS(int stream) {
+    int s = getStream(stream);
+    if (s < 0) return 0;
+    AVStream* st = vFile->streams[s];
+    if (st->avg_frame_rate.num && st->avg_frame_rate.den) return av_q2d(st->avg_frame_rate);
+    if (st->r_frame_rate.num && st->r_frame_rate.den) return av_q2d(st->r_frame_rate);
+    return 25;
+}
 
-    NStreams = getNStreams();
+float VRVideo::getDuration(int stream) {
+    int s = getStream(stream);
+    if (s < 0) return 0;
+    AVStream* st = vFile->streams[s];
+    if (st->duration != (int64_t)AV_NOPTS_VALUE) return st->duration * av_q2d(st->time_base);
+    if (vFile->duration != (int64_t)AV_NOPTS_VALUE) return vFile->duration / float(AV_TIME_BASE);
+    return 0;
+}
 
-    vFrame = avcodec_alloc_frame(); // Allocate video frame
+int VRVideo::getNFrames(int stream) {
+    int s = getStream(stream);
+    if (s < 0) return 0;
+    if (vFile->streams[s]->nb_frames > 0) return vFile->streams[s]->nb_frames;
+    return round(getDuration(stream)*getFPS(stream));
+}
+
+OSG::VRTexturePtr VRVideo::getTexture(int stream) { return textures.count(stream) ? textures[stream] : 0; }
+
+void VRVideo::setBufferSize(int N) { ringSize = max(N, 2); } // used when the decoder starts next time
+
+int VRVideo::toFrame(int stream, long long pts) {
+    AVStream* st = vFile->streams[getStream(stream)];
+    long long start = (st->start_time != (int64_t)AV_NOPTS_VALUE) ? st->start_time : 0;
+    return round((pts - start) * av_q2d(st->time_base) * getFPS(stream));
+}
+
+void VRVideo::seek(int stream, int frame) {
+    int s = getStream(stream);
+    AVStream* st = vFile->streams[s];
+    long long start = (st->start_time != (int64_t)AV_NOPTS_VALUE) ? st->start_time : 0;
+    long long ts = start + (long long)(frame / (getFPS(stream) * av_q2d(st->time_base)));
+    av_seek_frame(vFile, s, ts, AVSEEK_FLAG_BACKWARD); // to the key frame before
+    avcodec_flush_buffers(vCodec);
+}
+
+/** decodes the next frame of the stream with an index of at least minIndex into f **/
+bool VRVideo::decodeFrame(int stream, Frame* f, int& index, int minIndex) {
+    int s = getStream(stream);
+    for(AVPacket packet; av_read_frame(vFile, &packet)>=0; av_free_packet(&packet) ) { // read stream
+        if(packet.stream_index != s) continue;
+
+        int valid = 0;
+        avcodec_decode_video2(vCodec, vFrame, &valid, &packet); // Decode video frame
+        if(valid == 0) continue;
+
+        long long pts = vFrame->pkt_pts;
+        if (pts == (int64_t)AV_NOPTS_VALUE) pts = vFrame->pkt_dts;
+        index = (pts != (int64_t)AV_NOPTS_VALUE) ? toFrame(stream, pts) : index+1;
+        if (index < minIndex) continue;
+
+        // convert to RGB, the negative stride flips the rows for OpenGL
+        uint8_t* dst[1] = { &f->data[0] + (height-1)*width*3 };
+        int stride[1] = { -width*3 };
+        sws_scale(swsContext, vFrame->data, vFrame->linesize, 0, height, dst, stride);
+        f->index = index;
+        av_free_packet(&packet);
+        return true;
+    }
+    return false;
+}
+
+void VRVideo::decode(int stream) {
+    int index = -1;
+    int minIndex = 0;
+    while (true) {
+        Frame* f = 0;
+        int target = -1;
+        {
+            PLock lock(mtx);
+            while (running && seekTarget < 0 && (pool.empty() || endOfStream)) ringChanged.wait(lock);
+            if (!running) return;
+            if (seekTarget >= 0) {
+                target = seekTarget;
+                seekTarget = -1;
+                endOfStream = false;
+                for (auto r : ring) pool.push_back(r);
+                ring.clear();
+            }
+            f = pool.back();
+            pool.pop_back();
+        }
+
+        if (target >= 0) {
+            seek(stream, target);
+            minIndex = target;
+            index = target-1;
+        }
 
-    frames.clear();
-    for (int i=0; i<NStreams; i++) {
-        int stream = getStream(i);
-        vCodec = vFile->streams[stream]->codec;
-        if (vCodec == 0) continue;
+        bool ok = decodeFrame(stream, f, index, minIndex);
 
-        // Find the decoder for the video stream
-        AVDictionary* optionsDict = 0;
-        AVCodec* c = avcodec_find_decoder(vCodec->codec_id);
-        if(c == 0) { fprintf(stderr, "Unsupported codec!\n"); return; } // Codec not found
-        if(avcodec_open2(vCodec, c, &optionsDict)<0) return; // Could not open codec
+        PLock lock(mtx);
+        if (!ok || seekTarget >= 0) {
+            pool.push_back(f);
+            if (!ok) endOfStream = true;
+            continue;
+        }
+        ring.push_back(f);
+        lastDecoded = f->index;
+        ringChanged.notify_all();
+    }
+}
 
-        width = vCodec->width;
-        height = vCodec->height;
+void VRVideo::startDecoder(int stream, int frame) {
+    stopDecoder();
+    int s = getStream(stream);
+    if (s < 0) return;
 
-        int valid=0;
-        int frame=0;
-        for(AVPacket packet; av_read_frame(vFile, &packet)>=0; av_free_packet(&packet) ) { // read stream
-            if(packet.stream_index != stream) continue;
+    if (vCodec) avcodec_close(vCodec);
+    vCodec = vFile->streams[s]->codec;
 
-            avcodec_decode_video2(vCodec, vFrame, &valid, &packet); // Decode video frame
-            if(valid == 0) continue;
+    // Find the decoder for the video stream
+    AVDictionary* optionsDict = 0;
+    AVCodec* c = avcodec_find_decoder(vCodec->codec_id);
+    if(c == 0) { fprintf(stderr, "Unsupported codec!\n"); vCodec = 0; return; } // Codec not found
+    if(avcodec_open2(vCodec, c, &optionsDict)<0) { vCodec = 0; return; } // Could not open codec
 
-            OSG::VRTexturePtr img = OSG::VRTexture::create();
-            //img->setData(vFrame->data);
+    width = vCodec->width;
+    height = vCodec->height;
+    if (swsContext) sws_freeContext(swsContext);
+    swsContext = sws_getContext(width, height, vCodec->pix_fmt, width, height, AV_PIX_FMT_RGB24, SWS_BILINEAR, 0, 0, 0);
 
-            img->getImage()->set(OSG::Image::OSG_RGB_PF, width, height, 1, 1, 1, 0.0, (const uint8_t *)vFrame->data, OSG::Image::OSG_UINT8_IMAGEDATA, true, 1); // TODO: try to change true to false
+    for (auto f : pool) delete f;
+    pool.clear();
+    for (int i=0; i<ringSize; i++) {
+        Frame* f = new Frame();
+        f->data.resize(width*height*3);
+        pool.push_back(f);
+    }
 
-            frames[stream][frame] = img;
-            frame++;
+    activeStream = stream;
+    running = true;
+    endOfStream = false;
+    seekTarget = frame;
+    lastDecoded = frame-1;
+    decoder = new boost::thread(boost::bind(&VRVideo::decode, this, stream));
+}
+
+void VRVideo::stopDecoder() {
+    if (decoder) {
+        {
+            PLock lock(mtx);
+            running = false;
+            ringChanged.notify_all();
         }
+        decoder->join();
+        delete decoder;
+        decoder = 0;
     }
+
+    for (auto f : ring) pool.push_back(f);
+    ring.clear();
+    activeStream = -1;
+    seekTarget = -1;
+}
+
+void VRVideo::open(string f) {
+    close();
+
+    // open file
+    if(avformat_open_input(&vFile, f.c_str(), NULL, NULL)!=0) return; // Couldn't open file
+    if(avformat_find_stream_info(vFile, NULL)<0) { close(); return; } // Couldn't find stream information
+    av_dump_format(vFile, 0, f.c_str(), 0); // Dump information about file onto standard error
+
+    NStreams = getNStreams();
+    vFrame = avcodec_alloc_frame(); // Allocate video frame
+
+    for (int i=0; i<NStreams; i++) { // one texture per stream, reused for all frames
+        AVCodecContext* codec = vFile->streams[getStream(i)]->codec;
+        OSG::VRTexturePtr tex = OSG::VRTexture::create();
+        tex->getImage()->set(OSG::Image::OSG_RGB_PF, codec->width, codec->height, 1, 1, 1, 0.0, 0, OSG::Image::OSG_UINT8_IMAGEDATA, true, 1);
+        textures[i] = tex;
+        shownFrame[i] = -1;
+    }
+
+    if (NStreams > 0) startDecoder(0, 0); // fill the ring while the scene is set up
 }
 
 void VRVideo::close() {
+    stop();
+    stopDecoder();
+    for (auto f : pool) delete f;
+    pool.clear();
+
+    if (swsContext) sws_freeContext(swsContext);
     if (vFrame) av_free(vFrame); // Free the YUV frame
     if (vCodec) avcodec_close(vCodec); // Close the codec
     if (vFile) avformat_close_input(&vFile); // Close the video file
 
+    swsContext = 0;
     vFrame = 0;
     vCodec = 0;
     vFile = 0;
+    NStreams = 0;
+    textures.clear();
+    shownFrame.clear();
+}
+
+/** shows the frame at the relative position t of the stream, seeks if the frame is not buffered **/
+void VRVideo::showFrame(int stream, float t) {
+    if (!vFile || !textures.count(stream)) return;
+    int N = getNFrames(stream);
+    int target = max(0, min(N-1, int(t*N)));
+    if (stream != activeStream) startDecoder(stream, target);
+    if (stream != activeStream) return;
+
+    PLock lock(mtx);
+    while (ring.size() > 1 && ring[1]->index <= target) { // recycle the frames that are passed
+        pool.push_back(ring.front());
+        ring.pop_front();
+    }
+
+    bool behind = ring.size() && ring.front()->index > target+1; // jumped back
+    bool ahead = ring.empty() && target > lastDecoded + ringSize; // jumped forward, faster to seek than to decode
+    if ((behind || ahead) && seekTarget != target) {
+        seekTarget = target;
+        lastDecoded = target-1;
+    }
+    ringChanged.notify_all();
+
+    if (ring.empty() || behind) return;
+    Frame* f = ring.front();
+    if (f->index == shownFrame[stream]) return;
+    textures[stream]->getImage()->setData(&f->data[0]);
+    shownFrame[stream] = f->index;
 }
 
 void VRVideo::play(int stream, float t0, float t1, float v) {
-    cout << "\nPLAY\n";
-    material->setTexture(getFrame(stream,0));
+    if (!textures.count(stream) || v <= 0) return;
+    stop();
+    material->setTexture(textures[stream], false);
+
+    float duration = getDuration(stream) * abs(t1-t0) / v;
+    animCb = VRFunction<float>::create("videoAnim", boost::bind(&VRVideo::showFrame, this, stream, _1));
+    anim = OSG::VRScene::getCurrent()->addAnimation<float>(duration, 0, animCb, t0, t1, false);
 }
 
-OSG::VRTexturePtr VRVideo::getFrame(int stream, int i) { if (frames[stream].count(i) == 0) return 0; return frames[stream][i]; }
-OSG::VRTexturePtr VRVideo::getFrame(int stream, float t) { return frames[stream][(int)t*getNFrames()]; }
-int VRVideo::getNFrames() { return frames.size(); }
+void VRVideo::stop() {
+    if (anim) anim->stop();
+    anim = 0;
+}
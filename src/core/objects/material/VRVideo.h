@@ -2,29 +2,72 @@
 #define VRVIDEO_H_INCLUDED
 
 #include "core/objects/VRObjectFwd.h"
+#include "core/utils/VRFunctionFwd.h"
+#include "core/tools/VRToolsFwd.h"
 #include "core/utils/VRStorage.h"
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <deque>
 
 using namespace std;
 
 class AVFormatContext;
 class AVCodecContext;
 class AVFrame;
+class SwsContext;
+namespace boost{ class thread; }
+
+/**
+    Streams the frames of a video into a texture of the material.
+    A decode thread keeps a bounded ring of converted RGB frames ahead of the playback position,
+    the main thread copies the frame to show into one texture per stream.
+    Seeking far from the buffered frames restarts the decoder at the nearest key frame.
+*/
 
 class VRVideo : public OSG::VRStorage {
     private:
-        map<int, map<int, OSG::VRTexturePtr> > frames; // frames[stream, frame]
-        int width;
-        int height;
-        int NStreams;
+        struct Frame {
+            int index = -1;
+            vector<unsigned char> data; // RGB, rows bottom up
+        };
+
+        int width = 0;
+        int height = 0;
+        int NStreams = 0;
+        int ringSize = 16;
 
         OSG::VRMaterialPtr material;
+        map<int, OSG::VRTexturePtr> textures; // one texture per stream, updated in place
+        map<int, int> shownFrame;
+        OSG::VRAnimationPtr anim;
+        VRAnimCbPtr animCb;
 
-        AVFormatContext* vFile;
-        AVCodecContext* vCodec;
-        AVFrame* vFrame;
+        AVFormatContext* vFile = 0;
+        AVCodecContext* vCodec = 0;
+        AVFrame* vFrame = 0;
+        SwsContext* swsContext = 0;
+
+        // shared with the decode thread
+        boost::thread* decoder = 0;
+        boost::mutex mtx;
+        boost::condition_variable ringChanged;
+        deque<Frame*> ring; // decoded frames, ascending
+        vector<Frame*> pool; // free frames
+        bool running = false;
+        bool endOfStream = false;
+        int activeStream = -1;
+        int seekTarget = -1;
+        int lastDecoded = -1;
 
         int getNStreams();
         int getStream(int j);
+        int toFrame(int stream, long long pts);
+        void seek(int stream, int frame);
+        void decode(int stream);
+        bool decodeFrame(int stream, Frame* f, int& index, int minIndex);
+        void startDecoder(int stream, int frame);
+        void stopDecoder();
+        void showFrame(int stream, float t);
 
     public:
         VRVideo(OSG::VRMaterialPtr mat);
@@ -33,10 +76,14 @@ class VRVideo : public OSG::VRStorage {
         void open(string f);
         void close();
         void play(int stream, float t0, float t1, float v);
+        void stop();
+
+        void setBufferSize(int N);
 
-        OSG::VRTexturePtr getFrame(int stream, int i);
-        OSG::VRTexturePtr getFrame(int stream, float t);
-        int getNFrames();
+        OSG::VRTexturePtr getTexture(int stream);
+        int getNFrames(int stream = 0);
+        float getDuration(int stream = 0);
+        float getFPS(int stream = 0);
 };
 
 #endif // VRVIDEO_H_INCLUDED
@@ -16,10 +16,66 @@
 #include "core/utils/VRStorage_template.h"
 #include "addons/Semantics/Reasoning/VREntity.h"
 #include <libxml++/nodes/element.h>
+#include <boost/thread/mutex.hpp>
+#include <unordered_map>
+#include <atomic>
+#include <algorithm>
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
+/**
+    Scene wide index of all objects attached to a parent, maintained on add, remove and rename.
+    The find methods resolve nodes, names and IDs with it and only check the ancestry instead of walking the tree.
+    Objects are created and destroyed by loader threads too, all access goes through the mutex.
+*/
+
+struct VRObjectRegistry {
+    typedef map<int, VRObjectWeakPtr> Entries; // ID -> object
+
+    boost::mutex mtx;
+    unordered_map<Node*, Entries> nodes; // objects may share a node
+    unordered_map<int, VRObjectWeakPtr> IDs;
+    unordered_map<string, Entries> names; // unique name
+    unordered_map<string, Entries> baseNames;
+
+    static VRObjectRegistry& get() {
+        static VRObjectRegistry* r = new VRObjectRegistry(); // never deleted, objects may outlive static destruction
+        return *r;
+    }
+
+    template<class K> static void erase(unordered_map<K, Entries>& m, const K& key, int ID) {
+        auto itr = m.find(key);
+        if (itr == m.end()) return;
+        itr->second.erase(ID);
+        if (itr->second.size() == 0) m.erase(itr);
+    }
+
+    /** copies the entries, locking a weak pointer may destroy the object which then unregisters itself **/
+    template<class K> Entries lookup(unordered_map<K, Entries>& m, const K& key) {
+        boost::mutex::scoped_lock lock(mtx);
+        auto itr = m.find(key);
+        return itr != m.end() ? itr->second : Entries();
+    }
+
+    /** the entries below the root, in depth first order like a walk of the tree **/
+    static vector<VRObjectPtr> descendants(const Entries& entries, VRObjectPtr root) {
+        vector< pair<vector<int>, VRObjectPtr> > res;
+        for (auto& e : entries) {
+            auto o = e.second.lock();
+            if (!o || o == root || !o->hasAncestor(root)) continue;
+            vector<int> path; // child indices from the root down to the object
+            for (auto a = o; a && a != root; a = a->getParent()) path.push_back(a->getChildIndex());
+            reverse(path.begin(), path.end());
+            res.push_back( make_pair(path, o) );
+        }
+        sort(res.begin(), res.end(), [](const pair<vector<int>, VRObjectPtr>& a, const pair<vector<int>, VRObjectPtr>& b) { return a.first < b.first; });
+        vector<VRObjectPtr> objs;
+        for (auto& r : res) objs.push_back(r.second);
+        return objs;
+    }
+};
+
 
 VRObject::VRObject(string _name) {
     static int _ID = 0;
@@ -44,11 +100,53 @@ VRObject::VRObject(string _name) {
 }
 
 VRObject::~VRObject() {
+    unregisterObject();
     NodeMTRecPtr p;
     if (osg->node) p = osg->node->getParent();
     if (p) p->subChild(osg->node);
 }
 
+void VRObject::registerObject() {
+    if (registered) return;
+    auto& r = VRObjectRegistry::get();
+    auto self = ptr();
+    boost::mutex::scoped_lock lock(r.mtx);
+    regName = name;
+    regBaseName = base_name;
+    r.nodes[osg->node.get()][ID] = self;
+    r.IDs[ID] = self;
+    r.names[regName][ID] = self;
+    r.baseNames[regBaseName][ID] = self;
+    registered = true;
+}
+
+void VRObject::unregisterObject() {
+    if (!registered) return;
+    auto& r = VRObjectRegistry::get();
+    boost::mutex::scoped_lock lock(r.mtx);
+    VRObjectRegistry::erase(r.nodes, osg->node.get(), ID);
+    r.IDs.erase(ID);
+    VRObjectRegistry::erase(r.names, regName, ID);
+    VRObjectRegistry::erase(r.baseNames, regBaseName, ID);
+    registered = false;
+}
+
+void VRObject::onNameChanged() {
+    if (!registered) return;
+    unregisterObject();
+    registerObject();
+}
+
+int VRObject::getRegistrySize() {
+    auto& r = VRObjectRegistry::get();
+    boost::mutex::scoped_lock lock(r.mtx);
+    return r.IDs.size();
+}
+
+static atomic<unsigned int> graphRevision(1); // loader threads mark changes too
+unsigned int VRObject::getGraphRevision() { return graphRevision; }
+void VRObject::markGraphChanged() { graphRevision++; }
+
 void VRObject::setup() {
     setVisible(visible);
     setPickable(pickable);
@@ -213,6 +311,7 @@ void VRObject::addChild(OSGObjectPtr n) {
     if (!osg || !osg->node) { cout << "Warning! VRObject::addChild: bad osg parent node!\n"; return; }
     if (!n || !n->node) { cout << "Warning! VRObject::addChild: bad osg child node!\n"; return; }
     osg->node->addChild(n->node);
+    markGraphChanged();
 }
 
 void VRObject::addChild(VRObjectPtr child, bool osg, int place) {
@@ -221,24 +320,29 @@ void VRObject::addChild(VRObjectPtr child, bool osg, int place) {
 
     if (osg) addChild(child->osg);
     child->graphChanged = VRGlobals::CURRENT_FRAME;
+    child->invalidateWorldMatrix();
     child->childIndex = children.size();
     children.push_back(child);
     child->parent = ptr();
+    child->registerObject();
+    markGraphChanged();
     child->setSiblingPosition(place);
     updateChildrenIndices(true);
 }
 
 int VRObject::getChildIndex() { return childIndex;}
 
-void VRObject::subChild(OSGObjectPtr n) { osg->node->subChild(n->node); }
+void VRObject::subChild(OSGObjectPtr n) { osg->node->subChild(n->node); markGraphChanged(); }
 void VRObject::subChild(VRObjectPtr child, bool doOsg) {
     if (doOsg) osg->node->subChild(child->osg->node);
 
     int target = findChild(child);
 
     if (target != -1) children.erase(children.begin() + target);
-    if (child->getParent() == ptr()) child->parent.reset();
+    if (child->getParent() == ptr()) { child->parent.reset(); child->unregisterObject(); }
     child->graphChanged = VRGlobals::CURRENT_FRAME;
+    child->invalidateWorldMatrix();
+    markGraphChanged();
     updateChildrenIndices(true);
 }
 
@@ -321,50 +425,44 @@ void VRObject::getObjectListByType(string _type, vector<VRObjectPtr>& list) {
 }
 
 VRObjectPtr VRObject::find(OSGObjectPtr n, string indent) {
-    //cout << endl << indent << getName() << " " << node << " " << ptr() << flush;
     if (osg->node == n->node) return ptr();
-    for (auto c : children) {
-        VRObjectPtr tmp = c->find(n, indent+" ");
-        if (tmp != 0) return tmp;
-    }
-    return 0;
+    auto& r = VRObjectRegistry::get();
+    auto res = VRObjectRegistry::descendants(r.lookup(r.nodes, n->node.get()), ptr());
+    return res.size() ? res[0] : 0;
 }
 
 VRObjectPtr VRObject::find(VRObjectPtr obj) {
-    if (obj == ptr()) return ptr();
-    for (auto c : children) {
-        VRObjectPtr tmp = c->find(obj);
-        if (tmp != 0) return tmp;
-    }
+    if (obj && obj->hasAncestor(ptr())) return obj;
     return 0;
 }
 
 VRObjectPtr VRObject::find(string Name) {
     if (name == Name) return ptr();
-    for (auto c : children) {
-        if (c == ptr()) continue; // workaround! TODO: find why ptr() can happn
-        VRObjectPtr tmp = c->find(Name);
-        if (tmp != 0) return tmp;
-    }
-    return 0;
+    auto& r = VRObjectRegistry::get();
+    auto res = VRObjectRegistry::descendants(r.lookup(r.names, Name), ptr());
+    return res.size() ? res[0] : 0;
 }
 
 vector<VRObjectPtr> VRObject::findAll(string Name, vector<VRObjectPtr> res ) {
     if (base_name == Name) res.push_back(ptr());
-    for (auto c : children) {
-        if (c == ptr()) continue; // workaround! TODO: find why ptr() can happn
-        res = c->findAll(Name, res);
-    }
+    auto& r = VRObjectRegistry::get();
+    for (auto o : VRObjectRegistry::descendants(r.lookup(r.baseNames, Name), ptr())) res.push_back(o);
     return res;
 }
 
 VRObjectPtr VRObject::find(int id) {
     if (ID == -1) return 0;
     if (ID == id) return ptr();
-    for (auto c : children) {
-        VRObjectPtr tmp = c->find(id);
-        if (tmp != 0) return tmp;
+    auto& r = VRObjectRegistry::get();
+    VRObjectWeakPtr w;
+    {
+        boost::mutex::scoped_lock lock(r.mtx);
+        auto itr = r.IDs.find(id);
+        if (itr == r.IDs.end()) return 0;
+        w = itr->second;
     }
+    auto o = w.lock();
+    if (o && o->hasAncestor(ptr())) return o;
     return 0;
 }
 
@@ -389,6 +487,11 @@ VRObjectPtr VRObject::findPickableAncestor() {
     else return getParent()->findPickableAncestor();
 }
 
+/** the transforms of the subtree cache their world matrix, called when the hierarchy above them changes **/
+void VRObject::invalidateWorldMatrix() {
+    for (auto c : children) c->invalidateWorldMatrix();
+}
+
 bool VRObject::hasGraphChanged() {
     if (graphChanged == VRGlobals::CURRENT_FRAME) return true;
     if (getParent() == 0) return false;
@@ -509,6 +612,7 @@ void VRObject::setVisible(bool b) {
     visible = b;
     if (b) osg->node->setTravMask(0xffffffff);
     else osg->node->setTravMask(0);
+    markGraphChanged();
 }
 
 /** toggle visibility **/
@@ -33,9 +33,14 @@ class VRObject : public std::enable_shared_from_this<VRObject>, public VRName, p
         unsigned int graphChanged = 0; //is frame number
         map<string, VRAttachment*> attachments;
         VREntityPtr entity;
+        bool registered = false;
+        string regName, regBaseName;
 
         int findChild(VRObjectPtr node);
         void updateChildrenIndices(bool recursive = false);
+        void registerObject();
+        void unregisterObject();
+        void onNameChanged();
 
         static void unitTest();
 
@@ -67,6 +72,7 @@ class VRObject : public std::enable_shared_from_this<VRObject>, public VRName, p
         VRObjectPtr getAtPath(string path);
 
         bool hasGraphChanged();
+        virtual void invalidateWorldMatrix();
 
         template<typename T> void addAttachment(string name, T t);
         template<typename T> T getAttachment(string name);
@@ -142,6 +148,12 @@ class VRObject : public std::enable_shared_from_this<VRObject>, public VRName, p
 
         void setup();
         void destroy();
+
+        static int getRegistrySize();
+
+        /** incremented on every change of the graph structure or visibility, used to invalidate caches over subtrees **/
+        static unsigned int getGraphRevision();
+        static void markGraphChanged();
 };
 
 OSG_END_NAMESPACE;
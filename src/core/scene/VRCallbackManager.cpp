@@ -2,63 +2,61 @@
 #include "core/utils/VRFunction.h"
 #include "core/utils/VRGlobals.h"
 #include "core/objects/object/VRObject.h"
+#include "VRWorkPool.h"
 #include <iostream>
-#include <vector>
+#include <algorithm>
 #include <GL/glut.h>
-#include <boost/thread/recursive_mutex.hpp>
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 typedef boost::recursive_mutex::scoped_lock PLock;
-boost::recursive_mutex mtx;
 
-VRCallbackManager::VRCallbackManager() { updateListsChanged = false; }
-VRCallbackManager::~VRCallbackManager() {
-    for (auto ufs : updateFktPtrs) delete ufs.second;
+VRCallbackManager::VRCallbackManager() {
+    updateListsChanged = false;
+    clearJobsFlag = false;
+    wheel.resize(wheelSize);
 }
 
+VRCallbackManager::~VRCallbackManager() {}
+
 void VRCallbackManager::queueJob(VRUpdateCbPtr f, int priority, int delay) {
-    PLock lock(mtx);
-    updateListsChanged = true;
-    jobFktPtrs[f.get()] = job(f,priority,delay);
+    jobQueue.push( job(f,priority,delay) );
 }
 
+void VRCallbackManager::clearJobs() { clearJobsFlag = true; }
+
 void VRCallbackManager::addUpdateFkt(VRUpdateCbWeakPtr f, int priority) {
     PLock lock(mtx);
     updateListsChanged = true;
-    if (updateFktPtrs.count(priority) == 0) {
-        updateFktPtrs[priority] = new list<VRUpdateCbWeakPtr>();
-    }
     updateFktPtrs_priorities[f.lock().get()] = priority;
-    updateFktPtrs[priority]->push_back(f);
+    updateFktPtrs[priority].push_back(f);
 }
 
 void VRCallbackManager::addTimeoutFkt(VRUpdateCbWeakPtr p, int priority, int timeout) {
     PLock lock(mtx);
     auto f = p.lock().get();
-    updateListsChanged = true;
     if (updateFktPtrs_priorities.count(f)) return;
-
-    if (timeoutFktPtrs.count(priority) == 0) timeoutFktPtrs[priority] = new list<timeoutFkt>();
+    updateListsChanged = true;
     updateFktPtrs_priorities[f] = priority;
 
-    timeoutFkt tof;
-    tof.fktPtr = p;
-    tof.timeout = timeout;
-    tof.last_call = glutGet(GLUT_ELAPSED_TIME);
-    timeoutFktPtrs[priority]->push_back(tof);
+    timeoutFktPtr tof = timeoutFktPtr( new timeoutFkt() );
+    tof->fktPtr = p;
+    tof->timeout = timeout;
+    tof->last_call = glutGet(GLUT_ELAPSED_TIME);
+    tof->prio = priority;
+    timeoutFktPtrs[priority].push_back(tof);
 }
 
-void VRCallbackManager::dropUpdateFkt(VRUpdateCbWeakPtr p) {//replace by list || map || something..
+void VRCallbackManager::dropUpdateFkt(VRUpdateCbWeakPtr p) {
     PLock lock(mtx);
     auto f = p.lock().get();
     if (updateFktPtrs_priorities.count(f) == 0) return;
     int prio = updateFktPtrs_priorities[f];
-    list<VRUpdateCbWeakPtr>* l = updateFktPtrs[prio];
-    if (l == 0) return;
+    if (updateFktPtrs.count(prio) == 0) return;
+    updateListsChanged = true;
 
-    l->remove_if([p](VRUpdateCbWeakPtr p2){
+    updateFktPtrs[prio].remove_if([p](VRUpdateCbWeakPtr p2){
         auto sp = p.lock();
         auto sp2 = p2.lock();
         return (sp && sp2) ? sp == sp2 : false;
@@ -67,70 +65,153 @@ void VRCallbackManager::dropUpdateFkt(VRUpdateCbWeakPtr p) {//replace by list ||
     updateFktPtrs_priorities.erase(f);
 }
 
-void VRCallbackManager::dropTimeoutFkt(VRUpdateCbWeakPtr p) {//replace by list || map || something..
+void VRCallbackManager::dropTimeoutFkt(VRUpdateCbWeakPtr p) {
     PLock lock(mtx);
     auto f = p.lock().get();
-    updateListsChanged = true;
     if (updateFktPtrs_priorities.count(f) == 0) return;
     int prio = updateFktPtrs_priorities[f];
     if (timeoutFktPtrs.count(prio) == 0) return;
-    list<timeoutFkt>* l = timeoutFktPtrs[prio];
-    if (l == 0) return;
+    updateListsChanged = true;
 
     auto sp = p.lock();
-    list<timeoutFkt>::iterator itr;
-    for (itr = l->begin(); itr != l->end(); itr++) {
-        auto sp2 = itr->fktPtr.lock();
-        if( (sp && sp2) ? sp == sp2 : false ) { l->erase(itr); break; }
+    auto& l = timeoutFktPtrs[prio];
+    for (auto itr = l.begin(); itr != l.end(); itr++) {
+        auto sp2 = (*itr)->fktPtr.lock();
+        if( (sp && sp2) ? sp == sp2 : false ) { l.erase(itr); break; }
     }
 
     updateFktPtrs_priorities.erase(f);
 }
 
-void VRCallbackManager::updateCallbacks() {
+void VRCallbackManager::setThreadSafePriority(int priority, bool b) {
     PLock lock(mtx);
-    //printCallbacks();
-    vector<VRUpdateCbWeakPtr> cbsPtr;
-
-    // gather all update callbacks
-    for (auto fl : updateFktPtrs) for (auto f : *fl.second) cbsPtr.push_back(f);
-
-    // gather all timeout callbacks
-    int time = glutGet(GLUT_ELAPSED_TIME);
-    for (auto tfl : timeoutFktPtrs)
-        for (auto& tf : *tfl.second)
-            if (time - tf.last_call >= tf.timeout) {
-                cbsPtr.push_back(tf.fktPtr);
-                tf.last_call = time;
-            }
-
-    for (auto cb : cbsPtr) { // trigger all callbacks
-        if ( auto scb = cb.lock()) (*scb)(0);
+    updateListsChanged = true;
+    threadSafePriorities[priority] = b;
+}
+
+bool VRCallbackManager::isThreadSafePriority(int priority) {
+    PLock lock(mtx);
+    return threadSafePriorities.count(priority) ? threadSafePriorities[priority] : false;
+}
+
+void VRCallbackManager::rebuildLists() {
+    PLock lock(mtx);
+    updateListsChanged = false;
+
+    updateFkts.clear();
+    for (auto& fl : updateFktPtrs) {
+        bool safe = isThreadSafePriority(fl.first);
+        for (auto& f : fl.second) {
+            updateFkt uf;
+            uf.fktPtr = f;
+            uf.prio = fl.first;
+            uf.threadSafe = safe;
+            updateFkts.push_back(uf);
+        }
     }
 
-    map<VRFunction<int>* , job> delayedJobs;
-    for (auto j : jobFktPtrs) {
-        if (j.second.delay > 0) {
-            j.second.delay--;
-            delayedJobs[j.first] = j.second;
+    for (auto& slot : wheel) slot.clear();
+    for (auto& tfl : timeoutFktPtrs) for (auto& tf : tfl.second) schedule(tf);
+}
+
+void VRCallbackManager::schedule(timeoutFktPtr t) {
+    int deadline = max(t->last_call + t->timeout, wheelTime+1);
+    wheel[deadline % wheelSize].push_back(t);
+}
+
+void VRCallbackManager::updateTimeouts(int time) {
+    dueTimeouts.clear();
+    if (wheelTime < 0) wheelTime = time;
+    int N = min(time - wheelTime, wheelSize);
+
+    for (int i=1; i<=N; i++) {
+        auto& slot = wheel[(wheelTime+i) % wheelSize];
+        for (unsigned int j=0; j<slot.size();) {
+            auto& tf = slot[j];
+            if (time - tf->last_call < tf->timeout) { j++; continue; } // later round
+            dueTimeouts.push_back(tf);
+            tf = slot.back();
+            slot.pop_back();
+        }
+    }
+    wheelTime = time;
+
+    sort(dueTimeouts.begin(), dueTimeouts.end(), [](const timeoutFktPtr& a, const timeoutFktPtr& b) { return a->prio < b->prio; });
+    for (auto& tf : dueTimeouts) {
+        auto scb = tf->fktPtr.lock();
+        if (!scb) continue;
+        tf->last_call = time;
+        schedule(tf);
+        (*scb)(0);
+    }
+}
+
+void VRCallbackManager::updateJobs() {
+    job j;
+    if (clearJobsFlag) {
+        clearJobsFlag = false;
+        while (jobQueue.pop(j));
+        jobs.clear();
+        jobIndex.clear();
+        return;
+    }
+
+    while (jobQueue.pop(j)) { // queueing the same function again replaces the pending job
+        auto k = j.ptr.get();
+        auto itr = jobIndex.find(k);
+        if (itr != jobIndex.end()) jobs[itr->second] = j;
+        else { jobIndex[k] = jobs.size(); jobs.push_back(j); }
+    }
+
+    delayedJobs.clear();
+    for (auto& j : jobs) {
+        if (j.delay > 0) {
+            j.delay--;
+            jobIndex[j.ptr.get()] = delayedJobs.size(); // existing entry, only the position changes
+            delayedJobs.push_back(j);
             continue;
         }
 
-        if (j.second.ptr) {
-            string name = j.second.ptr->getName();
-            (*j.second.ptr)(0);
+        jobIndex.erase(j.ptr.get());
+        if (j.ptr) (*j.ptr)(0);
+    }
+
+    jobs.swap(delayedJobs);
+}
+
+void VRCallbackManager::updateCallbacks() {
+    //printCallbacks();
+    if (updateListsChanged) rebuildLists();
+
+    // trigger all update callbacks, consecutive thread safe callbacks run in parallel on the work pool
+    auto pool = VRWorkPool::get();
+    VRWorkPool::Group group;
+    for (auto& uf : updateFkts) {
+        uf.locked = uf.fktPtr.lock();
+        if (!uf.locked) continue;
+        if (uf.threadSafe) { // the task only holds a pointer to the entry, small enough to not allocate
+            updateFkt* p = &uf;
+            pool->push( [p](){ (*p->locked)(0); }, &group );
+            continue;
         }
+        pool->wait(&group);
+        (*uf.locked)(0);
+        uf.locked.reset();
     }
-    jobFktPtrs = delayedJobs;
+    pool->wait(&group);
+    for (auto& uf : updateFkts) uf.locked.reset();
+
+    updateTimeouts( glutGet(GLUT_ELAPSED_TIME) );
+    updateJobs();
 }
 
 void VRCallbackManager::printCallbacks() {
     PLock lock(mtx);
     cout << "VRCallbackManager " << this << " t " << VRGlobals::CURRENT_FRAME << endl;
     cout << " update fkts (" << updateFktPtrs.size() << ")\n";
-    for (auto fl : updateFktPtrs) {
-        cout << "  prio " << fl.first << " (" << fl.second->size() << ")\n";
-        for (auto f : *fl.second) {
+    for (auto& fl : updateFktPtrs) {
+        cout << "  prio " << fl.first << " (" << fl.second.size() << ")\n";
+        for (auto f : fl.second) {
             auto sp = f.lock();
             if (sp) cout << "   fkt " << sp->getName() << endl;
         }
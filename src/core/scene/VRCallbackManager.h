@@ -4,11 +4,23 @@
 #include <OpenSG/OSGConfig.h>
 #include <map>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <boost/thread/recursive_mutex.hpp>
 #include "core/utils/VRFunctionFwd.h"
+#include "core/utils/VRMPSCQueue.h"
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
+
+/**
+    Registration (add/drop) is guarded by a mutex and only flags the dispatch lists as changed.
+    The dispatch lists are flat and priority sorted, they are rebuilt by updateCallbacks when flagged.
+    Jobs are queued lock free and may be queued from any thread.
+    Timeout callbacks are kept in a timer wheel with a resolution of one millisecond.
+*/
 
 class VRCallbackManager {
     private:
@@ -24,15 +36,42 @@ class VRCallbackManager {
             VRUpdateCbWeakPtr fktPtr;
             int timeout;
             int last_call;
+            int prio;
+        };
+
+        struct updateFkt {
+            VRUpdateCbWeakPtr fktPtr;
+            VRUpdateCbPtr locked; // while the callback runs
+            int prio;
+            bool threadSafe;
         };
 
-        bool updateListsChanged;
-        map<VRFunction<int>* , job> jobFktPtrs;
-        map<int, list<timeoutFkt>* > timeoutFktPtrs;
-        map<int, list<VRUpdateCbWeakPtr>* > updateFktPtrs;
-        map<int, list<VRUpdateCbWeakPtr>* >::reverse_iterator fktPtr_list_itr;
-        list<VRUpdateCbWeakPtr>::iterator fktPtr_itr;
+        typedef shared_ptr<timeoutFkt> timeoutFktPtr;
+        static const int wheelSize = 1024;
+
+        // registration, guarded by mtx
+        boost::recursive_mutex mtx;
+        atomic<bool> updateListsChanged;
+        map<int, list<timeoutFktPtr> > timeoutFktPtrs;
+        map<int, list<VRUpdateCbWeakPtr> > updateFktPtrs;
         map<VRFunction<int>* , int> updateFktPtrs_priorities;//to easier delete functions
+        map<int, bool> threadSafePriorities;
+
+        // dispatch, only used by the thread calling updateCallbacks
+        vector<updateFkt> updateFkts;
+        vector< vector<timeoutFktPtr> > wheel;
+        int wheelTime = -1;
+        vector<timeoutFktPtr> dueTimeouts;
+        VRMPSCQueue<job> jobQueue;
+        vector<job> jobs;
+        vector<job> delayedJobs;
+        unordered_map<VRFunction<int>*, int> jobIndex; // position of the pending jobs, kept in sync with jobs
+        atomic<bool> clearJobsFlag;
+
+        void rebuildLists();
+        void schedule(timeoutFktPtr t);
+        void updateTimeouts(int time);
+        void updateJobs();
 
     public:
         VRCallbackManager();
@@ -45,6 +84,9 @@ class VRCallbackManager {
         void dropUpdateFkt(VRUpdateCbWeakPtr f);
         void dropTimeoutFkt(VRUpdateCbWeakPtr f);
 
+        void setThreadSafePriority(int priority, bool b);
+        bool isThreadSafePriority(int priority);
+
         void clearJobs();
         void updateCallbacks();
         void printCallbacks();
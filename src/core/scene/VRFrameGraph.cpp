@@ -0,0 +1,120 @@
+#include "VRFrameGraph.h"
+#include "VRWorkPool.h"
+#include "core/utils/VRProfiler.h"
+
+#include <OpenSG/OSGBaseFunctions.h>
+#include <boost/bind.hpp>
+#include <chrono>
+#include <map>
+#include <iostream>
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+VRFrameGraph::VRFrameGraph() {}
+VRFrameGraph::~VRFrameGraph() {}
+
+void VRFrameGraph::addStage(string name, Fkt fkt, vector<string> reads, vector<string> writes, bool threadSafe, VRGlobals::FPS* stat) {
+    Stage s;
+    s.name = name;
+    s.fkt = fkt;
+    s.reads = reads;
+    s.writes = writes;
+    s.threadSafe = threadSafe;
+    s.stat = stat;
+    stages.push_back(s);
+    compiled = false;
+}
+
+void VRFrameGraph::setThreadSafe(string name, bool b) {
+    for (auto& s : stages) if (s.name == name) s.threadSafe = b;
+}
+
+void VRFrameGraph::setActive(string name, bool b) {
+    for (auto& s : stages) if (s.name == name) s.active = b;
+}
+
+int VRFrameGraph::getStageTime(string name) {
+    for (auto& s : stages) if (s.name == name) return s.ms;
+    return 0;
+}
+
+void VRFrameGraph::setTargetRate(int fps) { targetRate = max(fps,0); }
+int VRFrameGraph::getTargetRate() { return targetRate; }
+
+bool VRFrameGraph::conflicts(Stage& a, Stage& b) {
+    auto overlap = [](vector<string>& v1, vector<string>& v2) {
+        for (auto& r1 : v1) for (auto& r2 : v2) if (r1 == r2) return true;
+        return false;
+    };
+    return overlap(a.writes, b.reads) || overlap(a.writes, b.writes) || overlap(a.reads, b.writes);
+}
+
+void VRFrameGraph::compile() {
+    waves.clear();
+    vector<int> level(stages.size(), 0);
+    for (unsigned int i=0; i<stages.size(); i++) {
+        stages[i].deps.clear();
+        for (unsigned int j=0; j<i; j++) {
+            if (!conflicts(stages[j], stages[i])) continue;
+            stages[i].deps.push_back(j);
+            level[i] = max(level[i], level[j]+1);
+        }
+        if (level[i] >= (int)waves.size()) waves.resize(level[i]+1);
+        waves[level[i]].push_back(i);
+    }
+    compiled = true;
+}
+
+void VRFrameGraph::runStage(int i) {
+    auto& s = stages[i];
+    VRPROFILE_SCOPE(s.name);
+    auto t0 = chrono::steady_clock::now();
+    if (s.fkt) s.fkt();
+    auto t1 = chrono::steady_clock::now();
+    s.ms = chrono::duration_cast<chrono::milliseconds>(t1-t0).count();
+}
+
+void VRFrameGraph::execute() {
+    frameTimer.start();
+    if (!compiled) compile();
+
+    auto pool = VRWorkPool::get();
+    for (auto& wave : waves) {
+        VRWorkPool::Group group;
+        for (int i : wave) {
+            if (!stages[i].active || !stages[i].threadSafe) continue;
+            pool->push( boost::bind(&VRFrameGraph::runStage, this, i), &group );
+        }
+        for (int i : wave) {
+            if (!stages[i].active || stages[i].threadSafe) continue;
+            runStage(i);
+        }
+        pool->wait(&group);
+    }
+
+    map<VRGlobals::FPS*, int> stats;
+    for (auto& s : stages) if (s.stat && s.active) stats[s.stat] += s.ms;
+    for (auto s : stats) s.first->update(s.second);
+}
+
+int VRFrameGraph::pace() { // returns the time slept in ms
+    if (targetRate == 0) return 0;
+    int t = max(1000/targetRate - frameTimer.stop(), 0);
+    if (t > 0) osgSleep(t);
+    return t;
+}
+
+void VRFrameGraph::print() {
+    if (!compiled) compile();
+    cout << "VRFrameGraph, target rate: " << targetRate << endl;
+    for (unsigned int w=0; w<waves.size(); w++) {
+        cout << " wave " << w << endl;
+        for (int i : waves[w]) {
+            auto& s = stages[i];
+            cout << "  " << s.name << (s.threadSafe ? " (pool)" : "") << (s.active ? "" : " (inactive)") << " " << s.ms << " ms" << endl;
+        }
+    }
+}
+
+OSG_END_NAMESPACE;
@@ -0,0 +1,66 @@
+#ifndef VRFRAMEGRAPH_H_INCLUDED
+#define VRFRAMEGRAPH_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <boost/function.hpp>
+#include <vector>
+#include <string>
+#include "core/utils/VRGlobals.h"
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Per frame update stages with declared read and write sets.
+    Stages are grouped in waves, a stage depends on every earlier stage it shares a written resource with.
+    Thread safe stages of a wave run on the VRWorkPool, the others run in order on the calling thread.
+    The stage timings feed the VRGlobals frame rates, stages may share the same frame rate.
+*/
+
+class VRFrameGraph {
+    public:
+        typedef boost::function<void ()> Fkt;
+
+        struct Stage {
+            string name;
+            Fkt fkt;
+            vector<string> reads;
+            vector<string> writes;
+            bool threadSafe = false;
+            bool active = true;
+            VRGlobals::FPS* stat = 0;
+            int ms = 0;
+            vector<int> deps;
+        };
+
+    private:
+        vector<Stage> stages;
+        vector< vector<int> > waves;
+        bool compiled = false;
+        int targetRate = 60;
+        VRTimer frameTimer;
+
+        bool conflicts(Stage& a, Stage& b);
+        void compile();
+        void runStage(int i);
+
+    public:
+        VRFrameGraph();
+        ~VRFrameGraph();
+
+        void addStage(string name, Fkt fkt, vector<string> reads, vector<string> writes, bool threadSafe = false, VRGlobals::FPS* stat = 0);
+        void setThreadSafe(string name, bool b);
+        void setActive(string name, bool b);
+        int getStageTime(string name);
+
+        void setTargetRate(int fps);
+        int getTargetRate();
+
+        void execute();
+        int pace();
+        void print();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRFRAMEGRAPH_H_INCLUDED
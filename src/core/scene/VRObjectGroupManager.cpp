@@ -25,6 +25,8 @@ void VRObjectGroupManager::updateObjects() {
         if (auto sp = t.lock()) sp->update();
         // TODO: else: remove the t from dynamicObjects
     }
+
+    VRTransform::updateWorldMatrices();
 }
 
 VRObjectGroupManager::VRObjectGroupManager() {
@@ -16,6 +16,7 @@
 #include "core/objects/material/VRMaterial.h"
 #include "core/utils/VRGlobals.h"
 #include "core/utils/VRFunction.h"
+#include "core/utils/VRProfiler.h"
 #include "core/utils/VRVisualLayer.h"
 #include "VRThreadManager.h"
 #include "core/objects/geometry/VRPrimitive.h"
@@ -123,6 +124,7 @@ void VRPhysicsManager::updatePhysics( VRThreadWeakPtr wthread) {
             MLock lock(mtx);
             prepareObjects();
             for (auto f : updateFktsPre) (*f)(0);
+            VRPROFILE_SCOPE("physics step");
             dynamicsWorld->stepSimulation(1e-6*dt, 30);
             for (auto f : updateFktsPost) (*f)(0);
         }
@@ -1,5 +1,6 @@
 #include "VRSceneManager.h"
 #include "VRSceneLoader.h"
+#include "VRFrameGraph.h"
 #include "core/setup/VRSetup.h"
 #include "core/setup/windows/VRWindow.h"
 #include "core/utils/VRRate.h"
@@ -11,6 +12,7 @@
 #include "core/gui/VRGuiManager.h"
 #include "core/utils/VRTimer.h"
 #include "core/utils/VRGlobals.h"
+#include "core/utils/VROptions.h"
 #include "core/gui/VRGuiSignals.h"
 #include "core/gui/VRGuiFile.h"
 #include "addons/Semantics/Reasoning/VROntology.h"
@@ -31,10 +33,11 @@ VRSceneManager::VRSceneManager() {
     on_scene_close = VRSignal::create();
 
     VROntology::setupLibrary();
+    initFrameGraph();
     cout << " done" << endl;
 }
 
-VRSceneManager::~VRSceneManager() {}
+VRSceneManager::~VRSceneManager() { delete frameGraph; }
 
 void VRSceneManager::operator= (VRSceneManager v) {;}
 
@@ -190,51 +193,41 @@ void VRSceneManager::updateScene() {
     //current->allowScriptThreads();
 }
 
+void VRSceneManager::initFrameGraph() {
+    frameGraph = new VRFrameGraph();
+    frameGraph->setTargetRate( VROptions::get()->getOption<int>("frame_rate") );
+
+    auto gtk = [](){ VRGuiManager::get()->updateGtk(); };
+    auto tracking = [](){ if (auto setup = VRSetup::getCurrent()) setup->updateTracking(); };
+    auto devices = [](){ if (auto setup = VRSetup::getCurrent()) setup->updateDevices(); }; // device beacon update
+    auto windows = [](){ if (auto setup = VRSetup::getCurrent()) setup->updateWindows(); }; // rendering
+
+    frameGraph->addStage("gtk1", gtk, {}, {"gui"}, false, &VRGlobals::GTK1_FRAME_RATE);
+    frameGraph->addStage("callbacks", boost::bind(&VRSceneManager::updateCallbacks, this), {"gui"}, {"scene"}, false, &VRGlobals::SMCALLBACKS_FRAME_RATE);
+    frameGraph->addStage("tracking", tracking, {"scene"}, {"tracking"}, false, &VRGlobals::SETUP_FRAME_RATE);
+    frameGraph->addStage("devices", devices, {"tracking"}, {"scene"}, false, &VRGlobals::SETUP_FRAME_RATE);
+    frameGraph->addStage("scene", boost::bind(&VRSceneManager::updateScene, this), {"gui", "tracking"}, {"scene"}, false, &VRGlobals::SCRIPTS_FRAME_RATE);
+    frameGraph->addStage("windows", windows, {"scene"}, {"framebuffer"}, false, &VRGlobals::WINDOWS_FRAME_RATE);
+    frameGraph->addStage("gtk2", gtk, {"framebuffer"}, {"gui"}, false, &VRGlobals::GTK2_FRAME_RATE);
+}
+
+VRFrameGraph* VRSceneManager::getFrameGraph() { return frameGraph; }
+void VRSceneManager::setTargetFrameRate(int fps) { frameGraph->setTargetRate(fps); }
+
 void VRSceneManager::update() {
     // statistics
     VRProfiler::get()->swap();
     static VRRate FPS; int fps = FPS.getRate();
-    VRTimer timer; timer.start();
 
-    // update GUI
     if (current) current->blockScriptThreads();
-
-    VRTimer t1; t1.start();
-    VRGuiManager::get()->updateGtk();
-    VRGlobals::GTK1_FRAME_RATE.update(t1);
-
-    VRTimer t4; t4.start();
-    updateCallbacks();
-    VRGlobals::SMCALLBACKS_FRAME_RATE.update(t4);
-
-    VRTimer t5; t5.start();
-    auto setup = VRSetup::getCurrent();
-    if (setup) setup->updateTracking(); // tracking
-    if (setup) setup->updateDevices(); // device beacon update
-    VRGlobals::SMCALLBACKS_FRAME_RATE.update(t5);
-
-    VRTimer t6; t6.start();
-    updateScene();
-    VRGlobals::SCRIPTS_FRAME_RATE.update(t6);
-
-    if (setup) {
-        VRTimer t2; t2.start();
-        setup->updateWindows(); //rendering
-        VRGlobals::WINDOWS_FRAME_RATE.update(t2);
-    }
-
-    VRTimer t3; t3.start();
-    VRGuiManager::get()->updateGtk();
-    VRGlobals::GTK2_FRAME_RATE.update(t3);
-
+    frameGraph->execute();
     if (current) current->allowScriptThreads();
 
-
     // statistics
     VRGlobals::CURRENT_FRAME++;
     VRGlobals::FRAME_RATE.fps = fps;
     VRTimer t7; t7.start();
-    osgSleep(max(16-timer.stop(),0));
+    frameGraph->pace();
     VRGlobals::SLEEP_FRAME_RATE.update(t7);
 }
 
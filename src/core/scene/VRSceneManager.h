@@ -11,6 +11,7 @@ OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 void glutUpdate();
+class VRFrameGraph;
 
 class VRSceneManager : public VRThreadManager, public VRCallbackManager, public VRNetworkManager {
     private:
@@ -20,11 +21,13 @@ class VRSceneManager : public VRThreadManager, public VRCallbackManager, public
         string original_workdir;
         VRSignalPtr on_scene_load = 0;
         VRSignalPtr on_scene_close = 0;
+        VRFrameGraph* frameGraph = 0;
 
         VRSceneManager();
         void operator= (VRSceneManager v);
 
         void searchExercisesAndFavorites();
+        void initFrameGraph();
 
     public:
         static VRSceneManager* get();
@@ -50,6 +53,9 @@ class VRSceneManager : public VRThreadManager, public VRCallbackManager, public
 
         VRScenePtr getCurrent();
 
+        VRFrameGraph* getFrameGraph();
+        void setTargetFrameRate(int fps);
+
         void updateScene();
         void update();
 };
@@ -1,5 +1,6 @@
 #include "VRThreadManager.h"
 #include "core/utils/VRFunction.h"
+#include "core/utils/VRProfiler.h"
 
 #include <boost/thread/thread.hpp>
 //#include <boost/thread.hpp>
@@ -27,6 +28,7 @@ void VRThreadManager::runLoop(VRThreadWeakPtr wt) {
 
     t->osg_t = tr;
     t->status = 1;
+    VRProfiler::get()->setThreadName(t->name);
 
     do if (t = wt.lock()) if (auto f = t->fkt.lock()) (*f)(t);
     while(t->control_flag);
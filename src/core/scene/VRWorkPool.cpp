@@ -0,0 +1,151 @@
+#include "VRWorkPool.h"
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <OpenSG/OSGThread.h>
+#include <OpenSG/OSGThreadManager.h>
+#include <iostream>
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+typedef boost::mutex::scoped_lock PLock;
+
+VRWorkPool::VRWorkPool(int N) {
+    queued = 0;
+    next = 0;
+    running = true;
+    if (N <= 0) N = max(int(boost::thread::hardware_concurrency())-1, 1);
+    for (int i=0; i<N; i++) workers.push_back(new Worker());
+    for (int i=0; i<N; i++) workers[i]->thread = new boost::thread(boost::bind(&VRWorkPool::work, this, i));
+}
+
+VRWorkPool::~VRWorkPool() {
+    {
+        PLock lock(idleMtx);
+        running = false;
+    }
+    idle.notify_all();
+    for (auto w : workers) {
+        w->thread->join();
+        delete w->thread;
+        delete w;
+    }
+}
+
+VRWorkPool* VRWorkPool::get() {
+    static VRWorkPool* pool = new VRWorkPool();
+    return pool;
+}
+
+int VRWorkPool::size() { return workers.size(); }
+
+void VRWorkPool::push(Task t, Group* g) {
+    Job j;
+    j.task = t;
+    j.group = g;
+    if (g) g->pending++; // before the job is visible, the group is never done while it waits in a deque
+
+    auto w = workers[next++ % workers.size()];
+    {
+        PLock lock(w->mtx);
+        w->jobs.push_back(j);
+    }
+
+    if (g) {
+        {
+            PLock lock(doneMtx);
+            g->queued++;
+        }
+        done.notify_all(); // a thread waiting on the group helps with the new job
+    }
+
+    {
+        PLock lock(idleMtx);
+        queued++;
+    }
+    idle.notify_one();
+}
+
+void VRWorkPool::taken(Job& j) {
+    queued--;
+    if (j.group) j.group->queued--;
+}
+
+bool VRWorkPool::pop(int i, Job& j) {
+    auto w = workers[i];
+    PLock lock(w->mtx);
+    if (w->jobs.size() == 0) return false;
+    j = w->jobs.back();
+    w->jobs.pop_back();
+    taken(j);
+    return true;
+}
+
+bool VRWorkPool::steal(int i, Job& j) {
+    int N = workers.size();
+    for (int k=1; k<=N; k++) {
+        auto w = workers[(i+k)%N];
+        PLock lock(w->mtx);
+        if (w->jobs.size() == 0) continue;
+        j = w->jobs.front();
+        w->jobs.pop_front();
+        taken(j);
+        return true;
+    }
+    return false;
+}
+
+bool VRWorkPool::take(Group* g, Job& j) { // oldest job of the group
+    if (g->queued == 0) return false;
+    for (auto w : workers) {
+        PLock lock(w->mtx);
+        for (auto i = w->jobs.begin(); i != w->jobs.end(); i++) {
+            if (i->group != g) continue;
+            j = *i;
+            w->jobs.erase(i);
+            taken(j);
+            return true;
+        }
+    }
+    return false;
+}
+
+void VRWorkPool::run(Job& j) {
+    try { j.task(); }
+    catch (exception& e) { cout << "VRWorkPool task failed: " << e.what() << endl; }
+    j.task = 0;
+
+    if (!j.group) return;
+    {
+        PLock lock(doneMtx);
+        j.group->pending--; // the waiting thread may destroy the group once the lock is released
+    }
+    done.notify_all();
+}
+
+void VRWorkPool::work(int i) {
+    ExternalThreadRefPtr osg_t = ExternalThread::create(("workpool" + to_string(i)).c_str(), 0);
+    osg_t->initialize(0);
+
+    Job j;
+    while (running) {
+        if (pop(i, j) || steal(i, j)) { run(j); continue; }
+        PLock lock(idleMtx);
+        while (running && queued == 0) idle.wait(lock);
+    }
+}
+
+void VRWorkPool::wait(Group* g) { // the waiting thread only helps with the jobs of its group
+    if (!g) return;
+    Job j;
+    while (true) {
+        if (take(g, j)) { run(j); continue; }
+        PLock lock(doneMtx);
+        if (g->pending == 0) return;
+        if (g->queued > 0) continue;
+        done.wait(lock);
+    }
+}
+
+OSG_END_NAMESPACE;
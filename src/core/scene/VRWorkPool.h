@@ -0,0 +1,75 @@
+#ifndef VRWORKPOOL_H_INCLUDED
+#define VRWORKPOOL_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <deque>
+#include <vector>
+#include <atomic>
+
+namespace boost{ class thread; }
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Work stealing thread pool, each worker owns a task deque and steals from the others when idle.
+    Tasks are pushed into a group, the thread calling wait(group) helps processing the tasks of that group until they are done,
+    tasks of other groups, like long running loaders, never block it.
+    Tasks must not modify the scenegraph, the workers share aspect 0 with the main thread and their changes are never committed.
+*/
+
+class VRWorkPool {
+    public:
+        typedef boost::function<void ()> Task;
+
+        struct Group { // latch over the tasks pushed into it, has to outlive them
+            atomic<int> pending;
+            atomic<int> queued;
+            Group() { pending = 0; queued = 0; }
+        };
+
+    private:
+        struct Job {
+            Task task;
+            Group* group = 0;
+        };
+
+        struct Worker {
+            deque<Job> jobs;
+            boost::mutex mtx;
+            boost::thread* thread = 0;
+        };
+
+        vector<Worker*> workers;
+        boost::mutex idleMtx;
+        boost::condition_variable idle;
+        boost::mutex doneMtx;
+        boost::condition_variable done;
+        atomic<int> queued;
+        atomic<unsigned int> next;
+        atomic<bool> running;
+
+        bool pop(int i, Job& j);
+        bool steal(int i, Job& j);
+        bool take(Group* g, Job& j);
+        void taken(Job& j);
+        void run(Job& j);
+        void work(int i);
+
+    public:
+        VRWorkPool(int N = 0);
+        ~VRWorkPool();
+
+        static VRWorkPool* get();
+
+        int size();
+        void push(Task t, Group* g = 0);
+        void wait(Group* g);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRWORKPOOL_H_INCLUDED
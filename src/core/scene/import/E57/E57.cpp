@@ -1,89 +1,279 @@
 #include "E57.h"
 
 #include <iostream>
+#include <unordered_set>
+#include <atomic>
+#include <omp.h>
+#include <boost/thread/mutex.hpp>
 #include "E57Foundation.h"
 #include "core/objects/geometry/VRGeometry.h"
-#include "core/objects/geometry/VRGeoData.h"
+#include "core/objects/geometry/VRPointCloud.h"
+#include "core/objects/material/VRMaterial.h"
+#include "core/utils/VRProgress.h"
+#include "core/utils/toString.h"
 
 using namespace e57;
 using namespace std;
 using namespace OSG;
 
-void OSG::loadE57(string path, VRTransformPtr res) {
-    res->setName(path);
+namespace {
+    boost::mutex imageFileMutex; // opening and closing image files is not thread safe (xerces init)
 
-    try {
-        ImageFile imf(path, "r"); // Read file from disk
+    struct ScanInfo {
+        int ID = 0;
+        int64_t N = 0;
+        string name;
+        bool hasCol = false;
+        bool hasInvalid = false;
+        bool hasBounds = false;
+        float colScale = 1.0/255;
+        Matrix pose;
+        Vec3f min, max;
+    };
 
-        StructureNode root = imf.root();
-        if (!root.isDefined("/data3D")) { cout << "File doesn't contain 3D images" << endl; return; }
+    struct E57Options {
+        float voxel = 0; // voxel size of the decimation, 0 to keep all points
+        bool lod = false; // out of core octree point cloud
+        int chunk = 1<<20; // points per lod chunk
+        float distance = 10; // lod load distance
 
-        e57::Node n = root.get("/data3D");
-        if (n.type() != E57_VECTOR) { cout << "bad file" << endl; return; }
+        E57Options(string opts) {
+            for (auto o : splitString(opts, ' ')) {
+                auto kv = splitString(o, '=');
+                if (kv.size() == 0) continue;
+                if (kv[0] == "lod") lod = true;
+                if (kv.size() < 2) continue;
+                if (kv[0] == "voxel") voxel = toFloat(kv[1]);
+                if (kv[0] == "chunk") chunk = toInt(kv[1]);
+                if (kv[0] == "distance") distance = toFloat(kv[1]);
+            }
+        }
+    };
 
-        VectorNode data3D(n);
-        int64_t scanCount = data3D.childCount(); // number of scans in file
+    /** keeps the first point of each voxel, the voxel keys are sharded to reduce lock contention **/
+    struct VoxelFilter {
+        static const int Nshards = 64;
+        float size = 0;
+        unordered_set<uint64_t> shards[Nshards];
+        boost::mutex locks[Nshards];
 
-        /// For each scan, print out first 4 points in either Cartesian or Spherical coordinates.
-        for (int i = 0; i < scanCount; i++) {
-            StructureNode scan(data3D.get(i));
-            string sname = scan.pathName();
+        VoxelFilter(float s) : size(s) {}
+
+        bool insert(float x, float y, float z) {
+            uint64_t kx = int64_t(floor(x/size)) & 0x1fffff;
+            uint64_t ky = int64_t(floor(y/size)) & 0x1fffff;
+            uint64_t kz = int64_t(floor(z/size)) & 0x1fffff;
+            uint64_t k = kx | ky << 21 | kz << 42;
+            int s = (kx ^ ky*31 ^ kz*977) % Nshards;
+            boost::mutex::scoped_lock lock(locks[s]);
+            return shards[s].insert(k).second;
+        }
+    };
+
+    double getNumber(StructureNode& s, string path, double def) {
+        if (!s.isDefined(path)) return def;
+        e57::Node n = s.get(path);
+        if (n.type() == E57_INTEGER) return IntegerNode(n).value();
+        if (n.type() == E57_SCALED_INTEGER) return ScaledIntegerNode(n).scaledValue();
+        if (n.type() == E57_FLOAT) return FloatNode(n).value();
+        return def;
+    }
+
+    ScanInfo getScanInfo(VectorNode& data3D, int i) {
+        ScanInfo info;
+        info.ID = i;
+        StructureNode scan(data3D.get(i));
+        CompressedVectorNode points( scan.get("points") );
+        StructureNode proto(points.prototype());
+        info.N = points.childCount();
+        info.name = points.pathName();
+        info.hasCol = (proto.isDefined("colorRed") && proto.isDefined("colorGreen") && proto.isDefined("colorBlue"));
+        info.hasInvalid = proto.isDefined("cartesianInvalidState");
+        info.colScale = 1.0/max(getNumber(scan, "colorLimits/colorRedMaximum", 255), 1.0);
 
+        if (scan.isDefined("pose")) {
+            Quaternion q(getNumber(scan, "pose/rotation/x", 0), getNumber(scan, "pose/rotation/y", 0), getNumber(scan, "pose/rotation/z", 0), getNumber(scan, "pose/rotation/w", 1));
+            Vec3f t(getNumber(scan, "pose/translation/x", 0), getNumber(scan, "pose/translation/y", 0), getNumber(scan, "pose/translation/z", 0));
+            info.pose.setTransform(t, q);
+        }
+
+        if (scan.isDefined("cartesianBounds")) { // transform the local bounds into the file frame
+            Vec3f a(getNumber(scan, "cartesianBounds/xMinimum", 0), getNumber(scan, "cartesianBounds/yMinimum", 0), getNumber(scan, "cartesianBounds/zMinimum", 0));
+            Vec3f b(getNumber(scan, "cartesianBounds/xMaximum", 0), getNumber(scan, "cartesianBounds/yMaximum", 0), getNumber(scan, "cartesianBounds/zMaximum", 0));
+            for (int k=0; k<8; k++) {
+                Pnt3f c(k&1 ? b[0] : a[0], k&2 ? b[1] : a[1], k&4 ? b[2] : a[2]);
+                info.pose.mult(c, c);
+                for (int j=0; j<3; j++) {
+                    info.min[j] = k ? min(info.min[j], c[j]) : c[j];
+                    info.max[j] = k ? max(info.max[j], c[j]) : c[j];
+                }
+            }
+            info.hasBounds = true;
+        }
+        return info;
+    }
+
+    /** decodes a scan in large batches, f(points, N, Nread) is called for every batch of N valid out of Nread points **/
+    template<class F>
+    void readScan(string path, const ScanInfo& info, bool colors, F f) {
+        ImageFile* imf = 0;
+        try {
+            boost::mutex::scoped_lock lock(imageFileMutex);
+            imf = new ImageFile(path, "r");
+        }
+        catch (E57Exception& ex) { ex.report(__FILE__, __LINE__, __FUNCTION__); return; }
+
+        try {
+            VectorNode data3D(imf->root().get("/data3D"));
+            StructureNode scan(data3D.get(info.ID));
             CompressedVectorNode points( scan.get("points") );
-            string pname = points.pathName();
-            auto cN = points.childCount();
-            cout << "Got " << cN << " points\n";
-
-            /// Call subroutine in this file to print the points
-            /// Need to figure out if has Cartesian or spherical coordinate system.
-            /// Interrogate the CompressedVector's prototype of its records.
-            StructureNode proto(points.prototype());
-            bool hasPos = (proto.isDefined("cartesianX") && proto.isDefined("cartesianY") && proto.isDefined("cartesianZ"));
-            bool hasCol = (proto.isDefined("colorRed") && proto.isDefined("colorGreen") && proto.isDefined("colorBlue"));
-            if (!hasPos) continue;
-
-            VRGeoData data;
+
+            const int N = 1<<16;
+            vector<float> x(N), y(N), z(N), r(N), g(N), b(N);
+            vector<int8_t> invalid(N, 0);
+            vector<VRPointCloud::Point> batch(N);
             vector<SourceDestBuffer> destBuffers;
-            const int N = 4;
-            double x[N]; destBuffers.push_back(SourceDestBuffer(imf, "cartesianX", x, N, true));
-            double y[N]; destBuffers.push_back(SourceDestBuffer(imf, "cartesianY", y, N, true));
-            double z[N]; destBuffers.push_back(SourceDestBuffer(imf, "cartesianZ", z, N, true));
-            double r[N];
-            double g[N];
-            double b[N];
-            if (hasCol) {
-                destBuffers.push_back(SourceDestBuffer(imf, "colorRed", r, N, true));
-                destBuffers.push_back(SourceDestBuffer(imf, "colorGreen", g, N, true));
-                destBuffers.push_back(SourceDestBuffer(imf, "colorBlue", b, N, true));
+            destBuffers.push_back(SourceDestBuffer(*imf, "cartesianX", &x[0], N, true, true));
+            destBuffers.push_back(SourceDestBuffer(*imf, "cartesianY", &y[0], N, true, true));
+            destBuffers.push_back(SourceDestBuffer(*imf, "cartesianZ", &z[0], N, true, true));
+            if (info.hasInvalid) destBuffers.push_back(SourceDestBuffer(*imf, "cartesianInvalidState", &invalid[0], N, true));
+            if (info.hasCol && colors) {
+                destBuffers.push_back(SourceDestBuffer(*imf, "colorRed", &r[0], N, true, true));
+                destBuffers.push_back(SourceDestBuffer(*imf, "colorGreen", &g[0], N, true, true));
+                destBuffers.push_back(SourceDestBuffer(*imf, "colorBlue", &b[0], N, true, true));
             }
 
-            unsigned int gotCount = 0;
             CompressedVectorReader reader = points.reader(destBuffers);
-            do {
-                gotCount = reader.read();
-                for (unsigned j=0; j < gotCount; j++) {
-                    int v;
-                    if (hasCol) v = data.pushVert(Pnt3f(x[j], y[j], z[j]), Vec3f(0,1,0), Vec3f(r[j]/255.0, g[j]/255.0, b[j]/255.0));
-                    else v = data.pushVert(Pnt3f(x[j], y[j], z[j]), Vec3f(0,1,0));
-                    data.pushPoint(v);
+            while (unsigned int gotCount = reader.read()) {
+                unsigned int k = 0;
+                for (unsigned int j=0; j<gotCount; j++) {
+                    if (invalid[j]) continue;
+                    Pnt3f p(x[j], y[j], z[j]);
+                    info.pose.mult(p, p);
+                    auto& v = batch[k++];
+                    v.x = p[0]; v.y = p[1]; v.z = p[2];
+                    if (info.hasCol && colors) {
+                        v.r = min(255.f, r[j]*info.colScale*255);
+                        v.g = min(255.f, g[j]*info.colScale*255);
+                        v.b = min(255.f, b[j]*info.colScale*255);
+                    } else v.r = v.g = v.b = 255;
+                    v.a = 255;
                 }
-            } while(gotCount);
+                f(&batch[0], k, gotCount);
+            }
             reader.close();
-
-            auto geo = data.asGeometry(pname);
-            res->addChild(geo);
         }
+        catch (E57Exception& ex) { ex.report(__FILE__, __LINE__, __FUNCTION__); }
+        catch (std::exception& ex) { cerr << "Got an std::exception, what=" << ex.what() << endl; }
+
+        boost::mutex::scoped_lock lock(imageFileMutex);
+        imf->close();
+        delete imf;
+    }
+}
 
+void OSG::loadE57(string path, VRTransformPtr res, string options) {
+    res->setName(path);
+    E57Options opts(options);
+
+    vector<ScanInfo> scans;
+    try {
+        boost::mutex::scoped_lock lock(imageFileMutex);
+        ImageFile imf(path, "r");
+        StructureNode root = imf.root();
+        if (!root.isDefined("/data3D")) { cout << "File doesn't contain 3D images" << endl; return; }
+
+        e57::Node n = root.get("/data3D");
+        if (n.type() != E57_VECTOR) { cout << "bad file" << endl; return; }
+
+        VectorNode data3D(n);
+        for (int i = 0; i < data3D.childCount(); i++) {
+            StructureNode scan(data3D.get(i));
+            StructureNode proto(CompressedVectorNode(scan.get("points")).prototype());
+            if (!proto.isDefined("cartesianX") || !proto.isDefined("cartesianY") || !proto.isDefined("cartesianZ")) continue;
+            scans.push_back( getScanInfo(data3D, i) );
+        }
         imf.close();
     }
     catch (E57Exception& ex) { ex.report(__FILE__, __LINE__, __FUNCTION__); return; }
     catch (std::exception& ex) { cerr << "Got an std::exception, what=" << ex.what() << endl; return; }
     catch (...) { cerr << "Got an unknown exception" << endl; return; }
-}
 
-//void writeE57(VRGeometryPtr geo, string path);
+    int64_t Ntotal = 0;
+    for (auto& s : scans) Ntotal += s.N;
+    cout << "loadE57: " << scans.size() << " scans with " << Ntotal << " points\n";
 
+    shared_ptr<VoxelFilter> filter;
+    if (opts.voxel > 0) filter = shared_ptr<VoxelFilter>( new VoxelFilter(opts.voxel) );
 
+    VRPointCloudPtr cloud;
+    if (opts.lod) {
+        Vec3f mi, ma;
+        bool hasBounds = true;
+        for (auto& s : scans) hasBounds = hasBounds && s.hasBounds;
 
+        VRProgress boundsProgress("E57 bounds " + path, Ntotal);
+        for (unsigned int i=0; i<scans.size(); i++) {
+            auto& s = scans[i];
+            if (!hasBounds) { // no bounds in the header, requires an extra pass over the positions
+                s.min = Vec3f(1e30, 1e30, 1e30);
+                s.max = -s.min;
+                readScan(path, s, false, [&](VRPointCloud::Point* p, unsigned int N, unsigned int Nread) {
+                    for (unsigned int j=0; j<N; j++) {
+                        s.min = Vec3f(min(s.min[0], p[j].x), min(s.min[1], p[j].y), min(s.min[2], p[j].z));
+                        s.max = Vec3f(max(s.max[0], p[j].x), max(s.max[1], p[j].y), max(s.max[2], p[j].z));
+                    }
+                    boundsProgress.update(Nread);
+                });
+            }
+            for (int j=0; j<3; j++) {
+                mi[j] = i ? min(mi[j], s.min[j]) : s.min[j];
+                ma[j] = i ? max(ma[j], s.max[j]) : s.max[j];
+            }
+        }
+
+        cloud = VRPointCloud::create(path);
+        cloud->setLoadDistance(opts.distance);
+        cloud->setup(mi, ma, Ntotal, opts.chunk);
+    }
+
+    VRProgress progress("load E57 " + path, Ntotal);
+    vector< vector<VRPointCloud::Point> > scanPoints(scans.size());
+    atomic<size_t> read(0);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i=0; i<(int)scans.size(); i++) {
+        auto& points = scanPoints[i];
+        if (!cloud) points.reserve(filter ? scans[i].N/8 : scans[i].N);
+
+        readScan(path, scans[i], true, [&](VRPointCloud::Point* p, unsigned int N, unsigned int Nread) {
+            if (filter) {
+                unsigned int k = 0;
+                for (unsigned int j=0; j<N; j++) if (filter->insert(p[j].x, p[j].y, p[j].z)) p[k++] = p[j];
+                N = k;
+            }
+            if (cloud) cloud->addPoints(p, N);
+            else points.insert(points.end(), p, p+N);
+            read += Nread;
+            if (omp_get_thread_num() == 0) progress.update(read.exchange(0)); // only the calling thread reports
+        });
+    }
+    progress.update(read.exchange(0));
+    progress.finish();
 
+    if (cloud) {
+        cloud->finish();
+        cout << "loadE57: " << cloud->getChunkCount() << " lod chunks\n";
+        res->addChild(cloud);
+        return;
+    }
 
+    for (unsigned int i=0; i<scans.size(); i++) {
+        auto& points = scanPoints[i];
+        auto geo = VRPointCloud::makeGeometry(scans[i].name, points.data(), points.size(), VRMaterial::getDefault(), true); // normals and material like the old import
+        vector<VRPointCloud::Point>().swap(points);
+        res->addChild(geo);
+    }
+}
+
+//void writeE57(VRGeometryPtr geo, string path);
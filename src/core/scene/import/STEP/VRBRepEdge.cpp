@@ -70,7 +70,7 @@ void VRBRepEdge::build(string type) {
 
         bool doWeights = (weights.size() == cpoints.size());
 
-        int res = (Ncurv - 1)*0.5;
+        int res = getResolution(cpoints);
         float T = knots[knots.size()-1] - knots[0];
         for (int i=0; i<=res; i++) {
             float t = i*T/res;
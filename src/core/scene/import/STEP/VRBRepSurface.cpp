@@ -25,9 +25,237 @@ struct triangle {
     }
 };
 
+bool VRBRepSurface::build(string type, Mesh& data) {
+    Matrix m;
+    if (trans) m = trans->asMatrix();
+    Matrix mI = m;
+    mI.invert();
+
+    if (type == "Plane") {
+        //return 0;
+        Triangulator t;
+        if (bounds.size() == 0) cout << "Warning: No bounds!\n";
+        for (auto b : bounds) {
+            //if (b.points.size() == 0) cout << "Warning: No bound points for bound " << b.BRepType << endl;
+            polygon poly;
+            for(auto p : b.points) {
+                mI.mult(Pnt3f(p),p);
+                poly.addPoint(Vec2f(p[0], p[1]));
+                //cout << Vec2f(p[0], p[1]) << endl;
+            }
+            if (!poly.isCCW()) poly.turn();
+            t.add(poly);
+        }
+
+        t.append(data.positions, data.normals, data.triangles, m);
+        return true;
+    }
+
+    if (type == "B_Spline_Surface") {
+
+        // ROADMAP
+        //  first idea:
+        //   - tesselate whole BSpline surface (lots of quads)
+        //   - keep uv map of the resulting mesh
+        //   - for each edge point:
+        //      - get nearest quad to point
+        //      - get UV koords of the point on that quad
+        //      - add point UV to polyline
+        //   - triangulate in UV space
+        //   - reuse first tesselation
+        //      - cut quads traversed by edges
+        //      - ignore quads outside of the triangulation
+
+
+        Vec3f n(0,0,1);
+        m.mult(n,n);
+
+        map<int, map<int, int> > ids;
+
+        int res = getResolution(cpoints);
+        float T = 1; //knots[knots.size()-1] - knots[0];
+        for (int i=0; i<=res; i++) {
+            float u = i*T/res;
+            for (int j=0; j<=res; j++) {
+                float v = j*T/res;
+                Pnt3f p = Pnt3f(BSpline(u,v, degu, degv, cpoints, knotsu, knotsv));
+                m.mult(p,p);
+                ids[i][j] = data.pushVert(p,n);
+
+                if (i > 0 && j%2 == 0) data.pushTri(ids[i][j], ids[i-1][j], ids[i-1][j+1]);
+                if (i > 0 && j%2 == 1) data.pushTri(ids[i][j], ids[i][j-1], ids[i-1][j]);
+            }
+        }
+
+
+        // feed the triangulator with unprojected points
+        /*Triangulator t;
+        for (auto b : bounds) {
+            polygon poly;
+            for(auto p : b.points) {
+                mI.mult(Pnt3f(p),p);
+                float u = p[0];
+                float v = p[1];
+                poly.addPoint(Vec2f(u, v));
+            }
+            if (!poly.isCCW()) poly.turn();
+            t.add(poly);
+        }
+        auto g = t.compute();*/
+
+        // tesselate the result while projecting it back on the surface
+        /*if (g) if (auto gg = g->getMesh()) {
+            TriangleIterator it;
+            VRGeoData nMesh;
+            Vec3f n(0,0,1);
+
+            auto checkOrder = [&](Pnt3f p0, Pnt3f p1, Pnt3f p2) {
+                float cp = (p1-p0).cross(p2-p0).dot(n);
+                return (cp >= 0);
+            };
+
+            auto pushTri = [&](Pnt3f p1, Pnt3f p2, Pnt3f p3) {
+                int a = nMesh.pushVert(p1,n);
+                int b = nMesh.pushVert(p2,n);
+                int c = nMesh.pushVert(p3,n);
+                if (checkOrder(p1,p2,p3)) nMesh.pushTri(a,b,c);
+                else nMesh.pushTri(a,c,b);
+            };
+
+            auto pushQuad = [&](Pnt3f p1, Pnt3f p2, Pnt3f p3, Pnt3f p4) {
+                int a = nMesh.pushVert(p1,n);
+                int b = nMesh.pushVert(p2,n);
+                int c = nMesh.pushVert(p3,n);
+                int d = nMesh.pushVert(p4,n);
+                if (checkOrder(p1,p2,p3)) nMesh.pushTri(a,b,c);
+                else nMesh.pushTri(a,c,b);
+                if (checkOrder(p2,p3,p4)) nMesh.pushTri(b,c,d);
+                else nMesh.pushTri(b,d,c);
+            };
+
+            for (it = TriangleIterator(gg); !it.isAtEnd() ;++it) {
+                triangle t(it);
+                if (t.A < 1e-6) continue; // ignore flat triangles
+
+                Vec3i pOrder(0,1,2); // get the order of the vertices
+                for (int i=0; i<3; i++) { // max 3 sort steps
+                    if (pSides[pOrder[0]] > pSides[pOrder[1]]) swap(pOrder[0], pOrder[1]);
+                    else if (pSides[pOrder[0]] > pSides[pOrder[2]]) swap(pOrder[0], pOrder[2]);
+                    else if (pSides[pOrder[1]] > pSides[pOrder[2]]) swap(pOrder[1], pOrder[2]);
+                }
+
+                if (pSides[0] == pSides[1] && pSides[0] == pSides[2]) {
+                    pushTri(t.p[0],t.p[1],t.p[2]);
+                    continue;
+                }
+
+                //cout << " unhandled triangle " << endl;
+            }
+
+            nMesh.apply(g);
+
+            // project the points back into 3D space
+            GeoVectorPropertyRecPtr pos = gg->getPositions();
+            GeoVectorPropertyRecPtr norms = gg->getNormals();
+            if (pos) {
+                for (int i=0; i<pos->size(); i++) {
+                    Pnt3f p = pos->getValue<Pnt3f>(i);
+                    Vec3f n = norms->getValue<Vec3f>(i);
+                    n = Vec3f(cos(p[0]), sin(p[0]), 0);
+
+                    Vec2f side = getSide(p[0]);
+                    Vec3f A = Vec3f(R*cos(side[0]), R*sin(side[0]), 0);
+                    Vec3f B = Vec3f(R*cos(side[1]), R*sin(side[1]), 0);
+                    Vec3f D = B-A;
+                    D.normalize();
+
+                    float t = (A[0]*D[1] - A[1]*D[0]) / (n[0]*D[1] - n[1]*D[0]);
+
+                    //cout << "p: " << p[0]/Pi*180 << " AB: " << side*(180/Pi) << " s: " << getSideN(p[0]) << endl;
+                    //if (p[0] < side[0] || p[0] > side[1]) cout << "   AAAH\n"; // TODO: check this out!
+
+                    p[2] = p[1];
+                    p[1] = n[1]*t;
+                    p[0] = n[0]*t;
+
+                    pos->setValue(p, i);
+                    norms->setValue(n, i);
+                }
+            }
+        }*/
+
+        return true;
+    }
+
+    if (type == "B_Spline_Surface_With_Knots") {
+        // ROADMAP
+        //  first idea:
+        //   - tesselate whole BSpline surface (lots of quads)
+        //   - keep uv map of the resulting mesh
+        //   - for each edge point:
+        //      - get nearest quad to point
+        //      - get UV koords of the point on that quad
+        //      - add point UV to polyline
+        //   - triangulate in UV space
+        //   - reuse first tesselation
+        //      - cut quads traversed by edges
+        //      - ignore quads outside of the triangulation
+
+        bool isWeighted = (weights.height == cpoints.height && weights.width == cpoints.width);
+
+        /*cout << "B_Spline_Surface_with_knots du " << degu << " dv " << degv << "  pw " << cpoints.width << " ph " << cpoints.height << endl;
+        cout << " knotsu ";
+        for (auto ku : knotsu) cout << " " << ku;
+        cout << endl;
+        cout << " knotsv ";
+        for (auto kv : knotsv) cout << " " << kv;
+        cout << endl;
+        cout << " points\n";
+        for (int i = 0; i < cpoints.height; i++) {
+            for (int j = 0; j < cpoints.width; j++) {
+                cout << " p" << j << i << ": " << cpoints.get(j,i);
+            }
+            cout << endl;
+        }*/
+
+        if (knotsu.size() == 0 || knotsv.size() == 0) return true;
+
+        // BSpline mesh
+        map<int, map<int, int> > ids;
+        int res = getResolution(cpoints);
+        float Tu = knotsu[knotsu.size()-1] - knotsu[0];
+        float Tv = knotsv[knotsv.size()-1] - knotsv[0];
+        for (int i=0; i<=res; i++) {
+            float u = knotsu[0]+i*Tu/res;
+            for (int j=0; j<=res; j++) {
+                float v = knotsv[0]+j*Tv/res;
+                Pnt3f p = Pnt3f(isWeighted ? BSpline(u,v, degu, degv, cpoints, knotsu, knotsv, weights) : BSpline(u,v, degu, degv, cpoints, knotsu, knotsv));
+                Vec3f n = isWeighted ? BSplineNorm(u,v, degu, degv, cpoints, knotsu, knotsv, weights) : BSplineNorm(u,v, degu, degv, cpoints, knotsu, knotsv);
+                m.mult(p,p);
+                m.mult(n,n);
+                ids[i][j] = data.pushVert(p,n);
+
+                if (i > 0 && j > 0) data.pushQuad(ids[i][j], ids[i][j-1], ids[i-1][j-1], ids[i-1][j]);
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
 VRGeometryPtr VRBRepSurface::build(string type) {
     //cout << "VRSTEP::Surface build " << type << endl;
 
+    Mesh mesh;
+    if (build(type, mesh)) {
+        if (mesh.positions.empty()) return 0;
+        VRGeoData data;
+        for (uint i=0; i<mesh.positions.size(); i++) data.pushVert(mesh.positions[i], mesh.normals[i]);
+        for (uint i=0; i+2<mesh.triangles.size(); i+=3) data.pushTri(mesh.triangles[i], mesh.triangles[i+1], mesh.triangles[i+2]);
+        return data.asGeometry(type);
+    }
+
     Matrix m;
     Vec3f d, u;
     if (trans) {
@@ -53,28 +281,6 @@ VRGeometryPtr VRBRepSurface::build(string type) {
         }
     };
 
-    if (type == "Plane") {
-        //return 0;
-        Triangulator t;
-        if (bounds.size() == 0) cout << "Warning: No bounds!\n";
-        for (auto b : bounds) {
-            //if (b.points.size() == 0) cout << "Warning: No bound points for bound " << b.BRepType << endl;
-            polygon poly;
-            for(auto p : b.points) {
-                mI.mult(Pnt3f(p),p);
-                poly.addPoint(Vec2f(p[0], p[1]));
-                //cout << Vec2f(p[0], p[1]) << endl;
-            }
-            if (!poly.isCCW()) poly.turn();
-            t.add(poly);
-        }
-
-        auto g = t.compute(); // TODO: check about g??
-        if (!g->getMesh()->geo->getPositions()) cout << "NO MESH!\n";
-        g->setMatrix(m);
-        return g;
-    }
-
     if (type == "Cylindrical_Surface") {
 
         static int i=0; i++;
@@ -505,207 +711,6 @@ VRGeometryPtr VRBRepSurface::build(string type) {
         return 0;
     }
 
-    if (type == "B_Spline_Surface") {
-        cout << " BUILD B_Spline_Surface" << endl;
-
-        // ROADMAP
-        //  first idea:
-        //   - tesselate whole BSpline surface (lots of quads)
-        //   - keep uv map of the resulting mesh
-        //   - for each edge point:
-        //      - get nearest quad to point
-        //      - get UV koords of the point on that quad
-        //      - add point UV to polyline
-        //   - triangulate in UV space
-        //   - reuse first tesselation
-        //      - cut quads traversed by edges
-        //      - ignore quads outside of the triangulation
-
-
-        Vec3f n(0,0,1);
-        VRGeoData nMesh;
-
-        map<int, map<int, int> > ids;
-
-        cout << "B_Spline_Surface du " << degu << " dv " << degv << "  pw " << cpoints.width << " ph " << cpoints.height << endl;
-
-        int res = (Ncurv - 1)*0.5;
-        float T = 1; //knots[knots.size()-1] - knots[0];
-        for (int i=0; i<=res; i++) {
-            float u = i*T/res;
-            for (int j=0; j<=res; j++) {
-                float v = j*T/res;
-                Vec3f p = BSpline(u,v, degu, degv, cpoints, knotsu, knotsv);
-                ids[i][j] = nMesh.pushVert(p,n);
-
-                if (i > 0 && j%2 == 0) nMesh.pushTri(ids[i][j], ids[i-1][j], ids[i-1][j+1]);
-                if (i > 0 && j%2 == 1) nMesh.pushTri(ids[i][j], ids[i][j-1], ids[i-1][j]);
-            }
-        }
-
-        auto g = nMesh.asGeometry("BSpline");
-
-
-        // feed the triangulator with unprojected points
-        /*Triangulator t;
-        for (auto b : bounds) {
-            polygon poly;
-            for(auto p : b.points) {
-                mI.mult(Pnt3f(p),p);
-                float u = p[0];
-                float v = p[1];
-                poly.addPoint(Vec2f(u, v));
-            }
-            if (!poly.isCCW()) poly.turn();
-            t.add(poly);
-        }
-        auto g = t.compute();*/
-
-        // tesselate the result while projecting it back on the surface
-        /*if (g) if (auto gg = g->getMesh()) {
-            TriangleIterator it;
-            VRGeoData nMesh;
-            Vec3f n(0,0,1);
-
-            auto checkOrder = [&](Pnt3f p0, Pnt3f p1, Pnt3f p2) {
-                float cp = (p1-p0).cross(p2-p0).dot(n);
-                return (cp >= 0);
-            };
-
-            auto pushTri = [&](Pnt3f p1, Pnt3f p2, Pnt3f p3) {
-                int a = nMesh.pushVert(p1,n);
-                int b = nMesh.pushVert(p2,n);
-                int c = nMesh.pushVert(p3,n);
-                if (checkOrder(p1,p2,p3)) nMesh.pushTri(a,b,c);
-                else nMesh.pushTri(a,c,b);
-            };
-
-            auto pushQuad = [&](Pnt3f p1, Pnt3f p2, Pnt3f p3, Pnt3f p4) {
-                int a = nMesh.pushVert(p1,n);
-                int b = nMesh.pushVert(p2,n);
-                int c = nMesh.pushVert(p3,n);
-                int d = nMesh.pushVert(p4,n);
-                if (checkOrder(p1,p2,p3)) nMesh.pushTri(a,b,c);
-                else nMesh.pushTri(a,c,b);
-                if (checkOrder(p2,p3,p4)) nMesh.pushTri(b,c,d);
-                else nMesh.pushTri(b,d,c);
-            };
-
-            for (it = TriangleIterator(gg); !it.isAtEnd() ;++it) {
-                triangle t(it);
-                if (t.A < 1e-6) continue; // ignore flat triangles
-
-                Vec3i pOrder(0,1,2); // get the order of the vertices
-                for (int i=0; i<3; i++) { // max 3 sort steps
-                    if (pSides[pOrder[0]] > pSides[pOrder[1]]) swap(pOrder[0], pOrder[1]);
-                    else if (pSides[pOrder[0]] > pSides[pOrder[2]]) swap(pOrder[0], pOrder[2]);
-                    else if (pSides[pOrder[1]] > pSides[pOrder[2]]) swap(pOrder[1], pOrder[2]);
-                }
-
-                if (pSides[0] == pSides[1] && pSides[0] == pSides[2]) {
-                    pushTri(t.p[0],t.p[1],t.p[2]);
-                    continue;
-                }
-
-                //cout << " unhandled triangle " << endl;
-            }
-
-            nMesh.apply(g);
-
-            // project the points back into 3D space
-            GeoVectorPropertyRecPtr pos = gg->getPositions();
-            GeoVectorPropertyRecPtr norms = gg->getNormals();
-            if (pos) {
-                for (int i=0; i<pos->size(); i++) {
-                    Pnt3f p = pos->getValue<Pnt3f>(i);
-                    Vec3f n = norms->getValue<Vec3f>(i);
-                    n = Vec3f(cos(p[0]), sin(p[0]), 0);
-
-                    Vec2f side = getSide(p[0]);
-                    Vec3f A = Vec3f(R*cos(side[0]), R*sin(side[0]), 0);
-                    Vec3f B = Vec3f(R*cos(side[1]), R*sin(side[1]), 0);
-                    Vec3f D = B-A;
-                    D.normalize();
-
-                    float t = (A[0]*D[1] - A[1]*D[0]) / (n[0]*D[1] - n[1]*D[0]);
-
-                    //cout << "p: " << p[0]/Pi*180 << " AB: " << side*(180/Pi) << " s: " << getSideN(p[0]) << endl;
-                    //if (p[0] < side[0] || p[0] > side[1]) cout << "   AAAH\n"; // TODO: check this out!
-
-                    p[2] = p[1];
-                    p[1] = n[1]*t;
-                    p[0] = n[0]*t;
-
-                    pos->setValue(p, i);
-                    norms->setValue(n, i);
-                }
-            }
-        }*/
-
-        if (g) g->setMatrix(m);
-        if (g && g->getMesh() && g->getMesh()->geo->getPositions() && g->getMesh()->geo->getPositions()->size() > 0) return g;
-        return 0;
-    }
-
-    if (type == "B_Spline_Surface_With_Knots") {
-        // ROADMAP
-        //  first idea:
-        //   - tesselate whole BSpline surface (lots of quads)
-        //   - keep uv map of the resulting mesh
-        //   - for each edge point:
-        //      - get nearest quad to point
-        //      - get UV koords of the point on that quad
-        //      - add point UV to polyline
-        //   - triangulate in UV space
-        //   - reuse first tesselation
-        //      - cut quads traversed by edges
-        //      - ignore quads outside of the triangulation
-
-        bool isWeighted = (weights.height == cpoints.height && weights.width == cpoints.width);
-
-        Vec3f n(0,0,1);
-        VRGeoData nMesh;
-
-        /*cout << "B_Spline_Surface_with_knots du " << degu << " dv " << degv << "  pw " << cpoints.width << " ph " << cpoints.height << endl;
-        cout << " knotsu ";
-        for (auto ku : knotsu) cout << " " << ku;
-        cout << endl;
-        cout << " knotsv ";
-        for (auto kv : knotsv) cout << " " << kv;
-        cout << endl;
-        cout << " points\n";
-        for (int i = 0; i < cpoints.height; i++) {
-            for (int j = 0; j < cpoints.width; j++) {
-                cout << " p" << j << i << ": " << cpoints.get(j,i);
-            }
-            cout << endl;
-        }*/
-
-        if (knotsu.size() == 0 || knotsv.size() == 0) return 0;
-
-        // BSpline mesh
-        map<int, map<int, int> > ids;
-        int res = (Ncurv - 1)*0.5;
-        float Tu = knotsu[knotsu.size()-1] - knotsu[0];
-        float Tv = knotsv[knotsv.size()-1] - knotsv[0];
-        for (int i=0; i<=res; i++) {
-            float u = knotsu[0]+i*Tu/res;
-            for (int j=0; j<=res; j++) {
-                float v = knotsv[0]+j*Tv/res;
-                Vec3f p = isWeighted ? BSpline(u,v, degu, degv, cpoints, knotsu, knotsv, weights) : BSpline(u,v, degu, degv, cpoints, knotsu, knotsv);
-                Vec3f n = isWeighted ? BSplineNorm(u,v, degu, degv, cpoints, knotsu, knotsv, weights) : BSplineNorm(u,v, degu, degv, cpoints, knotsu, knotsv);
-                ids[i][j] = nMesh.pushVert(p,n);
-
-                if (i > 0 && j > 0) nMesh.pushQuad(ids[i][j], ids[i][j-1], ids[i-1][j-1], ids[i-1][j]);
-            }
-        }
-
-        auto g = nMesh.asGeometry("BSpline");
-        if (g) g->setMatrix(m);
-        if (g && g->getMesh() && g->getMesh()->geo->getPositions() && g->getMesh()->geo->getPositions()->size() > 0) return g;
-        return 0;
-    }
-
     cout << "VRBRepSurface::build Error: unhandled surface type " << type << endl;
 
     // wireframe
@@ -13,6 +13,16 @@ OSG_BEGIN_NAMESPACE;
 
 class VRBRepSurface : public VRBRepUtils {
     public:
+        struct Mesh { // plain vectors for the worker threads, the loading thread copies them into OpenSG properties
+            vector<Pnt3f> positions;
+            vector<Vec3f> normals;
+            vector<int> triangles;
+
+            int pushVert(Pnt3f p, Vec3f n) { positions.push_back(p); normals.push_back(n); return positions.size()-1; }
+            void pushTri(int a, int b, int c) { triangles.push_back(a); triangles.push_back(b); triangles.push_back(c); }
+            void pushQuad(int a, int b, int c, int d) { pushTri(a, b, c); pushTri(a, c, d); }
+        };
+
         vector<VRBRepBound> bounds;
         posePtr trans;
         double R = 1;
@@ -28,6 +38,7 @@ class VRBRepSurface : public VRBRepUtils {
         VRBRepSurface();
 
         VRGeometryPtr build(string type);
+        bool build(string type, Mesh& data); // appends the face mesh, returns false if the type needs build(type)
 };
 
 OSG_END_NAMESPACE;
@@ -2,11 +2,54 @@
 
 using namespace OSG;
 
-const float VRBRepUtils::Dangle = 2*Pi/(VRBRepUtils::Ncurv-1);
-vector<float> VRBRepUtils::Adict;
+VRBRepUtils::VRBRepUtils() { Dangle = 2*Pi/(Ncurv-1); }
+
+/** angular tolerance in radians, sets the segments of circles and cylinders, set before building **/
+void VRBRepUtils::setTolerance(float chordal, float angular) {
+    chordTolerance = max(chordal, 0.f);
+    if (angular > 0) {
+        int N = ceil(2*Pi/angular);
+        N = max(4, (N+3)/4*4); // multiple of 4, the sides of the quadrants have to match
+        Ncurv = N+1;
+        Dangle = 2*Pi/N;
+    }
+}
+
+void VRBRepUtils::setTolerance(const VRBRepUtils& u) {
+    chordTolerance = u.chordTolerance;
+    Ncurv = u.Ncurv;
+    Dangle = u.Dangle;
+}
 
-VRBRepUtils::VRBRepUtils() {
-    for (int i=0; i<Ncurv; i++) Adict.push_back(Dangle*i);
+/**
+    Number of segments of a spline with the given control polygon.
+    The deviation of a segment from its chord is bounded by the second differences of the control points,
+    with a chordal tolerance the resolution is the smallest one that keeps the deviation below the tolerance.
+**/
+int VRBRepUtils::getResolution(const vector<Vec3f>& cp) {
+    int res = (Ncurv - 1)*0.5;
+    if (chordTolerance <= 0 || cp.size() < 3) return res;
+    float D = 0;
+    for (uint i=1; i+1<cp.size(); i++) D = max(D, (cp[i+1] - cp[i]*2 + cp[i-1]).length());
+    int N = cp.size()-1;
+    res = ceil( N*sqrt(D/(8*chordTolerance)) );
+    return max(1, min(res, 128));
+}
+
+int VRBRepUtils::getResolution(const field<Vec3f>& cp) {
+    if (chordTolerance <= 0) return (Ncurv - 1)*0.5;
+    int res = 1;
+    for (int i=0; i<cp.height; i++) {
+        vector<Vec3f> row;
+        for (int j=0; j<cp.width; j++) row.push_back(cp.get(j,i));
+        res = max(res, getResolution(row));
+    }
+    for (int j=0; j<cp.width; j++) {
+        vector<Vec3f> col;
+        for (int i=0; i<cp.height; i++) col.push_back(cp.get(j,i));
+        res = max(res, getResolution(col));
+    }
+    return res;
 }
 
 bool VRBRepUtils::sameVec(const Vec3f& v1, const Vec3f& v2, float d) {
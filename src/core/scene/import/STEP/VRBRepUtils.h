@@ -10,15 +10,17 @@ OSG_BEGIN_NAMESPACE;
 class VRBRepUtils {
     protected:
 
-        static const int Ncurv = 17;//17; // N in 2pi - should be multiple of 4 +1
-        static const float Dangle; // angle segment
-        static vector<float> Adict; // all angles
+        int Ncurv = 17; // N in 2pi - should be multiple of 4 +1
+        float Dangle = 0; // angle segment
+        float chordTolerance = 0; // max distance between B spline and mesh, 0 for fixed resolution
 
         bool sameVec(const Vec3f& v1, const Vec3f& v2, float d = 1e-5);
         vector<float> angleFrame(float a1, float a2);
         int getSideN(float a);
         Vec2f getSide(float a);
         Vec2f getSide(int i);
+        int getResolution(const vector<Vec3f>& cpoints);
+        int getResolution(const field<Vec3f>& cpoints);
 
         // B Splines
         float Bik(float t, int i, int k, const vector<double>& knots, bool verbose = 0);
@@ -31,6 +33,9 @@ class VRBRepUtils {
 
     public:
         VRBRepUtils();
+
+        void setTolerance(float chordal, float angular);
+        void setTolerance(const VRBRepUtils& u);
 };
 
 OSG_END_NAMESPACE;
@@ -19,6 +19,9 @@
 #include "core/math/polygon.h"
 #include "core/math/pose.h"
 #include "core/gui/VRGuiTreeExplorer.h"
+#include "core/objects/geometry/VRGeoData.h"
+#include "core/scene/VRWorkPool.h"
+#include "core/utils/VRProfiler.h"
 
 #include "VRBRepEdge.h"
 #include "VRBRepBound.h"
@@ -960,7 +963,8 @@ struct VRSTEP::Edge : public VRSTEP::Instance, public VRBRepEdge {
         cout << "Error: edge geo type not handled " << EdgeGeo.type << endl;
     }
 
-    Edge(Instance& i, map<STEPentity*, Instance>& instances) : Instance(i) {
+    Edge(Instance& i, map<STEPentity*, Instance>& instances, const VRBRepUtils& tolerance) : Instance(i) {
+        setTolerance(tolerance);
         if (i.type == "Oriented_Edge") {
             auto& EdgeElement = instances[ i.get<0, STEPentity*, bool>() ];
             //bool edir = i.get<1, STEPentity*, bool>();
@@ -987,14 +991,15 @@ struct VRSTEP::Edge : public VRSTEP::Instance, public VRBRepEdge {
 };
 
 struct VRSTEP::Bound : public VRSTEP::Instance, public VRBRepBound {
-    Bound(Instance& i, map<STEPentity*, Instance>& instances) : Instance(i) {
+    Bound(Instance& i, map<STEPentity*, Instance>& instances, const VRBRepUtils& tolerance) : Instance(i) {
+        setTolerance(tolerance);
         BRepType = type;
         if (type != "Face_Outer_Bound") outer = false;
         if (type == "Face_Bound" || type == "Face_Outer_Bound") {
             auto& Loop = instances[ get<0, STEPentity*, bool>() ];
             //bool dir = get<1, STEPentity*, bool>();
             for (auto l : Loop.get<0, vector<STEPentity*> >() ) {
-                Edge edge(instances[l], instances);
+                Edge edge(instances[l], instances, tolerance);
                 if (edge.points.size() <= 1) {
                     //cout << "Warning2: No edge points " << &edge << endl;
                     continue;
@@ -1105,7 +1110,8 @@ struct VRSTEP::Surface : public VRSTEP::Instance, public VRBRepSurface {
         }
     }
 
-    Surface(Instance& i, map<STEPentity*, Instance>& instances) : Instance(i) {
+    Surface(Instance& i, map<STEPentity*, Instance>& instances, const VRBRepUtils& tolerance) : Instance(i) {
+        setTolerance(tolerance);
         if (i.entity->IsComplex()) {
             for (auto e : unfoldComplex(i.entity)) handleSurface(e, instances);
             return;
@@ -1113,43 +1119,105 @@ struct VRSTEP::Surface : public VRSTEP::Instance, public VRBRepSurface {
     }
 };
 
+/**
+    The B-Rep is tessellated in three steps:
+    - the surfaces and their bounds are extracted from the STEP instances, serial because the instance map is not thread safe
+    - the faces are tessellated in batches on the work pool, each batch into plain vectors, no OpenSG field containers are created
+    - the batches of each shape are concatenated into one VRGeoData and geometry on the loading thread
+    Surface types without a plain tessellation (cylinders) use the legacy path on the loading thread.
+    The tolerances are passed to each surface, concurrent imports may use different ones.
+**/
 void VRSTEP::buildGeometries() {
     cout << blueBeg << "VRSTEP::buildGeometries start\n" << colEnd;
-    for (auto BrepShape : instancesByType["Advanced_Brep_Shape_Representation"]) {
-        static int i=0; i++;
-        //if (i != 5) continue;
-
-        string name = BrepShape.get<0, string, vector<STEPentity*> >();
-        auto geo = VRGeometry::create(name);
-
-        cout << "VRSTEP::buildGeometries " << name << " ID: " << BrepShape.ID << endl;
-
-        for (auto i : BrepShape.get<1, string, vector<STEPentity*> >() ) {
-            auto& Item = instances[i];
-            if (Item.type == "Manifold_Solid_Brep") {
-                auto& Outer = instances[ Item.get<0, STEPentity*>() ];
-                for (auto j : Outer.get<0, vector<STEPentity*> >() ) {
-                    auto& Face = instances[j];
-                    if (Face.type == "Advanced_Face") {
-                        auto& s = instances[ Face.get<1, vector<STEPentity*>, STEPentity*, bool>() ];
-                        Surface surface(s, instances);
-                        //bool same_sense = Face.get<2, vector<STEPentity*>, STEPentity*, bool>();
-                        for (auto k : Face.get<0, vector<STEPentity*>, STEPentity*, bool>() ) {
-                            auto& b = instances[k];
-                            Bound bound(b, instances);
-                            surface.bounds.push_back(bound);
-                        }
-                        geo->merge( surface.build(surface.type) );
-                        //geo->addChild( surface.build(surface.type) );
-                    } else cout << "VRSTEP::buildGeometries Error 2 " << Face.type << " " << Face.ID << endl;
-                }
-                if (materials.count(Item.entity)) geo->setMaterial(materials[Item.entity]);
-            } else if (Item.type == "Axis2_Placement_3d") { // ignore?
-            } else cout << "VRSTEP::buildGeometries Error 1 " << Item.type << " " << Item.ID << endl;
+
+    struct Shape {
+        VRGeometryPtr geo;
+        vector<Surface> surfaces;
+        vector<VRBRepSurface::Mesh> batches;
+        vector<char> handled;
+    };
+
+    const int batchSize = 16;
+    vector<Shape> shapes;
+    VRBRepUtils tolerance;
+    tolerance.setTolerance(chordalTolerance, angularTolerance*Pi/180);
+
+    timer.start("instances");
+    {
+        VRPROFILE_SCOPE("STEP instances");
+        for (auto BrepShape : instancesByType["Advanced_Brep_Shape_Representation"]) {
+            string name = BrepShape.get<0, string, vector<STEPentity*> >();
+            shapes.push_back(Shape());
+            auto& shape = shapes.back();
+            shape.geo = VRGeometry::create(name);
+            resGeos[BrepShape.entity] = shape.geo;
+
+            for (auto i : BrepShape.get<1, string, vector<STEPentity*> >() ) {
+                auto& Item = instances[i];
+                if (Item.type == "Manifold_Solid_Brep") {
+                    auto& Outer = instances[ Item.get<0, STEPentity*>() ];
+                    for (auto j : Outer.get<0, vector<STEPentity*> >() ) {
+                        auto& Face = instances[j];
+                        if (Face.type == "Advanced_Face") {
+                            auto& s = instances[ Face.get<1, vector<STEPentity*>, STEPentity*, bool>() ];
+                            Surface surface(s, instances, tolerance);
+                            //bool same_sense = Face.get<2, vector<STEPentity*>, STEPentity*, bool>();
+                            for (auto k : Face.get<0, vector<STEPentity*>, STEPentity*, bool>() ) {
+                                auto& b = instances[k];
+                                Bound bound(b, instances, tolerance);
+                                surface.bounds.push_back(bound);
+                            }
+                            shape.surfaces.push_back(surface);
+                        } else cout << "VRSTEP::buildGeometries Error 2 " << Face.type << " " << Face.ID << endl;
+                    }
+                    if (materials.count(Item.entity)) shape.geo->setMaterial(materials[Item.entity]);
+                } else if (Item.type == "Axis2_Placement_3d") { // ignore?
+                } else cout << "VRSTEP::buildGeometries Error 1 " << Item.type << " " << Item.ID << endl;
+            }
+
+            int N = shape.surfaces.size();
+            shape.batches.resize( (N+batchSize-1)/batchSize );
+            shape.handled.resize(N, 0);
         }
+    }
+    timer.stop("instances");
 
-        resGeos[BrepShape.entity] = geo;
+    timer.start("tessellate");
+    {
+        VRPROFILE_SCOPE("STEP tessellate");
+        auto pool = VRWorkPool::get();
+        VRWorkPool::Group group;
+        for (auto& shape : shapes) {
+            for (unsigned int b=0; b<shape.batches.size(); b++) {
+                Shape* sh = &shape;
+                pool->push([sh, b, batchSize]() {
+                    int N = sh->surfaces.size();
+                    for (int i = b*batchSize; i < N && i < int(b+1)*batchSize; i++) {
+                        auto& surface = sh->surfaces[i];
+                        sh->handled[i] = surface.build(surface.type, sh->batches[b]);
+                    }
+                }, &group);
+            }
+        }
+        pool->wait(&group);
+
+        for (auto& shape : shapes) {
+            VRGeoData data;
+            for (auto& batch : shape.batches) {
+                int i0 = data.size();
+                for (uint i=0; i<batch.positions.size(); i++) data.pushVert(batch.positions[i], batch.normals[i]);
+                for (uint i=0; i+2<batch.triangles.size(); i+=3) data.pushTri(i0+batch.triangles[i], i0+batch.triangles[i+1], i0+batch.triangles[i+2]);
+            }
+            for (unsigned int i=0; i<shape.surfaces.size(); i++) {
+                if (shape.handled[i]) continue;
+                auto& surface = shape.surfaces[i];
+                if (auto g = surface.build(surface.type)) data.append(g, g->getWorldMatrix());
+            }
+            if (data.size()) data.apply(shape.geo);
+        }
     }
+    timer.stop("tessellate");
+
     cout << "VRSTEP::buildGeometries  got " << resGeos.size() << " geometries" << endl;
     cout << blueBeg << "VRSTEP::buildGeometries finished\n" << colEnd;
 }
@@ -1416,44 +1484,78 @@ void VRSTEP::buildMaterials() {
 void VRSTEP::build() {
     blacklisted = 0;
 
-    int N = instMgr->InstanceCount();
-    for( int i=0; i<N; i++ ) { // add all instances to dict
-        STEPentity* se = instMgr->GetApplication_instance(i);
-        registerEntity(se);
-    }
+    timer.start("instances");
+    {
+        VRPROFILE_SCOPE("STEP instances");
+        int N = instMgr->InstanceCount();
+        for( int i=0; i<N; i++ ) { // add all instances to dict
+            STEPentity* se = instMgr->GetApplication_instance(i);
+            registerEntity(se);
+        }
 
-    for( int i=0; i<N; i++ ) { // parse all instances
-        STEPentity* se = instMgr->GetApplication_instance(i);
-        parseEntity(se);
-    }
+        for( int i=0; i<N; i++ ) { // parse all instances
+            STEPentity* se = instMgr->GetApplication_instance(i);
+            parseEntity(se);
+        }
 
-    auto root = new VRSTEP::Node();
-    for( int i=0; i<N; i++ ) {
-        STEPentity* se = instMgr->GetApplication_instance(i);
-        string name = se->EntityName();
-        traverseEntity(se,0,root);
-    }
+        auto root = new VRSTEP::Node();
+        for( int i=0; i<N; i++ ) {
+            STEPentity* se = instMgr->GetApplication_instance(i);
+            traverseEntity(se,0,root);
+        }
+
+        if (useExplorer) {
+            explorer->setSelectCallback( VRFunction<VRGuiTreeExplorer*>::create( "step_explorer", boost::bind(&VRSTEP::on_explorer_select, this, _1) ) );
+            explore(root);
+        }
 
-    if (options == "explorer") {
-        explorer->setSelectCallback( VRFunction<VRGuiTreeExplorer*>::create( "step_explorer", boost::bind(&VRSTEP::on_explorer_select, this, _1) ) );
-        explore(root);
+        buildMaterials();
     }
+    timer.stop("instances");
 
-    buildMaterials();
     buildGeometries();
-    buildScenegraph();
+
+    timer.start("scenegraph");
+    {
+        VRPROFILE_SCOPE("STEP scenegraph");
+        buildScenegraph();
+    }
+    timer.stop("scenegraph");
 
     cout << "build results:\n";
     cout << instances.size() << " STEP entities parsed\n";
     cout << blacklisted << " STEP blacklisted entities ignored\n";
     cout << resGeos.size() << " VR objects created\n";
+    timer.print();
 }
 
+/**
+    options are separated by spaces:
+    explorer - opens the STEP entity explorer
+    chordal=<d> - max distance between B spline surfaces and their tessellation, by default a fixed resolution is used
+    angular=<deg> - max angle of a segment of circles and cylinders, default is 22.5
+**/
 void VRSTEP::load(string file, VRTransformPtr t, string opt) {
     options = opt;
-    if (options == "explorer") explorer = VRGuiTreeExplorer::create("iss", "STEP file explorer (" + file + ")");
+    for (auto o : splitString(options, ' ')) {
+        auto kv = splitString(o, '=');
+        if (kv.size() == 0) continue;
+        if (kv[0] == "explorer") useExplorer = true;
+        if (kv.size() < 2) continue;
+        if (kv[0] == "chordal") chordalTolerance = toFloat(kv[1]);
+        if (kv[0] == "angular") angularTolerance = toFloat(kv[1]);
+    }
+
+    if (useExplorer) explorer = VRGuiTreeExplorer::create("iss", "STEP file explorer (" + file + ")");
     resRoot = t;
-    open(file);
+
+    timer.start("parse");
+    {
+        VRPROFILE_SCOPE("STEP parse");
+        open(file);
+    }
+    timer.stop("parse");
+
     build();
 }
 
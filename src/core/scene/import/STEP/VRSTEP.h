@@ -22,6 +22,7 @@ class SingleLinkNode;
 #include "core/utils/VRFunctionFwd.h"
 #include "core/math/field.h"
 #include "core/math/VRMathFwd.h"
+#include "core/utils/VRTimer.h"
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
@@ -88,6 +89,10 @@ class VRSTEP {
         map<string, bool> blacklist;
         int blacklisted = 0;
         string options;
+        bool useExplorer = false;
+        float chordalTolerance = 0; // tessellation tolerances of this import
+        float angularTolerance = 22.5; // degree
+        VRTimer timer; // stage timings
 
         string redBeg  = "\033[0;38;2;255;150;150m";
         string greenBeg  = "\033[0;38;2;150;255;150m";
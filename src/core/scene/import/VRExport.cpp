@@ -21,6 +21,6 @@ void VRExport::write(VRObjectPtr obj, string path) {
 
     auto bp = boost::filesystem::path(path);
     string ext = bp.extension().string();
-    if (ext == ".ply" && geo) { writePly(geo, path); }
+    if (ext == ".ply" && geo) { writePly(geo, path, true); return; }
     SceneFileHandler::the()->write(obj->getNode()->node, path.c_str());
 }
@@ -1,4 +1,5 @@
 #include "VRImport.h"
+#include "VRImportCache.h"
 #include "VRCOLLADA.h"
 #include "VRPLY.h"
 #include "VRVTK.h"
@@ -25,6 +26,7 @@
 #include "core/objects/material/VRMaterial.h"
 #include "core/utils/VRProgress.h"
 #include "core/utils/VRFunction.h"
+#include "core/utils/VRProfiler.h"
 #include "core/utils/toString.h"
 #include "core/scene/VRScene.h"
 
@@ -93,6 +95,7 @@ VRTransformPtr VRImport::load(string path, VRObjectPtr parent, bool reload, stri
     setlocale(LC_ALL, "C");
 
     // check cache
+    bool force = reload;
     reload = reload ? true : (cache.count(path) == 0);
     if (!reload) {
         auto res = cache[path].retrieve(parent);
@@ -103,6 +106,14 @@ VRTransformPtr VRImport::load(string path, VRObjectPtr parent, bool reload, stri
     // check file path
     if (!boost::filesystem::exists(path)) { cout << "VRImport::load " << path << " not found!" << endl; return 0; }
 
+    // check disk cache
+    if (!force) {
+        if (auto snapshot = VRImportCache::get()->load(path, preset, options)) {
+            fillCache(path, snapshot);
+            return cache[path].retrieve(parent);
+        }
+    }
+
     VRTransformPtr res = VRTransform::create("proxy");
     if (!thread) {
         LoadJob job(path, preset, res, progress, options);
@@ -132,11 +143,12 @@ void VRImport::LoadJob::load(VRThreadWeakPtr tw) {
     bool thread = false;
     if (t) { t->syncFromMain(); thread = true; }
 
+    string cachePreset = preset; // the switch may fall back to another preset
     auto loadSwitch = [&]() {
         auto bpath = boost::filesystem::path(path);
         string ext = bpath.extension().string();
         cout << "load " << path << " ext: " << ext << " preset: " << preset << "\n";
-        if (ext == ".e57") { loadE57(path, res); return; }
+        if (ext == ".e57") { loadE57(path, res, options); return; }
         if (ext == ".ply") { loadPly(path, res); return; }
         if (ext == ".stp") { VRSTEP step; step.load(path, res, options); return; }
         if (ext == ".wrl" && preset == "SOLIDWORKS-VRML2") { VRFactory f; if (f.loadVRML(path, progress, res, thread)) return; else preset = "OSG"; }
@@ -147,8 +159,12 @@ void VRImport::LoadJob::load(VRThreadWeakPtr tw) {
         if (preset == "COLLADA") loadCollada(path, res);
     };
 
-    loadSwitch();
+    {
+        VRPROFILE_SCOPE("import"); // static label, interned names are kept for the whole session
+        loadSwitch();
+    }
     VRImport::get()->fillCache(path, res);
+    VRImportCache::get()->store(path, cachePreset, options, res);
     if (t) t->syncToMain();
 }
 
@@ -0,0 +1,649 @@
+#include "VRImportCache.h"
+#include "core/objects/VRTransform.h"
+#include "core/objects/geometry/VRGeometry.h"
+#include "core/objects/geometry/OSGGeometry.h"
+#include "core/objects/material/VRMaterial.h"
+#include "core/objects/material/VRTexture.h"
+#include "core/utils/VROptions.h"
+#include "core/utils/toString.h"
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGGeoProperties.h>
+#include <OpenSG/OSGImage.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace OSG;
+
+namespace {
+    const char magic[4] = { 'P', 'V', 'R', 'C' };
+    const uint32_t version = 2;
+    const size_t alignment = 16;
+    const size_t sampleSize = 1<<20; // bytes hashed at the beginning and the end of the source file
+
+    enum NodeKind { NODE_OBJECT = 0, NODE_TRANSFORM = 1, NODE_GEOMETRY = 2 };
+
+    uint64_t fnv1a(const char* data, size_t N, uint64_t h = 14695981039346656037ull) {
+        for (size_t i=0; i<N; i++) { h ^= (unsigned char)data[i]; h *= 1099511628211ull; }
+        return h;
+    }
+
+    /** bytes of an uncompressed image with one frame, side and mipmap level, 0 for formats the cache does not store **/
+    size_t imageSize(UInt32 pixelFormat, Int32 dataType, Int32 width, Int32 height, Int32 depth) {
+        size_t channels = 0;
+        switch (pixelFormat) {
+            case Image::OSG_A_PF: case Image::OSG_I_PF: case Image::OSG_L_PF: case Image::OSG_DEPTH_PF:
+            case Image::OSG_ALPHA_INTEGER_PF: case Image::OSG_LUMINANCE_INTEGER_PF: channels = 1; break;
+            case Image::OSG_LA_PF: case Image::OSG_LUMINANCE_ALPHA_INTEGER_PF: channels = 2; break;
+            case Image::OSG_RGB_PF: case Image::OSG_BGR_PF: case Image::OSG_RGB_INTEGER_PF: case Image::OSG_BGR_INTEGER_PF: channels = 3; break;
+            case Image::OSG_RGBA_PF: case Image::OSG_BGRA_PF: case Image::OSG_RGBA_INTEGER_PF: case Image::OSG_BGRA_INTEGER_PF: channels = 4; break;
+            default: return 0;
+        }
+
+        size_t bytes = 0;
+        switch (dataType) {
+            case Image::OSG_UINT8_IMAGEDATA: bytes = 1; break;
+            case Image::OSG_UINT16_IMAGEDATA: case Image::OSG_INT16_IMAGEDATA: case Image::OSG_FLOAT16_IMAGEDATA: bytes = 2; break;
+            case Image::OSG_UINT32_IMAGEDATA: case Image::OSG_INT32_IMAGEDATA: case Image::OSG_FLOAT32_IMAGEDATA: bytes = 4; break;
+            default: return 0;
+        }
+
+        const Int32 maxSize = 1<<16;
+        if (width < 1 || height < 1 || depth < 1 || width > maxSize || height > maxSize || depth > maxSize) return 0;
+        return size_t(width)*height*depth*channels*bytes;
+    }
+
+    struct Writer {
+        ofstream out;
+        size_t pos = 0;
+
+        Writer(string path) : out(path, ios::binary | ios::trunc) {}
+
+        void raw(const void* d, size_t N) { out.write((const char*)d, N); pos += N; }
+        template<class T> void pod(const T& t) { raw(&t, sizeof(T)); }
+        void str(const string& s) { pod<uint32_t>(s.size()); raw(s.data(), s.size()); }
+
+        void blob(const void* d, size_t N) { // aligned to the file start, mapped files are page aligned
+            static const char zeros[alignment] = {0};
+            pod<uint64_t>(N);
+            raw(zeros, (alignment - pos%alignment)%alignment);
+            raw(d, N);
+        }
+    };
+
+    struct Reader {
+        const char* data = 0;
+        size_t size = 0;
+        size_t pos = 0;
+        bool ok = true;
+
+        ~Reader() { if (data) munmap((void*)data, size); }
+
+        bool map(string path) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+            void* m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (m == MAP_FAILED) return false;
+            madvise(m, st.st_size, MADV_SEQUENTIAL);
+            data = (const char*)m;
+            size = st.st_size;
+            return true;
+        }
+
+        const char* take(size_t N) {
+            if (!ok || N > size - pos) { ok = false; return 0; }
+            const char* d = data + pos;
+            pos += N;
+            return d;
+        }
+
+        template<class T> T pod() {
+            T t = T();
+            if (auto d = take(sizeof(T))) memcpy(&t, d, sizeof(T));
+            return t;
+        }
+
+        string str() {
+            uint32_t N = pod<uint32_t>();
+            auto d = take(N);
+            return d ? string(d, N) : "";
+        }
+
+        const char* blob(size_t& N) {
+            N = pod<uint64_t>();
+            take((alignment - pos%alignment)%alignment);
+            return take(N);
+        }
+    };
+
+    GeoVectorPropertyRecPtr makeVectorProperty(UInt32 slot, UInt32 format, UInt32 dim) {
+        bool isPos = (slot == Geometry::PositionsIndex);
+        bool isCol = (slot == Geometry::ColorsIndex || slot == Geometry::SecondaryColorsIndex);
+        GeoVectorPropertyRecPtr p = 0;
+        if (format == GL_FLOAT) {
+            if (dim == 1) p = GeoVec1fProperty::create();
+            if (dim == 2) p = GeoVec2fProperty::create();
+            if (dim == 3) {
+                if (isPos) p = GeoPnt3fProperty::create();
+                else if (isCol) p = GeoColor3fProperty::create();
+                else p = GeoVec3fProperty::create();
+            }
+            if (dim == 4) {
+                if (isPos) p = GeoPnt4fProperty::create();
+                else if (isCol) p = GeoColor4fProperty::create();
+                else p = GeoVec4fProperty::create();
+            }
+        }
+        if (format == GL_UNSIGNED_BYTE && isCol) {
+            if (dim == 3) p = GeoColor3ubProperty::create();
+            if (dim == 4) p = GeoColor4ubProperty::create();
+        }
+        if (format == GL_DOUBLE && dim == 3) {
+            if (isPos) p = GeoPnt3dProperty::create();
+            else p = GeoVec3dProperty::create();
+        }
+        return p;
+    }
+
+    GeoIntegralPropertyRecPtr makeIntegralProperty(UInt32 format) {
+        GeoIntegralPropertyRecPtr p = 0;
+        if (format == GL_UNSIGNED_BYTE) p = GeoUInt8Property::create();
+        if (format == GL_UNSIGNED_SHORT) p = GeoUInt16Property::create();
+        if (format == GL_UNSIGNED_INT) p = GeoUInt32Property::create();
+        return p;
+    }
+
+    bool supported(GeoVectorProperty* p, UInt32 slot) {
+        UInt32 elem = p->getFormatSize()*p->getDimension();
+        if (p->getStride() != 0 && p->getStride() != elem) return false; // interleaved
+        return makeVectorProperty(slot, p->getFormat(), p->getDimension()) != 0;
+    }
+
+    bool supported(GeoIntegralProperty* p) {
+        UInt32 elem = p->getFormatSize()*p->getDimension();
+        if (p->getStride() != 0 && p->getStride() != elem) return false;
+        return makeIntegralProperty(p->getFormat()) != 0;
+    }
+
+    /** one pass, one texture, no shaders or videos, the snapshot stores only the colors and the image **/
+    bool supported(VRMaterialPtr m) {
+        if (m->getNPasses() != 1) return false;
+        if (m->hasShader() || m->getVideo()) return false;
+        for (int unit=1; unit<8; unit++) if (m->getTextureObjChunk(unit)) return false;
+        return true;
+    }
+
+    /** the snapshot covers only the object types and attributes it can restore, other trees are imported each time **/
+    bool supported(VRObjectPtr o) {
+        string t = o->getType();
+        if (t != "Object" && t != "Transform" && t != "Geometry") return false;
+        for (auto a : o->getAttachmentNames()) {
+            if (a != "collada_name" && a != "transform" && a != "geometry") return false; // type markers are set by the constructors
+        }
+        if (t == "Geometry") {
+            auto geo = static_pointer_cast<VRGeometry>(o);
+            if (auto mat = geo->getMaterial()) if (!supported(mat)) return false;
+            if (auto mesh = geo->getMesh()) if (auto g = mesh->geo) {
+                if (g->getTypes() && !supported(g->getTypes())) return false;
+                if (g->getLengths() && !supported(g->getLengths())) return false;
+                for (UInt32 i=0; i<g->getMFProperties()->size(); i++) {
+                    if (auto p = g->getProperty(i)) if (!supported(p, i)) return false;
+                    if (auto p = g->getIndex(i)) if (!supported(p)) return false;
+                }
+            }
+        }
+        for (auto c : o->getChildren()) if (!supported(c)) return false;
+        return true;
+    }
+
+    string resolve(const boost::filesystem::path& dir, string f) {
+        f.erase(0, f.find_first_not_of(" \t\"'"));
+        f.erase(f.find_last_not_of(" \t\r\"'")+1);
+        if (f.compare(0, 7, "file://") == 0) f = f.substr(7);
+        if (f == "") return "";
+        boost::filesystem::path p(f);
+        if (p.is_relative()) p = dir / p;
+        boost::system::error_code ec;
+        if (!boost::filesystem::is_regular_file(p, ec)) return "";
+        return boost::filesystem::canonical(p, ec).string();
+    }
+
+    /** files referenced by the source, material libraries and textures of OBJ, COLLADA and VRML files **/
+    void scanDependencies(const boost::filesystem::path& path, set<string>& deps) {
+        string ext = path.extension().string();
+        transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext != ".obj" && ext != ".mtl" && ext != ".dae" && ext != ".wrl" && ext != ".vrml") return;
+
+        auto dir = path.parent_path();
+        vector<string> found;
+        ifstream in(path.string());
+        string line;
+        while (getline(in, line)) {
+            if (ext == ".obj" || ext == ".mtl") { // the file name is the last token of the statement
+                stringstream ss(line);
+                string key, token, last;
+                ss >> key;
+                if (key != "mtllib" && key.compare(0, 4, "map_") != 0 && key != "bump" && key != "disp" && key != "decal" && key != "refl") continue;
+                while (ss >> token) last = token;
+                found.push_back(last);
+                continue;
+            }
+
+            string open = ext == ".dae" ? "<init_from>" : "url";
+            for (size_t i = line.find(open); i != string::npos; i = line.find(open, i+1)) {
+                if (ext == ".dae") found.push_back( line.substr(i+open.size(), line.find('<', i+open.size()) - i - open.size()) );
+                else { // url "a" or url [ "a" "b" ]
+                    size_t a = line.find('"', i);
+                    while (a != string::npos) {
+                        size_t b = line.find('"', a+1);
+                        if (b == string::npos) break;
+                        found.push_back( line.substr(a+1, b-a-1) );
+                        a = line.find('"', b+1);
+                        if (line.find_first_not_of(" \t", b+1) != a) break;
+                    }
+                }
+            }
+        }
+
+        for (auto f : found) {
+            string d = resolve(dir, f);
+            if (d == "" || deps.count(d)) continue;
+            deps.insert(d);
+            scanDependencies(d, deps); // textures of material libraries
+        }
+    }
+
+    void writeProperty(Writer& w, GeoIntegralProperty* p) {
+        w.pod<UInt32>(p->getFormat());
+        w.blob(p->getData(), p->getSize()*p->getFormatSize());
+    }
+
+    void writeProperty(Writer& w, GeoVectorProperty* p) {
+        w.pod<UInt32>(p->getFormat());
+        w.pod<UInt32>(p->getDimension());
+        w.blob(p->getData(), p->getSize()*p->getFormatSize()*p->getDimension());
+    }
+
+    GeoIntegralPropertyRecPtr readIntegralProperty(Reader& r) {
+        UInt32 format = r.pod<UInt32>();
+        size_t N = 0;
+        const char* d = r.blob(N);
+        auto p = makeIntegralProperty(format);
+        if (!d || !p || N%p->getFormatSize()) { r.ok = false; return 0; }
+        p->resize(N/p->getFormatSize());
+        if (N) memcpy(p->editData(), d, N);
+        return p;
+    }
+
+    GeoVectorPropertyRecPtr readVectorProperty(Reader& r, UInt32 slot) {
+        UInt32 format = r.pod<UInt32>();
+        UInt32 dim = r.pod<UInt32>();
+        size_t N = 0;
+        const char* d = r.blob(N);
+        auto p = makeVectorProperty(slot, format, dim);
+        if (!d || !p) { r.ok = false; return 0; }
+        size_t elem = p->getFormatSize()*dim;
+        if (N%elem) { r.ok = false; return 0; }
+        p->resize(N/elem);
+        if (N) memcpy(p->editData(), d, N);
+        return p;
+    }
+
+    void writeMaterial(Writer& w, VRMaterialPtr m) {
+        w.str(m->getBaseName());
+        w.pod(m->getDiffuse());
+        w.pod(m->getAmbient());
+        w.pod(m->getSpecular());
+        w.pod(m->getEmission());
+        w.pod<float>(m->getShininess());
+        w.pod<float>(m->getTransparency());
+        w.pod<char>(m->isLit());
+
+        ImageRecPtr img = 0;
+        if (auto tex = m->getTexture()) img = tex->getImage();
+        if (img && imageSize(img->getPixelFormat(), img->getDataType(), img->getWidth(), img->getHeight(), img->getDepth()) != img->getSize(false, false, false)) img = 0; // compressed or unknown format, not cached
+        w.pod<char>(img != 0);
+        if (!img) return;
+        w.pod<Int32>(img->getWidth());
+        w.pod<Int32>(img->getHeight());
+        w.pod<Int32>(img->getDepth());
+        w.pod<UInt32>(img->getPixelFormat());
+        w.pod<Int32>(img->getDataType());
+        w.blob(img->getData(), img->getSize(false, false, false));
+    }
+
+    VRMaterialPtr readMaterial(Reader& r) {
+        auto m = VRMaterial::create(r.str());
+        m->setDiffuse(r.pod<Color3f>());
+        m->setAmbient(r.pod<Color3f>());
+        m->setSpecular(r.pod<Color3f>());
+        m->setEmission(r.pod<Color3f>());
+        m->setShininess(r.pod<float>());
+        float t = r.pod<float>();
+        if (t < 1) m->setTransparency(t);
+        m->setLit(r.pod<char>());
+        if (!r.pod<char>()) return m;
+
+        Int32 width = r.pod<Int32>();
+        Int32 height = r.pod<Int32>();
+        Int32 depth = r.pod<Int32>();
+        UInt32 pixelFormat = r.pod<UInt32>();
+        Int32 dataType = r.pod<Int32>();
+        size_t N = 0;
+        const char* d = r.blob(N);
+        if (!d) return m;
+        size_t expected = imageSize(pixelFormat, dataType, width, height, depth);
+        if (expected == 0 || expected != N) { r.ok = false; return m; } // Image::set would read width*height*depth pixels from d
+        ImageRecPtr img = Image::create();
+        img->set(pixelFormat, width, height, depth, 1, 1, 0.0, (const UInt8*)d, dataType);
+        m->setTexture(VRTexture::create(img), img->hasAlphaChannel());
+        return m;
+    }
+
+    void writeGeometry(Writer& w, VRGeometryPtr geo, map<VRMaterial*, int>& materials) {
+        auto mat = geo->getMaterial();
+        w.pod<Int32>(mat ? materials[mat.get()] : -1);
+        auto ref = geo->getReference();
+        w.pod<Int32>(ref.type);
+        w.str(ref.parameter);
+
+        GeometryMTRecPtr g = geo->getMesh() ? geo->getMesh()->geo : 0;
+        w.pod<char>(g != 0);
+        if (!g) return;
+
+        GeoIntegralProperty* types = g->getTypes();
+        GeoIntegralProperty* lengths = g->getLengths();
+        w.pod<char>(types != 0);
+        if (types) writeProperty(w, types);
+        w.pod<char>(lengths != 0);
+        if (lengths) writeProperty(w, lengths);
+
+        vector<GeoIntegralProperty*> indices; // shared index properties are written once
+        vector<UInt32> slots;
+        for (UInt32 i=0; i<g->getMFProperties()->size(); i++) if (g->getProperty(i)) slots.push_back(i);
+
+        w.pod<UInt32>(slots.size());
+        for (auto i : slots) {
+            w.pod<UInt32>(i);
+            writeProperty(w, g->getProperty(i));
+            GeoIntegralProperty* ind = g->getIndex(i);
+            int k = -1;
+            if (ind) {
+                k = find(indices.begin(), indices.end(), ind) - indices.begin();
+                if (k == (int)indices.size()) indices.push_back(ind);
+            }
+            w.pod<Int32>(k);
+        }
+
+        w.pod<UInt32>(indices.size());
+        for (auto ind : indices) writeProperty(w, ind);
+    }
+
+    void readGeometry(Reader& r, VRGeometryPtr geo, vector<VRMaterialPtr>& materials) {
+        int mat = r.pod<Int32>();
+        VRGeometry::Reference ref;
+        ref.type = r.pod<Int32>();
+        ref.parameter = r.str();
+        if (!r.pod<char>()) { geo->setReference(ref); return; }
+
+        GeometryMTRecPtr g = Geometry::create();
+        if (r.pod<char>()) g->setTypes( readIntegralProperty(r) );
+        if (r.pod<char>()) g->setLengths( readIntegralProperty(r) );
+
+        vector< pair<UInt32, int> > slotIndices;
+        UInt32 Nslots = r.pod<UInt32>();
+        for (UInt32 j=0; j<Nslots && r.ok; j++) {
+            UInt32 i = r.pod<UInt32>();
+            g->setProperty( readVectorProperty(r, i), i );
+            slotIndices.push_back( make_pair(i, r.pod<Int32>()) );
+        }
+
+        vector<GeoIntegralPropertyRecPtr> indices;
+        UInt32 Nindices = r.pod<UInt32>();
+        for (UInt32 j=0; j<Nindices && r.ok; j++) indices.push_back( readIntegralProperty(r) );
+        for (auto si : slotIndices) {
+            if (si.second >= 0 && si.second < (int)indices.size()) g->setIndex(indices[si.second], si.first);
+        }
+
+        geo->setMesh( OSGGeometry::create(g), ref );
+        if (mat >= 0 && mat < (int)materials.size()) geo->setMaterial(materials[mat]);
+    }
+}
+
+VRImportCache::VRImportCache() {
+    auto options = VROptions::get();
+    active = options->getOption<bool>("import_cache");
+    dir = options->getOption<string>("import_cache_dir");
+    maxSize = size_t(max(options->getOption<int>("import_cache_size"), 0)) << 20;
+
+    if (dir == "") {
+        const char* home = getenv("HOME");
+        dir = home ? string(home) + "/.cache/polyvr/import" : (boost::filesystem::temp_directory_path() / "polyvr_import").string();
+    }
+
+    boost::system::error_code ec;
+    if (active) boost::filesystem::create_directories(dir, ec);
+    if (ec) { cout << "VRImportCache: cannot create " << dir << ", " << ec.message() << endl; active = false; }
+}
+
+VRImportCache* VRImportCache::get() {
+    static VRImportCache* s = new VRImportCache();
+    return s;
+}
+
+/** the key identifies the source file and the import parameters, a sample of the content guards against files replaced with the same mtime **/
+string VRImportCache::getKey(string path, string preset, string options) {
+    boost::system::error_code ec;
+    auto p = boost::filesystem::canonical(path, ec);
+    if (ec) return "";
+    size_t size = boost::filesystem::file_size(p, ec);
+    if (ec) return "";
+    time_t mtime = boost::filesystem::last_write_time(p, ec);
+    if (ec) return "";
+
+    uint64_t h = fnv1a(0, 0);
+    ifstream in(p.string(), ios::binary);
+    vector<char> sample(min(size, sampleSize));
+    in.read(sample.data(), sample.size());
+    h = fnv1a(sample.data(), in.gcount(), h);
+    if (size > sampleSize) {
+        in.seekg(size - sample.size());
+        in.read(sample.data(), sample.size());
+        h = fnv1a(sample.data(), in.gcount(), h);
+    }
+
+    return p.string() + "|" + toString(size) + "|" + toString(mtime) + "|" + toString(h) + "|" + preset + "|" + options;
+}
+
+string VRImportCache::getFile(string key) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)fnv1a(key.data(), key.size()));
+    return dir + "/" + buf + ".pvrc";
+}
+
+VRTransformPtr VRImportCache::load(string path, string preset, string options) {
+    if (!active) return 0;
+    string key = getKey(path, preset, options);
+    if (key == "") return 0;
+    string file = getFile(key);
+    if (!boost::filesystem::exists(file)) return 0;
+
+    Reader r;
+    if (!r.map(file)) return 0;
+    const char* m = r.take(4);
+    if (!m || memcmp(m, magic, 4) != 0 || r.pod<uint32_t>() != version) return 0;
+    if (r.str() != key) return 0; // hash collision
+
+    UInt32 Ndeps = r.pod<UInt32>(); // changed textures and material libraries invalidate the snapshot
+    for (UInt32 i=0; i<Ndeps && r.ok; i++) {
+        string dep = r.str();
+        time_t mtime = r.pod<int64_t>();
+        uint64_t size = r.pod<uint64_t>();
+        boost::system::error_code ec1, ec2;
+        if (boost::filesystem::last_write_time(dep, ec1) != mtime || boost::filesystem::file_size(dep, ec2) != size || ec1 || ec2) {
+            cout << "VRImportCache: " << dep << " changed, reimporting " << path << endl;
+            return 0;
+        }
+    }
+
+    vector<VRMaterialPtr> materials;
+    UInt32 Nmaterials = r.pod<UInt32>();
+    for (UInt32 i=0; i<Nmaterials && r.ok; i++) materials.push_back( readMaterial(r) );
+
+    vector<VRObjectPtr> nodes;
+    UInt32 Nnodes = r.pod<UInt32>();
+    for (UInt32 i=0; i<Nnodes && r.ok; i++) {
+        int parent = r.pod<Int32>();
+        int kind = r.pod<char>();
+        string name = r.str();
+        bool visible = r.pod<char>();
+        bool pickable = r.pod<char>();
+        string colladaName = r.str();
+
+        VRObjectPtr o;
+        if (kind == NODE_OBJECT) o = VRObject::create(name);
+        else {
+            VRTransformPtr t;
+            if (kind == NODE_GEOMETRY) t = VRGeometry::create(name);
+            else t = VRTransform::create(name);
+            t->setMatrix( r.pod<Matrix>() );
+            if (kind == NODE_GEOMETRY) readGeometry(r, static_pointer_cast<VRGeometry>(t), materials);
+            o = t;
+        }
+
+        o->setVisible(visible);
+        o->setPickable(pickable);
+        if (colladaName != "") o->addAttachment("collada_name", colladaName);
+        if (parent >= 0 && parent < (int)nodes.size()) nodes[parent]->addChild(o);
+        nodes.push_back(o);
+    }
+
+    if (!r.ok || nodes.size() == 0 || nodes[0]->getType() != "Transform") {
+        cout << "VRImportCache: corrupt snapshot " << file << endl;
+        boost::system::error_code ec;
+        boost::filesystem::remove(file, ec);
+        return 0;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(file, time(0), ec); // least recently used eviction
+    cout << "VRImportCache: loaded " << path << " from " << file << endl;
+    return static_pointer_cast<VRTransform>(nodes[0]);
+}
+
+bool VRImportCache::store(string path, string preset, string options, VRTransformPtr root) {
+    if (!active || !root) return false;
+    if (!supported(root)) return false;
+    string key = getKey(path, preset, options);
+    if (key == "") return false;
+    string file = getFile(key);
+    string tmp = file + ".tmp" + toString(getpid());
+
+    set<string> deps;
+    boost::system::error_code ec;
+    scanDependencies(boost::filesystem::canonical(path, ec), deps);
+
+    vector<VRObjectPtr> nodes; // depth first, parents before children
+    map<VRObject*, int> nodeIDs;
+    vector<VRObjectPtr> stack = { root };
+    while (stack.size()) {
+        auto o = stack.back();
+        stack.pop_back();
+        nodeIDs[o.get()] = nodes.size();
+        nodes.push_back(o);
+        auto children = o->getChildren();
+        stack.insert(stack.end(), children.rbegin(), children.rend());
+    }
+
+    vector<VRMaterialPtr> materials;
+    map<VRMaterial*, int> materialIDs;
+    for (auto o : nodes) {
+        if (o->getType() != "Geometry") continue;
+        auto mat = static_pointer_cast<VRGeometry>(o)->getMaterial();
+        if (!mat || materialIDs.count(mat.get())) continue;
+        materialIDs[mat.get()] = materials.size();
+        materials.push_back(mat);
+    }
+
+    {
+        Writer w(tmp);
+        if (!w.out) return false;
+        w.raw(magic, 4);
+        w.pod<uint32_t>(version);
+        w.str(key);
+
+        w.pod<UInt32>(deps.size());
+        for (auto d : deps) {
+            w.str(d);
+            w.pod<int64_t>(boost::filesystem::last_write_time(d, ec));
+            w.pod<uint64_t>(boost::filesystem::file_size(d, ec));
+        }
+
+        w.pod<UInt32>(materials.size());
+        for (auto m : materials) writeMaterial(w, m);
+
+        w.pod<UInt32>(nodes.size());
+        for (auto o : nodes) {
+            auto parent = o->getParent();
+            w.pod<Int32>(o != root && parent && nodeIDs.count(parent.get()) ? nodeIDs[parent.get()] : -1);
+            string type = o->getType();
+            char kind = NODE_OBJECT;
+            if (type == "Transform") kind = NODE_TRANSFORM;
+            if (type == "Geometry") kind = NODE_GEOMETRY;
+            w.pod<char>(kind);
+            w.str(o->getBaseName());
+            w.pod<char>(o->isVisible());
+            w.pod<char>(o->isPickable());
+            w.str(o->hasAttachment("collada_name") ? o->getAttachment<string>("collada_name") : "");
+            if (kind == NODE_OBJECT) continue;
+            w.pod( static_pointer_cast<VRTransform>(o)->getMatrix() );
+            if (kind == NODE_GEOMETRY) writeGeometry(w, static_pointer_cast<VRGeometry>(o), materialIDs);
+        }
+
+        w.out.close();
+        if (!w.out) {
+            boost::system::error_code ec;
+            boost::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    boost::filesystem::rename(tmp, file, ec); // atomic, concurrent readers never see a partial snapshot
+    if (ec) { boost::filesystem::remove(tmp, ec); return false; }
+    cout << "VRImportCache: stored " << path << " in " << file << endl;
+    evict();
+    return true;
+}
+
+void VRImportCache::evict() {
+    if (maxSize == 0) return;
+    vector< pair<time_t, boost::filesystem::path> > files;
+    size_t total = 0;
+
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator itr(dir, ec), end; !ec && itr != end; itr.increment(ec)) {
+        auto p = itr->path();
+        if (p.extension() != ".pvrc") continue;
+        total += boost::filesystem::file_size(p, ec);
+        files.push_back( make_pair(boost::filesystem::last_write_time(p, ec), p) );
+    }
+
+    sort(files.begin(), files.end());
+    for (auto& f : files) {
+        if (total <= maxSize) break;
+        size_t s = boost::filesystem::file_size(f.second, ec);
+        if (boost::filesystem::remove(f.second, ec)) total -= s;
+    }
+}
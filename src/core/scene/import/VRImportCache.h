@@ -0,0 +1,41 @@
+#ifndef VRIMPORTCACHE_H_INCLUDED
+#define VRIMPORTCACHE_H_INCLUDED
+
+#include <string>
+#include "core/objects/VRObjectFwd.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Persistent import cache, the result of an import is written as binary snapshot into the cache directory.
+    A snapshot is keyed by the source path, size, modification time, a hash of the file content, the preset and the options.
+    The snapshot lists the files the source references (material libraries, textures), a change of one of them invalidates it.
+    The arrays of the snapshot are aligned, a cache hit maps the file and copies them directly into the geometry properties.
+    Only trees of objects, transforms and geometries with single pass materials without shaders and with at most one texture are cached,
+    other trees are imported each time.
+    Disabled by default, configured by the options import_cache, import_cache_dir and import_cache_size (MB), the least recently used snapshots are evicted.
+*/
+
+class VRImportCache {
+    private:
+        bool active = false;
+        string dir;
+        size_t maxSize = 0;
+
+        VRImportCache();
+
+        string getKey(string path, string preset, string options);
+        string getFile(string key);
+        void evict();
+
+    public:
+        static VRImportCache* get();
+
+        VRTransformPtr load(string path, string preset, string options);
+        bool store(string path, string preset, string options, VRTransformPtr root);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRIMPORTCACHE_H_INCLUDED
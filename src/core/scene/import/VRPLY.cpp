@@ -3,6 +3,14 @@
 #include "core/objects/geometry/OSGGeometry.h"
 
 #include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <omp.h>
 #include <OpenSG/OSGGeoProperties.h>
 #include <OpenSG/OSGGeometry.h>
 #include <OpenSG/OSGSimpleMaterial.h>
@@ -11,18 +19,258 @@
 
 OSG_BEGIN_NAMESPACE;
 
-struct property {
-    string type;
-    string name;
-    property(string type, string name) : type(type), name(name) {}
-};
+namespace {
+    enum PLYFormat { PLY_ASCII, PLY_BINARY_LE, PLY_BINARY_BE };
+    enum PLYType { PLY_NONE, PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64 };
+    enum PLYSlot { PX, PY, PZ, NX, NY, NZ, CR, CG, CB, TS, TT, NSLOTS };
+
+    struct PLYProperty {
+        PLYType type = PLY_NONE;
+        PLYType countType = PLY_NONE; // list properties only
+        int offset = -1; // byte offset in a binary row, -1 if behind a list
+        int slot = -1; // target vertex attribute, -1 if ignored
+        float scale = 1;
+    };
+
+    struct PLYElement {
+        string name;
+        size_t N = 0;
+        int stride = 0; // binary row size, 0 if the element has list properties
+        vector<PLYProperty> properties;
+    };
+
+    struct PLYFile {
+        const char* data = 0;
+        size_t size = 0;
+        size_t body = 0;
+        PLYFormat format = PLY_ASCII;
+        vector<PLYElement> elements;
+
+        ~PLYFile() { if (data) munmap((void*)data, size); }
+
+        bool map(string path) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+            void* m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (m == MAP_FAILED) return false;
+            madvise(m, st.st_size, MADV_SEQUENTIAL);
+            data = (const char*)m;
+            size = st.st_size;
+            return true;
+        }
+    };
+
+    PLYType parseType(const string& t) {
+        if (t == "char" || t == "int8") return PLY_INT8;
+        if (t == "uchar" || t == "uint8") return PLY_UINT8;
+        if (t == "short" || t == "int16") return PLY_INT16;
+        if (t == "ushort" || t == "uint16") return PLY_UINT16;
+        if (t == "int" || t == "int32") return PLY_INT32;
+        if (t == "uint" || t == "uint32") return PLY_UINT32;
+        if (t == "float" || t == "float32") return PLY_FLOAT32;
+        if (t == "double" || t == "float64") return PLY_FLOAT64;
+        return PLY_NONE;
+    }
+
+    int typeSize(PLYType t) {
+        switch (t) {
+            case PLY_INT8: case PLY_UINT8: return 1;
+            case PLY_INT16: case PLY_UINT16: return 2;
+            case PLY_INT32: case PLY_UINT32: case PLY_FLOAT32: return 4;
+            case PLY_FLOAT64: return 8;
+            default: return 0;
+        }
+    }
+
+    int parseSlot(const string& n) {
+        if (n == "x") return PX;
+        if (n == "y") return PY;
+        if (n == "z") return PZ;
+        if (n == "nx") return NX;
+        if (n == "ny") return NY;
+        if (n == "nz") return NZ;
+        if (n == "r" || n == "red" || n == "diffuse_red") return CR;
+        if (n == "g" || n == "green" || n == "diffuse_green") return CG;
+        if (n == "b" || n == "blue" || n == "diffuse_blue") return CB;
+        if (n == "s" || n == "u" || n == "texture_u") return TS;
+        if (n == "t" || n == "v" || n == "texture_v") return TT;
+        return -1;
+    }
+
+    bool hostIsBigEndian() {
+        const unsigned short one = 1;
+        return *(const unsigned char*)&one == 0;
+    }
+
+    template<class T> inline T readRaw(const char* p, bool swap) {
+        T v;
+        if (!swap) { memcpy(&v, p, sizeof(T)); return v; }
+        char b[sizeof(T)];
+        for (unsigned int i=0; i<sizeof(T); i++) b[i] = p[sizeof(T)-1-i];
+        memcpy(&v, b, sizeof(T));
+        return v;
+    }
+
+    inline double readBinary(const char* p, PLYType t, bool swap) {
+        switch (t) {
+            case PLY_INT8: return *(const int8_t*)p;
+            case PLY_UINT8: return *(const uint8_t*)p;
+            case PLY_INT16: return readRaw<int16_t>(p, swap);
+            case PLY_UINT16: return readRaw<uint16_t>(p, swap);
+            case PLY_INT32: return readRaw<int32_t>(p, swap);
+            case PLY_UINT32: return readRaw<uint32_t>(p, swap);
+            case PLY_FLOAT32: return readRaw<float>(p, swap);
+            case PLY_FLOAT64: return readRaw<double>(p, swap);
+            default: return 0;
+        }
+    }
+
+    /** parses the header and compiles each vertex property into its byte offset, type and target attribute **/
+    bool parseHeader(PLYFile& f) {
+        const char* end = f.data + f.size;
+        const char* p = f.data;
+        bool first = true;
+        while (p < end) {
+            const char* e = (const char*)memchr(p, '\n', end-p);
+            if (!e) return false;
+            string line(p, e);
+            p = e+1;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (first) { if (line != "ply") return false; first = false; continue; }
+            if (line == "end_header") { f.body = p - f.data; break; }
+
+            auto data = splitString(line, ' ');
+            if (data.size() == 0) continue;
+            if (data[0] == "format" && data.size() > 1) {
+                if (data[1] == "ascii") f.format = PLY_ASCII;
+                else if (data[1] == "binary_little_endian") f.format = PLY_BINARY_LE;
+                else if (data[1] == "binary_big_endian") f.format = PLY_BINARY_BE;
+                else return false;
+            }
+            if (data[0] == "element" && data.size() > 2) {
+                PLYElement el;
+                el.name = data[1];
+                el.N = strtoull(data[2].c_str(), 0, 10);
+                f.elements.push_back(el);
+            }
+            if (data[0] == "property" && data.size() > 2 && f.elements.size() > 0) {
+                PLYProperty prop;
+                if (data[1] == "list" && data.size() > 4) {
+                    prop.countType = parseType(data[2]);
+                    prop.type = parseType(data[3]);
+                } else {
+                    prop.type = parseType(data[1]);
+                    prop.slot = parseSlot(data[2]);
+                    if (prop.slot >= CR && prop.slot <= CB) {
+                        if (prop.type == PLY_UINT8) prop.scale = 1.0/255;
+                        if (prop.type == PLY_UINT16) prop.scale = 1.0/65535;
+                    }
+                }
+                if (prop.type == PLY_NONE) return false;
+                f.elements.back().properties.push_back(prop);
+            }
+        }
+        if (f.body == 0) return false;
+
+        for (auto& el : f.elements) { // binary row layout
+            int offset = 0;
+            for (auto& prop : el.properties) {
+                if (offset < 0) break;
+                if (prop.countType != PLY_NONE) { offset = -1; break; }
+                prop.offset = offset;
+                offset += typeSize(prop.type);
+            }
+            el.stride = max(offset, 0);
+        }
+        return true;
+    }
+
+    /** end of a binary row with lists, 0 if the row or one of its lists is cut off by the end of the file **/
+    const char* binaryRowEnd(const PLYElement& el, const char* p, const char* end, bool swap) {
+        for (auto& prop : el.properties) {
+            if (prop.countType != PLY_NONE) {
+                size_t cs = typeSize(prop.countType);
+                if (size_t(end-p) < cs) return 0;
+                long n = readBinary(p, prop.countType, swap);
+                p += cs;
+                size_t s = typeSize(prop.type);
+                if (n < 0 || (s && size_t(end-p)/s < size_t(n))) return 0;
+                p += n*s;
+                continue;
+            }
+            size_t s = typeSize(prop.type);
+            if (size_t(end-p) < s) return 0;
+            p += s;
+        }
+        return p;
+    }
 
-struct element {
-    string type;
-    int N;
-    vector<property> properties;
-    element(string type, int N) : type(type), N(N) {}
-};
+    /** finds the start of every complete row of an element and returns the position behind the element **/
+    const char* scanRows(const PLYFile& f, const PLYElement& el, const char* p, vector<const char*>* rows) {
+        const char* end = f.data + f.size;
+        bool swap = (f.format == PLY_BINARY_BE) != hostIsBigEndian();
+        if (f.format != PLY_ASCII && el.stride > 0) return min(p + el.N*el.stride, end); // rows are implicit
+
+        if (rows) rows->reserve(el.N);
+        for (size_t i=0; i<el.N && p < end; i++) {
+            if (rows) rows->push_back(p);
+            if (f.format == PLY_ASCII) {
+                const char* e = (const char*)memchr(p, '\n', end-p);
+                p = e ? e+1 : end;
+                continue;
+            }
+            const char* next = binaryRowEnd(el, p, end, swap);
+            if (!next) { if (rows) rows->pop_back(); return end; } // truncated file
+            p = next;
+        }
+        return min(p, end);
+    }
+
+    /** copies an ascii row into a terminated buffer, strtod would read past the end of the mapping on a last line without newline **/
+    inline char* terminatedRow(const char* row, const char* end, string& buf) {
+        const char* e = (const char*)memchr(row, '\n', end-row);
+        buf.assign(row, e ? e : end);
+        return &buf[0];
+    }
+
+    inline void decodeVertex(const PLYElement& el, const char* row, const char* end, PLYFormat format, bool swap, float* vals, string& buf) {
+        if (format == PLY_ASCII) {
+            char* p = terminatedRow(row, end, buf);
+            char* pend = p + buf.size();
+            for (auto& prop : el.properties) {
+                if (p >= pend) return;
+                if (prop.countType != PLY_NONE) { // skip list
+                    int n = strtol(p, &p, 10);
+                    for (int i=0; i<n; i++) strtod(p, &p);
+                    continue;
+                }
+                float v = strtod(p, &p);
+                if (prop.slot >= 0) vals[prop.slot] = v*prop.scale;
+            }
+            return;
+        }
+
+        if (el.stride > 0) {
+            for (auto& prop : el.properties)
+                if (prop.slot >= 0) vals[prop.slot] = readBinary(row + prop.offset, prop.type, swap)*prop.scale;
+            return;
+        }
+
+        const char* p = row;
+        for (auto& prop : el.properties) {
+            if (prop.countType != PLY_NONE) {
+                int n = readBinary(p, prop.countType, swap);
+                p += typeSize(prop.countType) + n*typeSize(prop.type);
+                continue;
+            }
+            if (prop.slot >= 0) vals[prop.slot] = readBinary(p, prop.type, swap)*prop.scale;
+            p += typeSize(prop.type);
+        }
+    }
+}
 
 void loadPly(string filename, VRTransformPtr res) {
     GeoUInt8PropertyRecPtr      Type = GeoUInt8Property::create();
@@ -39,99 +287,133 @@ void loadPly(string filename, VRTransformPtr res) {
     Mat->setAmbient(Color3f(0.4, 0.4, 0.2));
     Mat->setSpecular(Color3f(0.1, 0.1, 0.1));
 
-    ifstream file(filename.c_str());
-    string line;
-    list<element> elements;
-    while (getline(file, line)) {
-        if (line == "end_header") break;
-        auto data = splitString(line, ' ');
-        if (data[0] == "element") elements.push_back( element(data[1], toInt(data[2]) ) );
-        if (data[0] == "property") {
-            if (data.size() == 3) elements.back().properties.push_back( property(data[1], data[2]) );
-            else elements.back().properties.push_back( property(data[1], data[2]) );
-        }
-    }
+    PLYFile file;
+    if (!file.map(filename)) { cout << "loadPly: could not open " << filename << endl; return; }
+    if (!parseHeader(file)) { cout << "loadPly: invalid header in " << filename << endl; return; }
 
-    int N = 0;
-    for (auto e : elements) N += e.N;
+    bool swap = (file.format == PLY_BINARY_BE) != hostIsBigEndian();
+    const char* end = file.data + file.size;
+    const char* p = file.data + file.body;
+
+    size_t N = 0;
+    for (auto& e : file.elements) N += e.N;
     VRProgress progress("load PLY " + filename, N);
 
-    for (auto e : elements) {
-        if (e.type == "vertex") {
-            Vec3f p, n;
-            Vec3i c;
-            Vec2f t;
+    for (auto& e : file.elements) {
+        if (e.name == "vertex") {
             bool doP = 0, doN = 0, doC = 0, doT = 0;
-            for (int i=0; i<e.N; i++) {
-                progress.update(1);
-                getline(file, line);
-                istringstream iss(line);
-                for (auto prop : e.properties) {
-                    if (prop.name == "x") { iss >> p[0]; doP = 1; }
-                    if (prop.name == "y") { iss >> p[1]; doP = 1; }
-                    if (prop.name == "z") { iss >> p[2]; doP = 1; }
-                    if (prop.name == "nx") { iss >> n[0]; doN = 1; }
-                    if (prop.name == "ny") { iss >> n[1]; doN = 1; }
-                    if (prop.name == "nz") { iss >> n[2]; doN = 1; }
-                    if (prop.name == "r") { iss >> c[0]; doC = 1; }
-                    if (prop.name == "g") { iss >> c[1]; doC = 1; }
-                    if (prop.name == "b") { iss >> c[2]; doC = 1; }
-                    if (prop.name == "red") { iss >> c[0]; doC = 1; }
-                    if (prop.name == "green") { iss >> c[1]; doC = 1; }
-                    if (prop.name == "blue") { iss >> c[2]; doC = 1; }
-                    if (prop.name == "s") { iss >> t[0]; doT = 1; }
-                    if (prop.name == "t") { iss >> t[1]; doT = 1; }
-                }
+            for (auto& prop : e.properties) {
+                if (prop.slot >= PX && prop.slot <= PZ) doP = 1;
+                if (prop.slot >= NX && prop.slot <= NZ) doN = 1;
+                if (prop.slot >= CR && prop.slot <= CB) doC = 1;
+                if (prop.slot >= TS && prop.slot <= TT) doT = 1;
+            }
 
-                if (doP) Pos->addValue(p);
-                if (doN) Norms->addValue(n);
-                if (doC) Cols->addValue(Vec3f(c[0]/255., c[1]/255., c[2]/255.));
-                if (doT) Tex->addValue(t);
+            const char* base = p;
+            vector<const char*> rows;
+            p = scanRows(file, e, p, &rows);
+            bool fixed = file.format != PLY_ASCII && e.stride > 0;
+            int Nv = fixed ? (p-base)/e.stride : rows.size();
+
+            if (doP) Pos->resize(Nv);
+            if (doN) Norms->resize(Nv);
+            if (doC) Cols->resize(Nv);
+            if (doT) Tex->resize(Nv);
+            Pnt3f* pos = doP && Nv ? &Pos->editField()[0] : 0;
+            Vec3f* norms = doN && Nv ? &Norms->editField()[0] : 0;
+            Vec3f* cols = doC && Nv ? &Cols->editField()[0] : 0;
+            Vec2f* tex = doT && Nv ? &Tex->editField()[0] : 0;
+
+            const int chunk = 1<<16;
+            int Nchunks = (Nv+chunk-1)/chunk;
+            atomic<size_t> decoded(0);
+            #pragma omp parallel for schedule(dynamic)
+            for (int c=0; c<Nchunks; c++) {
+                float vals[NSLOTS] = {0};
+                string buf;
+                int i1 = min(Nv, (c+1)*chunk);
+                for (int i=c*chunk; i<i1; i++) {
+                    decodeVertex(e, fixed ? base + size_t(i)*e.stride : rows[i], end, file.format, swap, vals, buf);
+                    if (pos) pos[i] = Pnt3f(vals[PX], vals[PY], vals[PZ]);
+                    if (norms) norms[i] = Vec3f(vals[NX], vals[NY], vals[NZ]);
+                    if (cols) cols[i] = Vec3f(vals[CR], vals[CG], vals[CB]);
+                    if (tex) tex[i] = Vec2f(vals[TS], vals[TT]);
+                }
+                decoded += i1-c*chunk;
+                if (omp_get_thread_num() == 0) progress.update(decoded.exchange(0)); // only the calling thread reports
             }
+            progress.update(decoded.exchange(0));
             continue;
         }
 
-        if (e.type == "face") {
-            int N = 0, lastN = 0, k = 0, i1 = 0;
-            for (int i=0; i<e.N; i++) {
-                progress.update(1);
-                getline(file, line);
-                istringstream iss(line);
-                iss >> N;
-                if (N != lastN) {
-                    if (N == 1) { Type->addValue(GL_POINTS); cout << "add GL_POINTS type\n"; }
-                    if (N == 2) { Type->addValue(GL_LINES); cout << "add GL_LINES type\n"; }
-                    if (N == 3) { Type->addValue(GL_TRIANGLES); cout << "add GL_TRIANGLES type\n"; }
-                    if (N == 4) { Type->addValue(GL_QUADS); cout << "add GL_QUADS type\n"; }
-                    if (k > 0) { Length->addValue(k*N); cout << "add length " << k*N << endl; }
-                    k = 0;
-                    lastN = N;
+        if (e.name == "face") {
+            int listID = -1;
+            for (unsigned int k=0; k<e.properties.size(); k++) if (e.properties[k].countType != PLY_NONE) { listID = k; break; }
+            if (listID < 0) { p = scanRows(file, e, p, 0); continue; }
+
+            vector<UInt32> inds;
+            inds.reserve(e.N*3);
+            int lastN = 0, k = 0;
+            auto addRun = [&]() {
+                if (k == 0) return;
+                if (lastN > 4) { for (int j=0; j<k; j++) { Type->addValue(GL_POLYGON); Length->addValue(lastN); } }
+                else { Type->addValue(lastN == 1 ? GL_POINTS : lastN == 2 ? GL_LINES : lastN == 3 ? GL_TRIANGLES : GL_QUADS); Length->addValue(k*lastN); }
+                k = 0;
+            };
+
+            string buf;
+            for (size_t i=0; i<e.N && p < end; i++) {
+                int n = 0;
+                char* q = file.format == PLY_ASCII ? terminatedRow(p, end, buf) : 0;
+                if (file.format != PLY_ASCII && !binaryRowEnd(e, p, end, swap)) { // the counts and indices are read unchecked below
+                    cout << "\nWarning! truncated face " << i << " of " << e.N << endl;
+                    p = end;
+                    break;
+                }
+                for (unsigned int pi=0; pi<e.properties.size(); pi++) {
+                    auto& prop = e.properties[pi];
+                    if (file.format == PLY_ASCII) {
+                        if (prop.countType == PLY_NONE) { strtod(q, &q); continue; }
+                        int m = strtol(q, &q, 10);
+                        for (int j=0; j<m; j++) {
+                            UInt32 v = strtoul(q, &q, 10);
+                            if (int(pi) == listID) inds.push_back(v);
+                        }
+                        if (int(pi) == listID) n = m;
+                        continue;
+                    }
+                    if (prop.countType == PLY_NONE) { p += typeSize(prop.type); continue; }
+                    int m = readBinary(p, prop.countType, swap);
+                    p += typeSize(prop.countType);
+                    int s = typeSize(prop.type);
+                    if (int(pi) == listID) {
+                        for (int j=0; j<m; j++) inds.push_back( readBinary(p + j*s, prop.type, swap) );
+                        n = m;
+                    }
+                    p += m*s;
                 }
-                for (int j=0; j<N; j++) {
-                    iss >> i1;
-                    Indices->addValue(i1);
+                if (file.format == PLY_ASCII) { // go to next line
+                    const char* q = (const char*)memchr(p, '\n', end-p);
+                    p = q ? q+1 : end;
                 }
+
+                if (n != lastN) { addRun(); lastN = n; }
                 k++;
+                if (i%4096 == 4095) progress.update(4096);
             }
-            if (k > 0) { Length->addValue(k*N); cout << "add length " << k*N << endl; }
+            addRun();
+
+            Indices->resize(inds.size());
+            if (inds.size()) memcpy(&Indices->editField()[0], &inds[0], inds.size()*sizeof(UInt32));
             continue;
         }
 
-        cout << "\nWarning! unknown element " << e.type << " with " << e.N << " entries.\n";
+        cout << "\nWarning! unknown element " << e.name << " with " << e.N << " entries.\n";
+        p = scanRows(file, e, p, 0);
     }
-    file.close();
-
-    cout << "\n summary:\n";
-    cout << "  file header:";
-    for (auto e : elements) cout << " " << e.N;
-    cout << endl;
-    cout << "  types: " << Type->size() << endl;
-    cout << "  lengths: " << Length->size() << endl;
-    cout << "  indices: " << Indices->size() << endl;
-    cout << "  positions: " << Pos->size() << endl;
-    cout << "  normals: " << Norms->size() << endl;
-    cout << "  colors: " << Cols->size() << endl;
-    cout << "  texcoords: " << Tex->size() << endl;
+    progress.finish();
+
+    cout << "loadPly: " << Pos->size() << " vertices, " << Indices->size() << " indices, " << Type->size() << " primitive groups\n";
 
     GeometryMTRecPtr geo = Geometry::create();
     geo->setTypes(Type);
@@ -148,8 +430,8 @@ void loadPly(string filename, VRTransformPtr res) {
     res->addChild(vrgeo);
 }
 
-void writePly(VRGeometryPtr geo, string path) {
-	if (!geo) return;
+void writePly(VRGeometryPtr geo, string path, bool binary) {
+	if (!geo || !geo->getMesh() || !geo->getMesh()->geo) return;
 
 	auto pos = geo->getMesh()->geo->getPositions();
 	auto norms = geo->getMesh()->geo->getNormals();
@@ -159,94 +441,50 @@ void writePly(VRGeometryPtr geo, string path) {
 	auto types = geo->getMesh()->geo->getTypes();
 	auto lengths = geo->getMesh()->geo->getLengths();
 
-	int Np = pos->size();
-	int Nn = norms->size();
-	int Nc = cols->size();
-	int Nt = texc->size();
-	int Nl = lengths->size();
-    int Nfaces = 0;
+	int Np = pos ? pos->size() : 0;
+	int Nn = norms ? norms->size() : 0;
+	int Nc = cols ? cols->size() : 0;
+	int Nt = texc ? texc->size() : 0;
+	int Nl = lengths ? lengths->size() : 0;
 
 	if (Np == 0) return;
 
-	auto writeVertices = [&]() {
-		string data;
-		Pnt3f p;
-		Vec3f n,c;
-		Vec2f t;
-        for (int i=0; i<Np; i++) {
-            p = pos->getValue<Pnt3f>(i);
-            if (Nn == Np) n = norms->getValue<Vec3f>(i);
-            if (Nc == Np) c = cols->getValue<Vec3f>(i);
-            if (Nt == Np) t = texc->getValue<Vec2f>(i);
-
-            data += toString(p);
-            if (Nn == Np) data += " "+toString(n);
-            if (Nc == Np) data += " "+toString(Vec3i(c*255));
-            if (Nt == Np) data += " "+toString(t);
-            data += "\n";
-        }
-		return data;
-	};
-
 	auto check = [&](Vec3i v) {
 		return (v[0] != v[1] && v[0] != v[2] && v[1] != v[2]);
 	};
 
-	auto writeIndices = [&]() {
-		int j = 0;
-		Nfaces = 0;
-		string data;
-		for (int k=0; k<Nl; k++) {
-            int t = types->getValue<UInt8>(k);
-            int l = lengths->getValue<UInt32>(k);
-			int p = 3;
-
-			if (t == 4) { // triangle
-				for (int i=0; i<l; i++) {
-					if (i%p == 0) data += toString(p);
-					int in = inds->getValue<UInt32>(j);
-					data += " "+toString(in);
-					if (i%p == p-1) {
-						data += "\n";
-						Nfaces += 1;
-					}
-					j += 1;
-				}
-			}
-
-			if (t == 5) { // triangle strip
-				for (int i=0; i<l; i++) {
-					int in = inds->getValue<UInt32>(j);
-					if (i == 0) data += toString(p); // first triangle of strip
-					if (i < 3) data += " "+toString(in);
-					if (i == 2) {
-						data += "\n";
-						Nfaces += 1;
-					}
-					if (i > 2) {
-                        int in1 = inds->getValue<UInt32>(j-2);
-                        int in2 = inds->getValue<UInt32>(j-1);
-                        int in3 = inds->getValue<UInt32>(j);
-						Vec3i veci = Vec3i(in1, in2, in3);
-						if (i%2 == 1) veci = Vec3i(in2, in1, in3);
-						if (check(veci)) {
-							data += toString(p)+' '+toString(veci)+"\n";
-							Nfaces += 1;
-						}
-					}
-					j += 1;
-				}
-			}
-
-			if (t != 4 && t != 5) cout << "PLY write: bad type " << t << endl;
-		}
-
-		return data;
-	};
+	vector<Vec3i> faces;
+	int j = 0;
+	for (int k=0; k<Nl; k++) {
+        int t = types->getValue<UInt8>(k);
+        int l = lengths->getValue<UInt32>(k);
+
+        if (t == GL_TRIANGLES) {
+            for (int i=0; i+2<l; i+=3) faces.push_back( Vec3i(inds->getValue<UInt32>(j+i), inds->getValue<UInt32>(j+i+1), inds->getValue<UInt32>(j+i+2)) );
+        }
+
+        if (t == GL_TRIANGLE_STRIP) {
+            for (int i=2; i<l; i++) {
+                int in1 = inds->getValue<UInt32>(j+i-2);
+                int in2 = inds->getValue<UInt32>(j+i-1);
+                int in3 = inds->getValue<UInt32>(j+i);
+                Vec3i veci = Vec3i(in1, in2, in3);
+                if (i%2 == 1) veci = Vec3i(in2, in1, in3);
+                if (i == 2 || check(veci)) faces.push_back(veci);
+            }
+        }
+
+        if (t != GL_TRIANGLES && t != GL_TRIANGLE_STRIP) cout << "PLY write: bad type " << t << endl;
+        j += l;
+	}
+	int Nfaces = faces.size();
+
+	bool bigEndian = hostIsBigEndian();
+	string format = !binary ? "ascii" : bigEndian ? "binary_big_endian" : "binary_little_endian";
 
 	string header =
 	"ply\n"
-	"format ascii 1.0\n"
+	"format "+format+" 1.0\n"
 	"comment Created by PolyVR - https://github.com/Victor-Haefner/polyvr\n"
 	"element vertex "+toString(Np)+"\n"
 	"property float x\n"
@@ -266,16 +504,45 @@ void writePly(VRGeometryPtr geo, string path) {
 
 	cout << "PLY export " << geo->getName() << endl;
 
-	auto vertsData = writeVertices();
-	auto indsData = writeIndices();
-
-
-    fstream f;
-    f.open (path, fstream::out | fstream::app);
+    ofstream f(path, ios::out | ios::trunc | ios::binary);
+    if (!f.is_open()) { cout << "PLY write: could not open " << path << endl; return; }
 	f << header;
-	f << vertsData;
-	f << indsData;
-	f.close();
+
+	if (!binary) {
+        for (int i=0; i<Np; i++) {
+            f << toString(pos->getValue<Pnt3f>(i));
+            if (Nn == Np) f << " " << toString(norms->getValue<Vec3f>(i));
+            if (Nc == Np) f << " " << toString(Vec3i(cols->getValue<Vec3f>(i)*255));
+            if (Nt == Np) f << " " << toString(texc->getValue<Vec2f>(i));
+            f << "\n";
+        }
+        for (auto& face : faces) f << "3 " << toString(face) << "\n";
+        return;
+	}
+
+	int stride = 12 + (Nn == Np)*12 + (Nc == Np)*3 + (Nt == Np)*8;
+	vector<char> data(size_t(Np)*stride);
+	#pragma omp parallel for
+	for (int i=0; i<Np; i++) {
+        char* d = &data[size_t(i)*stride];
+        Pnt3f p = pos->getValue<Pnt3f>(i);
+        memcpy(d, &p[0], 12); d += 12;
+        if (Nn == Np) { Vec3f n = norms->getValue<Vec3f>(i); memcpy(d, &n[0], 12); d += 12; }
+        if (Nc == Np) {
+            Vec3f c = cols->getValue<Vec3f>(i);
+            for (int k=0; k<3; k++) *d++ = (unsigned char)max(0.f, min(255.f, c[k]*255+0.5f));
+        }
+        if (Nt == Np) { Vec2f t = texc->getValue<Vec2f>(i); memcpy(d, &t[0], 8); }
+	}
+	f.write(&data[0], data.size());
+
+	data.resize(size_t(Nfaces)*13);
+	for (int i=0; i<Nfaces; i++) {
+        char* d = &data[size_t(i)*13];
+        d[0] = 3;
+        for (int k=0; k<3; k++) { uint32_t v = faces[i][k]; memcpy(d+1+4*k, &v, 4); }
+	}
+	if (Nfaces) f.write(&data[0], size_t(Nfaces)*13);
 }
 
 OSG_END_NAMESPACE;
@@ -9,7 +9,7 @@ OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 void loadPly(string path, VRTransformPtr res);
-void writePly(VRGeometryPtr geo, string path);
+void writePly(VRGeometryPtr geo, string path, bool binary = false);
 
 OSG_END_NAMESPACE;
 
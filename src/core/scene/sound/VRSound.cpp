@@ -2,6 +2,7 @@
 #include "VRSoundUtils.h"
 #include "core/math/path.h"
 #include "VRSoundManager.h"
+#include "core/scene/VRWorkPool.h"
 
 
 extern "C" {
@@ -32,10 +33,191 @@ sudo apt-get install libfftw3-dev
 #include <fftw3.h>
 #include <map>
 #include <climits>
+#include <cstring>
+#include <atomic>
+#include <cstdlib>
+#include <boost/thread/mutex.hpp>
+#include <boost/filesystem.hpp>
 //#include <complex>
 
 using namespace OSG;
 
+namespace {
+    const uint streamBlock = 1024; // samples per streamed buffer
+    const int streamDepth = 4; // buffers queued ahead
+
+    /** arrays allocated by fftw, all with the alignment the cached plans were measured with **/
+    struct FFTBuffer {
+        double* data = 0;
+        uint N = 0;
+
+        FFTBuffer() {}
+        FFTBuffer(const FFTBuffer&) = delete;
+        ~FFTBuffer() { if (data) fftw_free(data); }
+
+        void resize(uint n) {
+            if (n == N) return;
+            if (data) fftw_free(data);
+            data = n ? fftw_alloc_real(n) : 0;
+            N = n;
+        }
+
+        void swap(FFTBuffer& b) { std::swap(data, b.data); std::swap(N, b.N); }
+    };
+
+    /**
+        DHT plans by size, the wisdom is kept next to the import cache so later runs plan instantly.
+        A new size is planned with FFTW_ESTIMATE on the calling thread, which uses the wisdom if there is any,
+        the work pool measures the size in the background and the measured plan replaces the estimated one.
+        The planner is not thread safe, a caller only waits for a measurement when it needs another new size at the same time.
+    */
+    struct FFTPlans {
+        boost::mutex mtx; // plans
+        boost::mutex plannerMtx;
+        map<uint, fftw_plan> plans;
+        vector<fftw_plan> estimated; // replaced plans, they may still be executed
+        VRWorkPool::Group group;
+        string wisdom;
+
+        FFTPlans() {
+            const char* home = getenv("HOME");
+            if (!home) return;
+            string dir = string(home) + "/.cache/polyvr";
+            boost::system::error_code ec;
+            boost::filesystem::create_directories(dir, ec);
+            if (ec) return;
+            wisdom = dir + "/fftw.wisdom";
+            fftw_import_wisdom_from_filename(wisdom.c_str());
+        }
+
+        static fftw_plan plan(uint N, unsigned flags) {
+            FFTBuffer in, out;
+            in.resize(N);
+            out.resize(N);
+            return fftw_plan_r2r_1d(N, in.data, out.data, FFTW_DHT, flags);
+        }
+
+        void measure(uint N) {
+            fftw_plan p;
+            {
+                boost::mutex::scoped_lock lock(plannerMtx);
+                p = plan(N, FFTW_MEASURE);
+                if (wisdom != "") fftw_export_wisdom_to_filename(wisdom.c_str());
+            }
+            boost::mutex::scoped_lock lock(mtx);
+            estimated.push_back(plans[N]);
+            plans[N] = p;
+        }
+
+        fftw_plan get(uint N) { // the plans are executed on other arrays, only planning needs the planner lock
+            {
+                boost::mutex::scoped_lock lock(mtx);
+                auto p = plans.find(N);
+                if (p != plans.end()) return p->second;
+            }
+
+            fftw_plan p;
+            {
+                boost::mutex::scoped_lock lock(plannerMtx);
+                p = plan(N, FFTW_ESTIMATE);
+            }
+
+            boost::mutex::scoped_lock lock(mtx);
+            auto i = plans.find(N);
+            if (i != plans.end()) { estimated.push_back(p); return i->second; } // planned by another thread meanwhile
+            plans[N] = p;
+            VRWorkPool::get()->push( [this, N]() { measure(N); }, &group );
+            return p;
+        }
+
+        void transform(const vector<double>& spectrum, FFTBuffer& in, FFTBuffer& out, uint N) {
+            in.resize(N);
+            out.resize(N);
+            uint n = min(N, (uint)spectrum.size());
+            if (n) memcpy(in.data, &spectrum[0], n*sizeof(double));
+            for (uint i=n; i<N; i++) in.data[i] = 0;
+            fftw_execute_r2r(get(N), in.data, out.data);
+        }
+    };
+
+    FFTPlans& getPlans() {
+        static FFTPlans* plans = new FFTPlans();
+        return *plans;
+    }
+}
+
+/**
+    Streamed synthesis, the inverse transform of a spectrum is one period of the waveform, the blocks are read from it continuously.
+    A new spectrum is transformed on the sound thread and crossfaded in at the same phase, the overlap of both waveforms.
+    The parameters are passed in a triple buffer, the caller never waits and the sound thread always gets the latest spectrum.
+*/
+struct VRSound::SynthStream {
+    struct Params {
+        vector<double> spectrum;
+        uint sample_rate = 0;
+        float crossfade = 0;
+    };
+
+    Params slots[3];
+    atomic<int> latest; // slot of the newest parameters, 4 is set until the sound thread takes them
+    int writing = 0; // used by the caller
+    int reading = 2; // used by the sound thread
+    enum State { IDLE = 0, RUNNING, STOPPING };
+    atomic<int> state; // RUNNING and STOPPING are set by the caller, only the sound thread goes back to IDLE
+
+    FFTBuffer in, current, next; // sound thread only
+    uint N = 0;
+    uint pos = 0;
+    uint fade = 0;
+    uint fadePos = 0;
+    bool fading = false;
+    vector<short> block;
+
+    SynthStream() : block(streamBlock) { latest = 1; state = IDLE; }
+
+    void publish(const vector<double>& spectrum, uint sample_rate, float crossfade) {
+        auto& p = slots[writing];
+        p.spectrum.assign(spectrum.begin(), spectrum.end());
+        p.sample_rate = sample_rate;
+        p.crossfade = crossfade;
+        writing = latest.exchange(writing | 4) & 3;
+    }
+
+    bool consume() {
+        if ((latest.load() & 4) == 0) return false;
+        reading = latest.exchange(reading) & 3;
+        return true;
+    }
+
+    void start(Params& p) {
+        if (p.sample_rate == 0) return;
+        if (p.sample_rate != N) { // fade in from silence
+            N = p.sample_rate;
+            pos = 0;
+            current.resize(N);
+            for (uint i=0; i<N; i++) current.data[i] = 0;
+        }
+        getPlans().transform(p.spectrum, in, next, N);
+        fade = max(1u, min(N, uint(p.crossfade*N)));
+        fadePos = 0;
+        fading = true;
+    }
+
+    void render() {
+        for (uint i=0; i<streamBlock; i++) {
+            double v = current.data[pos];
+            if (fading) {
+                double w = 0.5 - 0.5*cos(Pi*double(fadePos)/fade);
+                v += w*(next.data[pos] - v);
+                if (++fadePos >= fade) { current.swap(next); fading = false; }
+            }
+            v *= 0.5 * SHRT_MAX; // like synthesizeSpectrum
+            block[i] = max(double(SHRT_MIN), min(double(SHRT_MAX), v));
+            if (++pos >= N) pos = 0;
+        }
+    }
+};
+
 struct VRSound::ALData {
     ALenum sample = 0;
     ALenum format = 0;
@@ -52,6 +234,7 @@ VRSound::VRSound() {
     VRSoundManager::get(); // this may init channel
     buffers = new uint[Nbuffers];
     al = shared_ptr<ALData>( new ALData() );
+    interrupt = false;
 }
 
 VRSound::~VRSound() {
@@ -70,7 +253,11 @@ void VRSound::setPitch(float pitch) { this->pitch = pitch; doUpdate = true; }
 void VRSound::setGain(float gain) { this->gain = gain; doUpdate = true; }
 void VRSound::setUser(Vec3f p, Vec3f v) { pos = p; vel = v; doUpdate = true; }
 bool VRSound::isRunning() { return al->state == AL_PLAYING; }
-void VRSound::stop() { interrupt = true; }
+void VRSound::stop() {
+    if (!synth) { interrupt = true; return; }
+    int s = SynthStream::RUNNING; // a stream that is not running stays idle
+    synth->state.compare_exchange_strong(s, SynthStream::STOPPING);
+}
 
 void VRSound::close() {
     ALCHECK( alDeleteSources(1u, &source));
@@ -209,6 +396,7 @@ bool VRSound::initiate() {
 }
 
 void VRSound::playFrame() {
+    if (synth) { synthFrame(); return; }
     cout << "play frame " << endl;
     if (al->state == AL_INITIAL) {
         cout << "reset sound " << endl;
@@ -350,11 +538,12 @@ void VRSound::play() {
 
 void VRSound::playBuffer(vector<short>& buffer, int sample_rate) {
     recycleBuffer();
+    if (free_buffers.size() == 0) { cout << "VRSound::playBuffer: all buffers queued, packet dropped\n"; return; }
 
     ALint val = -1;
-    ALuint buf;
-    alGenBuffers(1, &buf);
-    alBufferData(buf, AL_FORMAT_MONO16, &buffer[0], buffer.size()*sizeof(short), sample_rate);
+    ALuint buf = free_buffers.front();
+    free_buffers.pop_front();
+    ALCHECK( alBufferData(buf, AL_FORMAT_MONO16, &buffer[0], buffer.size()*sizeof(short), sample_rate));
 
     queuedBuffers += 1;
     ALCHECK( alSourceQueueBuffers(source, 1, &buf));
@@ -394,22 +583,14 @@ vector<short> VRSound::synthesizeSpectrum(vector<double> spectrum, uint sample_r
     size_t buf_size = duration * sample_rate;
     uint fade = min(fade_factor * sample_rate, duration * sample_rate); // number of samples to fade at beginning and end
 
-    // transform spectrum back to time domain using fftw3
-    vector<double> out(sample_rate);
-    //vector<double> out(buf_size);
-    // create plan
-    fftw_plan ifft;
-    //out = (double *) malloc(size*sizeof(double));
-
-    ifft = fftw_plan_r2r_1d(sample_rate, &spectrum[0], &out[0], FFTW_DHT, FFTW_ESTIMATE);   //Setup fftw plan for ifft
-    //ifft = fftw_plan_r2r_1d(buf_size, &spectrum[0], &out[0], FFTW_DHT, FFTW_ESTIMATE);
-    fftw_execute(ifft); // is output normalized?
-    fftw_destroy_plan(ifft);
+    // transform spectrum back to time domain using a cached fftw3 plan
+    FFTBuffer in, out;
+    getPlans().transform(spectrum, in, out, sample_rate); // is output normalized?
 
     vector<short> samples(buf_size);
     for(uint i=0; i<buf_size; ++i) {
         //samples[i] = (double)(SHRT_MAX - 1) * out[i] / (sample_rate * maxVal); // for fftw normalization
-        samples[i] = 0.5 * SHRT_MAX * out[i]; // for fftw normalization
+        samples[i] = 0.5 * SHRT_MAX * out.data[i%sample_rate]; // for fftw normalization
     }
 
     //uint flat = fade / 10;
@@ -506,15 +687,58 @@ int VRSound::getQueuedBuffer() { return queuedBuffers; }
 
 void VRSound::recycleBuffer() {
     ALint val = -1;
-    ALuint bufid = 0; // TODO: not working properly!!
+    ALuint bufid = 0;
     do { ALCHECK_BREAK( alGetSourcei(source, AL_BUFFERS_PROCESSED, &val) ); // recycle buffers
         for(; val > 0; --val) {
             ALCHECK( alSourceUnqueueBuffers(source, 1, &bufid));
+            free_buffers.push_back(bufid);
             if ( queuedBuffers > 0 ) queuedBuffers -= 1;
         }
     } while (val > 0);
 }
 
+void VRSound::streamSpectrum(const vector<double>& spectrum, uint sample_rate, float crossfade) {
+    if (!synth) synth = shared_ptr<SynthStream>( new SynthStream() );
+    synth->publish(spectrum, sample_rate, crossfade);
+    if (synth->state.exchange(SynthStream::RUNNING) != SynthStream::IDLE) return; // still registered, a pending stop is revoked
+
+    al->state = AL_PLAYING;
+    VRSoundManager::get().playStream( shared_from_this() );
+}
+
+/** called by the sound thread, keeps streamDepth buffers queued **/
+void VRSound::synthFrame() {
+    if (!initiated) initiate();
+    if (synth->state == SynthStream::STOPPING) {
+        al->state = AL_STOPPED; // before going idle, a streamSpectrum after that sets it to playing again
+        int s = SynthStream::STOPPING;
+        if (synth->state.compare_exchange_strong(s, SynthStream::IDLE)) {
+            ALCHECK( alSourceStop(source));
+            recycleBuffer();
+            return;
+        }
+        al->state = AL_PLAYING; // restarted in between
+    }
+    if (doUpdate) updateSource();
+
+    recycleBuffer();
+    while (queuedBuffers < streamDepth && free_buffers.size()) {
+        if (!synth->fading && synth->consume()) synth->start( synth->slots[synth->reading] );
+        if (synth->N == 0) return; // no spectrum yet
+
+        synth->render();
+        ALuint bufid = free_buffers.front();
+        free_buffers.pop_front();
+        queuedBuffers += 1;
+        ALCHECK( alBufferData(bufid, AL_FORMAT_MONO16, &synth->block[0], synth->block.size()*sizeof(short), synth->N));
+        ALCHECK( alSourceQueueBuffers(source, 1, &bufid));
+    }
+
+    ALint val = -1;
+    ALCHECK( alGetSourcei(source, AL_SOURCE_STATE, &val));
+    if (val != AL_PLAYING && queuedBuffers > 0) ALCHECK( alSourcePlay(source));
+}
+
 
 
 
@@ -2,6 +2,7 @@
 #define VRSOUND_H_INCLUDED
 
 #include <list>
+#include <atomic>
 #include <OpenSG/OSGVector.h>
 
 #include "VRSoundFwd.h"
@@ -9,10 +10,12 @@
 using namespace std;
 OSG_BEGIN_NAMESPACE;
 
-class VRSound {
+class VRSound : public std::enable_shared_from_this<VRSound> {
     private:
         struct ALData;
+        struct SynthStream;
         shared_ptr<ALData> al;
+        shared_ptr<SynthStream> synth;
 
         int queuedBuffers = 0;
         uint source = 0;
@@ -23,7 +26,7 @@ class VRSound {
         int stream_id = 0;
         int init = 0;
         string path;
-        bool interrupt = false;
+        atomic<bool> interrupt; // set by stop, read by the sound thread
         bool initiated = false;
         bool doUpdate = false;
 
@@ -33,6 +36,7 @@ class VRSound {
         Vec3f pos, vel;
 
         void playBuffer(vector<short>& buffer, int sample_rate);
+        void synthFrame();
 
     public:
         VRSound();
@@ -69,6 +73,10 @@ class VRSound {
         vector<short> synthesizeSpectrum(vector<double> spectrum, uint samples, float duration, float fade_factor, bool returnBuffer = false);
         vector<short> synthBuffer(vector<Vec2d> freqs1, vector<Vec2d> freqs2, float T = 1);
 
+        /** continuous synthesis of the spectrum on the sound thread, the waveform crossfades to each new spectrum,
+            the caller only copies the spectrum and never waits for the sound thread **/
+        void streamSpectrum(const vector<double>& spectrum, uint sample_rate, float crossfade = 0.01);
+
 };
 
 OSG_END_NAMESPACE;
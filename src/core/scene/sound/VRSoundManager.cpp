@@ -79,6 +79,7 @@ struct VRSoundChannel {
     VRSoundContext* context = 0;
     boost::mutex mutex;
     map<int, VRSoundPtr> current;
+    int nextID = 0;
 
     VRSoundChannel() {
         thread = new boost::thread(boost::bind(&VRSoundChannel::soundThread, this));
@@ -92,7 +93,8 @@ struct VRSoundChannel {
 
     void play(VRSoundPtr sound) {
         boost::mutex::scoped_lock lock(mutex);
-        current[current.size()] = sound;
+        for (auto& c : current) if (c.second == sound) return; // a restarted stream may not be erased yet
+        current[nextID++] = sound;
     }
 
     void soundThread() {
@@ -154,6 +156,11 @@ void VRSoundManager::playSound(string path, bool loop) {
 
 void VRSoundManager::play(VRSoundPtr sound) { sound->play(); }
 
+void VRSoundManager::playStream(VRSoundPtr sound) {
+    if (!channel) channel = new VRSoundChannel();
+    channel->play(sound);
+}
+
 VRSoundPtr VRSoundManager::getSound(string path) {
     if (sounds.count(path) == 0) { // TODO: WORKAROUND
         sounds[path] = VRSound::create();
@@ -23,6 +23,7 @@ public:
     void clearSoundMap(void);
 
     void play(VRSoundPtr sound);
+    void playStream(VRSoundPtr sound);
 
 public:
     static VRSoundManager& get();
@@ -20,6 +20,8 @@
 
 #include <OpenSG/OSGGeoProperties.h>
 #include <OpenSG/OSGGeometry.h>
+#include <type_traits>
+#include <cstring>
 
 using namespace OSG;
 
@@ -97,6 +99,11 @@ PyMethodDef VRPyGeometry::methods[] = {
     {"getColors", (PyCFunction)VRPyGeometry::getColors, METH_NOARGS, "get geometry colors" },
     {"getIndices", (PyCFunction)VRPyGeometry::getIndices, METH_NOARGS, "get geometry indices" },
     {"getTexCoords", (PyCFunction)VRPyGeometry::getTexCoords, METH_NOARGS, "get geometry texture coordinates" },
+    {"getBuffer", (PyCFunction)VRPyGeometry::getBuffer, METH_VARARGS, "Get a read only view on the geometry data, without copying it - buffer getBuffer( str data | int channel )"
+                        "\n\tdata can be: 'positions', 'normals', 'colors', 'texcoords', 'indices', 'lengths', 'types'"
+                        "\n\tthe buffer is flat, use for example numpy.asarray(geo.getBuffer('positions')).reshape(-1,3) or memoryview(geo.getBuffer('indices'))"
+                        "\n\tthe view keeps the data alive, while a numpy array or memoryview of it exists edits of the geometry work on a copy of the mesh"
+                        "\n\tthe setters copy numpy arrays or any other buffer in bulk, float32 and uint32 data with a single memcpy" },
     {"getMaterial", (PyCFunction)VRPyGeometry::getMaterial, METH_NOARGS, "get material" },
     {"merge", (PyCFunction)VRPyGeometry::merge, METH_VARARGS, "Merge another geometry into this one - merge( geo )" },
     {"remove", (PyCFunction)VRPyGeometry::remove, METH_VARARGS, "Remove a part of the geometry - remove( Selection s )" },
@@ -120,7 +127,7 @@ PyMethodDef VRPyGeometry::methods[] = {
     {"playVideo", (PyCFunction)VRPyGeometry::playVideo, METH_VARARGS, "Play the video texture from t0 to t1 - playVideo(t0, t1, speed)" },
     {"decimate", (PyCFunction)VRPyGeometry::decimate, METH_VARARGS, "Decimate geometry by collapsing a fraction of edges - decimate(f)" },
     {"setRandomColors", (PyCFunction)VRPyGeometry::setRandomColors, METH_NOARGS, "Set a random color for each vertex" },
-    {"removeDoubles", (PyCFunction)VRPyGeometry::removeDoubles, METH_VARARGS, "Remove double vertices" },
+    {"removeDoubles", (PyCFunction)VRPyGeometry::removeDoubles, METH_VARARGS, "Weld the vertices closer than the tolerance with normals differing less than the angle - removeDoubles( | float angle, float tolerance)" },
     {"updateNormals", (PyCFunction)VRPyGeometry::updateNormals, METH_VARARGS, "Recalculate the normals of the geometry - updateNormals(| bool face)\n\tset face to true to compute face normals, the default are vertex normals" },
     {"makeUnique", (PyCFunction)VRPyGeometry::makeUnique, METH_NOARGS, "Make the geometry data unique" },
     {"influence", (PyCFunction)VRPyGeometry::influence, METH_VARARGS, "Pass a points and value vector to influence the geometry - influence([points,f3], [values,f3], int power)" },
@@ -209,18 +216,6 @@ void feed2D_v2(PyObject* o, T& vec) {
     }
 }
 
-template<class T>
-void feed1Dnp(PyObject* o, T& vec) {
-    PyArrayObject* a = (PyArrayObject*)o;
-    int N = PyArray_DIMS(a)[0];
-    vec->resize(N);
-
-    for (Py_ssize_t i=0; i<N; i++) {
-        int* j = (int*)PyArray_GETPTR1(a, i);
-        vec->setValue(*j, i);
-    }
-}
-
 template<class T>
 void feed1D(PyObject* o, T& vec) {
     PyObject *pi;
@@ -233,20 +228,60 @@ void feed1D(PyObject* o, T& vec) {
     }
 }
 
-template<class T, class t>
-void feed1D3np(PyObject* o, T& vec) {
-    PyArrayObject* a = (PyArrayObject*)o;
-    int N = PyArray_DIMS(a)[0];
-    for (Py_ssize_t i=0; i<N; i+=3) {
-        t tmp;
-        float* x = (float*)PyArray_GETPTR1(a, i+0);
-        float* y = (float*)PyArray_GETPTR1(a, i+1);
-        float* z = (float*)PyArray_GETPTR1(a, i+2);
-        tmp[0] = *x;
-        tmp[1] = *y;
-        tmp[2] = *z;
-        vec->addValue(tmp);
-    }
+template<class S, class T>
+void copyBuffer(S* dst, const void* src, Py_ssize_t N) {
+    if (is_same<S, T>::value) { memcpy(dst, src, N*sizeof(S)); return; }
+    const T* s = (const T*)src;
+    for (Py_ssize_t i=0; i<N; i++) dst[i] = s[i];
+}
+
+/** number of columns of a 2D buffer, 0 for other buffers **/
+int bufferColumns(PyObject* o) {
+    Py_buffer b;
+    if (PyObject_GetBuffer(o, &b, PyBUF_ND) == -1) { PyErr_Clear(); return 0; }
+    int n = (b.ndim == 2) ? b.shape[1] : 0;
+    PyBuffer_Release(&b);
+    return n;
+}
+
+/**
+ * Bulk copy from an object exporting the buffer protocol, like numpy arrays, array.array or memoryview.
+ * The property is resized to N/dim elements, data with the scalar type S of the property is copied with a single memcpy.
+ * Returns false and sets a python error if the buffer is not contiguous or has an unsupported format.
+ */
+template<class S, class P>
+bool feedBuffer(PyObject* o, P& prop, int dim, string caller) {
+    Py_buffer b;
+    if (PyObject_GetBuffer(o, &b, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == -1) return false;
+
+    string f = b.format ? b.format : "B";
+    if (f.size() > 1 && (f[0] == '@' || f[0] == '=' || f[0] == '<')) f = f.substr(1);
+    Py_ssize_t N = b.itemsize ? b.len/b.itemsize : 0;
+    string e;
+    if (N%dim) e = caller + " - buffer size " + toString(N) + " is not a multiple of " + toString(dim);
+    if (b.ndim == 2 && b.shape[1] != dim) e = caller + " - buffer has " + toString(b.shape[1]) + " columns, expected " + toString(dim);
+    if (f.size() != 1) e = caller + " - unsupported buffer format " + f;
+    if (e != "") { PyBuffer_Release(&b); PyErr_SetString(VRPyBase::err, e.c_str()); return false; }
+
+    prop->resize(N/dim);
+    if (N == 0) { PyBuffer_Release(&b); return true; }
+    S* dst = (S*)&prop->editField()[0];
+
+    char c = f[0];
+    int s = b.itemsize;
+    bool ok = true;
+    if (c == 'f' && s == 4) copyBuffer<S, float>(dst, b.buf, N);
+    else if (c == 'd' && s == 8) copyBuffer<S, double>(dst, b.buf, N);
+    else if ((c == 'i' || c == 'l' || c == 'q') && s == 4) copyBuffer<S, int32_t>(dst, b.buf, N);
+    else if ((c == 'i' || c == 'l' || c == 'q') && s == 8) copyBuffer<S, int64_t>(dst, b.buf, N);
+    else if ((c == 'I' || c == 'L' || c == 'Q') && s == 4) copyBuffer<S, uint32_t>(dst, b.buf, N);
+    else if ((c == 'I' || c == 'L' || c == 'Q') && s == 8) copyBuffer<S, uint64_t>(dst, b.buf, N);
+    else if (c == 'B' && s == 1) copyBuffer<S, uint8_t>(dst, b.buf, N);
+    else ok = false;
+    PyBuffer_Release(&b);
+
+    if (!ok) { prop->resize(0); PyErr_SetString(VRPyBase::err, (caller + " - unsupported buffer format " + f).c_str()); }
+    return ok;
 }
 
 template<class T, class t>
@@ -473,7 +508,9 @@ PyObject* VRPyGeometry::makeUnique(VRPyGeometry* self) {
 
 PyObject* VRPyGeometry::removeDoubles(VRPyGeometry* self, PyObject *args) {
     if (!self->valid()) return NULL;
-    self->objPtr->removeDoubles( parseFloat(args) );
+    float a = 0, t = 1e-5;
+    if (! PyArg_ParseTuple(args, "|ff:removeDoubles", &a, &t)) return NULL;
+    self->objPtr->removeDoubles(a, t);
     Py_RETURN_TRUE;
 }
 
@@ -538,16 +575,17 @@ PyObject* VRPyGeometry::setPositions(VRPyGeometry* self, PyObject *args) {
 
 	GeoPnt3fPropertyRecPtr pos = GeoPnt3fProperty::create();
 
+    if (PyObject_CheckBuffer(vec)) {
+        if (!feedBuffer<Real32>(vec, pos, 3, "VRPyGeometry::setPositions")) return NULL;
+        self->objPtr->setPositions(pos);
+        Py_RETURN_TRUE;
+    }
+
     int ld = getListDepth(vec);
-    string tname = vec->ob_type->tp_name;
 
-    if (ld == 1) {
-        if (tname == "numpy.ndarray") feed1D3np<GeoPnt3fPropertyRecPtr, Pnt3f>(vec, pos);
-        else feed1D3<GeoPnt3fPropertyRecPtr, Pnt3f>(vec, pos);
-    } else if (ld == 2) {
-        if (tname == "numpy.ndarray") feed2Dnp<GeoPnt3fPropertyRecPtr, Pnt3f>(vec, pos);
-        else feed2D<GeoPnt3fPropertyRecPtr, Pnt3f>(vec, pos);
-    } else if (ld == 3) {
+    if (ld == 1) feed1D3<GeoPnt3fPropertyRecPtr, Pnt3f>(vec, pos);
+    else if (ld == 2) feed2D<GeoPnt3fPropertyRecPtr, Pnt3f>(vec, pos);
+    else if (ld == 3) {
         for(Py_ssize_t i = 0; i < PyList_Size(vec); i++) {
             PyObject* vecList = PyList_GetItem(vec, i);
             string tname = vecList->ob_type->tp_name;
@@ -570,16 +608,18 @@ PyObject* VRPyGeometry::setNormals(VRPyGeometry* self, PyObject *args) {
     if (! PyArg_ParseTuple(args, "O", &vec)) return NULL;
 
     GeoVec3fPropertyRecPtr norms = GeoVec3fProperty::create();
-    string tname = vec->ob_type->tp_name;
+
+    if (PyObject_CheckBuffer(vec)) {
+        if (!feedBuffer<Real32>(vec, norms, 3, "VRPyGeometry::setNormals")) return NULL;
+        self->objPtr->setNormals(norms);
+        Py_RETURN_TRUE;
+    }
+
     int ld = getListDepth(vec);
 
-    if (ld == 1) {
-        if (tname == "numpy.ndarray") feed1D3np<GeoVec3fPropertyRecPtr, Vec3f>( vec, norms);
-        else feed1D3<GeoVec3fPropertyRecPtr, Vec3f>( vec, norms);
-    } else if (ld == 2) {
-        if (tname == "numpy.ndarray") feed2Dnp<GeoVec3fPropertyRecPtr, Vec3f>( vec, norms);
-        else feed2D<GeoVec3fPropertyRecPtr, Vec3f>( vec, norms);
-    } else {
+    if (ld == 1) feed1D3<GeoVec3fPropertyRecPtr, Vec3f>( vec, norms);
+    else if (ld == 2) feed2D<GeoVec3fPropertyRecPtr, Vec3f>( vec, norms);
+    else {
         string e = "VRPyGeometry::setNormals - bad argument, ld is " + toString(ld);
         PyErr_SetString(err, e.c_str());
         return NULL;
@@ -595,9 +635,15 @@ PyObject* VRPyGeometry::setColors(VRPyGeometry* self, PyObject *args) {
     if (! PyArg_ParseTuple(args, "O", &vec)) return NULL;
     VRGeometryPtr geo = (VRGeometryPtr) self->objPtr;
 
+    if (PyObject_CheckBuffer(vec) && bufferColumns(vec) == 3) {
+        GeoVec3fPropertyRecPtr cols = GeoVec3fProperty::create();
+        if (!feedBuffer<Real32>(vec, cols, 3, "VRPyGeometry::setColors")) return NULL;
+        geo->setColors(cols, true);
+        Py_RETURN_TRUE;
+    }
+
     GeoVec4fPropertyRecPtr cols = GeoVec4fProperty::create();
-    string tname = vec->ob_type->tp_name;
-    if (tname == "numpy.ndarray") feed2Dnp<GeoVec4fPropertyRecPtr, Vec4f>( vec, cols);
+    if (PyObject_CheckBuffer(vec)) { if (!feedBuffer<Real32>(vec, cols, 4, "VRPyGeometry::setColors")) return NULL; }
     else feed2D<GeoVec4fPropertyRecPtr, Vec4f>( vec, cols);
 
     geo->setColors(cols, true);
@@ -623,12 +669,16 @@ PyObject* VRPyGeometry::setIndices(VRPyGeometry* self, PyObject *args) {
     if (! PyArg_ParseTuple(args, "O", &vec)) return NULL;
 
     GeoUInt32PropertyRecPtr inds = GeoUInt32Property::create();
-    string tname = vec->ob_type->tp_name;
+
+    if (PyObject_CheckBuffer(vec)) {
+        if (!feedBuffer<UInt32>(vec, inds, 1, "VRPyGeometry::setIndices")) return NULL;
+        self->objPtr->setIndices(inds, true);
+        Py_RETURN_TRUE;
+    }
 
     int ld = getListDepth(vec);
     if (ld == 1) {
-        if (tname == "numpy.ndarray") feed1Dnp<GeoUInt32PropertyRecPtr>( vec, inds);
-        else feed1D<GeoUInt32PropertyRecPtr>( vec, inds );
+        feed1D<GeoUInt32PropertyRecPtr>( vec, inds );
         self->objPtr->setIndices(inds, true);
     } else if (ld == 2) {
         GeoUInt32PropertyRecPtr lengths = GeoUInt32Property::create();
@@ -652,6 +702,19 @@ PyObject* VRPyGeometry::setTexCoords(VRPyGeometry* self, PyObject *args) {
     int doIndexFix = false;
     if (! PyArg_ParseTuple(args, "O|ii", &vec, &channel, &doIndexFix)) return NULL;
 
+    if (PyObject_CheckBuffer(vec)) {
+        if (bufferColumns(vec) == 3) {
+            GeoVec3fPropertyRecPtr tc = GeoVec3fProperty::create();
+            if (!feedBuffer<Real32>(vec, tc, 3, "VRPyGeometry::setTexCoords")) return NULL;
+            self->objPtr->setTexCoords(tc, channel, doIndexFix);
+        } else {
+            GeoVec2fPropertyRecPtr tc = GeoVec2fProperty::create();
+            if (!feedBuffer<Real32>(vec, tc, 2, "VRPyGeometry::setTexCoords")) return NULL;
+            self->objPtr->setTexCoords(tc, channel, doIndexFix);
+        }
+        Py_RETURN_TRUE;
+    }
+
     if (pySize(vec) == 0) Py_RETURN_TRUE;
     int vN = pySize(PyList_GetItem(vec,0));
 
@@ -816,6 +879,116 @@ PyObject* VRPyGeometry::getTexCoords(VRPyGeometry* self) {
     return res;
 }
 
+namespace {
+
+/**
+ * Read only view on a geometry property, exports the property memory with the buffer protocol.
+ * It holds a reference on the property, each export is registered with VRGeometry::exportProperty until it is released,
+ * VRGeoData then edits a copy of the mesh so the property is never resized below a numpy array or memoryview.
+ */
+struct VRPyGeoBuffer {
+    PyObject_HEAD;
+    GeoPropertyRecPtr* prop;
+    const char* format;
+    Py_ssize_t itemsize;
+    Py_ssize_t count;
+
+    static void dealloc(VRPyGeoBuffer* self) {
+        delete self->prop;
+        PyObject_Del(self);
+    }
+
+    static int getbuffer(VRPyGeoBuffer* self, Py_buffer* view, int flags) {
+        if (flags & PyBUF_WRITABLE) { PyErr_SetString(PyExc_BufferError, "VR.GeoBuffer is read only"); view->obj = 0; return -1; }
+        GeoProperty* p = *self->prop;
+        self->count = p->getSize()*p->getDimension();
+        void* data = self->count ? (void*)p->getData() : (void*)"";
+        if (PyBuffer_FillInfo(view, (PyObject*)self, data, self->count*self->itemsize, 1, flags) == -1) return -1;
+        view->itemsize = self->itemsize;
+        if (flags & PyBUF_FORMAT) view->format = (char*)self->format;
+        if (flags & PyBUF_ND) view->shape = &self->count;
+        VRGeometry::exportProperty(p, true);
+        return 0;
+    }
+
+    static void releasebuffer(VRPyGeoBuffer* self, Py_buffer* view) { VRGeometry::exportProperty(*self->prop, false); }
+};
+
+PyBufferProcs geoBufferProcs = { 0, 0, 0, 0, (getbufferproc)VRPyGeoBuffer::getbuffer, (releasebufferproc)VRPyGeoBuffer::releasebuffer };
+
+PyTypeObject geoBufferType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "VR.GeoBuffer",             /*tp_name*/
+    sizeof(VRPyGeoBuffer),             /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)VRPyGeoBuffer::dealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    &geoBufferProcs,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, /*tp_flags*/
+    "Read only view on geometry data, returned by Geometry.getBuffer",           /* tp_doc */
+};
+
+}
+
+PyObject* VRPyGeometry::getBuffer(VRPyGeometry* self, PyObject *args) {
+    if (!self->valid()) return NULL;
+    PyObject* o = 0;
+    if (!PyArg_ParseTuple(args, "O", &o)) return NULL;
+    if (self->objPtr->getMesh() == 0) { PyErr_SetString(err, "VRPyGeometry::getBuffer - Mesh is invalid"); return NULL; }
+
+    Geometry* geo = self->objPtr->getMesh()->geo;
+    GeoPropertyRecPtr prop;
+    if (PyInt_Check(o)) prop = geo->getProperty(Geometry::TexCoordsIndex + PyInt_AsLong(o));
+    else {
+        string data = PyString_AsString(o) ? PyString_AsString(o) : "";
+        if (data == "positions") prop = geo->getPositions();
+        else if (data == "normals") prop = geo->getNormals();
+        else if (data == "colors") prop = geo->getColors();
+        else if (data == "texcoords") prop = geo->getTexCoords();
+        else if (data == "indices") prop = geo->getIndices();
+        else if (data == "lengths") prop = geo->getLengths();
+        else if (data == "types") prop = geo->getTypes();
+        else { PyErr_SetString(err, ("VRPyGeometry::getBuffer - unknown data " + data).c_str()); return NULL; }
+    }
+    if (prop == 0) Py_RETURN_NONE;
+
+    const char* format = 0;
+    switch (prop->getFormat()) {
+        case GL_FLOAT: format = "f"; break;
+        case GL_DOUBLE: format = "d"; break;
+        case GL_INT: format = "i"; break;
+        case GL_UNSIGNED_INT: format = "I"; break;
+        case GL_SHORT: format = "h"; break;
+        case GL_UNSIGNED_SHORT: format = "H"; break;
+        case GL_BYTE: format = "b"; break;
+        case GL_UNSIGNED_BYTE: format = "B"; break;
+    }
+    if (!format) { PyErr_SetString(err, "VRPyGeometry::getBuffer - unsupported property format"); return NULL; }
+
+    static bool ready = PyType_Ready(&geoBufferType) == 0;
+    if (!ready) { PyErr_SetString(err, "VRPyGeometry::getBuffer - could not set up the buffer type"); return NULL; }
+    VRPyGeoBuffer* res = PyObject_New(VRPyGeoBuffer, &geoBufferType);
+    if (!res) return NULL;
+    res->prop = new GeoPropertyRecPtr(prop);
+    res->format = format;
+    res->itemsize = prop->getFormatSize();
+    res->count = 0;
+    return (PyObject*)res;
+}
+
 PyObject* VRPyGeometry::setVideo(VRPyGeometry* self, PyObject *args) {
     if (!self->valid()) return NULL;
     VRGeometryPtr geo = (VRGeometryPtr) self->objPtr;
@@ -28,6 +28,7 @@ struct VRPyGeometry : VRPyBaseT<OSG::VRGeometry> {
     static PyObject* getColors(VRPyGeometry* self);
     static PyObject* getIndices(VRPyGeometry* self);
     static PyObject* getTexCoords(VRPyGeometry* self);
+    static PyObject* getBuffer(VRPyGeometry* self, PyObject *args);
     static PyObject* getMaterial(VRPyGeometry* self);
     static PyObject* duplicate(VRPyGeometry* self);
     static PyObject* clear(VRPyGeometry* self);
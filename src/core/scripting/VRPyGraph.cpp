@@ -1,6 +1,7 @@
 #include "VRPyGraph.h"
 #include "VRPyTransform.h"
 #include "VRPyBaseT.h"
+#include "core/math/VRGraphCSR.h"
 
 using namespace OSG;
 
@@ -10,6 +11,10 @@ PyMethodDef VRPyGraph::methods[] = {
     {"getEdges", (PyCFunction)VRPyGraph::getEdges, METH_NOARGS, "Return graph edges - getEdges()" },
     {"getInEdges", (PyCFunction)VRPyGraph::getInEdges, METH_VARARGS, "Return graph edges going in node n - getInEdges( int n )" },
     {"getOutEdges", (PyCFunction)VRPyGraph::getOutEdges, METH_VARARGS, "Return graph edges comming out node n - getOutEdges( int n )" },
+    {"getShortestPath", (PyCFunction)VRPyGraph::getShortestPath, METH_VARARGS, "Return the nodes of the shortest path, weighted by the node distances, empty if not connected - [int] getShortestPath( int n1, int n2, bool undirected = False )" },
+    {"getReachable", (PyCFunction)VRPyGraph::getReachable, METH_VARARGS, "Return the nodes reachable from node n in breadth first order - [int] getReachable( int n, int maxDepth = -1, bool undirected = False )" },
+    {"getComponents", (PyCFunction)VRPyGraph::getComponents, METH_NOARGS, "Return the connected component of each node - [int] getComponents()" },
+    {"getTopologicalOrder", (PyCFunction)VRPyGraph::getTopologicalOrder, METH_NOARGS, "Return the nodes in topological order, None if the graph has cycles - [int] getTopologicalOrder()" },
     {NULL}  /* Sentinel */
 };
 
@@ -58,3 +63,45 @@ PyObject* VRPyGraph::getOutEdges(VRPyGraph* self, PyObject* args) {
     for (auto& e : n) PyList_Append(res, convEdge(e));
     return res;
 }
+
+static PyObject* toPyList(const vector<int>& v) {
+    PyObject* res = PyList_New(v.size());
+    for (uint i=0; i<v.size(); i++) PyList_SetItem(res, i, PyInt_FromLong(v[i]));
+    return res;
+}
+
+PyObject* VRPyGraph::getShortestPath(VRPyGraph* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    int i, j, u = 0;
+    if (!PyArg_ParseTuple(args, "ii|i", &i, &j, &u)) return NULL;
+    VRGraphCSR csr;
+    csr.build(self->objPtr, u);
+    return toPyList( csr.shortestPathAStar(i, j) );
+}
+
+PyObject* VRPyGraph::getReachable(VRPyGraph* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    int i, d = -1, u = 0;
+    if (!PyArg_ParseTuple(args, "i|ii", &i, &d, &u)) return NULL;
+    VRGraphCSR csr;
+    csr.build(self->objPtr, u);
+    return toPyList( csr.bfs(i, d) );
+}
+
+PyObject* VRPyGraph::getComponents(VRPyGraph* self) {
+    if (!self->valid()) return NULL;
+    VRGraphCSR csr;
+    csr.build(self->objPtr);
+    vector<int> labels;
+    csr.connectedComponents(labels);
+    return toPyList( labels );
+}
+
+PyObject* VRPyGraph::getTopologicalOrder(VRPyGraph* self) {
+    if (!self->valid()) return NULL;
+    VRGraphCSR csr;
+    csr.build(self->objPtr);
+    vector<int> order;
+    if (!csr.topologicalSort(order)) Py_RETURN_NONE;
+    return toPyList( order );
+}
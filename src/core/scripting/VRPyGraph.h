@@ -9,6 +9,10 @@ struct VRPyGraph : VRPyBaseT<OSG::Graph> {
     static PyObject* getEdges(VRPyGraph* self);
     static PyObject* getInEdges(VRPyGraph* self, PyObject* args);
     static PyObject* getOutEdges(VRPyGraph* self, PyObject* args);
+    static PyObject* getShortestPath(VRPyGraph* self, PyObject* args);
+    static PyObject* getReachable(VRPyGraph* self, PyObject* args);
+    static PyObject* getComponents(VRPyGraph* self);
+    static PyObject* getTopologicalOrder(VRPyGraph* self);
 };
 
 #endif // VRPYGRAPH_H_INCLUDED
@@ -163,6 +163,7 @@ PyObject* VRPyObject::getChildrenWithTag(VRPyObject* self, PyObject* args) {
 PyObject* VRPyObject::setTravMask(VRPyObject* self, PyObject* args) {
     if (self->objPtr == 0) { PyErr_SetString(err, "VRPyObject::setTravMask - C Object is invalid"); return NULL; }
     self->objPtr->getNode()->node->setTravMask( parseInt(args) );
+    VRObject::markGraphChanged();
     Py_RETURN_TRUE;
 }
 
@@ -16,12 +16,16 @@ PyMethodDef VRPyRecorder::methods[] = {
     {"getRecordingLength", (PyCFunction)VRPyRecorder::getRecordingLength, METH_NOARGS, "Get the length in seconds fromt he first to last of the captured frames - float getRecordingLength()" },
     {"setMaxFrames", (PyCFunction)VRPyRecorder::setMaxFrames, METH_VARARGS, "Set the maximum number of frames" },
     {"frameLimitReached", (PyCFunction)VRPyRecorder::frameLimitReached, METH_NOARGS, "Check if the frame limit has been reached" },
-    {"get", (PyCFunction)VRPyRecorder::get, METH_VARARGS, "Get capture i - get(int i)" },
+    {"get", (PyCFunction)VRPyRecorder::get, METH_VARARGS, "Get capture i, only the last capture is kept - get(int i)" },
     {"setTransform", (PyCFunction)VRPyRecorder::setTransform, METH_VARARGS, "Apply the transform of the camera pose of frame i - setTransform(transform t, int i)" },
     {"getFrom", (PyCFunction)VRPyRecorder::getFrom, METH_VARARGS, "Get the position of the camera pose of frame i - getFrom(int i)" },
     {"getDir", (PyCFunction)VRPyRecorder::getDir, METH_VARARGS, "Get the direction of the camera pose of frame i - getDir(int i)" },
     {"getAt", (PyCFunction)VRPyRecorder::getAt, METH_VARARGS, "Get the at vector of the camera pose of frame i - getAt(int i)" },
     {"getUp", (PyCFunction)VRPyRecorder::getUp, METH_VARARGS, "Get the up vector of the camera pose of frame i - getUp(int i)" },
+    {"setBufferCount", (PyCFunction)VRPyRecorder::setBufferCount, METH_VARARGS, "Set the number of frame buffers between capture and encoder, used for the next recording - setBufferCount(int N)" },
+    {"setBlocking", (PyCFunction)VRPyRecorder::setBlocking, METH_VARARGS, "Wait for a free buffer instead of dropping the frame when the encoder is behind - setBlocking(bool b)" },
+    {"getEncodedFrames", (PyCFunction)VRPyRecorder::getEncodedFrames, METH_NOARGS, "Get the number of encoded frames - int getEncodedFrames()" },
+    {"getDroppedFrames", (PyCFunction)VRPyRecorder::getDroppedFrames, METH_NOARGS, "Get the number of frames dropped because the encoder was behind - int getDroppedFrames()" },
     {NULL}  /* Sentinel */
 };
 
@@ -51,6 +55,28 @@ PyObject* VRPyRecorder::frameLimitReached(VRPyRecorder* self) {
     return PyBool_FromLong( self->objPtr->frameLimitReached() );
 }
 
+PyObject* VRPyRecorder::setBufferCount(VRPyRecorder* self, PyObject* args) {
+    if (self->objPtr) self->objPtr->setBufferCount( parseInt(args) );
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyRecorder::setBlocking(VRPyRecorder* self, PyObject* args) {
+    if (self->objPtr) self->objPtr->setBlocking( parseBool(args) );
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyRecorder::getEncodedFrames(VRPyRecorder* self) {
+    int N = 0;
+    if (self->objPtr) N = self->objPtr->getEncodedFrames();
+    return PyInt_FromLong(N);
+}
+
+PyObject* VRPyRecorder::getDroppedFrames(VRPyRecorder* self) {
+    int N = 0;
+    if (self->objPtr) N = self->objPtr->getDroppedFrames();
+    return PyInt_FromLong(N);
+}
+
 PyObject* VRPyRecorder::getRecordingSize(VRPyRecorder* self) {
     int size = 0;
     if (self->objPtr) size = self->objPtr->getRecordingSize();
@@ -21,6 +21,10 @@ struct VRPyRecorder : VRPyBaseT<OSG::VRRecorder> {
     static PyObject* getDir(VRPyRecorder* self, PyObject* args);
     static PyObject* getAt(VRPyRecorder* self, PyObject* args);
     static PyObject* getUp(VRPyRecorder* self, PyObject* args);
+    static PyObject* setBufferCount(VRPyRecorder* self, PyObject* args);
+    static PyObject* setBlocking(VRPyRecorder* self, PyObject* args);
+    static PyObject* getEncodedFrames(VRPyRecorder* self);
+    static PyObject* getDroppedFrames(VRPyRecorder* self);
 };
 
 #endif // VRPYRECORDER_H_INCLUDED
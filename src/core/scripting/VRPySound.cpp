@@ -15,6 +15,7 @@ PyMethodDef VRPySound::methods[] = {
     {"synthesize", (PyCFunction)VRPySound::synthesize, METH_VARARGS, "synthesize( Ac, wc, pc, Am, wm, pm, T)\t\n A,w,p are the amplitude, frequency and phase, c and m are the carrier sinusoid and modulator sinusoid, T is the packet duration in seconds" },
     {"synthBuffer", (PyCFunction)VRPySound::synthBuffer, METH_VARARGS, "synthBuffer( [[f,A]], T )\t\n [f,A] frequency/amplitude pairs, T is the packet duration in seconds" },
     {"synthSpectrum", (PyCFunction)VRPySound::synthSpectrum, METH_VARARGS, "synthSpectrum( [A], int S, float T, float F, bool retBuffer )\t\n A amplitude, S sample rate, T packet duration in seconds, F fade in/out duration in s , specify if you want to return the generated buffer" },
+    {"streamSpectrum", (PyCFunction)VRPySound::streamSpectrum, METH_VARARGS, "streamSpectrum( [A], int S, float F )\t\n A amplitude, S sample rate, F crossfade duration to the new spectrum in s, the sound plays the spectrum until the next call or stop" },
     {"getQueuedBuffer", (PyCFunction)VRPySound::getQueuedBuffer, METH_NOARGS, "Get the buffer currently queued - int getQueuedBuffer()" },
     {"recycleBuffer", (PyCFunction)VRPySound::recycleBuffer, METH_NOARGS, "Recycle unused buffers - recycleBuffer()" },
     {NULL}  /* Sentinel */
@@ -86,6 +87,20 @@ PyObject* VRPySound::synthSpectrum(VRPySound* self, PyObject* args) {
     return res;
 }
 
+PyObject* VRPySound::streamSpectrum(VRPySound* self, PyObject* args) {
+    int S;
+    float F = 0.01;
+    PyObject* v;
+    if (! PyArg_ParseTuple(args, "Oi|f", &v, &S, &F)) return NULL;
+
+    Py_ssize_t N = PyList_Size(v);
+    vector<double> data(N);
+    for (Py_ssize_t i=0; i<N; i++) data[i] = PyFloat_AsDouble( PyList_GetItem(v, i) );
+
+    self->objPtr->streamSpectrum(data, S, F);
+    Py_RETURN_TRUE;
+}
+
 PyObject* VRPySound::stopAllSounds(VRPySound* self) {
     VRSoundManager::get().stopAllSounds();
     Py_RETURN_TRUE;
@@ -14,6 +14,7 @@ struct VRPySound : VRPyBaseT<OSG::VRSound> {
     static PyObject* synthesize(VRPySound* self, PyObject* args);
     static PyObject* synthBuffer(VRPySound* self, PyObject* args);
     static PyObject* synthSpectrum(VRPySound* self, PyObject* args);
+    static PyObject* streamSpectrum(VRPySound* self, PyObject* args);
     static PyObject* getQueuedBuffer(VRPySound* self);
     static PyObject* recycleBuffer(VRPySound* self);
 };
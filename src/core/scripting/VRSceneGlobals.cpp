@@ -19,6 +19,7 @@
 #include "core/objects/VRTransform.h"
 #include "core/objects/material/VRMaterial.h"
 #include "core/utils/VRTests.h"
+#include "core/utils/VRProfiler.h"
 #include "PolyVR.h"
 
 #include <boost/bind.hpp>
@@ -31,7 +32,8 @@ PyMethodDef VRSceneGlobals::methods[] = {
 	{"exit", (PyCFunction)VRSceneGlobals::exit, METH_NOARGS, "Terminate application" },
 	{"loadGeometry", (PyCFunction)VRSceneGlobals::loadGeometry, METH_VARARGS|METH_KEYWORDS, "Loads a file and returns an object - obj loadGeometry(str path, bool cached = True, str preset = 'OSG', bool threaded = 0, str parent = None, str options = None)"
                                                                                              "\n\tpreset can be: 'OSG', 'COLLADA', 'SOLIDWORKS-VRML2'"
-                                                                                             "\n\toptions can be: 'explorer' (currently only for STEP files)" },
+                                                                                             "\n\toptions can be for STEP files: 'explorer chordal=<max deviation> angular=<max segment angle in degrees>'"
+                                                                                             "\n\t\tor for E57 files 'voxel=<size> lod chunk=<points> distance=<lod load distance>'" },
 	{"exportGeometry", (PyCFunction)VRSceneGlobals::exportGeometry, METH_VARARGS, "Export a part of the scene - exportGeometry( object, path )" },
 	{"getLoadGeometryProgress", (PyCFunction)VRSceneGlobals::getLoadGeometryProgress, METH_VARARGS, "Return the progress object for geometry loading - getLoadGeometryProgress()" },
 	{"stackCall", (PyCFunction)VRSceneGlobals::stackCall, METH_VARARGS, "Schedules a call to a python function - stackCall( function, delay, [args] )" },
@@ -52,6 +54,7 @@ PyMethodDef VRSceneGlobals::methods[] = {
 	{"setPhysicsActive", (PyCFunction)VRSceneGlobals::setPhysicsActive, METH_VARARGS, "Pause and unpause physics - setPhysicsActive( bool b )" },
 	{"runTest", (PyCFunction)VRSceneGlobals::runTest, METH_VARARGS, "Run a built-in system test - runTest( string test )" },
 	{"getSceneMaterials", (PyCFunction)VRSceneGlobals::getSceneMaterials, METH_NOARGS, "Get all materials of the scene - getSceneMaterials()" },
+	{"exportProfile", (PyCFunction)VRSceneGlobals::exportProfile, METH_VARARGS, "Export the recorded profiler scopes as chrome trace, open it in chrome://tracing or perfetto - exportProfile( str path )" },
     {NULL}  /* Sentinel */
 };
 
@@ -69,6 +72,11 @@ PyObject* VRSceneGlobals::getSceneMaterials(VRSceneGlobals* self) {
     Py_RETURN_TRUE;
 }
 
+PyObject* VRSceneGlobals::exportProfile(VRSceneGlobals* self, PyObject *args) {
+    VRProfiler::get()->exportChromeTrace( parseString(args) );
+    Py_RETURN_TRUE;
+}
+
 PyObject* VRSceneGlobals::setPhysicsActive(VRSceneGlobals* self, PyObject *args) {
     auto scene = VRScene::getCurrent();
     if (scene) (dynamic_pointer_cast<VRPhysicsManager>(scene))->setPhysicsActive( parseBool(args) );
@@ -275,7 +283,7 @@ PyObject* VRSceneGlobals::render(VRSceneGlobals* self) {
 PyObject* VRSceneGlobals::runTest(VRSceneGlobals* self, PyObject *args) {
     const char* test = "";
     if (!PyArg_ParseTuple(args, "s", &test)) return NULL;
-    VRRunTest(test);
+    if (!VRRunTest(test)) { PyErr_SetString(err, ("VRSceneGlobals::runTest - test " + string(test) + " failed").c_str()); return NULL; }
     Py_RETURN_TRUE;
 }
 
@@ -73,7 +73,7 @@ void VRHaptic::applyTransformation(VRTransformPtr t) { // TODO: rotation
 }
 
 void VRHaptic::updateHapticTimestep(VRTransformPtr t) {
-    list<VRProfiler::Frame> frames = VRProfiler::get()->getFrames();
+    vector<VRProfiler::Frame> frames = VRProfiler::get()->getFrames();
 
         VRProfiler::Frame tmpOlder;
         VRProfiler::Frame tmpNewer;
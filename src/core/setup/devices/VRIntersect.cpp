@@ -1,25 +1,23 @@
 #include "VRIntersect.h"
 #include <OpenSG/OSGLineChunk.h>
-#include <OpenSG/OSGIntersectAction.h>
 #include <OpenSG/OSGSimpleMaterial.h>
 #include <OpenSG/OSGTriangleIterator.h>
 
 #include "core/objects/geometry/VRGeometry.h"
+#include "core/objects/geometry/OSGGeometry.h"
 #include "core/objects/material/VRMaterial.h"
 #include "core/objects/OSGObject.h"
 #include "core/utils/VRFunction.h"
 #include "core/utils/VRGlobals.h"
 #include "VRSignal.h"
 #include "VRDevice.h"
+#include "VRPickEngine.h"
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
-Vec2f VRIntersect_computeTexel(VRIntersection& ins, NodeMTRecPtr node) {
+Vec2f VRIntersect_computeTexel(VRIntersection& ins, Geometry* geo, Pnt3f local_pnt) {
     if (!ins.hit) return Vec2f(0,0);
-    if (node == 0) return Vec2f(0,0);
-
-    GeometryRefPtr geo = dynamic_cast<Geometry*>( node->getCore() );
     if (geo == 0) return Vec2f(0,0);
     auto type = geo->getTypes()->getValue(0);
     if ( type == GL_PATCHES ) return Vec2f(0,0);
@@ -28,11 +26,6 @@ Vec2f VRIntersect_computeTexel(VRIntersection& ins, NodeMTRecPtr node) {
     if (texcoords == 0) return Vec2f(0,0);
     TriangleIterator iter = geo->beginTriangles(); iter.seek( ins.triangle );
 
-
-    Matrix m = node->getToWorld();
-    m.invert();
-    Pnt3f local_pnt; m.mult(ins.point, local_pnt);
-
     Pnt3f p0 = iter.getPosition(0);
     Pnt3f p1 = iter.getPosition(1);
     Pnt3f p2 = iter.getPosition(2);
@@ -49,11 +42,8 @@ Vec2f VRIntersect_computeTexel(VRIntersection& ins, NodeMTRecPtr node) {
     return iter.getTexCoords(0) * a + iter.getTexCoords(1) * b + iter.getTexCoords(2) * c;
 }
 
-Vec3i VRIntersect_computeVertices(VRIntersection& ins, NodeMTRecPtr node) {
+Vec3i VRIntersect_computeVertices(VRIntersection& ins, Geometry* geo) {
     if (!ins.hit) return Vec3i(0,0,0);
-    if (node == 0) return Vec3i(0,0,0);
-
-    GeometryRefPtr geo = dynamic_cast<Geometry*>( node->getCore() );
     if (geo == 0) return Vec3i(0,0,0);
     auto type = geo->getTypes()->getValue(0);
     if ( type == GL_PATCHES ) return Vec3i(0,0,0);
@@ -62,22 +52,6 @@ Vec3i VRIntersect_computeVertices(VRIntersection& ins, NodeMTRecPtr node) {
     return Vec3i(iter.getPositionIndex(0), iter.getPositionIndex(1), iter.getPositionIndex(2));
 }
 
-class VRIntersectAction : public IntersectAction {
-    private:
-        /*Action::ResultE GeoInstancer::intersectEnter(Action  *action) {
-            if(_sfBaseGeometry.getValue() == NULL) return Action::Continue;
-            return _sfBaseGeometry.getValue()->intersectEnter(action);
-            return Action::Continue;
-        }*/
-
-    public:
-        VRIntersectAction() {
-            // TODO: check OSG::Geometry::intersectEnter
-
-            //IntersectAction::registerEnterDefault( getClassType(), reinterpret_cast<Action::Callback>(&GeoInstancer::intersectEnter));
-        }
-};
-
 VRIntersection VRIntersect::intersect(VRObjectWeakPtr wtree, Line ray) {
     VRIntersection ins;
     auto tree = wtree.lock();
@@ -85,23 +59,21 @@ VRIntersection VRIntersect::intersect(VRObjectWeakPtr wtree, Line ray) {
 
     uint now = VRGlobals::CURRENT_FRAME;
 
-    VRIntersectAction iAct;
-    //IntersectActionRefPtr iAct = IntersectAction::create();
-    iAct.setTravMask(8);
-    iAct.setLine(ray);
-    iAct.apply(tree->getNode()->node);
+    auto hit = VRPickEngine::get()->intersect(tree, ray);
+    auto geo = hit.geo.lock();
 
-    ins.hit = iAct.didHit();
+    ins.hit = hit.hit && geo;
     if (ins.hit) {
-        ins.object = tree->find(OSGObject::create(iAct.getHitObject()->getParent()));
-        if (auto sp = ins.object.lock()) ins.name = sp->getName();
-        ins.point = iAct.getHitPoint();
-        ins.normal = iAct.getHitNormal();
+        ins.object = geo;
+        ins.name = geo->getName();
+        ins.point = hit.point;
+        ins.normal = hit.normal;
         if (tree->getParent()) tree->getParent()->getNode()->node->getToWorld().mult( ins.point, ins.point );
         if (tree->getParent()) tree->getParent()->getNode()->node->getToWorld().mult( ins.normal, ins.normal );
-        ins.triangle = iAct.getHitTriangle();
-        ins.triangleVertices = VRIntersect_computeVertices(ins, iAct.getHitObject());
-        ins.texel = VRIntersect_computeTexel(ins, iAct.getHitObject());
+        ins.triangle = hit.triangle;
+        Geometry* core = geo->getMesh() ? geo->getMesh()->geo.get() : 0;
+        ins.triangleVertices = VRIntersect_computeVertices(ins, core);
+        ins.texel = VRIntersect_computeTexel(ins, core, hit.localPoint);
         lastIntersection = ins;
         ins.time = now;
     } else {
@@ -0,0 +1,374 @@
+#include "VRPickEngine.h"
+#include "core/objects/geometry/VRGeometry.h"
+#include "core/objects/geometry/OSGGeometry.h"
+#include "core/objects/OSGObject.h"
+#include "core/objects/VRTransform.h"
+#include "core/utils/VRGlobals.h"
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGGeoProperties.h>
+#include <OpenSG/OSGTriangleIterator.h>
+#include <OpenSG/OSGIntersectAction.h>
+#include <cmath>
+
+using namespace OSG;
+
+/** triangles of a mesh in the order of its hierarchy, as structure of arrays for the leaf tests **/
+struct VRPickEngine::Mesh {
+    GeometryMTRecPtr core;
+    GeoVectorProperty* positions = 0;
+    GeoIntegralProperty* indices = 0;
+    int Npositions = 0;
+    int Nindices = 0;
+    int stamp = -1; // frame of the last build
+    bool built = false;
+
+    VRBVH bvh = VRBVH(8);
+    vector<int> triangles; // triangle index of each slot, as counted by the triangle iterator
+    vector<float> v0[3], e1[3], e2[3];
+
+    void update() {
+        vector<Pnt3f> pnts;
+        vector<int> ids;
+        if (core->getPositions() && core->getTypes() && core->getTypes()->size() > 0) {
+            for (TriangleIterator it = core->beginTriangles(); it != core->endTriangles(); ++it) {
+                for (int i=0; i<3; i++) pnts.push_back( it.getPosition(i) );
+                ids.push_back( it.getIndex() );
+            }
+        }
+
+        int N = ids.size();
+        vector<Vec3f> bbMin(N), bbMax(N);
+        for (int t=0; t<N; t++) {
+            for (int j=0; j<3; j++) {
+                bbMin[t][j] = min(pnts[3*t][j], min(pnts[3*t+1][j], pnts[3*t+2][j]));
+                bbMax[t][j] = max(pnts[3*t][j], max(pnts[3*t+1][j], pnts[3*t+2][j]));
+            }
+        }
+
+        if (built && N == (int)triangles.size()) bvh.refit(bbMin, bbMax); // same topology, keep the hierarchy
+        else bvh.build(bbMin, bbMax);
+
+        const vector<int>& order = bvh.getOrder();
+        triangles.resize(N);
+        for (int j=0; j<3; j++) { v0[j].resize(N); e1[j].resize(N); e2[j].resize(N); }
+        for (int s=0; s<N; s++) {
+            int t = order[s];
+            triangles[s] = ids[t];
+            const Pnt3f& p0 = pnts[3*t];
+            for (int j=0; j<3; j++) {
+                v0[j][s] = p0[j];
+                e1[j][s] = pnts[3*t+1][j] - p0[j];
+                e2[j][s] = pnts[3*t+2][j] - p0[j];
+            }
+        }
+
+        positions = core->getPositions();
+        indices = core->getIndices();
+        Npositions = positions ? positions->size() : 0;
+        Nindices = indices ? indices->size() : 0;
+        stamp = VRGlobals::CURRENT_FRAME;
+        built = true;
+    }
+
+    bool isOutdated(int geoStamp) { // stamps are frames, changes later in the frame of the build are picked up when the counts or arrays differ
+        if (!built || geoStamp > stamp) return true;
+        GeoVectorProperty* pos = core->getPositions();
+        GeoIntegralProperty* inds = core->getIndices();
+        if (pos != positions || inds != indices) return true;
+        if ((pos ? (int)pos->size() : 0) != Npositions) return true;
+        if ((inds ? (int)inds->size() : 0) != Nindices) return true;
+        return false;
+    }
+
+    /** nearest hit closer than tmax, returns the slot of the triangle or -1 **/
+    int intersect(const Pnt3f& o, const Vec3f& d, float& tmax, float& hu, float& hv) const {
+        int res = -1;
+        float best = tmax;
+        const float dx = d[0], dy = d[1], dz = d[2];
+        const float ox = o[0], oy = o[1], oz = o[2];
+        const float *v0x = v0[0].data(), *v0y = v0[1].data(), *v0z = v0[2].data();
+        const float *e1x = e1[0].data(), *e1y = e1[1].data(), *e1z = e1[2].data();
+        const float *e2x = e2[0].data(), *e2y = e2[1].data(), *e2z = e2[2].data();
+
+        bvh.traverse(o, d, tmax, [&](int begin, int count, float& tm) {
+            for (int c = begin; c < begin+count; c += 8) {
+                int m = min(8, begin+count-c);
+                float tt[8], uu[8], vv[8];
+                for (int k=0; k<m; k++) { // Moeller Trumbore, branch free to allow vectorization
+                    int j = c+k;
+                    float px = dy*e2z[j] - dz*e2y[j];
+                    float py = dz*e2x[j] - dx*e2z[j];
+                    float pz = dx*e2y[j] - dy*e2x[j];
+                    float det = e1x[j]*px + e1y[j]*py + e1z[j]*pz;
+                    float inv = 1.0f/det;
+                    float sx = ox - v0x[j], sy = oy - v0y[j], sz = oz - v0z[j];
+                    float u = (sx*px + sy*py + sz*pz)*inv;
+                    float qx = sy*e1z[j] - sz*e1y[j];
+                    float qy = sz*e1x[j] - sx*e1z[j];
+                    float qz = sx*e1y[j] - sy*e1x[j];
+                    float v = (dx*qx + dy*qy + dz*qz)*inv;
+                    float t = (e2x[j]*qx + e2y[j]*qy + e2z[j]*qz)*inv;
+                    bool ok = (det != 0.0f) & (u >= 0.0f) & (v >= 0.0f) & (u+v <= 1.0f) & (t > 0.0f);
+                    tt[k] = ok ? t : 1e30f;
+                    uu[k] = u;
+                    vv[k] = v;
+                }
+                for (int k=0; k<m; k++) {
+                    if (tt[k] >= tm) continue;
+                    tm = best = tt[k];
+                    res = c+k;
+                    hu = uu[k];
+                    hv = vv[k];
+                }
+            }
+        });
+
+        tmax = best;
+        return res;
+    }
+};
+
+VRPickEngine::VRPickEngine() : meshUpdates(0) {}
+
+VRPickEngine* VRPickEngine::get() {
+    static VRPickEngine* e = new VRPickEngine();
+    return e;
+}
+
+size_t VRPickEngine::getMeshUpdates() { return meshUpdates; }
+
+void VRPickEngine::clear() {
+    scenes.clear();
+    meshes.clear();
+}
+
+static Matrix getTransformWorld(VRObjectPtr o) { // o or its first transform ancestor
+    while (o && !o->hasAttachment("transform")) o = o->getParent();
+    if (!o) return Matrix();
+    return static_pointer_cast<VRTransform>(o)->getWorldMatrix();
+}
+
+void VRPickEngine::collect(VRObjectPtr o, Scene& s) {
+    Node* node = o->getNode()->node;
+    if ((node->getTravMask() & 8) == 0) return; // same mask as the intersect action
+
+    if (o->hasAttachment("geometry")) {
+        VRGeometryPtr geo = static_pointer_cast<VRGeometry>(o);
+        OSGGeometryPtr mesh = geo->getMesh();
+        OSGObjectPtr meshNode = geo->getMeshNode();
+        if (mesh && mesh->geo && meshNode && meshNode->node && (meshNode->node->getTravMask() & 8)) {
+            Instance i;
+            i.geo = geo;
+            i.meshNode = meshNode;
+            auto types = mesh->geo->getTypes();
+            i.patches = types && types->size() > 0 && types->getValue(0) == GL_PATCHES;
+            s.hasPatches = s.hasPatches || i.patches;
+            Geometry* core = mesh->geo;
+            if (!meshes.count(core)) {
+                meshes[core] = shared_ptr<Mesh>( new Mesh() );
+                meshes[core]->core = mesh->geo;
+            }
+            i.mesh = meshes[core];
+            s.instances.push_back(i);
+        }
+    }
+
+    for (uint i=0; i<o->getChildrenCount(); i++) {
+        auto c = o->getChild(i);
+        if (c->getNode()->node->getParent() != node) continue; // not in the OpenSG graph
+        collect(c, s);
+    }
+}
+
+void VRPickEngine::updateInstances(Scene& s, bool rebuild) {
+    int N = s.instances.size();
+    vector<Vec3f> bbMin(N), bbMax(N);
+    for (int k=0; k<N; k++) {
+        Instance& i = s.instances[k];
+        auto geo = i.geo.lock();
+        if (geo) {
+            i.world = geo->getWorldMatrix();
+            i.stamp = geo->getLastMeshChange();
+        }
+        i.toTree = s.toTree;
+        i.toTree.mult(i.world);
+        i.toLocal.invertFrom(i.toTree);
+
+        Pnt3f a, b; // mesh bounds, updated and cached by OpenSG
+        i.meshNode->node->updateVolume();
+        i.meshNode->node->getVolume().getBounds(a, b);
+        for (int c=0; c<8; c++) {
+            Pnt3f p(c&1 ? b[0] : a[0], c&2 ? b[1] : a[1], c&4 ? b[2] : a[2]);
+            i.toTree.mult(p, p);
+            for (int j=0; j<3; j++) {
+                bbMin[k][j] = c ? min(bbMin[k][j], p[j]) : p[j];
+                bbMax[k][j] = c ? max(bbMax[k][j], p[j]) : p[j];
+            }
+        }
+    }
+
+    if (rebuild) s.bvh.build(bbMin, bbMax);
+    else s.bvh.refit(bbMin, bbMax);
+}
+
+VRPickEngine::Scene& VRPickEngine::getScene(VRObjectPtr tree) {
+    Scene& s = scenes[tree.get()];
+    bool rebuild = (s.tree.lock() != tree || s.revision != VRObject::getGraphRevision());
+
+    if (rebuild) {
+        for (auto itr = scenes.begin(); itr != scenes.end();) { // forget expired trees
+            if (&itr->second != &s && !itr->second.tree.lock()) itr = scenes.erase(itr);
+            else itr++;
+        }
+
+        s = Scene();
+        s.tree = tree;
+        s.revision = VRObject::getGraphRevision();
+        collect(tree, s);
+
+        for (auto itr = meshes.begin(); itr != meshes.end();) { // forget meshes no longer used by any tree
+            if (itr->second.use_count() == 1) itr = meshes.erase(itr);
+            else itr++;
+        }
+    }
+
+    Matrix toTree;
+    toTree.invertFrom( getTransformWorld(tree->getParent()) );
+    bool refit = rebuild || !(toTree == s.toTree);
+    s.toTree = toTree;
+    for (auto& i : s.instances) {
+        if (refit) break;
+        auto geo = i.geo.lock();
+        if (!geo) continue;
+        if (!(geo->getWorldMatrix() == i.world)) refit = true;
+        int stamp = geo->getLastMeshChange();
+        if (stamp != i.stamp || stamp == (int)VRGlobals::CURRENT_FRAME) refit = true; // the mesh bounds may have changed
+    }
+
+    if (refit) updateInstances(s, rebuild);
+    return s;
+}
+
+bool VRPickEngine::updateMesh(Instance& i) {
+    auto geo = i.geo.lock();
+    if (!geo) return false;
+    int stamp = geo->getLastMeshChange();
+    Mesh& m = *i.mesh;
+    if (m.isOutdated(stamp)) {
+        m.update();
+        meshUpdates++;
+    }
+    return m.triangles.size() > 0;
+}
+
+void VRPickEngine::intersect(Scene& s, const Line& ray, Hit& hit, bool lazy) {
+    Pnt3f o = ray.getPosition();
+    Vec3f d = ray.getDirection();
+    const vector<int>& order = s.bvh.getOrder();
+    float best = hit.hit ? hit.t : 1e30;
+
+    s.bvh.traverse(o, d, best, [&](int begin, int count, float& tmax) {
+        for (int k=begin; k<begin+count; k++) {
+            Instance& i = s.instances[order[k]];
+            if (i.patches) continue;
+            if (lazy && !updateMesh(i)) continue;
+            if (!i.mesh->built) continue;
+
+            Pnt3f lo;
+            Vec3f ld;
+            i.toLocal.mult(o, lo);
+            i.toLocal.mult(d, ld); // not normalized, t stays the same in both frames
+
+            float u, v;
+            int slot = i.mesh->intersect(lo, ld, tmax, u, v);
+            if (slot < 0) continue;
+
+            const Mesh& m = *i.mesh;
+            Vec3f e1(m.e1[0][slot], m.e1[1][slot], m.e1[2][slot]);
+            Vec3f e2(m.e2[0][slot], m.e2[1][slot], m.e2[2][slot]);
+            Vec3f n = e1.cross(e2);
+            Vec3f wn; // normals transform with the inverse transpose
+            for (int j=0; j<3; j++) wn[j] = i.toLocal[j][0]*n[0] + i.toLocal[j][1]*n[1] + i.toLocal[j][2]*n[2];
+            wn.normalize();
+
+            hit.hit = true;
+            hit.t = tmax;
+            hit.geo = i.geo;
+            hit.triangle = m.triangles[slot];
+            hit.point = o + d*tmax;
+            hit.normal = wn;
+            hit.localPoint = lo + ld*tmax;
+        }
+    });
+}
+
+void VRPickEngine::intersectPatches(Scene& s, const Line& ray, Hit& hit) {
+    Pnt3f o = ray.getPosition();
+    Vec3f d = ray.getDirection();
+
+    for (auto& i : s.instances) {
+        if (!i.patches) continue;
+        Pnt3f lo;
+        Vec3f ld;
+        i.toLocal.mult(o, lo);
+        i.toLocal.mult(d, ld);
+
+        IntersectAction* ia = IntersectAction::create();
+        ia->setTravMask(8);
+        ia->setLine(Line(lo, ld));
+        ia->apply(i.meshNode->node);
+        if (ia->didHit()) {
+            Pnt3f lp = ia->getHitPoint();
+            Pnt3f p;
+            i.toTree.mult(lp, p);
+            float t = (p - o).dot(d) / d.squareLength();
+            if (!hit.hit || t < hit.t) {
+                Vec3f n = ia->getHitNormal();
+                i.toTree.mult(n, n);
+                n.normalize();
+                hit.hit = true;
+                hit.t = t;
+                hit.geo = i.geo;
+                hit.triangle = ia->getHitTriangle();
+                hit.point = p;
+                hit.normal = n;
+                hit.localPoint = lp;
+            }
+        }
+        delete ia;
+    }
+}
+
+VRPickEngine::Hit VRPickEngine::intersect(VRObjectPtr tree, const Line& ray) {
+    Hit hit;
+    if (!tree) return hit;
+    Scene& s = getScene(tree);
+    intersect(s, ray, hit, true);
+    if (s.hasPatches) intersectPatches(s, ray, hit);
+    return hit;
+}
+
+/** casts many rays at once, the meshes are brought up to date first, then the rays are cast in parallel **/
+vector<VRPickEngine::Hit> VRPickEngine::intersect(VRObjectPtr tree, const vector<Line>& rays) {
+    vector<Hit> hits(rays.size());
+    if (!tree) return hits;
+    Scene& s = getScene(tree);
+
+    vector<Instance*> outdated;
+    map<Mesh*, bool> seen;
+    for (auto& i : s.instances) {
+        if (i.patches || seen.count(i.mesh.get())) continue;
+        seen[i.mesh.get()] = true;
+        outdated.push_back(&i);
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int k=0; k<(int)outdated.size(); k++) updateMesh(*outdated[k]);
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int r=0; r<(int)rays.size(); r++) intersect(s, rays[r], hits[r], false);
+
+    if (s.hasPatches) for (uint r=0; r<rays.size(); r++) intersectPatches(s, rays[r], hits[r]);
+    return hits;
+}
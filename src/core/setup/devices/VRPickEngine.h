@@ -0,0 +1,90 @@
+#ifndef VRPICKENGINE_H_INCLUDED
+#define VRPICKENGINE_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGVector.h>
+#include <OpenSG/OSGMatrix.h>
+#include <OpenSG/OSGLine.h>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+
+#include "core/objects/VRObjectFwd.h"
+#include "core/math/VRBVH.h"
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+class Geometry;
+
+/**
+    Ray casting on the geometries of a subtree without the OpenSG intersect action.
+    Each mesh has a SAH bounding volume hierarchy over its triangles, built on the first ray that reaches it.
+    The hierarchy is refitted when the mesh changed (VRGeometry::getLastMeshChange), and rebuilt when the triangle count changed.
+    The leaves store the triangles as structure of arrays, the ray triangle tests of a leaf run in one branch free loop.
+    A top level hierarchy over the bounds of the meshes in the frame of the tree parent is cached per tree,
+    it is rebuilt when the scene graph changed and refitted when transformations or meshes changed.
+    Patch geometries (GL_PATCHES) are still tested with the intersect action of their mesh node.
+*/
+
+class VRPickEngine {
+    public:
+        struct Hit {
+            bool hit = false;
+            float t = 0;
+            VRGeometryWeakPtr geo;
+            int triangle = -1;
+            Pnt3f point; // in the frame of the tree parent
+            Vec3f normal;
+            Pnt3f localPoint; // in the frame of the geometry
+        };
+
+        struct Mesh;
+
+    private:
+        struct Instance {
+            VRGeometryWeakPtr geo;
+            OSGObjectPtr meshNode;
+            shared_ptr<Mesh> mesh;
+            Matrix world;
+            Matrix toTree; // geometry to tree parent frame
+            Matrix toLocal;
+            int stamp = -1; // mesh change of the last refit
+            bool patches = false;
+        };
+
+        struct Scene {
+            VRObjectWeakPtr tree;
+            unsigned int revision = 0;
+            Matrix toTree; // world to tree parent frame
+            vector<Instance> instances;
+            VRBVH bvh;
+            bool hasPatches = false;
+        };
+
+        map<Geometry*, shared_ptr<Mesh> > meshes;
+        map<VRObject*, Scene> scenes;
+        atomic<size_t> meshUpdates; // builds and refits of mesh hierarchies
+
+        Scene& getScene(VRObjectPtr tree);
+        void collect(VRObjectPtr o, Scene& s);
+        void updateInstances(Scene& s, bool rebuild);
+        bool updateMesh(Instance& i);
+        void intersect(Scene& s, const Line& ray, Hit& hit, bool lazy);
+        void intersectPatches(Scene& s, const Line& ray, Hit& hit);
+
+        VRPickEngine();
+
+    public:
+        static VRPickEngine* get();
+
+        Hit intersect(VRObjectPtr tree, const Line& ray);
+        vector<Hit> intersect(VRObjectPtr tree, const vector<Line>& rays);
+        size_t getMeshUpdates();
+        void clear();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRPICKENGINE_H_INCLUDED
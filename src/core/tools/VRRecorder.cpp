@@ -12,6 +12,9 @@
 
 #include <OpenSG/OSGImage.h>
 #include <GL/glut.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <cstdio>
 
 extern "C" {
     #include <libavutil/opt.h>
@@ -26,65 +29,21 @@ using namespace std;
 
 class VRFrame {
     public:
-        VRTexturePtr capture = 0;
         int timestamp = 0;
-
-        int valid = 0;
-        int pktSize = 0;
-        char* pktData = 0;
-
-        int width = 0;
-        int height = 0;
-
         Vec3f f,a,u; // from at up
-
-        VRFrame() {}
-        ~VRFrame() { if (pktData) delete pktData; }
-
-        void transcode(AVFrame *frame, AVCodecContext* codec_context, SwsContext* sws_context, int i) {
-            valid = 0;
-            if (!capture) return;
-
-            AVPacket pkt;
-            av_init_packet(&pkt);
-            pkt.data = NULL;    // packet data will be allocated by the encoder
-            pkt.size = 0;
-
-            const unsigned char* data = capture->getImage()->getData();
-            if (codec_context->pix_fmt == AV_PIX_FMT_YUV420P) {
-                const int in_linesize[1] = { 3 * codec_context->width };
-                sws_scale(sws_context, (const uint8_t * const *)&data, in_linesize, 0, codec_context->height, frame->data, frame->linesize);
-            }
-
-            /* encode the image */
-            frame->pts = i;
-            int ret = avcodec_encode_video2(codec_context, &pkt, frame, &valid);
-            if (ret < 0) { fprintf(stderr, "Error encoding frame\n"); return; }
-
-            pktSize = pkt.size;
-            pktData = new char[pktSize];
-            memcpy(pktData, pkt.data, pktSize);
-
-            av_free_packet(&pkt);
-            capture = 0;
-        }
-
-        void write(FILE* f) {
-            if (valid) fwrite(pktData, 1, pktSize, f);
-        }
 };
 
+typedef boost::mutex::scoped_lock PLock;
+
 VRRecorder::VRRecorder() {
     av_register_all();
     avcodec_register_all();
 
     toggleCallback = VRFunction<bool>::create("recorder toggle", boost::bind(&VRRecorder::setRecording, this, _1));
     updateCallback = VRFunction<int>::create("recorder update", boost::bind(&VRRecorder::capture, this));
-
-    //initCodec();
 }
 
-VRRecorder::~VRRecorder() { ; }
+VRRecorder::~VRRecorder() { clear(); }
 shared_ptr<VRRecorder> VRRecorder::create() { return shared_ptr<VRRecorder>(new VRRecorder()); }
 
 void VRRecorder::setView(int i) {
@@ -95,6 +54,12 @@ void VRRecorder::setView(int i) {
 
 void VRRecorder::setMaxFrames(int maxf) { maxFrames = maxf; }
 bool VRRecorder::frameLimitReached() { return ((int)captures.size() == maxFrames); }
+void VRRecorder::setBufferCount(int N) { Nbuffers = max(N, 1); } // used when the next recording starts
+void VRRecorder::setBlocking(bool b) { blocking = b; }
+
+int VRRecorder::getEncodedFrames() { PLock lock(mtx); return encodedFrames; }
+int VRRecorder::getDroppedFrames() { PLock lock(mtx); return droppedFrames; }
+int VRRecorder::getQueuedFrames() { PLock lock(mtx); return queue.size(); }
 
 void VRRecorder::setTransform(VRTransformPtr t, int f) {
     if (f >= (int)captures.size() || f < 0) return;
@@ -119,31 +84,59 @@ void VRRecorder::capture() {
     if (!v) return;
     if (frameLimitReached()) return;
 
+    VRTexturePtr img = v->grab();
+    if (!img || !img->getImage() || !img->getImage()->getData()) return;
+    int width = img->getImage()->getWidth();
+    int height = img->getImage()->getHeight();
+    if (!encoder && !startEncoder(width, height)) return;
+
+    Buffer* b = 0;
+    {
+        PLock lock(mtx);
+        if (width != codec_context->width || height != codec_context->height) { droppedFrames++; return; } // view resized
+        if (blocking) while (pool.empty()) bufferFreed.wait(lock); // back pressure on the render thread
+        if (pool.empty()) { droppedFrames++; return; } // the encoder is behind
+        b = pool.back();
+        pool.pop_back();
+    }
+
+    memcpy(&b->data[0], img->getImage()->getData(), b->data.size());
+    b->index = captures.size();
+    lastCapture = img;
+
     //int ts = VRGlobals::get()->CURRENT_FRAME;
     VRFrame* f = new VRFrame();
     captures.push_back(f);
-    f->capture = v->grab();
     f->timestamp = glutGet(GLUT_ELAPSED_TIME);
+    if (VRTransformPtr t = v->getCamera()) {
+        f->f = t->getFrom();
+        f->a = t->getAt();
+        f->u = t->getUp();
+    }
 
-    VRTransformPtr t = v->getCamera();
-    if (t == 0) return;
-    f->f = t->getFrom();
-    f->a = t->getAt();
-    f->u = t->getUp();
-
-    f->width = f->capture->getImage()->getWidth();
-    f->height = f->capture->getImage()->getHeight();
-
-    if (!frame) initFrame();
-
-    f->transcode(frame, codec_context, sws_context, captures.size()-1);
+    PLock lock(mtx);
+    queue.push_back(b);
+    queueChanged.notify_one();
 }
 
 bool VRRecorder::isRunning() { return running; }
 
 void VRRecorder::clear() {
+    stopEncoder();
+    if (out) {
+        fclose(out);
+        out = 0;
+        remove(tmpPath.c_str());
+    }
+    closeCodec();
+    closeFrame();
+
     for (auto f : captures) delete f;
     captures.clear();
+    lastCapture = 0;
+    encodedFrames = 0;
+    droppedFrames = 0;
+    writtenBytes = 0;
 }
 
 int VRRecorder::getRecordingSize() { return captures.size(); }
@@ -154,18 +147,17 @@ float VRRecorder::getRecordingLength() {
     return (t1-t0)*0.001; //seconds
 }
 
-void VRRecorder::initCodec() {
-    if (captures.size() == 0) { fprintf(stderr, "No initial capture for CODEC init!\n"); return; }
+bool VRRecorder::initCodec(int width, int height) {
     AVCodecID codec_id = AV_CODEC_ID_MPEG2VIDEO;
     //AVCodecID codec_id = AV_CODEC_ID_H264; // only works with m player??
     codec = avcodec_find_encoder(codec_id);
-    if (!codec) { fprintf(stderr, "Codec not found\n"); return; }
+    if (!codec) { fprintf(stderr, "Codec not found\n"); return false; }
 
     codec_context = avcodec_alloc_context3(codec);
-    if (!codec_context) { fprintf(stderr, "Could not allocate video codec context\n"); return; }
+    if (!codec_context) { fprintf(stderr, "Could not allocate video codec context\n"); return false; }
 
-    codec_context->width = captures[0]->width;
-    codec_context->height = captures[0]->height;
+    codec_context->width = width;
+    codec_context->height = height;
     codec_context->bit_rate = codec_context->width*codec_context->height*5; /* put sample parameters */
 	codec_context->time_base.num = 1;
 	codec_context->time_base.den = 25;/* frames per second */
@@ -177,22 +169,27 @@ void VRRecorder::initCodec() {
 
     AVDictionary *param = 0;
     av_dict_set(&param, "crf", "0", 0);
-    if (avcodec_open2(codec_context, codec, &param) < 0) { fprintf(stderr, "Could not open codec\n"); return; } /* open codec */
+    if (avcodec_open2(codec_context, codec, &param) < 0) { fprintf(stderr, "Could not open codec\n"); closeCodec(); return false; } /* open codec */
 
     sws_context = sws_getContext(
         codec_context->width, codec_context->height, AV_PIX_FMT_RGB24,
         codec_context->width, codec_context->height, AV_PIX_FMT_YUV420P,
         SWS_FAST_BILINEAR, 0, 0, 0);
-    if (!sws_context) fprintf(stderr, "Could not initialize the conversion context\n");
+    if (!sws_context) { fprintf(stderr, "Could not initialize the conversion context\n"); closeCodec(); return false; }
+    return true;
 }
 
 void VRRecorder::closeCodec() {
-    avcodec_close(codec_context);
-    av_free(codec_context);
+    if (sws_context) sws_freeContext(sws_context);
+    if (codec_context) {
+        avcodec_close(codec_context);
+        av_free(codec_context);
+    }
+    sws_context = 0;
+    codec_context = 0;
 }
 
 void VRRecorder::initFrame() {
-    initCodec();
     frame = avcodec_alloc_frame();
     if (!frame) { fprintf(stderr, "Could not allocate video frame\n"); return; }
     frame->format = codec_context->pix_fmt;
@@ -206,53 +203,135 @@ void VRRecorder::initFrame() {
 }
 
 void VRRecorder::closeFrame() {
+    if (!frame) return;
     av_freep(&frame->data[0]);
     avcodec_free_frame(&frame);
     frame = 0;
 }
 
-void VRRecorder::compile(string path) {
-    if (captures.size() == 0) return;
+/** opens the codec and the output file and starts the encoder thread with a pool of buffers for views of this size **/
+bool VRRecorder::startEncoder(int width, int height) {
+    if (!codec_context && !initCodec(width, height)) return false;
+    if (!frame) initFrame();
+
+    if (!out) {
+        tmpPath = getPath()+".part";
+        out = fopen(tmpPath.c_str(), "wb");
+        if (!out) { fprintf(stderr, "Could not open %s\n", tmpPath.c_str()); return false; }
+    }
+
+    for (auto b : pool) delete b;
+    pool.clear();
+    for (int i=0; i<Nbuffers; i++) {
+        Buffer* b = new Buffer();
+        b->data.resize(width*height*3);
+        pool.push_back(b);
+    }
+
+    encoding = true;
+    encoder = new boost::thread(boost::bind(&VRRecorder::encode, this));
+    return true;
+}
+
+/** waits until all queued frames are encoded **/
+void VRRecorder::stopEncoder() {
+    if (encoder) {
+        {
+            PLock lock(mtx);
+            encoding = false;
+            queueChanged.notify_all();
+        }
+        encoder->join();
+        delete encoder;
+        encoder = 0;
+    }
+
+    for (auto b : pool) delete b;
+    pool.clear();
+}
 
-    /*for (int i=0; i<1; i++) { // test export the first N images
-        string pimg = path+"."+toString(i)+".png";
-        captures[i]->capture->write(pimg.c_str());
-    }*/
+void VRRecorder::encode() {
+    while (true) {
+        Buffer* b = 0;
+        {
+            PLock lock(mtx);
+            while (encoding && queue.empty()) queueChanged.wait(lock);
+            if (queue.empty()) return; // stopped and all frames are encoded
+            b = queue.front();
+            queue.pop_front();
+        }
+
+        transcode(b);
+
+        PLock lock(mtx);
+        pool.push_back(b);
+        encodedFrames++;
+        bufferFreed.notify_one();
+    }
+}
+
+void VRRecorder::writePacket(AVPacket& pkt) {
+    fwrite(pkt.data, 1, pkt.size, out);
+    PLock lock(mtx);
+    writtenBytes += pkt.size;
+}
 
-    FILE* f = fopen(path.c_str(), "wb");
-    if (!f) { fprintf(stderr, "Could not open %s\n", path.c_str()); return; }
+void VRRecorder::transcode(Buffer* b) {
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;    // packet data will be allocated by the encoder
+    pkt.size = 0;
 
-    for (int i=0; i<(int)captures.size(); i++) captures[i]->write(f);
+    const unsigned char* data = &b->data[0];
+    if (codec_context->pix_fmt == AV_PIX_FMT_YUV420P) {
+        const int in_linesize[1] = { 3 * codec_context->width };
+        sws_scale(sws_context, (const uint8_t * const *)&data, in_linesize, 0, codec_context->height, frame->data, frame->linesize);
+    }
+
+    /* encode the image */
+    frame->pts = b->index;
+    int valid = 0;
+    int ret = avcodec_encode_video2(codec_context, &pkt, frame, &valid);
+    if (ret < 0) { fprintf(stderr, "Error encoding frame\n"); return; }
+    if (valid) writePacket(pkt);
+    av_free_packet(&pkt);
+}
+
+void VRRecorder::compile(string path) {
+    if (captures.size() == 0 || !out) return;
+    stopEncoder(); // encodes the remaining queue
 
     /* get the delayed frames */
     for (int got_output = 1; got_output;) {
-        fflush(stdout);
-
         AVPacket pkt;
         av_init_packet(&pkt);
         pkt.size = 0;
         pkt.data = NULL;
         int ret = avcodec_encode_video2(codec_context, &pkt, NULL, &got_output);
-        if (ret < 0) { fprintf(stderr, "Error encoding frame\n"); return; }
+        if (ret < 0) { fprintf(stderr, "Error encoding frame\n"); break; }
 
         if (got_output) {
-            fwrite(pkt.data, 1, pkt.size, f);
+            writePacket(pkt);
             av_free_packet(&pkt);
         }
     }
 
     /* add sequence end code to have a real mpeg file */
     uint8_t endcode[] = { 0, 0, 1, 0xb7 };
-    fwrite(endcode, 1, sizeof(endcode), f);
-    fclose(f);
+    fwrite(endcode, 1, sizeof(endcode), out);
+    fclose(out);
+    out = 0;
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) fprintf(stderr, "Could not move %s to %s\n", tmpPath.c_str(), path.c_str());
 
+    cout << "VRRecorder::compile " << path << ", " << encodedFrames << " frames, " << droppedFrames << " dropped, " << writtenBytes/1024 << " kb" << endl;
     closeCodec();
     closeFrame();
 }
 
+/** only the last capture is kept, the other frames are already encoded **/
 VRTexturePtr VRRecorder::get(int f) {
-    VRFrame* fr = captures[f];
-    return fr->capture;
+    if (f != (int)captures.size()-1) return 0;
+    return lastCapture;
 }
 
 void VRRecorder::setRecording(bool b) {
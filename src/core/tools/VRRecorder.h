@@ -4,6 +4,9 @@
 #include <OpenSG/OSGVector.h>
 #include <string>
 #include <vector>
+#include <deque>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 #include "core/utils/VRFunctionFwd.h"
 #include "core/objects/VRObjectFwd.h"
@@ -13,17 +16,31 @@ class AVCodec;
 class AVCodecContext;
 class AVFrame;
 class SwsContext;
+namespace boost{ class thread; }
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 class VRFrame;
 
+/**
+    Records a view to a MPEG video.
+    The render thread copies each grabbed view into a buffer of a fixed pool and queues it,
+    an encoder thread converts and encodes the buffers and streams the packets to a file.
+    When no buffer is free the frame is dropped, or with blocking enabled the render thread waits.
+*/
+
 class VRRecorder {
     private:
+        struct Buffer {
+            vector<unsigned char> data; // RGB
+            int index = 0;
+        };
+
         int viewID = 0;
         VRViewWeakPtr view;
-        vector<VRFrame*> captures;
+        vector<VRFrame*> captures; // camera poses of the queued frames
+        VRTexturePtr lastCapture;
         int maxFrames = -1;
         bool running = 0;
 
@@ -32,13 +49,35 @@ class VRRecorder {
         AVFrame* frame = 0;
         SwsContext* sws_context = NULL;
 
+        int Nbuffers = 8;
+        bool blocking = false;
+        string tmpPath;
+        FILE* out = 0;
+
+        // shared with the encoder thread
+        boost::thread* encoder = 0;
+        boost::mutex mtx;
+        boost::condition_variable queueChanged;
+        boost::condition_variable bufferFreed;
+        vector<Buffer*> pool; // free buffers
+        deque<Buffer*> queue; // grabbed frames waiting for encoding
+        bool encoding = false;
+        int encodedFrames = 0;
+        int droppedFrames = 0;
+        long long writtenBytes = 0;
+
         VRToggleCbPtr toggleCallback;
         VRUpdateCbPtr updateCallback;
 
-        void initCodec();
+        bool initCodec(int width, int height);
         void closeCodec();
         void initFrame();
         void closeFrame();
+        bool startEncoder(int width, int height);
+        void stopEncoder();
+        void encode();
+        void transcode(Buffer* b);
+        void writePacket(AVPacket& pkt);
 
     public:
         VRRecorder();
@@ -54,6 +93,11 @@ class VRRecorder {
         float getRecordingLength();
         void setMaxFrames(int maxf);
         bool frameLimitReached();
+        void setBufferCount(int N);
+        void setBlocking(bool b);
+        int getEncodedFrames();
+        int getDroppedFrames();
+        int getQueuedFrames();
         void setTransform(VRTransformPtr t, int f);
         Vec3f getFrom(int f);
         Vec3f getDir(int f);
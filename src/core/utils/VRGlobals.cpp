@@ -4,8 +4,10 @@ using namespace OSG;
 
 VRGlobals::FPS::FPS(Int ms, Int fps, string s1, string s2) : ms(ms), fps(fps), statFPS(s1.c_str(), s2.c_str()) {}
 
-void VRGlobals::FPS::update(VRTimer& t) {
-    ms = t.stop();
+void VRGlobals::FPS::update(VRTimer& t) { update(Int(t.stop())); }
+
+void VRGlobals::FPS::update(Int ms) {
+    this->ms = ms;
     fps = round(1000.0/max(ms,1lu));
 }
 
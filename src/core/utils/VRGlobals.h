@@ -22,6 +22,7 @@ class VRGlobals {
             FPS(Int ms, Int fps, string s1, string s2);
 
             void update(VRTimer& t);
+            void update(Int ms);
         };
 
     public:
@@ -0,0 +1,58 @@
+#ifndef VRMPSCQUEUE_H_INCLUDED
+#define VRMPSCQUEUE_H_INCLUDED
+
+#include <atomic>
+
+/**
+    Lock free multiple producer single consumer queue (Vyukov).
+    push() may be called from any thread, pop() only from the consumer thread.
+*/
+
+template<class T>
+class VRMPSCQueue {
+    private:
+        struct Node {
+            std::atomic<Node*> next;
+            T value;
+            Node() : next(0) {}
+            Node(const T& v) : next(0), value(v) {}
+        };
+
+        std::atomic<Node*> head;
+        Node* tail = 0;
+
+        VRMPSCQueue(const VRMPSCQueue&);
+        void operator= (const VRMPSCQueue&);
+
+    public:
+        VRMPSCQueue() {
+            tail = new Node();
+            head = tail;
+        }
+
+        ~VRMPSCQueue() {
+            T v;
+            while (pop(v));
+            delete tail;
+        }
+
+        void push(const T& v) {
+            Node* n = new Node(v);
+            Node* prev = head.exchange(n, std::memory_order_acq_rel);
+            prev->next.store(n, std::memory_order_release);
+        }
+
+        bool pop(T& v) {
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (next == 0) return false;
+            v = next->value;
+            next->value = T();
+            delete tail;
+            tail = next;
+            return true;
+        }
+
+        bool empty() { return tail->next.load(std::memory_order_acquire) == 0; }
+};
+
+#endif // VRMPSCQUEUE_H_INCLUDED
@@ -2,7 +2,11 @@
 #include <vector>
 #include <sstream>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <algorithm>
 #include <iostream>
+#include <boost/thread/mutex.hpp>
 #include "toString.h"
 #include "VRStorage_template.h"
 #include "VRFunction.h"
@@ -10,10 +14,53 @@
 
 using namespace std;
 
-// namespace   basename   suffix  name
-map<string, map<string, map<int, string> > > nameDicts;
+/** suffixes in use of a base name, released suffixes below next are kept sorted to reuse the lowest first **/
+struct VRNameEntry {
+    unordered_map<int, int> used; // suffix, number of objects with that name
+    set<int> released;
+    int next = 0;
 
-VRName::VRName() {
+    int allocate() {
+        int s;
+        if (released.size()) { s = *released.begin(); released.erase(released.begin()); }
+        else {
+            while (used.count(next)) next++; // skip suffixes set explicitly
+            s = next++;
+        }
+        used[s]++;
+        return s;
+    }
+
+    void add(int s) {
+        if (used[s]++ == 0 && s < next) released.erase(s);
+    }
+
+    void remove(int s) {
+        auto u = used.find(s);
+        if (u == used.end() || --u->second > 0) return;
+        used.erase(u);
+        if (s < next) released.insert(s);
+    }
+};
+
+namespace {
+    typedef boost::mutex::scoped_lock PLock;
+
+    struct NameRegistry { // entries are never removed, objects keep a pointer to theirs
+        boost::mutex mtx;
+        unordered_map<string, unordered_map<string, VRNameEntry> > spaces; // name space, base name
+    };
+
+    NameRegistry& getRegistry() { // never destroyed, names are released by static objects at exit
+        static NameRegistry* r = new NameRegistry();
+        return *r;
+    }
+}
+
+VRName::VRName() {}
+VRName::~VRName() {}
+
+void VRName::setupStorage() {
     store("name_suffix", &name_suffix);
     store("base_name", &base_name);
     store("name_space", &nameSpace);
@@ -22,23 +69,31 @@ VRName::VRName() {
     regStorageSetupFkt( VRFunction<int>::create("name_update", boost::bind(&VRName_base::compileName, dynamic_cast<VRName_base*>(this))) );
 }
 
-VRName::~VRName() {}
-
-VRName_base::VRName_base() {
-    if (nameDicts.count(nameSpace) == 0) nameDicts[nameSpace] = map<string, map<int, string> >();
+VRName_base::VRName_base() {}
+VRName_base::VRName_base(const VRName_base& n) { *this = n; }
+VRName_base::~VRName_base() { releaseName(); }
+
+VRName_base& VRName_base::operator=(const VRName_base& n) { // copies register their name too
+    if (this == &n) return *this;
+    releaseName();
+    name = n.name;
+    base_name = n.base_name;
+    name_suffix = n.name_suffix;
+    unique = n.unique;
+    separator = n.separator;
+    nameSpace = n.nameSpace;
+    filter = n.filter;
+    filter_rep = n.filter_rep;
+    if (n.nameEntry) compileName();
+    return *this;
 }
 
-VRName_base::~VRName_base() { setName(""); }
-
 void VRName_base::setSeparator(char   s) { separator = s; }
 void VRName_base::setNameSpace(string s) {
     if (nameSpace == s) return;
-
-    map<string, map<int, string> >& nameDict = nameDicts[nameSpace];
-    if (nameDict.count(base_name)) nameDict[base_name].erase(name_suffix);
+    releaseName();
 
     nameSpace = s;
-    if (nameDicts.count(nameSpace) == 0) nameDicts[nameSpace] = map<string, map<int, string> >();
     if (base_name != "") {
         string tmp = base_name;
         base_name = "";
@@ -48,15 +103,38 @@ void VRName_base::setNameSpace(string s) {
 
 void VRName_base::resetNameSpace() { setNameSpace("__global__"); }
 
-void VRName_base::compileName() {
-    setNameSpace(nameSpace);
+void VRName_base::releaseName() {
+    if (!nameEntry) return;
+    auto& registry = getRegistry();
+    PLock lock(registry.mtx);
+    nameEntry->remove(registeredSuffix);
+    nameEntry = 0;
+}
+
+/** replaces the registered suffix, by the lowest free suffix of the base name or by name_suffix **/
+void VRName_base::registerName(bool newSuffix) {
+    {
+        auto& registry = getRegistry();
+        PLock lock(registry.mtx);
+        if (nameEntry) nameEntry->remove(registeredSuffix);
+        nameEntry = 0;
+        if (unique) {
+            nameEntry = &registry.spaces[nameSpace][base_name];
+            if (newSuffix) name_suffix = nameEntry->allocate();
+            else nameEntry->add(name_suffix);
+            registeredSuffix = name_suffix;
+        }
+    }
+
     name = base_name;
-    map<string, map<int, string> >& nameDict = nameDicts[nameSpace];
     if (name_suffix>0 && unique) name += separator + toString(name_suffix);
-    if (nameDict.count(base_name) == 0 && unique) nameDict[base_name] = map<int, string>();
-    if (unique) nameDict[base_name][name_suffix] = name;
+    onNameChanged();
 }
 
+void VRName_base::compileName() { registerName(false); }
+
+void VRName_base::onNameChanged() {}
+
 string VRName_base::setName(string name) {
     for (char c : filter) replace(name.begin(), name.end(),c,filter_rep);
     //if (name == "arg") cout << "\n SET NAME " << name << " " << this->name << " " << nameSpace << flush;
@@ -65,16 +143,12 @@ string VRName_base::setName(string name) {
         return this->name; // allready named like that, return
     }
 
-    map<string, map<int, string> >& nameDict = nameDicts[nameSpace];
-
     // remove name from when passed name is empty
-    if (name == "" && nameDict.count(base_name) == 1) {
-        nameDict[base_name].erase(name_suffix);
+    if (name == "" && nameEntry) {
+        releaseName();
         return "";
     }
 
-    if (nameDict.count(base_name) == 1) nameDict[base_name].erase(name_suffix); // check if allready named, remove old name from dict
-
     // check if passed name has a base . suffix structure
     auto vs = splitString(name, separator);
     if (vs.size() > 1) {
@@ -90,21 +164,7 @@ string VRName_base::setName(string name) {
     }
 
     base_name = name; // set new base name
-
-    // get suffix
-    if (unique) {
-        if (nameDict.count(base_name) == 0) name_suffix = 0;
-        else {
-            for(unsigned int i=0; i<=nameDict[base_name].size(); i++) {
-                if (nameDict[base_name].count(i) == 1) continue;
-                name_suffix = i;
-                break;
-            }
-        }
-    }
-
-    // finish
-    compileName();
+    registerName(true); // get suffix
     return this->name;
 }
 string VRName_base::getName() { return name; }
@@ -121,9 +181,6 @@ void VRName_base::saveName(xmlpp::Element* e) {
 
 void VRName_base::loadName(xmlpp::Element* e) {
     //cout << "\nLOAD Name " << this;
-    map<string, map<int, string> >& nameDict = nameDicts[nameSpace];
-    if (nameDict.count(base_name) == 1) nameDict[base_name].erase(name_suffix); // check if allready named, remove old name from dict
-
     if (e->get_attribute("name_suffix")) name_suffix = toInt(e->get_attribute("name_suffix")->get_value());
     if (e->get_attribute("base_name")) base_name = e->get_attribute("base_name")->get_value();
     if (e->get_attribute("name_space")) nameSpace = e->get_attribute("name_space")->get_value();
@@ -133,25 +190,31 @@ void VRName_base::loadName(xmlpp::Element* e) {
 
 
 int VRName_base::getBaseNameNumber() {
+    auto& registry = getRegistry();
+    PLock lock(registry.mtx);
     int N = 0;
-    for (auto n : nameDicts) N += n.second.size();
+    for (auto& n : registry.spaces) N += n.second.size();
     return N;
 }
 
 int VRName_base::getNameNumber() {
+    auto& registry = getRegistry();
+    PLock lock(registry.mtx);
     int N = 0;
-    for (auto n : nameDicts) {
-        for (auto n2 : n.second) N += n2.second.size();
+    for (auto& n : registry.spaces) {
+        for (auto& n2 : n.second) N += n2.second.used.size();
     }
     return N;
 }
 
 void VRName_base::printNameDict() { // call this to see what is not deleted -> add to hidden button?
-    for (auto n : nameDicts) {
+    auto& registry = getRegistry();
+    PLock lock(registry.mtx);
+    for (auto& n : registry.spaces) {
         cout << "\n" << n.first << flush;
-        for (auto n2 : n.second) {
+        for (auto& n2 : n.second) {
             cout << "\n " << n2.first << flush;
-            for (auto n3 : n2.second) cout << "\n  " << n3.second << flush;
+            for (auto& n3 : n2.second.used) cout << "\n  " << n2.first << "." << n3.first << " (" << n3.second << ")" << flush;
         }
     }
 }
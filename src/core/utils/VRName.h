@@ -9,7 +9,21 @@ namespace xmlpp{ class Element; }
 
 using namespace std;
 
+struct VRNameEntry;
+
+/**
+    Unique names are base name and suffix, the registry tracks the suffixes in use per name space and base name.
+    A new name gets the lowest free suffix of its base name.
+*/
+
 class VRName_base {
+    private:
+        VRNameEntry* nameEntry = 0; // registry entry of the base name, if registered
+        int registeredSuffix = 0;
+
+        void registerName(bool newSuffix);
+        void releaseName();
+
     protected:
         string name;
         string base_name;
@@ -18,12 +32,17 @@ class VRName_base {
         char separator = '.';
         string nameSpace = "__global__";
         string filter;
-        char filter_rep;
+        char filter_rep = '_';
+
+        virtual void onNameChanged();
 
     public:
         VRName_base();
+        VRName_base(const VRName_base& n);
         ~VRName_base();
 
+        VRName_base& operator=(const VRName_base& n);
+
         void compileName();
         string setName(string name);
         string getName();
@@ -44,6 +63,9 @@ class VRName_base {
 };
 
 class VRName : public OSG::VRStorage, public VRName_base {
+    protected:
+        void setupStorage();
+
     public:
         VRName();
         ~VRName();
@@ -40,6 +40,12 @@ VROptions::VROptions() : desc("Configuration ") {
     addOption<string>("", "http_soc_addr", "server addr of http socket");
 
     addOption<bool>(false, "vrpn", "enable vrpn");
+
+    addOption<int>(60, "frame_rate", "target frame rate of the main loop, 0 for uncapped");
+
+    addOption<bool>(false, "import_cache", "keep binary snapshots of imported files on disk");
+    addOption<string>("", "import_cache_dir", "directory of the import cache, default is ~/.cache/polyvr/import");
+    addOption<int>(4096, "import_cache_size", "size limit of the import cache in MB, 0 for unlimited");
 }
 
 void VROptions::operator= (VROptions v) {;}
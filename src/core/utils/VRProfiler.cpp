@@ -1,70 +1,211 @@
 #include "VRProfiler.h"
 
-#include <GL/glut.h>
-#include <time.h>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <unordered_map>
+
+atomic<bool> VRProfiler::active(true);
+
+namespace {
+    struct BufferHolder { // releases the buffer of a thread when the thread ends
+        VRProfiler::ThreadBuffer* buffer = 0;
+        ~BufferHolder() { if (buffer) buffer->inUse = false; }
+    };
+
+    thread_local BufferHolder threadBuffer;
+    thread_local unordered_map<string, const char*> threadNames;
+
+    string escape(const string& s) {
+        string res;
+        for (char c : s) {
+            if (c == '"' || c == '\\') res += '\\';
+            if (c == '\n') { res += "\\n"; continue; }
+            res += c;
+        }
+        return res;
+    }
+}
+
+VRProfiler::ThreadBuffer::ThreadBuffer() : inUse(false), head(0) { events.resize(size); }
+
+VRProfiler::Scope::Scope(const char* name) { if (VRProfiler::active) ID = VRProfiler::get()->regStart(name); }
+VRProfiler::Scope::Scope(const string& name) { if (VRProfiler::active) ID = VRProfiler::get()->regStart(name); }
+VRProfiler::Scope::~Scope() { if (ID >= 0) VRProfiler::get()->regStop(ID); }
 
 VRProfiler* VRProfiler::get() {
     static VRProfiler* instance = new VRProfiler();
     return instance;
 }
 
-VRProfiler::VRProfiler() { swap(); }
-
-int VRProfiler::regStart(string name) {
-    if (!isActive()) return -1;
-    if (current == 0) return -1;
+VRProfiler::VRProfiler() {
+    frames.resize(history);
+    frames[current].t0 = getTime();
+}
 
-    boost::mutex::scoped_lock lock(mutex);
-    ID++;
-    Call c;
-    c.name = name;
-    c.t0 = getTime();
-    current->calls[ID] = c;
-    return ID;
+long long VRProfiler::getTime() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-void VRProfiler::regStop(int ID) {
-    if (ID < 0) return;
-    boost::mutex::scoped_lock lock(mutex);
-    current->calls[ID].t1 = getTime();
+VRProfiler::ThreadBuffer* VRProfiler::getBuffer() {
+    if (threadBuffer.buffer) return threadBuffer.buffer;
+
+    boost::mutex::scoped_lock lock(buffersMutex);
+    ThreadBuffer* b = 0;
+    for (auto tb : buffers) if (!tb->inUse) { b = tb; break; } // reuse buffers of finished threads
+    if (!b) {
+        b = new ThreadBuffer();
+        b->ID = buffers.size();
+        buffers.push_back(b);
+    }
+    b->inUse = true;
+    b->depth = 0;
+    b->name = "thread " + to_string(b->ID);
+    threadBuffer.buffer = b;
+    return b;
 }
 
-int VRProfiler::getTime() {
-    clock_t c = clock();
-    //int c = glutGet(GLUT_ELAPSED_TIME);
-    return c;
+const char* VRProfiler::intern(const string& name) {
+    auto itr = threadNames.find(name);
+    if (itr != threadNames.end()) return itr->second;
+
+    boost::mutex::scoped_lock lock(namesMutex);
+    const char* n = names.insert(name).first->c_str();
+    threadNames[name] = n;
+    return n;
 }
 
 void VRProfiler::setActive(bool b) { active = b; }
 bool VRProfiler::isActive() { return active; }
 
-list<VRProfiler::Frame> VRProfiler::getFrames() {
-    boost::mutex::scoped_lock lock(mutex);
-    return frames;
+void VRProfiler::setThreadName(string name) { getBuffer()->name = name; }
+
+int VRProfiler::regStart(const string& name) {
+    if (!active) return -1;
+    return regStart(intern(name));
 }
 
-VRProfiler::Frame VRProfiler::getFrame(int f) {
-    boost::mutex::scoped_lock lock(mutex);
-    int i=0;
-    for (auto fr : frames) {
-        if (i == f) return (Frame)fr;
-        i++;
+int VRProfiler::regStart(const char* name) {
+    if (!active) return -1;
+    auto b = getBuffer();
+    if (b->depth >= 64) return -1;
+    Event& e = b->stack[b->depth];
+    e.name = name;
+    e.depth = b->depth;
+    e.t0 = getTime();
+    return b->depth++;
+}
+
+void VRProfiler::regStop(int ID) {
+    if (ID < 0) return;
+    auto b = getBuffer();
+    b->depth = ID;
+    Event e = b->stack[ID];
+    e.t1 = getTime();
+    auto h = b->head.load(memory_order_relaxed);
+    b->events[h & (ThreadBuffer::size-1)] = e;
+    b->head.store(h+1, memory_order_release);
+}
+
+void VRProfiler::collect(Frame& f) { // skips the oldest part of each ring, it may be overwritten while reading
+    boost::mutex::scoped_lock lock(buffersMutex);
+    long long t1 = f.running ? getTime() : f.t1;
+    for (auto b : buffers) {
+        unsigned long long h = b->head.load(memory_order_acquire);
+        unsigned long long n = min(h, (unsigned long long)(ThreadBuffer::size - ThreadBuffer::size/8));
+        for (unsigned long long k = h-n; k<h; k++) {
+            Event e = b->events[k & (ThreadBuffer::size-1)];
+            if (e.t1 < f.t0 || e.t0 > t1 || e.name == 0) continue;
+            Call c;
+            c.name = e.name;
+            c.t0 = e.t0;
+            c.t1 = e.t1;
+            c.depth = e.depth;
+            c.thread = b->ID;
+            f.calls.push_back(c);
+        }
+    }
+}
+
+vector<VRProfiler::Frame> VRProfiler::getFrames() { // frame times only, newest first, without the slots not recorded yet
+    boost::mutex::scoped_lock lock(framesMutex);
+    vector<Frame> res;
+    for (int i=0; i<history; i++) {
+        auto& f = frames[(current-i+history)%history];
+        if (f.t0 == 0) break;
+        res.push_back(f);
+    }
+    return res;
+}
+
+VRProfiler::Frame VRProfiler::getFrame(int i) {
+    Frame f;
+    {
+        boost::mutex::scoped_lock lock(framesMutex);
+        if (i < 0 || i >= history) return f;
+        f = frames[(current-i+history)%history];
     }
-    return Frame();
+    if (f.t0 > 0) collect(f);
+    return f;
 }
 
 void VRProfiler::swap() {
     if (!isActive()) return;
 
-    boost::mutex::scoped_lock lock(mutex);
-    if (current) current->t1 = getTime();
-    Frame f;
-    f.t0 = getTime();
-    frames.push_front(f);
-    if (history <= (int)frames.size()) frames.pop_back();
-    current = &frames.front();
+    boost::mutex::scoped_lock lock(framesMutex);
+    long long t = getTime();
+    frames[current].t1 = t;
+    frames[current].running = false;
+    current = (current+1)%history;
+    frames[current] = Frame();
+    frames[current].t0 = t;
+}
+
+void VRProfiler::setHistoryLength(int N) {
+    if (N < 1) return;
+    boost::mutex::scoped_lock lock(framesMutex);
+    vector<Frame> tmp;
+    for (int i=N-1; i>=0; i--) tmp.push_back( i < history ? frames[(current-i+history)%history] : Frame() );
+    frames = tmp;
+    current = N-1;
+    history = N;
 }
 
-void VRProfiler::setHistoryLength(int N) { history = N; }
 int VRProfiler::getHistoryLength() { return history; }
+
+void VRProfiler::exportChromeTrace(string path) {
+    ofstream out(path);
+    if (!out.is_open()) { cout << "VRProfiler::exportChromeTrace failed to open " << path << endl; return; }
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    auto sep = [&]() { if (!first) out << ",\n"; first = false; };
+    auto us = [](long long ns) { return to_string(ns/1000) + "." + to_string(ns%1000/100); };
+
+    {
+        boost::mutex::scoped_lock lock(buffersMutex);
+        for (auto b : buffers) {
+            sep(); out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << b->ID << ",\"args\":{\"name\":\"" << escape(b->name) << "\"}}";
+
+            unsigned long long h = b->head.load(memory_order_acquire);
+            unsigned long long n = min(h, (unsigned long long)(ThreadBuffer::size - ThreadBuffer::size/8));
+            for (unsigned long long k = h-n; k<h; k++) {
+                Event e = b->events[k & (ThreadBuffer::size-1)];
+                if (e.name == 0) continue;
+                sep(); out << "{\"name\":\"" << escape(e.name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << b->ID;
+                out << ",\"ts\":" << us(e.t0) << ",\"dur\":" << us(e.t1-e.t0) << "}";
+            }
+        }
+    }
+
+    int framesID = -1;
+    sep(); out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << framesID << ",\"args\":{\"name\":\"frames\"}}";
+    for (auto& f : getFrames()) {
+        if (f.running || f.t0 == 0) continue;
+        sep(); out << "{\"name\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":" << framesID;
+        out << ",\"ts\":" << us(f.t0) << ",\"dur\":" << us(f.t1-f.t0) << "}";
+    }
+
+    out << "\n]}\n";
+    cout << "VRProfiler: exported chrome trace to " << path << endl;
+}
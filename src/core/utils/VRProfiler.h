@@ -1,55 +1,110 @@
 #ifndef VRPROFILER_H_INCLUDED
 #define VRPROFILER_H_INCLUDED
 
-#include <list>
-#include <map>
+#include <vector>
+#include <set>
+#include <string>
+#include <atomic>
 #include <boost/thread/mutex.hpp>
 
 using namespace std;
 
+/**
+    Every thread records its scopes into its own ring buffer, no locks are taken while recording.
+    Timestamps are monotonic nanoseconds, scopes nest and store their depth.
+    When the profiler is inactive recording a scope costs a single branch.
+    Use VRPROFILE_SCOPE("name") to profile a block, VRFunction calls are profiled automatically.
+*/
+
+#define VRPROFILE_CAT(a,b) a ## b
+#define VRPROFILE_CAT2(a,b) VRPROFILE_CAT(a,b)
+#define VRPROFILE_SCOPE(name) VRProfiler::Scope VRPROFILE_CAT2(profScope_, __LINE__)(name)
+
 class VRProfiler {
     public:
         struct Call {
             string name;
-            int t0;
-            int t1;
+            long long t0 = 0;
+            long long t1 = 0;
+            int depth = 0;
+            int thread = 0;
         };
 
         struct Frame {
-            int t0, t1;
+            long long t0 = 0;
+            long long t1 = 0;
             bool running = true;
-            map<int, Call> calls;
+            vector<Call> calls;
         };
 
-    private:
-        list<Frame> frames;
-        Frame* current = 0;
-        int ID = 0;
-        int history = 100;
-        bool active = true;
+        struct Event {
+            const char* name = 0;
+            long long t0 = 0;
+            long long t1 = 0;
+            int depth = 0;
+        };
 
-        boost::mutex mutex;
+        struct ThreadBuffer {
+            static const int size = 1<<14;
+            int ID = 0;
+            string name;
+            atomic<bool> inUse;
+            atomic<unsigned long long> head;
+            vector<Event> events;
+            Event stack[64];
+            int depth = 0;
+            ThreadBuffer();
+        };
 
-        int getTime();
+        class Scope {
+            private:
+                int ID = -1;
+            public:
+                Scope(const char* name);
+                Scope(const string& name);
+                ~Scope();
+        };
+
+        static atomic<bool> active;
+
+    private:
+        vector<ThreadBuffer*> buffers;
+        set<string> names;
+        boost::mutex buffersMutex;
+        boost::mutex namesMutex;
+
+        vector<Frame> frames;
+        int current = 0;
+        int history = 100;
+        boost::mutex framesMutex;
 
         VRProfiler();
 
+        ThreadBuffer* getBuffer();
+        const char* intern(const string& name);
+        void collect(Frame& f);
+
     public:
         static VRProfiler* get();
+        static long long getTime();
 
         void setActive(bool b);
         bool isActive();
 
-        int regStart(string name);
+        void setThreadName(string name);
+        int regStart(const char* name);
+        int regStart(const string& name);
         void regStop(int ID);
 
-        list<Frame> getFrames();
+        vector<Frame> getFrames();
         Frame getFrame(int i);
 
         void setHistoryLength(int N);
         int getHistoryLength();
 
         void swap();
+
+        void exportChromeTrace(string path);
 };
 
 #endif // VRPROFILER_H_INCLUDED
@@ -10,8 +10,20 @@ using namespace std;
 
 map<string, VRStorageFactoryCbPtr> VRStorage::factory = map<string, VRStorageFactoryCbPtr>();
 
-VRStorage::VRStorage() {
+VRStorage::VRStorage() {}
+
+/** storage that most objects never use is registered on the first save or load,
+    its setup functions are called before the ones registered by the constructors **/
+void VRStorage::setupStorage() {}
+
+void VRStorage::compileStorage() {
+    if (storageCompiled) return;
+    storageCompiled = true;
+    auto setups = f_setup;
+    f_setup.clear();
     store("persistency", &persistency);
+    setupStorage();
+    f_setup.insert(f_setup.end(), setups.begin(), setups.end());
 }
 
 void VRStorage::setPersistency(int p) { persistency = p; }
@@ -36,6 +48,7 @@ void VRStorage::setOverrideCallbacks(bool b) { overrideCallbacks = b; }
 void VRStorage::save(xmlpp::Element* e, int p) {
     if (e == 0) return;
     if (persistency <= p) return;
+    compileStorage();
     for (auto s : storage) (*s.second.f2)(e);
 }
 
@@ -51,6 +64,7 @@ xmlpp::Element* VRStorage::saveUnder(xmlpp::Element* e, int p, string t) {
 
 void VRStorage::load(xmlpp::Element* e) {
     if (e == 0) return;
+    compileStorage();
     for (auto f : f_setup_before) (*f)(0);
     for (auto s : storage) (*s.second.f1)(e);
     for (auto f : f_setup) (*f)(0);
@@ -29,8 +29,11 @@ class VRStorage {
         vector<VRUpdateCbPtr> f_setup; // called after loading
         vector<VRUpdateCbPtr> f_setup_after; // setup after tree loaded
         map<string, VRStorageBin> storage;
+        bool storageCompiled = false;
         static map<string, VRStorageFactoryCbPtr> factory;
 
+        void compileStorage();
+
         template<class T> static void typeFactoryCb(VRStoragePtr& s);
 
         void save_str_cb(string t, string tag, xmlpp::Element* e);
@@ -83,6 +86,9 @@ class VRStorage {
         static xmlpp::Element* getChild(xmlpp::Element* e, string c);
         static vector<xmlpp::Element*> getChildren(xmlpp::Element* e);
 
+    protected:
+        virtual void setupStorage();
+
     public:
         VRStorage();
 
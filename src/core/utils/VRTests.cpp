@@ -62,10 +62,607 @@ void vrpn_server() {
     if (setup) setup->startVRPNTestServer();
 }
 
-void VRRunTest(string test) {
+#include "core/math/Octree.h"
+#include "core/math/VRSpatialIndexT.h"
+#include <boost/function.hpp>
+#include <chrono>
+#include <functional>
+#include "core/utils/toString.h"
+
+double benchTime(boost::function<void ()> f) { // ms
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(t1-t0).count();
+}
+
+bool check(bool b, string what) {
+    if (!b) cout << " Failed: " << what << endl;
+    return b;
+}
+
+bool spatialIndexBenchmark() {
+    int N = 200000;
+    int Q = 10000;
+    float S = 10;
+    float r = 0.3;
+
+    srand(0);
+    auto rnd = [&]() { return Vec3f(rand()*S/RAND_MAX, rand()*S/RAND_MAX, rand()*S/RAND_MAX); };
+    vector<Vec3f> points, queries;
+    vector<int> data(N);
+    for (int i=0; i<N; i++) { points.push_back(rnd()); data[i] = i; }
+    for (int i=0; i<Q; i++) queries.push_back(rnd());
+
+    Octree oc(0.1, S);
+    VRSpatialIndex<int> si;
+    double tOcBuild = benchTime([&]() { for (int i=0; i<N; i++) oc.add(points[i], &data[i]); });
+    double tSiBuild = benchTime([&]() { si.build(points, data); });
+
+    size_t nOc = 0, nSi = 0;
+    double tOcRadius = benchTime([&]() { for (auto& q : queries) nOc += oc.radiusSearch(q, r).size(); });
+    vector<int> res;
+    double tSiRadius = benchTime([&]() { for (auto& q : queries) { res.clear(); si.radiusSearch(q, r, res); nSi += res.size(); } });
+
+    boundingbox bb;
+    double tOcBox = benchTime([&]() { for (auto& q : queries) { bb.clear(); bb.update(q); bb.update(q+Vec3f(r,r,r)); nOc += oc.boxSearch(bb).size(); } });
+    double tSiBox = benchTime([&]() { for (auto& q : queries) { res.clear(); si.boxSearch(q, q+Vec3f(r,r,r), res); nSi += res.size(); } });
+
+    int K = 8;
+    int knn[8];
+    float knnD[8];
+    double tSiKnn = benchTime([&]() { for (auto& q : queries) si.kNearest(q, K, knn, knnD); });
+
+    cout << "spatial index benchmark, " << N << " points, " << Q << " queries" << endl;
+    cout << " build   octree: " << tOcBuild << " ms, spatial index: " << tSiBuild << " ms" << endl;
+    cout << " radius  octree: " << tOcRadius << " ms, spatial index: " << tSiRadius << " ms" << endl;
+    cout << " box     octree: " << tOcBox << " ms, spatial index: " << tSiBox << " ms" << endl;
+    cout << " knn(" << K << ") spatial index: " << tSiKnn << " ms" << endl;
+    oc.clear();
+
+    bool ok = check(nOc == nSi, "result count octree " + toString(nOc) + ", spatial index " + toString(nSi));
+    for (int i=0; i<100; i++) { // against brute force
+        auto& q = queries[i];
+        size_t nRadius = 0, nBox = 0;
+        float d2 = 1e30;
+        for (auto& p : points) {
+            float d = (p-q).squareLength();
+            if (d <= r*r) nRadius++;
+            if (p[0] >= q[0] && p[1] >= q[1] && p[2] >= q[2] && p[0] <= q[0]+r && p[1] <= q[1]+r && p[2] <= q[2]+r) nBox++;
+            d2 = min(d2, d);
+        }
+        res.clear(); si.radiusSearch(q, r, res);
+        ok = check(res.size() == nRadius, "radius search of query " + toString(i)) && ok;
+        res.clear(); si.boxSearch(q, q+Vec3f(r,r,r), res);
+        ok = check(res.size() == nBox, "box search of query " + toString(i)) && ok;
+        int n = si.kNearest(q, K, knn, knnD);
+        ok = check(n == K && knnD[0] == d2, "nearest neighbour of query " + toString(i)) && ok;
+        for (int k=1; k<n; k++) ok = check(knnD[k-1] <= knnD[k], "knn order of query " + toString(i)) && ok;
+    }
+
+    int buffer[1] = { -1 };
+    ok = check(si.radiusSearch(queries[0], S, buffer, 0) == 0 && buffer[0] == -1, "radius search into an empty buffer") && ok;
+    ok = check(si.boxSearch(Vec3f(), Vec3f(S,S,S), buffer, 0) == 0 && buffer[0] == -1, "box search into an empty buffer") && ok;
+    ok = check(si.radiusSearch(queries[0], S, buffer, 1) == 1, "radius search into a buffer of one") && ok;
+    return ok;
+}
+
+bool objectRegistryBenchmark() {
+    int fanout = 10;
+    int depth = 5; // 111111 objects, about the size of a large CAD import
+    int Q = 1000;
+
+    vector<VRObjectPtr> objects;
+    function<void(VRObjectPtr, int)> build = [&](VRObjectPtr parent, int d) {
+        if (d == depth) return;
+        for (int i=0; i<fanout; i++) {
+            auto o = VRObject::create("node_" + toString(objects.size()));
+            objects.push_back(o);
+            parent->addChild(o);
+            build(o, d+1);
+        }
+    };
+
+    VRObjectPtr root;
+    double tBuild = benchTime([&]() { root = VRObject::create("registry_bench"); build(root, 0); });
+
+    srand(0);
+    vector<VRObjectPtr> queries;
+    for (int i=0; i<Q; i++) queries.push_back( objects[rand()%objects.size()] );
+
+    function<VRObjectPtr(VRObjectPtr, Node*)> walk = [&](VRObjectPtr o, Node* n) -> VRObjectPtr { // the old recursive lookup
+        if (o->getNode()->node.get() == n) return o;
+        for (size_t i=0; i<o->getChildrenCount(); i++) if (auto r = walk(o->getChild(i), n)) return r;
+        return 0;
+    };
+
+    int nWalk = 0, nNode = 0, nName = 0, nID = 0;
+    double tWalk = benchTime([&]() { for (auto& q : queries) nWalk += (walk(root, q->getNode()->node.get()) == q); });
+    double tNode = benchTime([&]() { for (auto& q : queries) nNode += (root->find(q->getNode()) == q); });
+    double tName = benchTime([&]() { for (auto& q : queries) nName += (root->find(q->getName()) == q); });
+    double tID = benchTime([&]() { for (auto& q : queries) nID += (root->find(q->getID()) == q); });
+
+    cout << "object registry benchmark, " << objects.size() << " objects, " << Q << " queries" << endl;
+    cout << " build tree: " << tBuild << " ms" << endl;
+    cout << " node lookup, tree walk: " << tWalk << " ms, registry: " << tNode << " ms" << endl;
+    cout << " name lookup, registry: " << tName << " ms" << endl;
+    cout << " ID lookup, registry: " << tID << " ms" << endl;
+    bool ok = check(nWalk == Q, "tree walk found " + toString(nWalk) + " of " + toString(Q));
+    ok = check(nNode == Q, "node lookup found " + toString(nNode) + " of " + toString(Q)) && ok;
+    ok = check(nName == Q, "name lookup found " + toString(nName) + " of " + toString(Q)) && ok;
+    ok = check(nID == Q, "ID lookup found " + toString(nID) + " of " + toString(Q)) && ok;
+
+    auto a = VRObject::create("registry_order"); // findAll and find return depth first order, not ID order
+    auto b = VRObject::create("registry_order");
+    auto c = VRObject::create("registry_order");
+    root->addChild(c);
+    c->addChild(b);
+    root->addChild(a);
+    auto all = root->findAll("registry_order");
+    ok = check(all.size() == 3 && all[0] == c && all[1] == b && all[2] == a, "findAll in tree order") && ok;
+    ok = check(root->find(b->getName()) == b, "find by unique name") && ok;
+
+    root->subChild(c);
+    ok = check(root->find(c->getName()) == 0 && root->find(b->getID()) == 0, "detached objects are not found") && ok;
+    ok = check(c->find(b->getNode()) == b, "detached subtree keeps its index") && ok;
+    return ok;
+}
+
+#include "addons/Algorithms/VRGraphLayout.h"
+bool graphLayoutTest() {
+    int N = 200;
+    float eps = 0.1;
+
+    srand(0);
+    vector<int> parents;
+    auto makeGraph = [&](float S, bool tree) {
+        auto g = Graph::create();
+        parents.clear();
+        for (int i=0; i<N; i++) {
+            int n = g->addNode();
+            auto& b = g->getNode(n).box;
+            Vec3f p(rand()*S/RAND_MAX, rand()*S/RAND_MAX, 0);
+            b.update(p - Vec3f(0.5,0.5,0));
+            b.update(p + Vec3f(0.5,0.5,0));
+            parents.push_back(tree && i > 0 ? rand()%i : -1);
+            if (parents[i] >= 0) g->connect(parents[i], n, Graph::HIERARCHY);
+        }
+        return g;
+    };
+
+    // overlapping unit boxes are pushed apart until no overlap is deeper than eps
+    auto g = makeGraph(12, false);
+    auto layout = VRGraphLayout::create();
+    layout->setGraph(g);
+    layout->setAlgorithm(VRGraphLayout::OCCUPANCYMAP, 0);
+    bool converged = false;
+    double t = benchTime([&]() { converged = layout->compute(2000, eps); });
+    bool ok = check(converged, "occupancy layout converged after " + toString(layout->getIterations()) + " iterations");
+
+    auto& nodes = g->getNodes();
+    float overlap = 0;
+    for (int i=0; i<N; i++) {
+        for (int j=i+1; j<N; j++) {
+            Vec3f d = nodes[i].box.center() - nodes[j].box.center();
+            overlap = max(overlap, min(1-abs(d[0]), 1-abs(d[1])));
+        }
+    }
+    ok = check(overlap < eps*1.05, "deepest box overlap " + toString(overlap)) && ok;
+
+    // the children of a random tree are pulled to the rest length of the springs, the root stays
+    auto tree = makeGraph(50, true);
+    Vec3f root = tree->getNode(0).box.center();
+    auto springs = VRGraphLayout::create();
+    springs->setGraph(tree);
+    springs->setAlgorithm(VRGraphLayout::SPRINGS, 0);
+    converged = springs->compute(2000, eps);
+    ok = check(converged, "spring layout converged after " + toString(springs->getIterations()) + " iterations") && ok;
+
+    auto& tnodes = tree->getNodes();
+    float error = 0;
+    for (int i=1; i<N; i++) {
+        auto& a = tnodes[i].box;
+        auto& b = tnodes[parents[i]].box;
+        float rest = 1 + a.radius() + b.radius(); // default layout radius
+        error = max(error, abs((a.center() - b.center()).length() - rest));
+    }
+    ok = check(error < eps*1.05, "largest spring length error " + toString(error)) && ok;
+    ok = check((tree->getNode(0).box.center() - root).length() < 1e-5, "root of the tree does not move") && ok;
+
+    cout << "graph layout test, " << N << " nodes, occupancy " << layout->getIterations() << " iterations in " << t << " ms, springs " << springs->getIterations() << " iterations" << endl;
+    return ok;
+}
+
+#include "core/math/VRGraphCSR.h"
+bool graphKernelsBenchmark() {
+    int W = 300; // grid graph, edges to the right and up
+    int N = W*W;
+    int Q = 100;
+
+    vector<Vec2i> edges;
+    vector<Vec3f> positions;
+    for (int i=0; i<W; i++) {
+        for (int j=0; j<W; j++) {
+            positions.push_back( Vec3f(i, j, 0) );
+            if (i < W-1) edges.push_back( Vec2i(i*W+j, (i+1)*W+j) );
+            if (j < W-1) edges.push_back( Vec2i(i*W+j, i*W+j+1) );
+        }
+    }
+
+    VRGraphCSR dag, csr;
+    double tBuild = benchTime([&]() { dag.build(N, edges, positions); csr.build(N, edges, positions, true); });
+
+    srand(0);
+    vector<Vec2i> queries;
+    for (int i=0; i<Q; i++) queries.push_back( Vec2i(rand()%N, rand()%N) );
+
+    size_t nBfs = 0, nDij = 0, nAstar = 0;
+    double tBfs = benchTime([&]() { for (auto& q : queries) nBfs += csr.bfs(q[0]).size(); });
+    double tDij = benchTime([&]() { for (auto& q : queries) nDij += csr.shortestPath(q[0], q[1]).size(); });
+    double tAstar = benchTime([&]() { for (auto& q : queries) nAstar += csr.shortestPathAStar(q[0], q[1]).size(); });
+
+    vector<int> labels, order;
+    int C = 0;
+    bool sorted = false;
+    double tComp = benchTime([&]() { C = csr.connectedComponents(labels); });
+    double tTopo = benchTime([&]() { sorted = dag.topologicalSort(order); });
+
+    VRGraphCSR small;
+    vector<Vec2i> smallEdges;
+    for (auto& e : edges) if (e[0] < 2*W && e[1] < 2*W) smallEdges.push_back(e);
+    small.build(2*W, smallEdges, positions, true);
+    vector<float> D;
+    double tAll = benchTime([&]() { small.allPairs(D); });
+
+    cout << "graph kernels benchmark, " << N << " nodes, " << csr.getNEdges() << " edge slots, " << Q << " queries" << endl;
+    cout << " build: " << tBuild << " ms" << endl;
+    cout << " bfs: " << tBfs << " ms, dijkstra: " << tDij << " ms, A*: " << tAstar << " ms" << endl;
+    cout << " components (" << C << "): " << tComp << " ms, topological sort (" << sorted << "): " << tTopo << " ms" << endl;
+    cout << " all pairs, " << small.size() << " nodes: " << tAll << " ms" << endl;
+
+    auto manhattan = [&](int a, int b) { return abs(a/W - b/W) + abs(a%W - b%W); }; // length of the shortest grid path
+    bool ok = check(nBfs == size_t(Q*N), "bfs visited " + toString(nBfs) + " of " + toString(Q*N) + " nodes");
+    ok = check(nDij == nAstar, "path sizes dijkstra " + toString(nDij) + ", A* " + toString(nAstar)) && ok;
+    ok = check(csr.bfs(W+1, 1).size() == 5, "bfs of depth one reaches the four grid neighbours") && ok;
+    for (int i=0; i<Q; i++) {
+        auto& q = queries[i];
+        float lDij = 0, lAstar = 0;
+        auto pDij = csr.shortestPath(q[0], q[1], &lDij);
+        auto pAstar = csr.shortestPathAStar(q[0], q[1], 0, &lAstar);
+        int L = manhattan(q[0], q[1]);
+        ok = check(lDij == L && lAstar == L, "path length of query " + toString(i) + ", dijkstra " + toString(lDij) + ", A* " + toString(lAstar) + ", grid " + toString(L)) && ok;
+        ok = check(int(pDij.size()) == L+1 && int(pAstar.size()) == L+1, "path size of query " + toString(i)) && ok;
+        bool steps = pDij.size() && pDij.front() == q[0] && pDij.back() == q[1];
+        for (size_t k=1; k<pDij.size(); k++) steps = steps && manhattan(pDij[k-1], pDij[k]) == 1;
+        ok = check(steps, "path of query " + toString(i) + " walks along grid edges") && ok;
+    }
+
+    vector<float> dist;
+    csr.distances(0, dist);
+    bool distOk = (int)dist.size() == N;
+    for (int i=0; i<N && distOk; i++) distOk = dist[i] == manhattan(0, i);
+    ok = check(distOk, "distances from the corner") && ok;
+    ok = check(C == 1, "grid has one component, not " + toString(C)) && ok;
+
+    vector<int> rank(N, -1);
+    for (size_t i=0; i<order.size(); i++) rank[order[i]] = i;
+    bool topoOk = sorted && (int)order.size() == N;
+    for (auto& e : edges) topoOk = topoOk && rank[e[0]] < rank[e[1]];
+    ok = check(topoOk, "topological order of the grid") && ok;
+
+    bool allOk = (int)D.size() == 4*W*W;
+    for (int i=0; i<2*W && allOk; i++) for (int j=0; j<2*W && allOk; j++) allOk = D[i*2*W+j] == manhattan(i, j);
+    ok = check(allOk, "all pairs distances of two grid rows") && ok;
+    return ok;
+}
+
+#include "core/math/VRMeshTopology.h"
+#include <algorithm>
+bool meshTopologyBenchmark() {
+    int W = 300; // grid of quads, each triangle with its own corners like a triangle soup from a scanner
+    float tol = 1e-4;
+
+    vector<Vec3f> soup;
+    auto vertex = [&](int i, int j) { return Vec3f(i*0.01, j*0.01, 0.1*sin(i*0.05)*cos(j*0.05)); };
+    for (int i=0; i<W-1; i++) {
+        for (int j=0; j<W-1; j++) {
+            soup.push_back(vertex(i,j)); soup.push_back(vertex(i+1,j)); soup.push_back(vertex(i+1,j+1));
+            soup.push_back(vertex(i,j)); soup.push_back(vertex(i+1,j+1)); soup.push_back(vertex(i,j+1));
+        }
+    }
+    int S = soup.size();
+
+    Octree oc(tol); // the old welding, one radius search per corner
+    vector<int> ocIDs(S);
+    int nOc = 0;
+    double tOc = benchTime([&]() {
+        for (int k=0; k<S; k++) {
+            auto res = oc.radiusSearch(soup[k], tol);
+            if (res.size()) { ocIDs[k] = *(int*)res[0]; continue; }
+            ocIDs[k] = nOc++;
+            oc.add(soup[k], &ocIDs[k]);
+        }
+    });
+
+    vector<int> remap, unique;
+    int nWeld = 0;
+    double tWeld = benchTime([&]() { nWeld = VRMeshTopology::weld(soup, tol, remap, unique); });
+
+    vector<Vec3f> points(nWeld);
+    for (int i=0; i<nWeld; i++) points[i] = soup[unique[i]];
+    VRMeshTopology topo;
+    double tBuild = benchTime([&]() { topo.build(points, remap); });
+    double tNormals = benchTime([&]() { topo.computeNormals(); });
+    double tCurv1 = benchTime([&]() { topo.computeCurvatures(1); });
+    double tCurv3 = benchTime([&]() { topo.computeCurvatures(3); });
+
+    cout << "mesh topology benchmark, " << S/3 << " triangles, " << S << " corners" << endl;
+    cout << " weld, octree: " << tOc << " ms, hash grid: " << tWeld << " ms" << endl;
+    cout << " topology: " << tBuild << " ms, " << topo.getNEdges() << " edges, " << topo.getBorderEdges().size() << " border edges" << endl;
+    cout << " normals: " << tNormals << " ms, curvatures range 1: " << tCurv1 << " ms, range 3: " << tCurv3 << " ms" << endl;
+    oc.clear();
+
+    bool ok = check(nWeld == W*W, "welded " + toString(nWeld) + " of " + toString(W*W) + " grid vertices");
+    ok = check(nOc == nWeld, "octree welded " + toString(nOc) + ", hash grid " + toString(nWeld)) && ok;
+    bool remapOk = (int)remap.size() == S;
+    for (int k=0; k<S && remapOk; k++) remapOk = remap[k] >= 0 && remap[k] < nWeld && (points[remap[k]] - soup[k]).length() <= tol;
+    ok = check(remapOk, "corners map to a welded vertex within the tolerance") && ok;
+
+    int T = 2*(W-1)*(W-1);
+    int E = 2*W*(W-1) + (W-1)*(W-1); // rows, columns and diagonals
+    ok = check(topo.getNTriangles() == T, "grid has " + toString(topo.getNTriangles()) + " triangles, not " + toString(T)) && ok;
+    ok = check(topo.getNEdges() == E, "grid has " + toString(topo.getNEdges()) + " edges, not " + toString(E)) && ok;
+    ok = check((int)topo.getBorderEdges().size() == 4*(W-1), "grid has " + toString(topo.getBorderEdges().size()) + " border edges") && ok;
+
+    float normalError = 0;
+    for (auto& n : topo.getNormals()) normalError = max(normalError, abs(n.length() - 1));
+    ok = check((int)topo.getNormals().size() == nWeld && normalError < 1e-4, "normals are unit length, error " + toString(normalError)) && ok;
+
+    // two triangles of a unit square, the adjacency is known
+    VRMeshTopology quad;
+    quad.build({ Vec3f(0,0,0), Vec3f(1,0,0), Vec3f(1,1,0), Vec3f(0,1,0) }, { 0,1,2, 0,2,3 });
+    quad.computeNormals();
+    auto sorted = [](vector<int> v) { sort(v.begin(), v.end()); return v; };
+    auto neighbors = [&](int i) { return sorted( vector<int>(quad.getNeighbors(i), quad.getNeighbors(i) + quad.getDegree(i)) ); };
+    ok = check(quad.getNEdges() == 5 && quad.getBorderEdges().size() == 4, "square has 5 edges, 4 on the border") && ok;
+    ok = check(neighbors(0) == vector<int>({1,2,3}) && neighbors(1) == vector<int>({0,2}), "square vertex neighbours") && ok;
+    ok = check(neighbors(2) == vector<int>({0,1,3}) && neighbors(3) == vector<int>({0,2}), "square vertex neighbours") && ok;
+    ok = check(sorted(quad.getVertexTriangles(0)) == vector<int>({0,1}) && quad.getVertexTriangles(1) == vector<int>({0}), "square vertex triangles") && ok;
+    for (int e=0; e<quad.getNEdges(); e++) {
+        Vec2i v = quad.getEdge(e);
+        bool diagonal = v == Vec2i(0,2);
+        ok = check(quad.isBorder(e) != diagonal && (int)quad.getEdgeTriangles(e).size() == (diagonal ? 2 : 1), "square edge " + toString(v)) && ok;
+    }
+    for (auto& n : quad.getNormals()) ok = check((n - Vec3f(0,0,1)).length() < 1e-5, "square normal " + toString(n)) && ok;
+    return ok;
+}
+
+#include "addons/Semantics/Reasoning/VROntology.h"
+#include "addons/Semantics/Reasoning/VRProperty.h"
+bool ontologyBenchmark() {
+    int N = 100000;
+    int Q = 1000;
+
+    auto onto = VROntology::create("benchmark");
+    auto vec = onto->addConcept("Vector");
+    vec->addProperty("x", "float");
+    vec->addProperty("y", "float");
+    vec->addProperty("z", "float");
+    auto element = onto->addConcept("Element");
+    element->addProperty("position", "Vector");
+    onto->addConcept("Road", "Element");
+    onto->addConcept("Lane", "Element");
+    onto->addConcept("Junction", "Road");
+
+    string types[3] = { "Road", "Lane", "Junction" };
+    vector<string> names;
+    double tBuild = benchTime([&]() {
+        for (int i=0; i<N; i++) {
+            auto e = onto->addEntity("element" + toString(i), types[i%3]);
+            vector<string> p = { toString(i%100), toString(i/100), "0" };
+            e->addVector("position", p, "Vector");
+            names.push_back(e->getName());
+        }
+    });
+
+    srand(0);
+    vector<string> queries;
+    for (int i=0; i<Q; i++) queries.push_back( names[rand()%N] );
+
+    int nScan = 0, nIndex = 0;
+    double tScan = benchTime([&]() { // the old lookup, a scan over all entities
+        for (int i=0; i<Q/10; i++) {
+            for (auto& e : onto->entities) if (e.second->getName() == queries[i]) { nScan++; break; }
+        }
+    });
+    double tIndex = benchTime([&]() { for (auto& q : queries) nIndex += (onto->getEntity(q) != 0); });
+
+    size_t nRoads = 0, nElements = 0;
+    double tExtent = benchTime([&]() { nRoads = onto->getEntities("Road").size(); nElements = onto->getEntities("Element").size(); });
+
+    Vec3f sum;
+    double tVec = benchTime([&]() { for (auto& q : queries) sum += onto->getEntity(q)->getVec3f("position"); });
+
+    cout << "ontology benchmark, " << onto->entities.size() << " entities, " << Q << " queries" << endl;
+    cout << " build: " << tBuild << " ms" << endl;
+    cout << " name lookup, scan: " << tScan*10 << " ms (extrapolated), index: " << tIndex << " ms" << endl;
+    cout << " extents, " << nRoads << " roads and " << nElements << " elements: " << tExtent << " ms" << endl;
+    cout << " vector property: " << tVec << " ms" << endl;
+
+    bool ok = check(nScan == Q/10 && nIndex == Q, "name lookups found " + toString(nScan) + " and " + toString(nIndex));
+    ok = check(nElements == (size_t)N, "extent of Element has " + toString(nElements) + " of " + toString(N) + " entities") && ok;
+    ok = check(nRoads == size_t(N - N/3), "extent of Road has " + toString(nRoads) + " entities, roads and junctions") && ok;
+    ok = check(onto->getEntities("Lane").size() == size_t(N/3), "extent of Lane") && ok;
+
+    // is_a closure of a tree and of a cycle, B is a A and A is a B
+    auto c = [&](string n) { return onto->getConcept(n); };
+    ok = check(c("Junction")->is_a("Road") && c("Junction")->is_a("Element") && c("Junction")->is_a("Thing"), "Junction is a Road, an Element and a Thing") && ok;
+    ok = check(!c("Lane")->is_a("Road") && !c("Road")->is_a("Junction") && !c("Road")->is_a(c("Lane")), "unrelated concepts") && ok;
+    auto A = onto->addConcept("CycleA", "Element");
+    auto B = onto->addConcept("CycleB", "CycleA");
+    B->append(A); // closes the cycle
+    ok = check(A->is_a(B) && B->is_a(A) && A->is_a("CycleB") && B->is_a("CycleA"), "concepts of a cycle are each other") && ok;
+    ok = check(B->is_a("Element") && B->is_a("Thing") && A->is_a("Element"), "concepts of a cycle inherit the ancestors of the cycle") && ok;
+    ok = check(!A->is_a("Road") && !B->is_a("Lane") && !c("Element")->is_a(A), "cycle has no other ancestors or descendants") && ok;
+
+    // extents follow the closure, entities with several concepts are listed once, ordered by ID
+    auto b = onto->addEntity("cycle_b", "CycleB");
+    auto l = onto->addEntity("lane_and_road", "Lane");
+    l->addConcept(c("Road"));
+    auto inA = onto->getEntities("CycleA");
+    ok = check(inA.size() == 1 && inA[0] == b, "extent of CycleA contains the CycleB entity") && ok;
+    auto elements = onto->getEntities("Element");
+    bool ordered = elements.size() == size_t(N+2);
+    for (size_t i=1; i<elements.size() && ordered; i++) ordered = elements[i-1]->ID < elements[i]->ID;
+    ok = check(ordered, "extent of Element has " + toString(elements.size()) + " entities, each once, ordered by ID") && ok;
+
+    // renamed entities are found by their new name only, lookups do not change the index
+    string old = l->getName();
+    onto->renameEntity(l, "renamed_lane");
+    ok = check(onto->getEntity("renamed_lane") == l && onto->getEntity(old) == 0 && onto->entityNames.count(old) == 0, "lookup of a renamed entity") && ok;
+    return ok;
+}
+
+#include "addons/Semantics/Reasoning/VRReasoner.h"
+bool queryBenchmark() {
+    int N = 2000; // roads
+    int Q = 50;
+
+    auto onto = VROntology::create("benchmark");
+    onto->addConcept("Node");
+    onto->addConcept("Path")->addProperty("nodes", "Node");
+    onto->addConcept("Road")->addProperty("path", "Path");
+    for (int i=0; i<=N; i++) onto->addEntity("node" + toString(i), "Node");
+    for (int i=0; i<N; i++) {
+        auto path = onto->addEntity("path" + toString(i), "Path");
+        path->add("nodes", "node" + toString(i));
+        path->add("nodes", "node" + toString(i+1));
+        onto->addEntity("road" + toString(i), "Road")->add("path", path->getName());
+    }
+
+    bool gui = VRReasoner::verbGui;
+    bool console = VRReasoner::verbConsole;
+    VRReasoner::verbGui = VRReasoner::verbConsole = false;
+
+    string q = "q(r):Node($0);Road(r);has(r.path.nodes,$0)";
+    size_t nReasoner = 0, nPlan = 0, nCached = 0;
+    double tReasoner = benchTime([&]() {
+        for (int i=0; i<Q; i++) {
+            string n = "node" + toString(i*N/Q + 1);
+            nReasoner += VRReasoner::create()->process("q(r):Node("+n+");Road(r);has(r.path.nodes,"+n+")", onto).size();
+        }
+    });
+    double tPlan = benchTime([&]() { for (int i=0; i<Q; i++) nPlan += onto->process(q, { "node" + toString(i*N/Q + 1) }).size(); });
+    double tCached = benchTime([&]() { for (int i=0; i<Q; i++) nCached += onto->process(q, { "node" + toString(i*N/Q + 1) }).size(); });
+
+    VRReasoner::verbGui = gui;
+    VRReasoner::verbConsole = console;
+
+    cout << "query benchmark, " << onto->entities.size() << " entities, " << Q << " queries" << endl;
+    cout << " reasoner: " << tReasoner << " ms" << endl;
+    cout << " query plan: " << tPlan << " ms, cached: " << tCached << " ms" << endl;
+
+    bool ok = true;
+    ok = check(nReasoner == size_t(2*Q), "reasoner found " + toString(nReasoner) + " roads, expected " + toString(2*Q)) && ok; // each node joins two paths
+    ok = check(nPlan == nReasoner, "query plan found " + toString(nPlan) + " roads, the reasoner " + toString(nReasoner)) && ok;
+    ok = check(nCached == nReasoner, "cached plan found " + toString(nCached) + " roads, the reasoner " + toString(nReasoner)) && ok;
+
+    auto r = onto->addRule("has(r.path,p):Road(r);Path(p)", "Road");
+    ok = check(onto->hasHasRules(), "has rule disables the query plans") && ok;
+    onto->remRule(r);
+    ok = check(!onto->hasHasRules(), "removed has rule enables the query plans") && ok;
+    return ok;
+}
+
+#include "core/utils/VRName.h"
+#include <boost/thread/thread.hpp>
+#include <set>
+bool nameBenchmark() {
+    int N = 100000;
+    int T = 4;
+
+    vector<VRObjectPtr> objects;
+    double tObjects = benchTime([&]() { for (int i=0; i<N; i++) objects.push_back( VRObject::create("tree") ); });
+    bool lastOk = objects.back()->getName() == "tree." + toString(N-1);
+
+    for (int i=0; i<N; i+=2) objects[i] = 0; // free every even suffix
+    double tReuse = benchTime([&]() { for (int i=0; i<N; i+=2) objects[i] = VRObject::create("tree"); });
+    bool reuseOk = objects[N-2]->getName() == "tree." + toString(N-2);
+    objects.clear();
+
+    vector<vector<VRName*> > names(T);
+    double tThreads = benchTime([&]() {
+        vector<boost::thread*> threads;
+        for (int t=0; t<T; t++) threads.push_back( new boost::thread([&names, t, N]() {
+            for (int i=0; i<N; i++) { auto n = new VRName(); n->setName("part"); names[t].push_back(n); }
+        }) );
+        for (auto t : threads) { t->join(); delete t; }
+    });
+
+    set<string> unique;
+    for (auto& v : names) for (auto n : v) unique.insert(n->getName());
+    for (auto& v : names) for (auto n : v) delete n;
+
+    cout << "name benchmark, " << N << " objects with the same name" << endl;
+    cout << " create objects: " << tObjects << " ms, recreate every second object: " << tReuse << " ms" << endl;
+    cout << " create " << T << "x" << N << " names in " << T << " threads: " << tThreads << " ms" << endl;
+
+    bool ok = true;
+    ok = check(lastOk, "suffix of the last object") && ok;
+    ok = check(reuseOk, "freed suffixes are reused") && ok;
+    ok = check((int)unique.size() == T*N, toString(T*N - (int)unique.size()) + " duplicate names created in threads") && ok;
+    return ok;
+}
+
+#include "core/setup/devices/VRPickEngine.h"
+#include "core/utils/VRGlobals.h"
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGGeoProperties.h>
+bool pickEngineTest() {
+    auto root = VRObject::create("pick_test");
+    auto geo = VRGeometry::create("pick_box");
+    geo->setPrimitive("Box", "1 1 1 1 1 1");
+    root->addChild(geo);
+
+    auto engine = VRPickEngine::get();
+    Line ray(Pnt3f(0.2,0.1,5), Vec3f(0,0,-1));
+    size_t n0 = engine->getMeshUpdates();
+    auto hit1 = engine->intersect(root, ray);
+    size_t n1 = engine->getMeshUpdates();
+    auto hit2 = engine->intersect(root, ray);
+    size_t n2 = engine->getMeshUpdates();
+
+    bool ok = check(hit1.hit && abs(hit1.t - 4.5) < 1e-4, "hit of the box at t " + toString(hit1.t));
+    ok = check(n1 == n0+1, "first pick builds the mesh hierarchy") && ok;
+    ok = check(n2 == n1, "second pick of the unchanged mesh does not rebuild") && ok;
+    ok = check(hit2.hit && hit2.t == hit1.t && hit2.triangle == hit1.triangle, "second pick has the same hit") && ok;
+
+    VRGlobals::CURRENT_FRAME++; // the mesh is scaled in place in a later frame
+    auto pos = geo->getMesh()->geo->getPositions();
+    for (uint i=0; i<pos->size(); i++) pos->setValue(pos->getValue<Pnt3f>(i)*2, i);
+    geo->setPositions(pos);
+    auto hit3 = engine->intersect(root, ray);
+    ok = check(engine->getMeshUpdates() == n2+1, "changed mesh is rebuilt") && ok;
+    ok = check(hit3.hit && abs(hit3.t - 4) < 1e-4, "hit of the changed box at t " + toString(hit3.t)) && ok;
+    return ok;
+}
+
+bool VRRunTest(string test) {
     cout << "run test " << test << endl;
+    bool ok = true;
 
     if (test == "listActiveMaterials") listActiveMaterials();
     if (test == "vrpn_client") vrpn_client();
     if (test == "vrpn_server") vrpn_server();
+    if (test == "spatialIndexBenchmark") ok = spatialIndexBenchmark();
+    if (test == "objectRegistryBenchmark") ok = objectRegistryBenchmark();
+    if (test == "graphLayoutTest") ok = graphLayoutTest();
+    if (test == "graphKernelsBenchmark") ok = graphKernelsBenchmark();
+    if (test == "meshTopologyBenchmark") ok = meshTopologyBenchmark();
+    if (test == "ontologyBenchmark") ok = ontologyBenchmark();
+    if (test == "queryBenchmark") ok = queryBenchmark();
+    if (test == "nameBenchmark") ok = nameBenchmark();
+    if (test == "pickEngineTest") ok = pickEngineTest();
+    if (!ok) cout << "test " << test << " failed" << endl;
+    return ok;
 }
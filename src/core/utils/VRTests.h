@@ -5,6 +5,6 @@
 
 using namespace std;
 
-void VRRunTest(string test);
+bool VRRunTest(string test); // false if a check of the test failed
 
 #endif // VRTESTS_H_INCLUDED